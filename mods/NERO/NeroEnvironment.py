@@ -245,7 +245,10 @@ class NeroEnvironment(OpenNero.Environment):
         min_enemy = None
         min_dist = constants.MAX_FIRE_ACTION_RADIUS
         pose = self.get_state(agent).pose
-        color = OpenNero.Color(128, 0, 0, 0)
+
+        # cast the rays to all the foes in range in one batch
+        candidates = []
+        rays = []
         for f in foes:
             f_pose = self.get_state(f).pose
             dist = self.distance(pose, f_pose)
@@ -254,16 +257,16 @@ class NeroEnvironment(OpenNero.Environment):
                 target_pos = f.state.position
                 source_pos.z = source_pos.z + 5
                 target_pos.z = target_pos.z + 5
-                obstacles = OpenNero.getSimContext().findInRay(
-                    source_pos,
-                    target_pos,
-                    constants.OBJECT_TYPE_OBSTACLE,
-                    False,
-                    color,
-                    color)
-                if len(obstacles) == 0:
-                    min_enemy = f
-                    min_dist = dist
+                candidates.append((f, dist))
+                rays.append((source_pos, target_pos, constants.OBJECT_TYPE_OBSTACLE))
+        if not rays:
+            return None
+        hits = OpenNero.getSimContext().findInRays(rays)
+
+        for (f, dist), (hit_id, hit_pos) in zip(candidates, hits):
+            if hit_id == 0 and dist < min_dist:
+                min_enemy = f
+                min_dist = dist
         return min_enemy
 
     def step(self, agent, action):
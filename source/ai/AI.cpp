@@ -118,36 +118,47 @@ namespace OpenNero
     FeatureVector FeatureVectorInfo::getInstance() const
     {
         FeatureVector result;
-        FeatureVector::const_iterator iter;
+        getInstance(result);
+        return result;
+    }
+
+    void FeatureVectorInfo::getInstance(FeatureVector& result) const
+    {
+        result.resize(size());
         for (size_t i = 0; i < size(); ++i)
         {
             // if 0 is an in-bounds value, use it
             if (lower[i] <= 0 && 0 <= upper[i]) {
-                result.push_back(0);
+                result[i] = 0;
             }
             else // otherwise, use the lower bound
             {
-                result.push_back(lower[i]);
+                result[i] = lower[i];
             }
         }
-        return result;
     }
     
     FeatureVector FeatureVectorInfo::getRandom() const
     {
         FeatureVector result;
+        getRandom(result);
+        return result;
+    }
+
+    void FeatureVectorInfo::getRandom(FeatureVector& result) const
+    {
+        result.resize(size());
         for (size_t i = 0; i < size(); ++i)
         {
             if (isDiscrete(i))
             {
-                result.push_back(RANDOM.randI( (uint32_t)(getMax(i) - getMin(i)) ) + getMin(i));
+                result[i] = RANDOM.randI( (uint32_t)(getMax(i) - getMin(i)) ) + getMin(i);
             }
             else
             {
-                result.push_back(RANDOM.randD(getMax(i) - getMin(i)) + getMin(i));
+                result[i] = RANDOM.randD(getMax(i) - getMin(i)) + getMin(i);
             }
         }
-        return result;
     }
     
     /// get a bounded array info from a string
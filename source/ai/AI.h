@@ -115,9 +115,15 @@ namespace OpenNero {
         /// create a vector of the appropriate size
         FeatureVector getInstance() const;
 
+        /// reset a vector to the values of getInstance() without reallocating it
+        void getInstance(FeatureVector& result) const;
+
         /// create a feature vector initialized randomly
         FeatureVector getRandom() const;
 
+        /// fill a vector with random values without reallocating it
+        void getRandom(FeatureVector& result) const;
+
         /// get the bounds on a particular element
         Bound getBound(size_t i);
 
@@ -194,6 +200,8 @@ namespace OpenNero {
     size_t hash_value(const StateActionPair& sa_pair);
     
     /// addition operator for Reward, Observation and Action vectors
+    /// (the binary operators allocate their result, so code that runs every
+    /// tick should use the compound assignment operators instead)
     FeatureVector operator+(const FeatureVector& left, const FeatureVector& right);
     
     /// addition operator for Reward, Observation and Action vectors
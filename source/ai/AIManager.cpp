@@ -1,11 +1,13 @@
 #include "core/Common.h"
 #include <vector>
 #include <map>
+#include <stdexcept>
 #include "ai/AIManager.h"
 #include "ai/AI.h"
 #include "ai/AgentBrain.h"
 #include "ai/Environment.h"
 #include "core/Log.h"
+#include "rtneat/neat.h"
 #include "scripting/scriptIncludes.h"
 
 using namespace std;
@@ -37,6 +39,23 @@ namespace OpenNero
         mEnabled = state;
     }
 
+    /// set the number of threads that make the decisions of C++ agent brains
+    void AIManager::SetNumThreads(size_t num_threads)
+    {
+        if (num_threads == GetNumThreads())
+        {
+            return;
+        }
+        mThreadPool.reset();
+        if (num_threads > 1)
+        {
+            mThreadPool.reset(new ThreadPool(num_threads));
+        }
+        // rtNEAT speciates populations on the same threads
+        NEAT::thread_pool = mThreadPool;
+        LOG_F_MSG("ai", "AI decisions are made by " << GetNumThreads() << " thread(s)");
+    }
+
     /// get the currently selected AI Environment
     EnvironmentPtr AIManager::GetEnvironment() const { return mEnvironment; }
 
@@ -49,10 +68,33 @@ namespace OpenNero
         mEnvironment = env;
     }
 
+    /// perform the actions of a batch of agents in the current Environment
+    void AIManager::StepAgents(const std::vector<AgentBrainPtr>& agents,
+                               const std::vector<double>& actions,
+                               std::vector<double>& observations,
+                               std::vector<double>& rewards,
+                               std::vector<uint8_t>& dones)
+    {
+        if (!mEnvironment)
+            throw std::runtime_error("No environment to step the agents in");
+        mEnvironment->step_all(agents, actions, observations, rewards, dones);
+    }
+
+    /// start a new episode for a batch of agents in the current Environment
+    void AIManager::ResetAgents(const std::vector<AgentBrainPtr>& agents,
+                                std::vector<double>& observations)
+    {
+        if (!mEnvironment)
+            throw std::runtime_error("No environment to reset the agents in");
+        mEnvironment->reset_all(agents, observations);
+    }
+
     /// Shutdown and clean-up the AI subsystem
     void AIManager::destroy()
     {
         SetEnabled(false);
+        mThreadPool.reset();
+        NEAT::thread_pool.reset();
         if (mEnvironment) {
             mEnvironment->cleanup();
             mEnvironment.reset();
@@ -76,8 +118,8 @@ namespace OpenNero
     void AIManager::Log(SimId id, 
                         size_t episode, 
                         size_t step, 
-                        Reward reward, 
-                        Reward fitness)
+                        const Reward& reward, 
+                        const Reward& fitness)
     {
         //stringstream ss;
         //GetStaticTimer().stamp(ss);
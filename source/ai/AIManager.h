@@ -3,6 +3,7 @@
 
 #include <set>
 #include "ai/AI.h"
+#include "core/ThreadPool.h"
 
 namespace OpenNero
 {
@@ -18,7 +19,7 @@ namespace OpenNero
     class AIManager
     {
         // private constructor
-        AIManager() : mEnabled(false), mEnvironment() {}
+        AIManager() : mEnabled(false), mEnvironment(), mThreadPool() {}
 
     public:
         /// singleton instance of class
@@ -37,12 +38,35 @@ namespace OpenNero
         /// tick the AIs
         void ProcessTick( float32_t incAmt );
 
+        /// set the number of threads that make the decisions of C++ agent brains
+        /// (1 makes all the decisions one after another on the main thread)
+        void SetNumThreads(size_t num_threads);
+
+        /// get the number of threads that make the decisions of C++ agent brains
+        size_t GetNumThreads() const { return mThreadPool ? mThreadPool->GetNumThreads() : 1; }
+
+        /// get the pool of threads to make decisions with (empty if there is only one)
+        ThreadPoolPtr GetThreadPool() const { return mThreadPool; }
+
         /// get the currently selected AI Environment
         EnvironmentPtr GetEnvironment() const;
 
         /// set the currently selected AI Environment
         void SetEnvironment(EnvironmentPtr env);
 
+        /// perform the actions of a batch of agents in the current Environment
+        /// and sense the results (see Environment::step_all)
+        void StepAgents(const std::vector<AgentBrainPtr>& agents,
+                        const std::vector<double>& actions,
+                        std::vector<double>& observations,
+                        std::vector<double>& rewards,
+                        std::vector<uint8_t>& dones);
+
+        /// start a new episode for a batch of agents in the current Environment
+        /// (see Environment::reset_all)
+        void ResetAgents(const std::vector<AgentBrainPtr>& agents,
+                         std::vector<double>& observations);
+
         /// get the named AI instance if available
         AIPtr GetAI(const std::string& name) const;
 
@@ -50,7 +74,7 @@ namespace OpenNero
         void SetAI(const std::string& name, AIPtr ai);
 
         /// log the performance of AI agents
-        void Log(SimId id, size_t episode, size_t step, Reward reward, Reward fitness);
+        void Log(SimId id, size_t episode, size_t step, const Reward& reward, const Reward& fitness);
         
         /// reset the ai (remove the ai systems)
         void Reset();
@@ -62,6 +86,7 @@ namespace OpenNero
         bool mEnabled; ///< global "disable AI" switch
         EnvironmentPtr mEnvironment; ///< current environment
         std::map<std::string, AIPtr> mAIs; ///< AIs currently used
+        ThreadPoolPtr mThreadPool; ///< threads for making agent decisions in parallel
     };
 
 }
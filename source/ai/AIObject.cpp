@@ -51,43 +51,113 @@ namespace OpenNero
     
     /// get the AI move and apply it to the shared data
     void AIObject::ProcessTick(float32_t dt)
+    {
+        if (BeginTick(dt))
+        {
+            Decide(dt);
+            FinishTick(dt);
+        }
+    }
+
+    /// end the episode if it is over, otherwise sense the world
+    bool AIObject::BeginTick(float32_t dt)
     {
         Assert(getBrain());
+        Assert(getWorld());
 
+        if (getBrain()->step != 0 && getWorld()->is_episode_over(getBrain())) 
+        {
+            getBrain()->end(dt, getReward());
+            StartNewEpisode();
+            return false;
+        }
+
+        senseInto(mObservations);
+        return true;
+    }
+
+    /// let the brain choose the next action from the sensed observations
+    void AIObject::Decide(float32_t dt)
+    {
         if (getBrain()->step == 0) // if first step
         {
-            Observations observations = sense();
-            setActions(getBrain()->start(dt, observations));
-            setReward(getWorld()->step(getBrain(), getActions()));
-            getBrain()->step++;
+            getBrain()->start_into(dt, mObservations, mActions);
         }
-        else
+        else if (!getBrain()->GetSkip()) // only generate new actions when not skipping
         {
-            Assert(getWorld());
-            if (getWorld()->is_episode_over(getBrain())) {
-                getBrain()->end(dt, getReward());
-                getWorld()->reset(getBrain());
-                getBrain()->episode++;
-                getBrain()->step = 0;
-                getBrain()->fitness = getInitInfo().reward.getInstance();
-            } else {
-                Observations observations = sense();
-                if (!getBrain()->GetSkip()) // only generate new actions when not skipping
-                    setActions(getBrain()->act(dt, observations, getReward()));
-                setReward(getWorld()->step(getBrain(), getActions()));
-                getBrain()->step++;
-            }
+            getBrain()->act_into(dt, mObservations, mReward, mActions);
         }
     }
-    
-    void AIObject::setReward(Reward reward)
+
+    /// apply the chosen action to the world
+    void AIObject::FinishTick(float32_t /*dt*/)
+    {
+        getWorld()->step_into(getBrain(), mActions, mReward);
+        AccumulateReward();
+        getBrain()->step++;
+    }
+
+    /// apply actions chosen outside of the brain and sense the result
+    const Reward& AIObject::StepExternally(const Actions& actions, bool& done)
+    {
+        Assert(getBrain());
+        Assert(getWorld());
+
+        mActions = actions;
+        FinishTick(0);
+        done = getWorld()->is_episode_over(getBrain());
+        if (done)
+        {
+            getBrain()->end(0, getReward());
+            StartNewEpisode();
+        }
+        senseInto(mObservations);
+        return mReward;
+    }
+
+    /// start a new episode and sense the world
+    void AIObject::ResetExternally()
     {
         Assert(getBrain());
-        AssertMsg(getBrain()->fitness.size() == reward.size(), "AgentBrain fitness and reward dimensions must match");
+        Assert(getWorld());
+
+        StartNewEpisode();
+        senseInto(mObservations);
+    }
+
+    /// reset the world for the brain and start counting a new episode
+    void AIObject::StartNewEpisode()
+    {
+        getWorld()->reset(getBrain());
+        getBrain()->episode++;
+        getBrain()->step = 0;
+        getInitInfo().reward.getInstance(getBrain()->fitness);
+    }
+
+    /// can Decide() run on a worker thread?
+    bool AIObject::CanDecideInParallel() const
+    {
+        // brains implemented in Python need the interpreter lock; this
+        // includes the rtNEAT agents of the mods, which are Python brains
+        // that activate their organism's network from act() (they can
+        // batch their networks with RTNEAT.activate_all instead)
+        return getBrain() && !dynamic_cast<PyAgentBrain*>(getBrain().get());
+    }
+
+    void AIObject::setReward(const Reward& reward)
+    {
         mReward = reward;
-		for (size_t i = 0; i < reward.size(); ++i)
+        AccumulateReward();
+    }
+
+    /// add the most recent reward to the fitness of the brain and log it
+    void AIObject::AccumulateReward()
+    {
+        Assert(getBrain());
+        AssertMsg(getBrain()->fitness.size() == mReward.size(), "AgentBrain fitness and reward dimensions must match");
+		for (size_t i = 0; i < mReward.size(); ++i)
 		{
-			getBrain()->fitness[i] += reward[i];
+			getBrain()->fitness[i] += mReward[i];
 		}
         AIManager::instance().Log
             (GetSharedState()->GetId(),
@@ -100,13 +170,20 @@ namespace OpenNero
     /// sense the agent's environment
     Observations AIObject::sense()
     {
-        // create a new observation vector
-        Observations o = getInitInfo().sensors.getInstance();
+        Observations observations;
+        senseInto(observations);
+        return observations;
+    }
+
+    /// sense the agent's environment into caller-owned storage
+    void AIObject::senseInto(Observations& observations)
+    {
+        // reset the observation vector
+        getInitInfo().sensors.getInstance(observations);
         // first, pass it along to the built-in sensors so that they can set some of the values
-        mSensors.getObservations(o);
+        mSensors.getObservations(observations);
         // then, pass it to the environment and let it compute the final sensor vector
-        Observations observations = getWorld()->sense(getBrain(), o);
-        return observations;
+        getWorld()->sense_into(getBrain(), observations);
     }
 
     inline std::ostream& operator<<(std::ostream& out, AIObject& obj)
@@ -37,9 +37,50 @@ namespace OpenNero
         /// get the AI move and apply it to the shared data
         virtual void ProcessTick(float32_t dt);
 
+        /// The three phases of ProcessTick, so that the decisions of many 
+        /// agents can be made in parallel between the serial phases
+        /// @{
+
+        /// end the episode if it is over, otherwise sense the world
+        /// @return true iff the agent should go on to Decide() and FinishTick()
+        bool BeginTick(float32_t dt);
+
+        /// let the brain choose the next action from the sensed observations
+        void Decide(float32_t dt);
+
+        /// apply the chosen action to the world
+        void FinishTick(float32_t dt);
+
+        /// @}
+
+        /// can Decide() run on a worker thread? (only if the brain is not Python,
+        /// so Python rtNEAT agents always decide on the main thread)
+        bool CanDecideInParallel() const;
+
+        /// Stepping with actions chosen outside of the brain, one gym-style
+        /// step at a time (see Environment::step_all)
+        /// @{
+
+        /// apply the actions, start a new episode if this one is over and sense the world
+        /// @param actions the actions to perform
+        /// @param done set to true iff the episode ended with this step
+        /// @return the reward for the actions
+        const Reward& StepExternally(const Actions& actions, bool& done);
+
+        /// start a new episode and sense the world
+        void ResetExternally();
+
+        /// the observations sensed by the last BeginTick, StepExternally or ResetExternally
+        const Observations& getObservations() const { return mObservations; }
+
+        /// @}
+
         /// sense the agent's environment
         virtual Observations sense();
 
+        /// sense the agent's environment into caller-owned storage
+        void senseInto(Observations& observations);
+
         /// add a new sensor to the built-in sensor collection for this AIObject
         size_t add_sensor(SensorPtr sensor) { return mSensors.addSensor(sensor); }
 
@@ -62,7 +103,7 @@ namespace OpenNero
         EnvironmentPtr getWorld() const { return mWorld.lock(); }
 
         /// set the most recent reward for this AIObject
-        void setReward(Reward reward);
+        void setReward(const Reward& reward);
 
         /// get the most recent reward for this AIObject
         Reward getReward() const { return mReward; }
@@ -75,6 +116,17 @@ namespace OpenNero
 
     private:
 
+        /// reset the world for the brain and start counting a new episode
+        void StartNewEpisode();
+
+        /// add the most recent reward to the fitness of the brain and log it
+        void AccumulateReward();
+
+    private:
+
+        // The observations, actions and reward are reused from tick to tick,
+        // so once they have grown to size a tick does not allocate them again.
+        Observations mObservations; ///< observations sensed at the beginning of the tick
         Actions mActions; ///< last performed action
         AgentBrainPtr mAgentBrain; ///< the brain whose actions we are applying
         EnvironmentWPtr mWorld; ///< world we are acting in
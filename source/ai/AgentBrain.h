@@ -56,6 +56,20 @@ namespace OpenNero
             /// act based on time, sensor arrays, and last reward
             virtual Actions act(const TimeType& time, const Observations& observations, const Reward& reward) = 0;
 
+            /// like start, but write the actions into caller-owned storage
+            /// (brains implemented in C++ override this so that no vectors
+            ///  are allocated every tick; the default calls start)
+            virtual void start_into(const TimeType& time, const Observations& observations, Actions& actions)
+            {
+                actions = start(time, observations);
+            }
+
+            /// like act, but write the actions into caller-owned storage
+            virtual void act_into(const TimeType& time, const Observations& observations, const Reward& reward, Actions& actions)
+            {
+                actions = act(time, observations, reward);
+            }
+
             /// called to tell agent about its last reward
             virtual bool end(const TimeType& time, const Reward& reward) = 0;
 
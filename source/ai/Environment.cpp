@@ -1,18 +1,127 @@
 #include "core/Common.h"
 #include "Environment.h"
+#include "ai/AIObject.h"
+#include "ai/AgentBrain.h"
 
 #include "scripting/scriptIncludes.h"
+#include <sstream>
+#include <stdexcept>
 
 namespace OpenNero
 {
     using namespace boost::python;
 
+    namespace
+    {
+        /// the body of an agent handed in by a script, which may be missing
+        AIObjectPtr body_of(const std::vector<AgentBrainPtr>& agents, size_t i)
+        {
+            AIObjectPtr body = agents[i] ? agents[i]->GetBody() : AIObjectPtr();
+            if (!body)
+            {
+                std::ostringstream message;
+                message << "Agent " << i << " has no body";
+                throw std::invalid_argument(message.str());
+            }
+            return body;
+        }
+    }
+
     /// Constructor
     Environment::~Environment()
     {
         // do nothing here
     }
 
+    /// perform the actions and write the reward into caller-owned storage
+    void Environment::step_into(AgentBrainPtr agent, const Actions& action, Reward& reward)
+    {
+        reward = step(agent, action);
+    }
+
+    /// sense the agent's environment in place
+    void Environment::sense_into(AgentBrainPtr agent, Observations& observations)
+    {
+        observations = sense(agent, observations);
+    }
+
+    /// perform the actions of a batch of agents and sense the results
+    void Environment::step_all(const std::vector<AgentBrainPtr>& agents,
+                               const std::vector<double>& actions,
+                               std::vector<double>& observations,
+                               std::vector<double>& rewards,
+                               std::vector<uint8_t>& dones)
+    {
+        observations.clear();
+        rewards.clear();
+        dones.clear();
+        if (agents.empty())
+        {
+            return;
+        }
+
+        // check the whole batch before any of the agents moves
+        std::vector<AIObjectPtr> bodies;
+        bodies.reserve(agents.size());
+        for (size_t i = 0; i < agents.size(); ++i)
+        {
+            bodies.push_back(body_of(agents, i));
+        }
+        const AgentInitInfo& info = bodies[0]->getInitInfo();
+        size_t num_actions = info.actions.size();
+        if (num_actions * agents.size() != actions.size())
+        {
+            std::ostringstream message;
+            message << "Got " << actions.size() << " actions for " << agents.size() << " agents with " << num_actions << " actions each";
+            throw std::invalid_argument(message.str());
+        }
+        for (size_t i = 1; i < bodies.size(); ++i)
+        {
+            if (bodies[i]->getInitInfo().actions.size() != num_actions ||
+                bodies[i]->getInitInfo().sensors.size() != info.sensors.size() ||
+                bodies[i]->getInitInfo().reward.size() != info.reward.size())
+            {
+                throw std::invalid_argument("All of the agents stepped together must have the same numbers of actions, sensors and rewards");
+            }
+        }
+        observations.reserve(agents.size() * info.sensors.size());
+        rewards.reserve(agents.size() * info.reward.size());
+        dones.reserve(agents.size());
+
+        Actions action(num_actions);
+        for (size_t i = 0; i < agents.size(); ++i)
+        {
+            AIObjectPtr body = bodies[i];
+            std::copy(actions.begin() + i * num_actions, actions.begin() + (i + 1) * num_actions, action.begin());
+            bool done = false;
+            const Reward& reward = body->StepExternally(action, done);
+            const Observations& sensed = body->getObservations();
+            observations.insert(observations.end(), sensed.begin(), sensed.end());
+            rewards.insert(rewards.end(), reward.begin(), reward.end());
+            dones.push_back(done ? 1 : 0);
+        }
+    }
+
+    /// start a new episode for each of a batch of agents
+    void Environment::reset_all(const std::vector<AgentBrainPtr>& agents,
+                                std::vector<double>& observations)
+    {
+        observations.clear();
+        std::vector<AIObjectPtr> bodies;
+        bodies.reserve(agents.size());
+        for (size_t i = 0; i < agents.size(); ++i)
+        {
+            bodies.push_back(body_of(agents, i));
+        }
+        for (size_t i = 0; i < bodies.size(); ++i)
+        {
+            AIObjectPtr body = bodies[i];
+            body->ResetExternally();
+            const Observations& sensed = body->getObservations();
+            observations.insert(observations.end(), sensed.begin(), sensed.end());
+        }
+    }
+
     /// get the information needed to create an agent suitable for this world
     AgentInitInfo PyEnvironment::get_agent_info(AgentBrainPtr agent)
     {
@@ -42,11 +42,44 @@ namespace OpenNero
         /// @param observations the observations vector already initialized with pre-defined sensor values (added via add_sensor)
         virtual Observations sense(AgentBrainPtr agent, Observations& observations) = 0;
 
+        /// @brief like step, but write the reward into caller-owned storage
+        /// (environments implemented in C++ override this and sense_into so
+        ///  that no vectors are allocated every tick; the default calls step)
+        virtual void step_into(AgentBrainPtr agent, const Actions& action, Reward& reward);
+
+        /// @brief like sense, but compute the observations in place
+        /// @param observations the pre-defined sensor values, overwritten with the final observations
+        virtual void sense_into(AgentBrainPtr agent, Observations& observations);
+
         /// cleanup the world on close
         virtual void cleanup() = 0;
 
         /// reset the environment to its initial state
         virtual void reset(AgentBrainPtr agent) = 0;
+
+        /// @brief perform the actions of a batch of agents and sense the results,
+        /// like a vectorized gym environment. Row i of each buffer belongs to
+        /// agents[i]; all of the agents must have the same numbers of actions,
+        /// sensors and rewards. An agent whose episode is over is reset, and
+        /// its observations are the first ones of its new episode. A batch with
+        /// a missing body, the wrong number of actions or mixed agents raises
+        /// std::invalid_argument before any of the agents moves.
+        /// @param agents the agents to step
+        /// @param actions the actions of the agents, one row after another
+        /// @param observations set to the observations of the agents after the step
+        /// @param rewards set to the rewards of the agents for the step
+        /// @param dones set to 1 for the agents whose episode ended and 0 for the others
+        virtual void step_all(const std::vector<AgentBrainPtr>& agents,
+                              const std::vector<double>& actions,
+                              std::vector<double>& observations,
+                              std::vector<double>& rewards,
+                              std::vector<uint8_t>& dones);
+
+        /// @brief start a new episode for each of a batch of agents
+        /// @param agents the agents to reset
+        /// @param observations set to the first observations of the agents, one row after another
+        virtual void reset_all(const std::vector<AgentBrainPtr>& agents,
+                               std::vector<double>& observations);
     };
 
     /**
@@ -3,9 +3,9 @@
 #include "RandomAI.h"
 
 namespace OpenNero {
-    Actions RandomAgent::get_random_action()
+    void RandomAgent::get_random_action(Actions& result)
     {
-        Actions result(_init.actions.size());
+        result.resize(_init.actions.size());
         for (size_t i = 0; i < result.size(); ++i)
         {
             if (_init.actions.isDiscrete(i))
@@ -20,7 +20,6 @@ namespace OpenNero {
                     - _init.actions.getMin(i)) + _init.actions.getMin(i);
             }
         }
-        return result;
     }
 
     RandomAgent::RandomAgent() :
@@ -37,13 +36,28 @@ namespace OpenNero {
 
     Actions RandomAgent::start(const TimeType& time, const Observations& observations)
     {
-        return this->get_random_action();
+        Actions actions;
+        this->get_random_action(actions);
+        return actions;
     }
 
     Actions RandomAgent::act(const TimeType& time, const Observations& observations,
                              const Reward& reward)
     {
-        return this->get_random_action();
+        Actions actions;
+        this->get_random_action(actions);
+        return actions;
+    }
+
+    void RandomAgent::start_into(const TimeType& time, const Observations& observations, Actions& actions)
+    {
+        this->get_random_action(actions);
+    }
+
+    void RandomAgent::act_into(const TimeType& time, const Observations& observations,
+                               const Reward& reward, Actions& actions)
+    {
+        this->get_random_action(actions);
     }
 
     bool RandomAgent::end(const TimeType& time, const Reward& reward)
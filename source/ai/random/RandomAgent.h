@@ -27,6 +27,12 @@ namespace OpenNero
         /// act based on time, sensor arrays, and last reward
         Actions act(const TimeType& time, const Observations& observations, const Reward& reward);
 
+        /// start a new episode, writing the actions into caller-owned storage
+        void start_into(const TimeType& time, const Observations& observations, Actions& actions);
+
+        /// act based on time, sensor arrays, and last reward, writing the actions into caller-owned storage
+        void act_into(const TimeType& time, const Observations& observations, const Reward& reward, Actions& actions);
+
         /// end an episode
         bool end(const TimeType& time, const Reward& reward);
 
@@ -37,7 +43,7 @@ namespace OpenNero
         bool LoadFromTemplate(ObjectTemplatePtr t, const SimEntityData& data);
     private:
         AgentInitInfo _init; ///< agent initialization information
-        Actions get_random_action(); ///< return random action based on _init
+        void get_random_action(Actions& result); ///< fill in a random action based on _init
     };
 
 }
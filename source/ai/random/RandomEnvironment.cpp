@@ -9,9 +9,9 @@
 namespace OpenNero
 {
 
-    Observations RandomEnvironment::get_random_sensors() const
+    void RandomEnvironment::get_random_sensors(Observations& result) const
     {
-        Observations result(mInitInfo.sensors.size());
+        result.resize(mInitInfo.sensors.size());
         for (size_t i = 0; i < result.size(); ++i)
         {
             if (mInitInfo.sensors.isDiscrete(i))
@@ -29,7 +29,6 @@ namespace OpenNero
                         + mInitInfo.sensors.getMin(i);
             }
         }
-        return result;
     }
 
     /// @brief perform agent actions in the environment and receive the reward
@@ -41,7 +40,21 @@ namespace OpenNero
     /// @brief passively sense the agent's environment
     Observations RandomEnvironment::sense(AgentBrainPtr agent, Observations& observations)
     {
-        return get_random_sensors();
+        Observations result;
+        get_random_sensors(result);
+        return result;
+    }
+
+    /// @brief perform agent actions and write the reward into caller-owned storage
+    void RandomEnvironment::step_into(AgentBrainPtr agent, const Actions& action, Reward& reward)
+    {
+        mInitInfo.reward.getRandom(reward);
+    }
+
+    /// @brief passively sense the agent's environment in place
+    void RandomEnvironment::sense_into(AgentBrainPtr agent, Observations& observations)
+    {
+        get_random_sensors(observations);
     }
 
     /// @brief cleanup the world on close
@@ -22,7 +22,7 @@ namespace OpenNero
 
     protected:
         /// get a random sensor in compiance with the environmental constraints
-        Observations get_random_sensors() const;
+        void get_random_sensors(Observations& result) const;
 
     public:
 
@@ -46,6 +46,12 @@ namespace OpenNero
         /// @brief passively sense the agent's environment
         Observations sense(AgentBrainPtr agent, Observations& observations);
 
+        /// @brief perform agent actions and write the reward into caller-owned storage
+        void step_into(AgentBrainPtr agent, const Actions& action, Reward& reward);
+
+        /// @brief passively sense the agent's environment in place
+        void sense_into(AgentBrainPtr agent, Observations& observations);
+
         /// @brief cleanup the world on close
         void cleanup();
     };
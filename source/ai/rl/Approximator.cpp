@@ -1,19 +1,103 @@
+#include <cmath>
+#include <cstring>
+#include <fstream>
 #include <boost/serialization/export.hpp>
 
 #include "core/Common.h"
 #include "math/Random.h"
 #include "Approximator.h"
-#include "tiles2.h"
 
 namespace OpenNero
 {
+    namespace
+    {
+        /// the first bytes of a file written by TableApproximator::save_table
+        const char kTableMagic[8] = { 'O', 'N', 'Q', 'T', 'A', 'B', 'L', 'E' };
+
+        /// the version of the format written by TableApproximator::save_table
+        const U32 kTableVersion = 1;
+
+        /// written as is to detect files from machines of another byte order
+        const U32 kTableByteOrder = 0x01020304;
+
+        /// the number of bits in the key for dimension i of a feature vector
+        U8 field_bits(const FeatureVectorInfo& info, size_t i, int bins)
+        {
+            double values;
+            if (info.isDiscrete(i))
+            {
+                values = info.getMax(i) - info.getMin(i) + 1;
+            }
+            else if (bins > 0)
+            {
+                values = bins;
+            }
+            else
+            {
+                // not quantized, keep the whole double
+                return 64;
+            }
+            U8 bits = 0;
+            while (bits < 64 && std::ldexp(1.0, bits) < values)
+            {
+                ++bits;
+            }
+            return bits;
+        }
+
+        /// the bin of the value x of dimension i of a feature vector
+        /// (the same bins as quantize below, with values out of bounds
+        ///  going into the first or the last bin)
+        QTable::Word field_value(const FeatureVectorInfo& info, size_t i, int bins, double x)
+        {
+            if (info.isDiscrete(i))
+            {
+                double v = int(x) - info.getMin(i);
+                double last = info.getMax(i) - info.getMin(i);
+                return QTable::Word(v < 0 ? 0 : (v > last ? last : v));
+            }
+            else if (bins > 1)
+            {
+                double lo = info.getMin(i), hi = info.getMax(i), span = hi - lo;
+                double inc = span / (bins - 1);
+                double bin = (bins - 1) * (x - (lo - inc / 2)) / span;
+                return QTable::Word(bin < 0 ? 0 : (bin > bins - 1 ? bins - 1 : bin));
+            }
+            else if (bins == 1)
+            {
+                return 0;
+            }
+            else
+            {
+                QTable::Word bits;
+                memcpy(&bits, &x, sizeof(bits));
+                return bits;
+            }
+        }
+
+        /// put the lowest bits of v into key at bit pos
+        inline void put_bits(QTable::Word* key, size_t pos, U8 bits, QTable::Word v)
+        {
+            size_t word = pos / 64, offset = pos % 64;
+            key[word] |= v << offset;
+            if (offset + bits > 64)
+            {
+                key[word + 1] |= v >> (64 - offset);
+            }
+        }
+    }
+
     /// @param info information about the agent for which this approximator is to be used
     TableApproximator::TableApproximator(const AgentInitInfo& info, const int actions, const int states) :
         Approximator(info)
         , table()
         , action_bins(actions)
         , state_bins(states)
+        , key_bits()
+        , key()
+        , state_key()
     {
+        init_layout();
     }
 
     /// copy constructor
@@ -22,6 +106,9 @@ namespace OpenNero
         , table(a.table)
         , action_bins(a.action_bins)
         , state_bins(a.state_bins)
+        , key_bits(a.key_bits)
+        , key(a.key)
+        , state_key(a.state_key)
     {
     }
 
@@ -36,18 +123,17 @@ namespace OpenNero
     /// @return currently approximated (exact) value
     double TableApproximator::predict(const FeatureVector& observation, const FeatureVector& action)
     {
-        const FeatureVector& s = quantize_state(observation);
-        const FeatureVector& a = quantize_action(action);
-        StateActionDoubleMap::iterator found = table.find(StateActionPair(s, a));
-        if (found == table.end())
+        pack_state(observation);
+        pack_actions(action);
+        double value;
+        if (table.find(&key[0], value))
         {
-            return 0;
+            return value;
         }
         else
         {
-            return found->second;
+            return 0;
         }
-
     }
 
     /// @param observation observation to update
@@ -55,9 +141,224 @@ namespace OpenNero
     /// @param target new value for this state/action pair
     void TableApproximator::update(const FeatureVector& observation, const FeatureVector& action, double target)
     {
-        const FeatureVector& s = quantize_state(observation);
-        const FeatureVector& a = quantize_action(action);
-        table[StateActionPair(s, a)] = target;
+        pack_state(observation);
+        pack_actions(action);
+        table.set(&key[0], target);
+    }
+
+    /// predict the values of a state with each of a list of actions
+    /// @param observation the state
+    /// @param actions the actions to evaluate in the state
+    /// @param values set to the value of each action
+    void TableApproximator::predict_all(const FeatureVector& observation, const std::vector<FeatureVector>& actions, std::vector<double>& values)
+    {
+        values.resize(actions.size());
+        pack_state(observation);
+        for (size_t i = 0; i < actions.size(); ++i)
+        {
+            pack_actions(actions[i]);
+            if (!table.find(&key[0], values[i]))
+            {
+                values[i] = 0;
+            }
+        }
+    }
+
+    /// work out the bits of the keys from mInfo and the bins
+    void TableApproximator::init_layout()
+    {
+        key_bits.clear();
+        size_t total = 0;
+        for (size_t i = 0; i < mInfo.sensors.size(); ++i)
+        {
+            key_bits.push_back(field_bits(mInfo.sensors, i, state_bins));
+            total += key_bits.back();
+        }
+        for (size_t i = 0; i < mInfo.actions.size(); ++i)
+        {
+            key_bits.push_back(field_bits(mInfo.actions, i, action_bins));
+            total += key_bits.back();
+        }
+        size_t words = total > 64 ? (total + 63) / 64 : 1;
+        key.assign(words, 0);
+        state_key.assign(words, 0);
+        table = QTable(words);
+    }
+
+    /// pack a state into state_key, each sensor in the next key_bits of it
+    void TableApproximator::pack_state(const FeatureVector& observation)
+    {
+        Assert(observation.size() == mInfo.sensors.size());
+        std::fill(state_key.begin(), state_key.end(), 0);
+        size_t pos = 0;
+        for (size_t i = 0; i < observation.size(); ++i)
+        {
+            U8 bits = key_bits[i];
+            if (bits > 0)
+            {
+                put_bits(&state_key[0], pos, bits, field_value(mInfo.sensors, i, state_bins, observation[i]));
+                pos += bits;
+            }
+        }
+    }
+
+    /// pack the state in state_key and the actions into key, each action in
+    /// the next key_bits after the sensors
+    void TableApproximator::pack_actions(const FeatureVector& action)
+    {
+        Assert(action.size() == mInfo.actions.size());
+        std::copy(state_key.begin(), state_key.end(), key.begin());
+        size_t num_sensors = mInfo.sensors.size();
+        size_t pos = 0;
+        for (size_t i = 0; i < num_sensors; ++i)
+        {
+            pos += key_bits[i];
+        }
+        for (size_t i = 0; i < action.size(); ++i)
+        {
+            U8 bits = key_bits[num_sensors + i];
+            if (bits > 0)
+            {
+                put_bits(&key[0], pos, bits, field_value(mInfo.actions, i, action_bins, action[i]));
+                pos += bits;
+            }
+        }
+    }
+
+    /// the packed keys of all entries one after another, and their values
+    void TableApproximator::get_entries(std::vector<QTable::Word>& keys, std::vector<double>& values) const
+    {
+        size_t words = table.getKeyWords();
+        keys.clear();
+        values.clear();
+        keys.reserve(table.size() * words);
+        values.reserve(table.size());
+        for (size_t i = 0; i < table.capacity(); ++i)
+        {
+            if (table.isUsed(i))
+            {
+                keys.insert(keys.end(), table.getKey(i), table.getKey(i) + words);
+                values.push_back(table.getValue(i));
+            }
+        }
+    }
+
+    /// replace the entries with the given ones
+    void TableApproximator::set_entries(const std::vector<QTable::Word>& keys, const std::vector<double>& values)
+    {
+        size_t words = key.size();
+        AssertMsg(keys.size() == values.size() * words, "expected " << words << " words for each of " << values.size() << " keys");
+        table = QTable(words);
+        table.reserve(values.size());
+        for (size_t i = 0; i < values.size(); ++i)
+        {
+            table.set(&keys[i * words], values[i]);
+        }
+    }
+
+    /// write the table to a binary file
+    /// @param filename the file to write
+    /// @return true iff the whole table was written
+    bool TableApproximator::save_table(const std::string& filename) const
+    {
+        std::ofstream out(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            LOG_F_ERROR("ai.rl", "could not open " << filename << " to save the table");
+            return false;
+        }
+        U32 num_fields = static_cast<U32>(key_bits.size());
+        boost::uint64_t count = table.size();
+        out.write(kTableMagic, sizeof(kTableMagic));
+        out.write(reinterpret_cast<const char*>(&kTableVersion), sizeof(kTableVersion));
+        out.write(reinterpret_cast<const char*>(&kTableByteOrder), sizeof(kTableByteOrder));
+        out.write(reinterpret_cast<const char*>(&action_bins), sizeof(action_bins));
+        out.write(reinterpret_cast<const char*>(&state_bins), sizeof(state_bins));
+        out.write(reinterpret_cast<const char*>(&num_fields), sizeof(num_fields));
+        if (num_fields > 0)
+        {
+            out.write(reinterpret_cast<const char*>(&key_bits[0]), num_fields);
+        }
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        // each entry is the words of its key followed by its value
+        size_t words = table.getKeyWords();
+        for (size_t i = 0; i < table.capacity(); ++i)
+        {
+            if (table.isUsed(i))
+            {
+                double value = table.getValue(i);
+                out.write(reinterpret_cast<const char*>(table.getKey(i)), words * sizeof(QTable::Word));
+                out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+            }
+        }
+        out.close();
+        if (!out)
+        {
+            LOG_F_ERROR("ai.rl", "could not write the table to " << filename);
+            return false;
+        }
+        return true;
+    }
+
+    /// read the table from a binary file written by save_table
+    /// @param filename the file to read
+    /// @return true iff the table was read (otherwise the table is unchanged)
+    bool TableApproximator::load_table(const std::string& filename)
+    {
+        std::ifstream in(filename.c_str(), std::ios::in | std::ios::binary);
+        if (!in)
+        {
+            LOG_F_ERROR("ai.rl", "could not open " << filename << " to load the table");
+            return false;
+        }
+        char magic[sizeof(kTableMagic)];
+        U32 version = 0, byte_order = 0, num_fields = 0;
+        int file_action_bins = 0, file_state_bins = 0;
+        in.read(magic, sizeof(magic));
+        in.read(reinterpret_cast<char*>(&version), sizeof(version));
+        in.read(reinterpret_cast<char*>(&byte_order), sizeof(byte_order));
+        in.read(reinterpret_cast<char*>(&file_action_bins), sizeof(file_action_bins));
+        in.read(reinterpret_cast<char*>(&file_state_bins), sizeof(file_state_bins));
+        in.read(reinterpret_cast<char*>(&num_fields), sizeof(num_fields));
+        if (!in || memcmp(magic, kTableMagic, sizeof(magic)) != 0 ||
+            version != kTableVersion || byte_order != kTableByteOrder)
+        {
+            LOG_F_ERROR("ai.rl", filename << " is not a table saved by this version on this machine");
+            return false;
+        }
+        std::vector<U8> file_key_bits(num_fields);
+        if (num_fields > 0)
+        {
+            in.read(reinterpret_cast<char*>(&file_key_bits[0]), num_fields);
+        }
+        if (!in || file_action_bins != action_bins || file_state_bins != state_bins || file_key_bits != key_bits)
+        {
+            LOG_F_ERROR("ai.rl", "the table in " << filename << " was saved for other sensors, actions or bins");
+            return false;
+        }
+        boost::uint64_t count = 0;
+        in.read(reinterpret_cast<char*>(&count), sizeof(count));
+        size_t words = key.size();
+        std::vector<QTable::Word> entries(static_cast<size_t>(count) * (words + 1));
+        if (!entries.empty())
+        {
+            in.read(reinterpret_cast<char*>(&entries[0]), entries.size() * sizeof(QTable::Word));
+        }
+        if (!in)
+        {
+            LOG_F_ERROR("ai.rl", "the table in " << filename << " is truncated");
+            return false;
+        }
+        QTable loaded(words);
+        loaded.reserve(static_cast<size_t>(count));
+        for (size_t i = 0; i < count; ++i)
+        {
+            double value;
+            memcpy(&value, &entries[i * (words + 1) + words], sizeof(value));
+            loaded.set(&entries[i * (words + 1)], value);
+        }
+        table = loaded;
+        return true;
     }
 
     /// given a feature vector from a continuous space, quantize each component
@@ -133,6 +434,7 @@ namespace OpenNero
         , floats()
         , tiles()
         , weights()
+        , coder(info, num_tiles, num_weights)
     {
         LOG_F_DEBUG("ai", "TilesApproximator( "  << info << " )");
         size_t num_sensors = info.sensors.size();
@@ -179,6 +481,7 @@ namespace OpenNero
         , floats(a.floats)
         , tiles(a.tiles)
         , weights(a.weights)
+        , coder(a.coder)
     {
     }
 
@@ -189,35 +492,40 @@ namespace OpenNero
     /// convert feature vector into tiles
     void TilesApproximator::to_tiles(const FeatureVector& observation, const FeatureVector& action)
     {
-        size_t num_sensors = mInfo.sensors.size();
-        size_t num_actions = mInfo.actions.size();
-        Assert(num_sensors == observation.size());
-        Assert(num_actions == action.size());
-        // shuffle feature vector into the arrays
-        for (size_t i = 0; i < ints_index.size(); ++i)
+        Assert(mInfo.sensors.size() == observation.size());
+        Assert(mInfo.actions.size() == action.size());
+        // the state part of the tiles is only computed again when the state changes,
+        // which is once per step when all of the actions are evaluated in a state
+        coder.setState(observation);
+        coder.getTiles(action, tiles);
+    }
+
+    /// predict the values of a state with each of a list of actions
+    /// @param observation the state
+    /// @param actions the actions to evaluate in the state
+    /// @param values set to the value of each action
+    void TilesApproximator::predict_all(const FeatureVector& observation, const std::vector<FeatureVector>& actions, std::vector<double>& values)
+    {
+        Assert(mInfo.sensors.size() == observation.size());
+        values.resize(actions.size());
+        coder.setState(observation);
+        for (size_t i = 0; i < actions.size(); ++i)
         {
-            if (ints_index[i] < num_sensors)
-            {
-                ints[i] = (int)observation[ints_index[i]];
-            }
-            else
-            {
-                ints[i] = (int)action[ints_index[i] - num_sensors];
-            }
+            Assert(mInfo.actions.size() == actions[i].size());
+            coder.getTiles(actions[i], tiles);
+            values[i] = sum_weights();
         }
-        for (size_t i = 0; i < floats_index.size(); ++i)
+    }
+
+    /// the sum of the weights of the tiles
+    double TilesApproximator::sum_weights() const
+    {
+        double result = 0.0;
+        for (size_t i = 0; i < tiles.size(); ++i) 
         {
-            if (floats_index[i] < num_sensors)
-            {
-                floats[i] = (float)observation[floats_index[i]];
-            }
-            else
-            {
-                floats[i] = (float)action[floats_index[i] - num_sensors];
-            }
+            result += weights[tiles[i]];
         }
-        // convert the input values to tiles
-        GetTiles(tiles, weights.size(), floats, ints);
+        return result;
     }
     
     /// @param observation sensor vector
@@ -225,12 +533,7 @@ namespace OpenNero
     double TilesApproximator::predict(const FeatureVector& observation, const FeatureVector& action)
     {
         to_tiles(observation, action);
-        double result=0.0;
-        for (size_t i = 0; i < tiles.size(); ++i) 
-        {
-            result += weights[tiles[i]];
-        }
-        return result;
+        return sum_weights();
     }
     
     /// Adapt the tile weights for the tiles that are triggered by the given example
@@ -239,11 +542,13 @@ namespace OpenNero
     /// @param target output target
     void TilesApproximator::update(const FeatureVector& observation, const FeatureVector& action, double target)
     {
-        double x = predict(observation, action);
+        to_tiles(observation, action);
+        double x = sum_weights();
         // then, adapt weights towards the prediction
+        float delta = (float)(mAlpha / tiles.size() * (target - x));
         for (size_t i = 0; i < tiles.size(); ++i) 
         {
-            weights[tiles[i]] += (float)(mAlpha / tiles.size() * (target - x));
+            weights[tiles[i]] += delta;
         }
     }
 }
@@ -11,10 +11,14 @@
 #include <boost/serialization/vector.hpp>
 #include <boost/serialization/utility.hpp>
 #include <boost/serialization/map.hpp>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/version.hpp>
 
 #include "core/Common.h"
 #include "ai/AI.h"
 #include "core/HashMap.h"
+#include "QTable.h"
+#include "TileCoder.h"
 
 /////////1/////////2/////////3/////////4/////////5/////////6/////////7/////////8
 // serialization/map.hpp:
@@ -112,6 +116,29 @@ namespace OpenNero
         /// update the value associated with a particular feature vector
         virtual void update(const FeatureVector& sensors, const FeatureVector& actions, double target) = 0;
 
+        /// predict the values of a state with each of a list of actions
+        /// (approximators override this to do the work for the state once)
+        /// @param values set to the value of each action
+        virtual void predict_all(const FeatureVector& sensors, const std::vector<FeatureVector>& actions, std::vector<double>& values)
+        {
+            values.resize(actions.size());
+            for (size_t i = 0; i < actions.size(); ++i)
+            {
+                values[i] = predict(sensors, actions[i]);
+            }
+        }
+
+        /// update the values associated with a minibatch of feature vectors
+        /// (the default calls update for each of them in turn)
+        virtual void update_batch(const std::vector<FeatureVector>& sensors, const std::vector<FeatureVector>& actions, const std::vector<double>& targets)
+        {
+            Assert(sensors.size() == actions.size() && actions.size() == targets.size());
+            for (size_t i = 0; i < targets.size(); ++i)
+            {
+                update(sensors[i], actions[i], targets[i]);
+            }
+        }
+
         /// serialize this object to/from a Boost serialization archive
         template<class Archive>
         void serialize(Archive & ar, const unsigned int version)
@@ -123,13 +150,37 @@ namespace OpenNero
 	typedef boost::unordered_map<StateActionPair, double> StateActionDoubleMap;
 
 	/// An exact table-based approximator
+	///
+	/// Each state and action dimension is quantized to the number of its bin
+	/// (or to its integer value if it is discrete), and the bin numbers are
+	/// packed into the bits of a QTable key. Continuous dimensions that are
+	/// not quantized (0 bins) keep the 64 bits of their value.
     class TableApproximator : public Approximator
     {
     private:
         friend class boost::serialization::access;
-        StateActionDoubleMap table;
+        QTable table; ///< values of the packed state-action keys
         int action_bins;
         int state_bins;
+        std::vector<U8> key_bits; ///< bits of the key used by each sensor, then each action
+        std::vector<QTable::Word> key; ///< the key of the latest state-action pair
+        std::vector<QTable::Word> state_key; ///< the key of the latest state with no actions
+
+        /// work out the bits of the keys from mInfo and the bins
+        void init_layout();
+
+        /// pack a state into state_key
+        void pack_state(const FeatureVector& sensors);
+
+        /// pack the state in state_key and the actions into key
+        void pack_actions(const FeatureVector& actions);
+
+        /// the packed keys of all entries one after another, and their values
+        void get_entries(std::vector<QTable::Word>& keys, std::vector<double>& values) const;
+
+        /// replace the entries with the given ones
+        void set_entries(const std::vector<QTable::Word>& keys, const std::vector<double>& values);
+
     public:
         /// constructor
         TableApproximator() {}
@@ -157,21 +208,69 @@ namespace OpenNero
         /// update the value associated with a particular feature vector
         void update(const FeatureVector& sensors, const FeatureVector& actions, double target);
 
+        /// predict the values of a state with each of a list of actions
+        void predict_all(const FeatureVector& sensors, const std::vector<FeatureVector>& actions, std::vector<double>& values);
+
         /// quantize continuous state or action vectors
         FeatureVector quantize_action(const FeatureVector& continuous) const;
         FeatureVector quantize_state(const FeatureVector& continuous) const;
 
-        /// serialize this object to/from a Boost serialization archive
+        /// number of state-action pairs in the table
+        size_t size() const { return table.size(); }
+
+        /// write the table to a binary file
+        bool save_table(const std::string& filename) const;
+
+        /// read the table from a binary file written by save_table for the
+        /// same sensors, actions and bins
+        bool load_table(const std::string& filename);
+
+        /// save this object to a Boost serialization archive
         template<class Archive>
-        void serialize(Archive & ar, const unsigned int version)
+        void save(Archive & ar, const unsigned int version) const
+        {
+            ar & boost::serialization::base_object<Approximator>(*this);
+            ar & BOOST_SERIALIZATION_NVP(action_bins);
+            ar & BOOST_SERIALIZATION_NVP(state_bins);
+            std::vector<QTable::Word> keys;
+            std::vector<double> values;
+            get_entries(keys, values);
+            ar & BOOST_SERIALIZATION_NVP(keys);
+            ar & BOOST_SERIALIZATION_NVP(values);
+            LOG_F_DEBUG("serialize", "serialized TableApproximator with " << table.size() << " entries.");
+        }
+
+        /// load this object from a Boost serialization archive
+        template<class Archive>
+        void load(Archive & ar, const unsigned int version)
         {
             ar & boost::serialization::base_object<Approximator>(*this);
             ar & BOOST_SERIALIZATION_NVP(action_bins);
             ar & BOOST_SERIALIZATION_NVP(state_bins);
-            // this uses unordered_map serialization
-            ar & BOOST_SERIALIZATION_NVP(table);
-            LOG_F_DEBUG("serialize", "(de)serialized TableApproximator with " << table.size() << " entries.");
+            init_layout();
+            if (version == 0)
+            {
+                // version 0 archives hold an unordered_map of quantized vectors
+                StateActionDoubleMap old_table;
+                ar & boost::serialization::make_nvp("table", old_table);
+                StateActionDoubleMap::const_iterator iter;
+                for (iter = old_table.begin(); iter != old_table.end(); ++iter)
+                {
+                    update(iter->first.first, iter->first.second, iter->second);
+                }
+            }
+            else
+            {
+                std::vector<QTable::Word> keys;
+                std::vector<double> values;
+                ar & BOOST_SERIALIZATION_NVP(keys);
+                ar & BOOST_SERIALIZATION_NVP(values);
+                set_entries(keys, values);
+            }
+            LOG_F_DEBUG("serialize", "deserialized TableApproximator with " << table.size() << " entries.");
         }
+
+        BOOST_SERIALIZATION_SPLIT_MEMBER()
     };
 
     /// A CMAC tile coding function approximator
@@ -183,13 +282,17 @@ namespace OpenNero
         float mAlpha; ///< learning rate
         std::vector<size_t> ints_index; ///< indeces of integer features
         std::vector<size_t> floats_index; ///< indeces of real features
-        std::vector<int> ints; ///< integer feature array
-        std::vector<float> floats; ///< real feature array
+        std::vector<int> ints; ///< integer feature array (unused, kept in archives)
+        std::vector<float> floats; ///< real feature array (unused, kept in archives)
         std::vector<int> tiles; ///< tiles array
         std::vector<float> weights; ///< weight array
+        TileCoder coder; ///< computes the tiles, reusing the state part between actions
 
         /// convert feature vector into tiles
         void to_tiles(const FeatureVector& sensors, const FeatureVector& actions);
+
+        /// the sum of the weights of the tiles
+        double sum_weights() const;
     public:
         /// constructors
         TilesApproximator() {}
@@ -214,9 +317,26 @@ namespace OpenNero
         /// update the value associated with a particular feature vector
         void update(const FeatureVector& sensors, const FeatureVector& actions, double target);
 
-        /// serialize this object to/from a Boost serialization archive
+        /// predict the values of a state with each of a list of actions
+        void predict_all(const FeatureVector& sensors, const std::vector<FeatureVector>& actions, std::vector<double>& values);
+
+        /// save this object to a Boost serialization archive
         template<class Archive>
-        void serialize(Archive & ar, const unsigned int version)
+        void save(Archive & ar, const unsigned int version) const
+        {
+            ar & boost::serialization::base_object<Approximator>(*this);
+            ar & BOOST_SERIALIZATION_NVP(mAlpha);
+            ar & BOOST_SERIALIZATION_NVP(ints_index);
+            ar & BOOST_SERIALIZATION_NVP(floats_index);
+            ar & BOOST_SERIALIZATION_NVP(ints);
+            ar & BOOST_SERIALIZATION_NVP(floats);
+            ar & BOOST_SERIALIZATION_NVP(tiles);
+            ar & BOOST_SERIALIZATION_NVP(weights);
+        }
+
+        /// load this object from a Boost serialization archive
+        template<class Archive>
+        void load(Archive & ar, const unsigned int version)
         {
             ar & boost::serialization::base_object<Approximator>(*this);
             ar & BOOST_SERIALIZATION_NVP(mAlpha);
@@ -226,9 +346,14 @@ namespace OpenNero
             ar & BOOST_SERIALIZATION_NVP(floats);
             ar & BOOST_SERIALIZATION_NVP(tiles);
             ar & BOOST_SERIALIZATION_NVP(weights);
+            coder = TileCoder(mInfo, tiles.size(), weights.size());
         }
+
+        BOOST_SERIALIZATION_SPLIT_MEMBER()
     };
 
 }
 
+BOOST_CLASS_VERSION(OpenNero::TableApproximator, 1)
+
 #endif
@@ -0,0 +1,117 @@
+#include <cmath>
+#include <boost/serialization/export.hpp>
+
+#include "core/Common.h"
+#include "BackpropApproximator.h"
+
+namespace OpenNero
+{
+    /// @param info information about the agent for which this approximator is to be used
+    /// @param num_hidden the number of hidden units
+    /// @param learning_rate the size of the gradient descent steps
+    BackpropApproximator::BackpropApproximator(const AgentInitInfo& info, size_t num_hidden, double learning_rate)
+        : Approximator(info)
+        , mNumHidden(num_hidden)
+        , mLearningRate(learning_rate)
+        , network()
+        , inputs()
+    {
+        std::vector<size_t> sizes;
+        sizes.push_back(info.sensors.size() + info.actions.size());
+        sizes.push_back(num_hidden);
+        sizes.push_back(1);
+        network = DenseNetwork(sizes);
+        inputs.assign(network.getNumInputs(), 0.0);
+    }
+
+    /// copy constructor
+    BackpropApproximator::BackpropApproximator(const BackpropApproximator& a)
+        : Approximator(a)
+        , mNumHidden(a.mNumHidden)
+        , mLearningRate(a.mLearningRate)
+        , network(a.network)
+        , inputs(a.inputs)
+    {
+    }
+
+    /// destructor
+    BackpropApproximator::~BackpropApproximator()
+    {
+    }
+
+    /// scale a state and an action into row i of inputs
+    void BackpropApproximator::encode(const FeatureVector& sensors, const FeatureVector& actions, size_t i)
+    {
+        Assert(sensors.size() == mInfo.sensors.size() && actions.size() == mInfo.actions.size());
+        double* row = &inputs[i * network.getNumInputs()];
+        for (size_t j = 0; j < sensors.size(); ++j)
+        {
+            double lo = mInfo.sensors.getMin(j), span = mInfo.sensors.getMax(j) - lo;
+            *row++ = (span > 0 && span < HUGE_VAL) ? 2 * (sensors[j] - lo) / span - 1 : sensors[j];
+        }
+        for (size_t j = 0; j < actions.size(); ++j)
+        {
+            double lo = mInfo.actions.getMin(j), span = mInfo.actions.getMax(j) - lo;
+            *row++ = (span > 0 && span < HUGE_VAL) ? 2 * (actions[j] - lo) / span - 1 : actions[j];
+        }
+    }
+
+    /// predict the value associated with a particular feature vector
+    /// @param sensors observation
+    /// @param actions action
+    /// @return the output of the network
+    double BackpropApproximator::predict(const FeatureVector& sensors, const FeatureVector& actions)
+    {
+        inputs.resize(network.getNumInputs());
+        encode(sensors, actions, 0);
+        return network.forward(&inputs[0], 1)[0];
+    }
+
+    /// update the value associated with a particular feature vector
+    /// @param sensors observation
+    /// @param actions action
+    /// @param target the value to move the output of the network towards
+    void BackpropApproximator::update(const FeatureVector& sensors, const FeatureVector& actions, double target)
+    {
+        inputs.resize(network.getNumInputs());
+        encode(sensors, actions, 0);
+        network.train(&inputs[0], &target, 1, mLearningRate);
+    }
+
+    /// predict the values of a state with each of a list of actions
+    /// (the whole list goes through the network as one batch)
+    void BackpropApproximator::predict_all(const FeatureVector& sensors, const std::vector<FeatureVector>& actions, std::vector<double>& values)
+    {
+        values.resize(actions.size());
+        if (actions.empty())
+        {
+            return;
+        }
+        inputs.resize(actions.size() * network.getNumInputs());
+        for (size_t i = 0; i < actions.size(); ++i)
+        {
+            encode(sensors, actions[i], i);
+        }
+        const double* outputs = network.forward(&inputs[0], actions.size());
+        values.assign(outputs, outputs + actions.size());
+    }
+
+    /// update the values associated with a minibatch of feature vectors
+    /// with one gradient step averaged over the minibatch
+    void BackpropApproximator::update_batch(const std::vector<FeatureVector>& sensors, const std::vector<FeatureVector>& actions, const std::vector<double>& targets)
+    {
+        Assert(sensors.size() == actions.size() && actions.size() == targets.size());
+        if (targets.empty())
+        {
+            return;
+        }
+        inputs.resize(targets.size() * network.getNumInputs());
+        for (size_t i = 0; i < targets.size(); ++i)
+        {
+            encode(sensors[i], actions[i], i);
+        }
+        network.train(&inputs[0], &targets[0], targets.size(), mLearningRate);
+    }
+}
+
+BOOST_CLASS_EXPORT(OpenNero::BackpropApproximator)
@@ -1,35 +1,88 @@
 #ifndef _OPENNERO_AI_RL_BACKAPPROXIMATOR_H_
 #define _OPENNERO_AI_RL_BACKAPPROXIMATOR_H_
 
+#include <boost/serialization/access.hpp>
+#include <boost/serialization/base_object.hpp>
+#include <boost/serialization/nvp.hpp>
+#include <boost/serialization/split_member.hpp>
+
 #include "core/Common.h"
 #include "ai/AI.h"
+#include "Approximator.h"
+#include "DenseNetwork.h"
 
 namespace OpenNero
 {
-
-    /// A CMAC tile coding function approximator
+    /// A neural network function approximator: a dense multilayer perceptron
+    /// with one hidden layer that maps the state and the action, each scaled
+    /// to [-1, 1], to their value
     class BackpropApproximator : public Approximator
     {
-            SNetwork network;
+    private:
+        friend class boost::serialization::access;
+
+        size_t mNumHidden; ///< number of hidden units
+        double mLearningRate; ///< size of the gradient descent steps
+        DenseNetwork network; ///< the network
+        std::vector<double> inputs; ///< network inputs of the latest batch, one row per example
+
+        /// scale a state and an action into row i of inputs
+        void encode(const FeatureVector& sensors, const FeatureVector& actions, size_t i);
+
+    public:
+        /// constructor
+        BackpropApproximator() : mNumHidden(0), mLearningRate(0) {}
+
+        /// constructor
+        /// @param info information about the agent for which this approximator is to be used
+        /// @param num_hidden the number of hidden units
+        /// @param learning_rate the size of the gradient descent steps
+        BackpropApproximator(const AgentInitInfo& info, size_t num_hidden, double learning_rate = 0.01);
+
+        /// copy constructor
+        BackpropApproximator(const BackpropApproximator& a);
+
+        /// destructor
+        ~BackpropApproximator();
+
+        /// return a copy of this approximator
+        ApproximatorPtr copy() const { ApproximatorPtr p(new BackpropApproximator(*this)); return p; }
+
+        /// predict the value associated with a particular feature vector
+        double predict(const FeatureVector& sensors, const FeatureVector& actions);
 
-        public:
-            /// constructor
-            explicit BackpropApproximator(const AgentInitInfo& info);
+        /// update the value associated with a particular feature vector
+        void update(const FeatureVector& sensors, const FeatureVector& actions, double target);
 
-            /// copy constructor
-            BackpropApproximator(const BackpropApproximator& a);
+        /// predict the values of a state with each of a list of actions
+        void predict_all(const FeatureVector& sensors, const std::vector<FeatureVector>& actions, std::vector<double>& values);
 
-            /// destructor
-            ~BackpropApproximator();
+        /// update the values associated with a minibatch of feature vectors
+        /// with one gradient step averaged over the minibatch
+        void update_batch(const std::vector<FeatureVector>& sensors, const std::vector<FeatureVector>& actions, const std::vector<double>& targets);
 
-            /// return a copy of this approximator
-            ApproximatorPtr copy() const { ApproximatorPtr p(new BackpropApproximator(*this)); return p; }
+        /// save this object to a Boost serialization archive
+        template<class Archive>
+        void save(Archive & ar, const unsigned int version) const
+        {
+            ar & boost::serialization::base_object<Approximator>(*this);
+            ar & BOOST_SERIALIZATION_NVP(mNumHidden);
+            ar & BOOST_SERIALIZATION_NVP(mLearningRate);
+            ar & BOOST_SERIALIZATION_NVP(network);
+        }
 
-            /// predict the value associated with a particular feature vector
-            double predict(const FeatureVector& sensors, const FeatureVector& actions);
+        /// load this object from a Boost serialization archive
+        template<class Archive>
+        void load(Archive & ar, const unsigned int version)
+        {
+            ar & boost::serialization::base_object<Approximator>(*this);
+            ar & BOOST_SERIALIZATION_NVP(mNumHidden);
+            ar & BOOST_SERIALIZATION_NVP(mLearningRate);
+            ar & BOOST_SERIALIZATION_NVP(network);
+            inputs.assign(network.getNumInputs(), 0.0);
+        }
 
-            /// update the value associated with a particular feature vector
-            void update(const FeatureVector& sensors, const FeatureVector& actions, double target);
+        BOOST_SERIALIZATION_SPLIT_MEMBER()
     };
 }
 
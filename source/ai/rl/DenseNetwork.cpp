@@ -0,0 +1,294 @@
+#include <cmath>
+#include <algorithm>
+
+#include "core/Common.h"
+#include "math/Random.h"
+#include "DenseNetwork.h"
+
+namespace OpenNero
+{
+    namespace
+    {
+        /// C = A * W^T + bias, with A m rows of k, W n rows of k, C m rows of n
+        /// (the layer activation of a batch; blocked over 4 rows of A and of W
+        ///  so that each value loaded is used four times)
+        void multiply_transposed(const double* A, size_t m, size_t k,
+                                 const double* W, size_t n, const double* bias, double* C)
+        {
+            size_t i = 0;
+            for (; i + 4 <= m; i += 4)
+            {
+                const double* a0 = A + i * k;
+                const double* a1 = a0 + k;
+                const double* a2 = a1 + k;
+                const double* a3 = a2 + k;
+                size_t j = 0;
+                for (; j + 4 <= n; j += 4)
+                {
+                    const double* w0 = W + j * k;
+                    const double* w1 = w0 + k;
+                    const double* w2 = w1 + k;
+                    const double* w3 = w2 + k;
+                    double c00 = 0, c01 = 0, c02 = 0, c03 = 0;
+                    double c10 = 0, c11 = 0, c12 = 0, c13 = 0;
+                    double c20 = 0, c21 = 0, c22 = 0, c23 = 0;
+                    double c30 = 0, c31 = 0, c32 = 0, c33 = 0;
+                    for (size_t p = 0; p < k; ++p)
+                    {
+                        double x0 = a0[p], x1 = a1[p], x2 = a2[p], x3 = a3[p];
+                        double y0 = w0[p], y1 = w1[p], y2 = w2[p], y3 = w3[p];
+                        c00 += x0 * y0; c01 += x0 * y1; c02 += x0 * y2; c03 += x0 * y3;
+                        c10 += x1 * y0; c11 += x1 * y1; c12 += x1 * y2; c13 += x1 * y3;
+                        c20 += x2 * y0; c21 += x2 * y1; c22 += x2 * y2; c23 += x2 * y3;
+                        c30 += x3 * y0; c31 += x3 * y1; c32 += x3 * y2; c33 += x3 * y3;
+                    }
+                    double* c = C + i * n + j;
+                    c[0] = c00 + bias[j]; c[1] = c01 + bias[j + 1]; c[2] = c02 + bias[j + 2]; c[3] = c03 + bias[j + 3];
+                    c += n;
+                    c[0] = c10 + bias[j]; c[1] = c11 + bias[j + 1]; c[2] = c12 + bias[j + 2]; c[3] = c13 + bias[j + 3];
+                    c += n;
+                    c[0] = c20 + bias[j]; c[1] = c21 + bias[j + 1]; c[2] = c22 + bias[j + 2]; c[3] = c23 + bias[j + 3];
+                    c += n;
+                    c[0] = c30 + bias[j]; c[1] = c31 + bias[j + 1]; c[2] = c32 + bias[j + 2]; c[3] = c33 + bias[j + 3];
+                }
+                for (; j < n; ++j)
+                {
+                    const double* w = W + j * k;
+                    double c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+                    for (size_t p = 0; p < k; ++p)
+                    {
+                        c0 += a0[p] * w[p];
+                        c1 += a1[p] * w[p];
+                        c2 += a2[p] * w[p];
+                        c3 += a3[p] * w[p];
+                    }
+                    C[i * n + j] = c0 + bias[j];
+                    C[(i + 1) * n + j] = c1 + bias[j];
+                    C[(i + 2) * n + j] = c2 + bias[j];
+                    C[(i + 3) * n + j] = c3 + bias[j];
+                }
+            }
+            // the rows left over, one matrix-vector product each
+            for (; i < m; ++i)
+            {
+                const double* a = A + i * k;
+                size_t j = 0;
+                for (; j + 4 <= n; j += 4)
+                {
+                    const double* w0 = W + j * k;
+                    const double* w1 = w0 + k;
+                    const double* w2 = w1 + k;
+                    const double* w3 = w2 + k;
+                    double c0 = 0, c1 = 0, c2 = 0, c3 = 0;
+                    for (size_t p = 0; p < k; ++p)
+                    {
+                        double x = a[p];
+                        c0 += x * w0[p];
+                        c1 += x * w1[p];
+                        c2 += x * w2[p];
+                        c3 += x * w3[p];
+                    }
+                    C[i * n + j] = c0 + bias[j];
+                    C[i * n + j + 1] = c1 + bias[j + 1];
+                    C[i * n + j + 2] = c2 + bias[j + 2];
+                    C[i * n + j + 3] = c3 + bias[j + 3];
+                }
+                for (; j < n; ++j)
+                {
+                    const double* w = W + j * k;
+                    double c = 0;
+                    for (size_t p = 0; p < k; ++p)
+                    {
+                        c += a[p] * w[p];
+                    }
+                    C[i * n + j] = c + bias[j];
+                }
+            }
+        }
+
+        /// G += D^T * A, with D m rows of n, A m rows of k, G n rows of k
+        /// (the weight gradient of a batch, accumulated over its rows)
+        void accumulate_outer(const double* D, size_t m, size_t n,
+                              const double* A, size_t k, double* G)
+        {
+            size_t i = 0;
+            for (; i + 4 <= m; i += 4)
+            {
+                const double* a0 = A + i * k;
+                const double* a1 = a0 + k;
+                const double* a2 = a1 + k;
+                const double* a3 = a2 + k;
+                for (size_t j = 0; j < n; ++j)
+                {
+                    double d0 = D[i * n + j];
+                    double d1 = D[(i + 1) * n + j];
+                    double d2 = D[(i + 2) * n + j];
+                    double d3 = D[(i + 3) * n + j];
+                    double* g = G + j * k;
+                    for (size_t p = 0; p < k; ++p)
+                    {
+                        g[p] += d0 * a0[p] + d1 * a1[p] + d2 * a2[p] + d3 * a3[p];
+                    }
+                }
+            }
+            for (; i < m; ++i)
+            {
+                const double* a = A + i * k;
+                for (size_t j = 0; j < n; ++j)
+                {
+                    double d = D[i * n + j];
+                    double* g = G + j * k;
+                    for (size_t p = 0; p < k; ++p)
+                    {
+                        g[p] += d * a[p];
+                    }
+                }
+            }
+        }
+
+        /// B = D * W, with D m rows of n, W n rows of k, B m rows of k
+        /// (the error sent back to the layer below)
+        void multiply(const double* D, size_t m, size_t n,
+                      const double* W, size_t k, double* B)
+        {
+            std::fill(B, B + m * k, 0.0);
+            for (size_t i = 0; i < m; ++i)
+            {
+                double* b = B + i * k;
+                size_t j = 0;
+                for (; j + 4 <= n; j += 4)
+                {
+                    double d0 = D[i * n + j];
+                    double d1 = D[i * n + j + 1];
+                    double d2 = D[i * n + j + 2];
+                    double d3 = D[i * n + j + 3];
+                    const double* w0 = W + j * k;
+                    const double* w1 = w0 + k;
+                    const double* w2 = w1 + k;
+                    const double* w3 = w2 + k;
+                    for (size_t p = 0; p < k; ++p)
+                    {
+                        b[p] += d0 * w0[p] + d1 * w1[p] + d2 * w2[p] + d3 * w3[p];
+                    }
+                }
+                for (; j < n; ++j)
+                {
+                    double d = D[i * n + j];
+                    const double* w = W + j * k;
+                    for (size_t p = 0; p < k; ++p)
+                    {
+                        b[p] += d * w[p];
+                    }
+                }
+            }
+        }
+    }
+
+    /// @param layer_sizes the number of inputs, then of the units of each hidden layer, then of outputs
+    DenseNetwork::DenseNetwork(const std::vector<size_t>& layer_sizes)
+        : mSizes(layer_sizes)
+        , mWeights()
+        , mBiases()
+    {
+        AssertMsg(mSizes.size() >= 2, "a network needs at least a layer of inputs and a layer of outputs");
+        for (size_t l = 0; l + 1 < mSizes.size(); ++l)
+        {
+            AssertMsg(mSizes[l] > 0 && mSizes[l + 1] > 0, "every layer of a network needs at least one unit");
+            // scaled so that the sums into each unit start with unit variance
+            double sigma = 1.0 / std::sqrt(double(mSizes[l]));
+            mWeights.push_back(std::vector<double>(mSizes[l + 1] * mSizes[l]));
+            std::vector<double>& weights = mWeights.back();
+            for (size_t w = 0; w < weights.size(); ++w)
+            {
+                weights[w] = RANDOM.normalD(0, sigma);
+            }
+            mBiases.push_back(std::vector<double>(mSizes[l + 1], 0.0));
+        }
+    }
+
+    /// evaluate a batch of inputs
+    const double* DenseNetwork::forward(const double* inputs, size_t batch)
+    {
+        size_t layers = mWeights.size();
+        mActivations.resize(layers);
+        const double* below = inputs;
+        for (size_t l = 0; l < layers; ++l)
+        {
+            std::vector<double>& out = mActivations[l];
+            out.resize(batch * mSizes[l + 1]);
+            multiply_transposed(below, batch, mSizes[l], &mWeights[l][0], mSizes[l + 1], &mBiases[l][0], &out[0]);
+            if (l + 1 < layers)
+            {
+                for (size_t i = 0; i < out.size(); ++i)
+                {
+                    out[i] = std::tanh(out[i]);
+                }
+            }
+            below = &out[0];
+        }
+        return below;
+    }
+
+    /// take one gradient descent step on the mean squared error of a batch
+    void DenseNetwork::train(const double* inputs, const double* targets, size_t batch, double learning_rate)
+    {
+        if (batch == 0)
+        {
+            return;
+        }
+        size_t layers = mWeights.size();
+        const double* outputs = forward(inputs, batch);
+
+        // the error gradient of the (linear) output layer
+        mDeltas.resize(layers);
+        std::vector<double>& top = mDeltas[layers - 1];
+        top.resize(batch * getNumOutputs());
+        for (size_t i = 0; i < top.size(); ++i)
+        {
+            top[i] = outputs[i] - targets[i];
+        }
+
+        double step = learning_rate / batch;
+        for (size_t l = layers; l-- > 0; )
+        {
+            size_t n = mSizes[l + 1];
+            size_t k = mSizes[l];
+            const double* below = (l == 0) ? inputs : &mActivations[l - 1][0];
+            const std::vector<double>& delta = mDeltas[l];
+
+            // send the error down through the weights before they change
+            if (l > 0)
+            {
+                std::vector<double>& down = mDeltas[l - 1];
+                down.resize(batch * k);
+                multiply(&delta[0], batch, n, &mWeights[l][0], k, &down[0]);
+                for (size_t i = 0; i < down.size(); ++i)
+                {
+                    down[i] *= 1.0 - below[i] * below[i];
+                }
+            }
+
+            // accumulate the gradient over the batch, then take one step
+            mWeightGradient.assign(n * k, 0.0);
+            mBiasGradient.assign(n, 0.0);
+            accumulate_outer(&delta[0], batch, n, below, k, &mWeightGradient[0]);
+            for (size_t i = 0; i < batch; ++i)
+            {
+                for (size_t j = 0; j < n; ++j)
+                {
+                    mBiasGradient[j] += delta[i * n + j];
+                }
+            }
+            std::vector<double>& weights = mWeights[l];
+            for (size_t w = 0; w < weights.size(); ++w)
+            {
+                weights[w] -= step * mWeightGradient[w];
+            }
+            std::vector<double>& biases = mBiases[l];
+            for (size_t j = 0; j < n; ++j)
+            {
+                biases[j] -= step * mBiasGradient[j];
+            }
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef _OPENNERO_AI_RL_DENSENETWORK_H_
+#define _OPENNERO_AI_RL_DENSENETWORK_H_
+
+#include <vector>
+#include <boost/serialization/access.hpp>
+#include <boost/serialization/nvp.hpp>
+#include <boost/serialization/vector.hpp>
+#include "core/Common.h"
+
+namespace OpenNero
+{
+    /// A fully connected feed-forward network with tanh hidden units and
+    /// linear outputs, trained by backpropagation of the squared error.
+    ///
+    /// The weights of each layer are one contiguous row-major matrix with a
+    /// row per unit, and a batch of inputs is one row-major matrix with a
+    /// row per input, so evaluating and training a batch are a few blocked
+    /// matrix products per layer.
+    class DenseNetwork
+    {
+    public:
+        /// constructor
+        DenseNetwork() {}
+
+        /// constructor
+        /// @param layer_sizes the number of inputs, then of the units of each hidden layer, then of outputs
+        explicit DenseNetwork(const std::vector<size_t>& layer_sizes);
+
+        /// the number of inputs
+        size_t getNumInputs() const { return mSizes.empty() ? 0 : mSizes.front(); }
+
+        /// the number of outputs
+        size_t getNumOutputs() const { return mSizes.empty() ? 0 : mSizes.back(); }
+
+        /// evaluate a batch of inputs
+        /// @param inputs batch rows of getNumInputs() values
+        /// @param batch the number of inputs
+        /// @return batch rows of getNumOutputs() values (valid until the next call)
+        const double* forward(const double* inputs, size_t batch);
+
+        /// take one gradient descent step on the mean squared error of a batch
+        /// @param inputs batch rows of getNumInputs() values
+        /// @param targets batch rows of getNumOutputs() values
+        /// @param batch the number of examples
+        /// @param learning_rate the size of the step
+        void train(const double* inputs, const double* targets, size_t batch, double learning_rate);
+
+        /// serialize this object to/from a Boost serialization archive
+        template<class Archive>
+        void serialize(Archive & ar, const unsigned int version)
+        {
+            ar & BOOST_SERIALIZATION_NVP(mSizes);
+            ar & BOOST_SERIALIZATION_NVP(mWeights);
+            ar & BOOST_SERIALIZATION_NVP(mBiases);
+        }
+
+    private:
+        friend class boost::serialization::access;
+
+        std::vector<size_t> mSizes; ///< number of values in each layer, the inputs first
+        std::vector< std::vector<double> > mWeights; ///< weights of each layer, mSizes[l + 1] rows of mSizes[l]
+        std::vector< std::vector<double> > mBiases; ///< biases of each layer
+        std::vector< std::vector<double> > mActivations; ///< outputs of each layer for the latest batch
+        std::vector< std::vector<double> > mDeltas; ///< error gradients of each layer for the latest batch
+        std::vector<double> mWeightGradient; ///< gradient of the weights of one layer
+        std::vector<double> mBiasGradient; ///< gradient of the biases of one layer
+    };
+}
+
+#endif // _OPENNERO_AI_RL_DENSENETWORK_H_
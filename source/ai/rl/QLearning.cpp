@@ -8,16 +8,19 @@
 namespace OpenNero
 {
 	double QLearningBrain::predict(const Observations& new_state) {
+		mApproximator->predict_all(new_state, action_list, action_values);
 		double max_value = -DBL_MAX;
-		std::vector< Actions >::const_iterator iter;
-		for (iter = action_list.begin(); iter != action_list.end(); ++iter)
+		for (size_t i = 0; i < action_values.size(); ++i)
 		{
-			double value = mApproximator->predict(new_state, *iter);
-			if (value > max_value)
+			if (action_values[i] > max_value)
 			{
-				max_value = value;
+				max_value = action_values[i];
 			}
 		}
 		return max_value;
 	}
+
+	double QLearningBrain::predict_next(const Observations& next_state, const Actions& /*next_action*/) {
+		return predict(next_state);
+	}
 }
@@ -16,6 +16,9 @@ namespace OpenNero
     protected:
     	// predicts reinforcement for current round
     	virtual double predict(const Observations& new_state);
+
+        // the value of the best action in the next state of a replayed transition
+        virtual double predict_next(const Observations& next_state, const Actions& next_action);
 	public:
 		/// constructor
 		/// @param gamma reward discount factor (between 0 and 1)
@@ -0,0 +1,133 @@
+#include <cstring>
+#include <algorithm>
+
+#include "core/Common.h"
+#include "QTable.h"
+
+namespace OpenNero
+{
+    namespace
+    {
+        /// the number of slots a new table starts with (a power of two)
+        const size_t kInitialSlots = 16;
+
+        /// scramble the bits of a word (the finalizer of MurmurHash3)
+        inline QTable::Word mix(QTable::Word x)
+        {
+            x ^= x >> 33;
+            x *= 0xff51afd7ed558ccdULL;
+            x ^= x >> 33;
+            x *= 0xc4ceb9fe1a85ec53ULL;
+            x ^= x >> 33;
+            return x;
+        }
+    }
+
+    QTable::QTable(size_t key_words)
+        : mKeyWords(key_words)
+        , mSize(0)
+        , mSlots()
+        , mUsed()
+    {
+        Assert(key_words > 0);
+        rehash(kInitialSlots);
+    }
+
+    /// look up the value stored under a key
+    bool QTable::find(const Word* key, double& value) const
+    {
+        size_t i = probe(key);
+        if (!mUsed[i])
+        {
+            return false;
+        }
+        value = getValue(i);
+        return true;
+    }
+
+    /// store a value under a key, replacing the old one if there is one
+    void QTable::set(const Word* key, double value)
+    {
+        size_t i = probe(key);
+        if (!mUsed[i])
+        {
+            // keep the load factor under 0.7 so that probe sequences stay short
+            if ((mSize + 1) * 10 > capacity() * 7)
+            {
+                rehash(capacity() * 2);
+                i = probe(key);
+            }
+            std::copy(key, key + mKeyWords, mSlots.begin() + i * (mKeyWords + 1));
+            mUsed[i] = 1;
+            ++mSize;
+        }
+        memcpy(&mSlots[i * (mKeyWords + 1) + mKeyWords], &value, sizeof(value));
+    }
+
+    /// make room for at least n entries without growing again
+    void QTable::reserve(size_t n)
+    {
+        size_t slots = capacity();
+        while (n * 10 > slots * 7)
+        {
+            slots *= 2;
+        }
+        if (slots > capacity())
+        {
+            rehash(slots);
+        }
+    }
+
+    /// remove all of the entries
+    void QTable::clear()
+    {
+        mSize = 0;
+        mSlots.clear();
+        mUsed.clear();
+        rehash(kInitialSlots);
+    }
+
+    /// the value in slot i
+    double QTable::getValue(size_t i) const
+    {
+        double value;
+        memcpy(&value, &mSlots[i * (mKeyWords + 1) + mKeyWords], sizeof(value));
+        return value;
+    }
+
+    /// the slot that holds the key, or the empty slot where it would go
+    size_t QTable::probe(const Word* key) const
+    {
+        Word h = mix(key[0]);
+        for (size_t w = 1; w < mKeyWords; ++w)
+        {
+            h = mix(h ^ key[w]);
+        }
+        size_t mask = capacity() - 1;
+        size_t i = static_cast<size_t>(h) & mask;
+        while (mUsed[i] && !std::equal(key, key + mKeyWords, &mSlots[i * (mKeyWords + 1)]))
+        {
+            i = (i + 1) & mask;
+        }
+        return i;
+    }
+
+    /// move all of the entries into a table with the given number of slots
+    void QTable::rehash(size_t slots)
+    {
+        std::vector<Word> old_slots(slots * (mKeyWords + 1), 0);
+        std::vector<U8> old_used(slots, 0);
+        old_slots.swap(mSlots);
+        old_used.swap(mUsed);
+        for (size_t i = 0; i < old_used.size(); ++i)
+        {
+            if (old_used[i])
+            {
+                const Word* slot = &old_slots[i * (mKeyWords + 1)];
+                size_t j = probe(slot);
+                std::copy(slot, slot + mKeyWords + 1, mSlots.begin() + j * (mKeyWords + 1));
+                mUsed[j] = 1;
+            }
+        }
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef _OPENNERO_AI_RL_QTABLE_H_
+#define _OPENNERO_AI_RL_QTABLE_H_
+
+#include <vector>
+#include <boost/cstdint.hpp>
+#include "core/Common.h"
+
+namespace OpenNero
+{
+    /// A hash table from packed integer keys to values, for tabular agents.
+    ///
+    /// All of the keys have the same number of 64-bit words. Each slot holds
+    /// the words of its key followed by the bits of its value, and the slots
+    /// are stored in one flat array and probed linearly, so a lookup usually
+    /// touches a single cache line and an entry costs (words + 1) * 8 bytes
+    /// plus a byte of occupancy. Entries cannot be removed one by one.
+    class QTable
+    {
+    public:
+        typedef boost::uint64_t Word; ///< a word of a packed key
+
+        /// constructor
+        /// @param key_words the number of words in every key
+        explicit QTable(size_t key_words = 1);
+
+        /// the number of words in every key
+        size_t getKeyWords() const { return mKeyWords; }
+
+        /// the number of entries in the table
+        size_t size() const { return mSize; }
+
+        /// the number of slots in the table
+        size_t capacity() const { return mUsed.size(); }
+
+        /// the number of bytes used by the slots of the table
+        size_t memory() const { return mSlots.size() * sizeof(Word) + mUsed.size(); }
+
+        /// look up the value stored under a key
+        /// @return true iff the key was found
+        bool find(const Word* key, double& value) const;
+
+        /// store a value under a key, replacing the old one if there is one
+        void set(const Word* key, double value);
+
+        /// make room for at least n entries without growing again
+        void reserve(size_t n);
+
+        /// remove all of the entries
+        void clear();
+
+        /// is slot i in use?
+        bool isUsed(size_t i) const { return mUsed[i] != 0; }
+
+        /// the key in slot i
+        const Word* getKey(size_t i) const { return &mSlots[i * (mKeyWords + 1)]; }
+
+        /// the value in slot i
+        double getValue(size_t i) const;
+
+    private:
+        /// the slot that holds the key, or the empty slot where it would go
+        size_t probe(const Word* key) const;
+
+        /// move all of the entries into a table with the given number of slots
+        void rehash(size_t slots);
+
+        size_t mKeyWords; ///< number of words in every key
+        size_t mSize; ///< number of entries
+        std::vector<Word> mSlots; ///< key words and value bits of every slot
+        std::vector<U8> mUsed; ///< 1 for the slots in use, 0 for the empty ones
+    };
+}
+
+#endif // _OPENNERO_AI_RL_QTABLE_H_
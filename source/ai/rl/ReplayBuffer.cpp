@@ -0,0 +1,113 @@
+#include <algorithm>
+
+#include "core/Common.h"
+#include "math/Random.h"
+#include "ReplayBuffer.h"
+
+namespace OpenNero
+{
+    /// @param capacity the number of transitions kept
+    ReplayBuffer::ReplayBuffer(size_t capacity)
+        : mCapacity(capacity)
+        , mNumSensors(0)
+        , mNumActions(0)
+        , mNext(0)
+        , mSize(0)
+        , mNumAdded(0)
+    {
+        AssertMsg(capacity > 0, "a replay buffer must be able to hold at least one transition");
+    }
+
+    /// the number of transitions stored so far
+    size_t ReplayBuffer::size() const
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        return mSize;
+    }
+
+    /// the number of transitions added since the buffer was created
+    size_t ReplayBuffer::getNumAdded() const
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        return mNumAdded;
+    }
+
+    /// add a transition, overwriting the oldest one if the buffer is full
+    void ReplayBuffer::add(const Observations& state, const Actions& action, double reward,
+                           const Observations& next_state, const Actions& next_action, bool done)
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        if (mRewards.empty())
+        {
+            allocate(state.size(), action.size());
+        }
+        AssertMsg(state.size() == mNumSensors && next_state.size() == mNumSensors &&
+                  action.size() == mNumActions && next_action.size() == mNumActions,
+                  "all of the transitions in a replay buffer must have " << mNumSensors << " sensors and " << mNumActions << " actions");
+        size_t i = mNext;
+        std::copy(state.begin(), state.end(), mStates.begin() + i * mNumSensors);
+        std::copy(action.begin(), action.end(), mActions.begin() + i * mNumActions);
+        mRewards[i] = reward;
+        std::copy(next_state.begin(), next_state.end(), mNextStates.begin() + i * mNumSensors);
+        std::copy(next_action.begin(), next_action.end(), mNextActions.begin() + i * mNumActions);
+        mDones[i] = done ? 1 : 0;
+        mNext = (mNext + 1) % mCapacity;
+        mSize = std::min(mSize + 1, mCapacity);
+        ++mNumAdded;
+    }
+
+    /// add a transition that ended the episode
+    void ReplayBuffer::addFinal(const Observations& state, const Actions& action, double reward)
+    {
+        // there is no next state or action, store the last ones in their place
+        add(state, action, reward, state, action, true);
+    }
+
+    /// copy n transitions chosen uniformly at random into batch
+    bool ReplayBuffer::sample(size_t n, ReplayBatch& batch) const
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        if (mSize == 0)
+        {
+            n = 0;
+        }
+        batch.states.resize(n);
+        batch.actions.resize(n);
+        batch.rewards.resize(n);
+        batch.next_states.resize(n);
+        batch.next_actions.resize(n);
+        batch.dones.resize(n);
+        for (size_t k = 0; k < n; ++k)
+        {
+            size_t i = RANDOM.randI(static_cast<uint32_t>(mSize - 1));
+            batch.states[k].assign(mStates.begin() + i * mNumSensors, mStates.begin() + (i + 1) * mNumSensors);
+            batch.actions[k].assign(mActions.begin() + i * mNumActions, mActions.begin() + (i + 1) * mNumActions);
+            batch.rewards[k] = mRewards[i];
+            batch.next_states[k].assign(mNextStates.begin() + i * mNumSensors, mNextStates.begin() + (i + 1) * mNumSensors);
+            batch.next_actions[k].assign(mNextActions.begin() + i * mNumActions, mNextActions.begin() + (i + 1) * mNumActions);
+            batch.dones[k] = mDones[i];
+        }
+        return n > 0;
+    }
+
+    /// remove all of the transitions
+    void ReplayBuffer::clear()
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        mNext = 0;
+        mSize = 0;
+    }
+
+    /// allocate the arrays for transitions of the given size
+    void ReplayBuffer::allocate(size_t num_sensors, size_t num_actions)
+    {
+        mNumSensors = num_sensors;
+        mNumActions = num_actions;
+        mStates.resize(mCapacity * num_sensors);
+        mActions.resize(mCapacity * num_actions);
+        mRewards.resize(mCapacity);
+        mNextStates.resize(mCapacity * num_sensors);
+        mNextActions.resize(mCapacity * num_actions);
+        mDones.resize(mCapacity);
+    }
+}
@@ -0,0 +1,86 @@
+#ifndef _OPENNERO_AI_RL_REPLAYBUFFER_H_
+#define _OPENNERO_AI_RL_REPLAYBUFFER_H_
+
+#include <vector>
+#include <boost/thread/mutex.hpp>
+#include "core/Common.h"
+#include "ai/AI.h"
+
+namespace OpenNero
+{
+    /// @cond
+    BOOST_SHARED_DECL(ReplayBuffer);
+    /// @endcond
+
+    /// A minibatch of transitions sampled from a ReplayBuffer; the vectors
+    /// are reused from one sample to the next
+    struct ReplayBatch
+    {
+        std::vector<Observations> states; ///< states the actions were taken in
+        std::vector<Actions> actions; ///< actions taken
+        std::vector<double> rewards; ///< rewards received for the actions
+        std::vector<Observations> next_states; ///< states the actions led to
+        std::vector<Actions> next_actions; ///< actions taken in the next states
+        std::vector<U8> dones; ///< 1 if the episode ended with the action (no next state or action)
+
+        /// the number of transitions in the batch
+        size_t size() const { return rewards.size(); }
+    };
+
+    /// A fixed-size circular store of the transitions (s, a, r, s', a', done)
+    /// seen by TD agents, for replaying them in minibatches. The transitions
+    /// are kept in flat preallocated arrays and the oldest ones are
+    /// overwritten when the buffer is full. A buffer can be shared by the
+    /// agents of a team, which may add to it from several threads.
+    class ReplayBuffer
+    {
+    public:
+        /// constructor
+        /// @param capacity the number of transitions kept
+        explicit ReplayBuffer(size_t capacity);
+
+        /// the number of transitions kept
+        size_t capacity() const { return mCapacity; }
+
+        /// the number of transitions stored so far (at most capacity)
+        size_t size() const;
+
+        /// the number of transitions added since the buffer was created
+        size_t getNumAdded() const;
+
+        /// add a transition, overwriting the oldest one if the buffer is full
+        /// (the first transition fixes the numbers of sensors and actions)
+        void add(const Observations& state, const Actions& action, double reward,
+                 const Observations& next_state, const Actions& next_action, bool done);
+
+        /// add a transition that ended the episode
+        void addFinal(const Observations& state, const Actions& action, double reward);
+
+        /// copy n transitions chosen uniformly at random (with replacement) into batch
+        /// @return false (and leaves batch empty) if the buffer is empty
+        bool sample(size_t n, ReplayBatch& batch) const;
+
+        /// remove all of the transitions
+        void clear();
+
+    private:
+        /// allocate the arrays for transitions of the given size
+        void allocate(size_t num_sensors, size_t num_actions);
+
+        size_t mCapacity; ///< number of transitions kept
+        size_t mNumSensors; ///< size of every state
+        size_t mNumActions; ///< size of every action
+        size_t mNext; ///< slot of the next transition added
+        size_t mSize; ///< number of transitions stored
+        size_t mNumAdded; ///< number of transitions ever added
+        std::vector<double> mStates; ///< states, one row per slot
+        std::vector<double> mActions; ///< actions, one row per slot
+        std::vector<double> mRewards; ///< rewards, one per slot
+        std::vector<double> mNextStates; ///< next states, one row per slot
+        std::vector<double> mNextActions; ///< next actions, one row per slot
+        std::vector<U8> mDones; ///< episode ended, one per slot
+        mutable boost::mutex mMutex; ///< protects all of the fields above but mCapacity
+    };
+}
+
+#endif // _OPENNERO_AI_RL_REPLAYBUFFER_H_
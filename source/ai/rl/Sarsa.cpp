@@ -9,18 +9,18 @@ namespace OpenNero
 {
 
     /// called for agent to take its first step
-    Actions SarsaBrain::start(const TimeType& time, const Observations& new_state)
+    void SarsaBrain::start_into(const TimeType& time, const Observations& new_state, Actions& actions)
     {
         cumulative_reward = 0;
-        return TDBrain::start(time, new_state);
+        TDBrain::start_into(time, new_state, actions);
     }
 
     /// act based on time, sensor arrays, and last reward
-    Actions SarsaBrain::act(const TimeType& time, const Observations& new_state, const Reward& reward)
+    void SarsaBrain::act_into(const TimeType& time, const Observations& new_state, const Reward& reward, Actions& actions)
     {
 		AssertMsg(reward.size() == 1, "multi-objective rewards not supported");
         cumulative_reward += reward[0];
-        return TDBrain::act(time, new_state, reward);
+        TDBrain::act_into(time, new_state, reward, actions);
     }
 
     /// called to tell agent about its last reward
@@ -58,10 +58,10 @@ namespace OpenNero
             virtual ~SarsaBrain() {}
 
             /// called for agent to take its first step
-            virtual Actions start(const TimeType& time, const Observations& o);
+            virtual void start_into(const TimeType& time, const Observations& o, Actions& actions);
 
             /// act based on time, sensor arrays, and last reward
-            virtual Actions act(const TimeType& time, const Observations& o, const Reward& reward);
+            virtual void act_into(const TimeType& time, const Observations& o, const Reward& reward, Actions& actions);
 
             /// called to tell agent about its last reward
             virtual bool end(const TimeType& time, const Reward& reward);
@@ -24,7 +24,14 @@ namespace OpenNero
 
         int bins = action_bins;
 
-        if (num_tiles > 0)
+        if (num_hidden > 0)
+        {
+            AssertMsg(num_tiles == 0, "num_tiles must be 0 for num_hidden > 0");
+            AssertMsg(action_bins > 0, "action_bins > 0 for num_hidden > 0");
+            mApproximator.reset(
+                new BackpropApproximator(mInfo, num_hidden));
+        }
+        else if (num_tiles > 0)
         {
             AssertMsg(action_bins == 0, "action_bins must be 0 for num_tiles > 0");
             AssertMsg(state_bins == 0, "state_bins must be 0 for num_tiles > 0");
@@ -81,15 +88,31 @@ namespace OpenNero
 
     /// called for agent to take its first step
     Actions TDBrain::start(const TimeType& time, const Observations& new_state)
+    {
+        Actions actions;
+        start_into(time, new_state, actions);
+        return actions;
+    }
+
+    /// act based on time, sensor arrays, and last reward
+    Actions TDBrain::act(const TimeType& time, const Observations& new_state, const Reward& reward)
+    {
+        Actions actions;
+        act_into(time, new_state, reward, actions);
+        return actions;
+    }
+
+    /// called for agent to take its first step, writing the actions into caller-owned storage
+    void TDBrain::start_into(const TimeType& time, const Observations& new_state, Actions& actions)
     {
         epsilon_greedy(new_state);
         action = new_action;
         state = new_state;
-        return action;
+        actions = action;
     }
 
-    /// act based on time, sensor arrays, and last reward
-    Actions TDBrain::act(const TimeType& time, const Observations& new_state, const Reward& reward)
+    /// act based on time, sensor arrays, and last reward, writing the actions into caller-owned storage
+    void TDBrain::act_into(const TimeType& time, const Observations& new_state, const Reward& reward, Actions& actions)
     {
 		AssertMsg(reward.size() == 1, "multi-objective rewards not supported");
         // select new action and estimate its value
@@ -97,9 +120,10 @@ namespace OpenNero
         double old_Q = mApproximator->predict(state, action);
         // Q(s_t, a_t) <- Q(s_t, a_t) + \alpha [r_{t+1} + \gamma Q(s_{t+1}, a_{t+1}) - Q(s_t, a_t)
         mApproximator->update(state, action, old_Q + mAlpha * (reward[0] + mGamma * new_Q - old_Q));
+        remember(new_state, new_action, reward[0], false);
         action = new_action;
         state = new_state;
-        return action;
+        actions = action;
     }
 
     /// called to tell agent about its last reward
@@ -110,38 +134,113 @@ namespace OpenNero
         // LOG_F_DEBUG("ai", "TD FINAL UPDATE s1: " << state << ", a1: " << action << ", r: " << reward);
         double old_Q = mApproximator->predict(state, action);
         mApproximator->update(state, action, old_Q + mAlpha * (reward[0] - old_Q));
+        remember(state, action, reward[0], true);
         return true;
     }
 
+    /// the value of the next state of a replayed transition
+    double TDBrain::predict_next(const Observations& next_state, const Actions& next_action)
+    {
+        return mApproximator->predict(next_state, next_action);
+    }
+
+    /// record the transition from the current state and action, and replay
+    /// a minibatch every mReplayFrequency transitions
+    void TDBrain::remember(const Observations& next_state, const Actions& next_action, double reward, bool done)
+    {
+        if (!mReplay)
+        {
+            return;
+        }
+        if (done)
+        {
+            mReplay->addFinal(state, action, reward);
+        }
+        else
+        {
+            mReplay->add(state, action, reward, next_state, next_action, false);
+        }
+        if (--mReplayCountdown == 0)
+        {
+            mReplayCountdown = mReplayFrequency;
+            replay();
+        }
+    }
+
+    /// update the approximator with a minibatch sampled from the replay buffer
+    void TDBrain::replay()
+    {
+        if (mReplayBatchSize == 0 || !mReplay->sample(mReplayBatchSize, mReplayBatch))
+        {
+            return;
+        }
+        // all of the targets come from the values before the minibatch update
+        mReplayTargets.resize(mReplayBatch.size());
+        for (size_t i = 0; i < mReplayBatch.size(); ++i)
+        {
+            double old_Q = mApproximator->predict(mReplayBatch.states[i], mReplayBatch.actions[i]);
+            double target = mReplayBatch.rewards[i];
+            if (!mReplayBatch.dones[i])
+            {
+                target += mGamma * predict_next(mReplayBatch.next_states[i], mReplayBatch.next_actions[i]);
+            }
+            mReplayTargets[i] = old_Q + mAlpha * (target - old_Q);
+        }
+        mApproximator->update_batch(mReplayBatch.states, mReplayBatch.actions, mReplayTargets);
+    }
+
     /// select action according to the epsilon-greedy policy
     double TDBrain::epsilon_greedy(const Observations& new_state)
     {
         // with chance epsilon, select random action
         if (RANDOM.randF() < mEpsilon)
         {
-            new_action = mInfo.actions.getRandom();
+            mInfo.actions.getRandom(new_action);
             double value = predict(new_state);
             return value;
         }
         // enumerate all possible actions (actions must be discrete!)
-        new_action = mInfo.actions.getInstance();
+        mInfo.actions.getInstance(new_action);
         // select the greedy action in random order
         std::random_shuffle(action_list.begin(), action_list.end());
+        mApproximator->predict_all(new_state, action_list, action_values);
         double max_value = -DBL_MAX;
-        std::vector< Actions >::const_iterator iter;
-        for (iter = action_list.begin(); iter != action_list.end(); ++iter)
+        for (size_t i = 0; i < action_list.size(); ++i)
         {
-            double value = mApproximator->predict(new_state, *iter);
-            if (value > max_value)
+            if (action_values[i] > max_value)
             {
-                max_value = value;
-                new_action = *iter;
+                max_value = action_values[i];
+                new_action = action_list[i];
             }
         }
         // Assuming if you choose max value, you will want to update with that as your prediction
         return max_value;
     }
 
+    /// write the Q table of a tabular agent to a binary file
+    bool TDBrain::save_table(const std::string& filename) const
+    {
+        const TableApproximator* table = dynamic_cast<const TableApproximator*>(mApproximator.get());
+        if (!table)
+        {
+            LOG_F_ERROR("ai.rl", "only agents with a table approximator can save their table");
+            return false;
+        }
+        return table->save_table(filename);
+    }
+
+    /// read the Q table of a tabular agent from a file written by save_table
+    bool TDBrain::load_table(const std::string& filename)
+    {
+        TableApproximator* table = dynamic_cast<TableApproximator*>(mApproximator.get());
+        if (!table)
+        {
+            LOG_F_ERROR("ai.rl", "only agents with a table approximator can load a table");
+            return false;
+        }
+        return table->load_table(filename);
+    }
+
     /// called right before the agent dies
     bool TDBrain::destroy()
     {
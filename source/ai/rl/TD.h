@@ -13,6 +13,8 @@
 #include "core/Common.h"
 #include "ai/AgentBrain.h"
 #include "Approximator.h"
+#include "BackpropApproximator.h"
+#include "ReplayBuffer.h"
 
 namespace OpenNero
 {
@@ -36,13 +38,31 @@ namespace OpenNero
         Actions action;      ///< previous action taken
         Observations state;  ///< previous state
         Actions new_action;  ///< new action
+        std::vector<double> action_values; ///< values of the actions in action_list in the latest state
         int action_bins; ///< number of discrete bins for action space.
         int state_bins; ///< number of discrete bins for state space.
         int num_tiles; ///< number of discrete bins for action space.
         int num_weights; ///< number of discrete bins for state space.
+        int num_hidden; ///< number of hidden units of a neural network approximator (0 for none)
+        ReplayBufferPtr mReplay; ///< transitions to replay (none for online learning only)
+        size_t mReplayBatchSize; ///< number of transitions replayed at a time
+        size_t mReplayFrequency; ///< number of transitions added between replays
+        size_t mReplayCountdown; ///< number of transitions to add before the next replay
+        ReplayBatch mReplayBatch; ///< the latest minibatch replayed
+        std::vector<double> mReplayTargets; ///< the targets for the latest minibatch
 
     	// predicts reinforcement for current round
     	virtual double predict(const Observations& new_state) = 0;
+
+        /// the value of the next state of a replayed transition
+        /// (the value of the next action taken, as in SARSA)
+        virtual double predict_next(const Observations& next_state, const Actions& next_action);
+
+        /// record a transition and replay a minibatch if it is time to
+        void remember(const Observations& next_state, const Actions& next_action, double reward, bool done);
+
+        /// update the approximator with a minibatch sampled from the replay buffer
+        void replay();
     public:
         /// constructor
         /// @param gamma reward discount factor (between 0 and 1)
@@ -60,10 +80,16 @@ namespace OpenNero
         , action()
         , state()
         , new_action()
+        , action_values()
         , action_bins(actions)
         , state_bins(states)
         , num_tiles(tiles)
         , num_weights(weights)
+        , num_hidden(0)
+        , mReplay()
+        , mReplayBatchSize(32)
+        , mReplayFrequency(1)
+        , mReplayCountdown(1)
         {}
 
         /// constructor
@@ -80,10 +106,16 @@ namespace OpenNero
         , action()
         , state()
         , new_action()
+        , action_values()
         , action_bins(3)
         , state_bins(5)
         , num_tiles(0)
         , num_weights(0)
+        , num_hidden(0)
+        , mReplay()
+        , mReplayBatchSize(32)
+        , mReplayFrequency(1)
+        , mReplayCountdown(1)
         {}
 
         /// copy constructor
@@ -97,10 +129,16 @@ namespace OpenNero
         , action(agent.action)
         , state(agent.state)
         , new_action(agent.new_action)
+        , action_values()
         , action_bins(agent.action_bins)
         , state_bins(agent.state_bins)
         , num_tiles(agent.num_tiles)
         , num_weights(agent.num_weights)
+        , num_hidden(agent.num_hidden)
+        , mReplay(agent.mReplay)
+        , mReplayBatchSize(agent.mReplayBatchSize)
+        , mReplayFrequency(agent.mReplayFrequency)
+        , mReplayCountdown(agent.mReplayFrequency)
         {}
 
         /// destructor
@@ -115,6 +153,12 @@ namespace OpenNero
         /// act based on time, sensor arrays, and last reward
         virtual Actions act(const TimeType& time, const Observations& new_state, const Reward& reward);
 
+        /// called for agent to take its first step, writing the actions into caller-owned storage
+        virtual void start_into(const TimeType& time, const Observations& new_state, Actions& actions);
+
+        /// act based on time, sensor arrays, and last reward, writing the actions into caller-owned storage
+        virtual void act_into(const TimeType& time, const Observations& new_state, const Reward& reward, Actions& actions);
+
         /// called to tell agent about its last reward
         virtual bool end(const TimeType& time, const Reward& reward);
 
@@ -148,6 +192,42 @@ namespace OpenNero
         /// select action according to policy
         double epsilon_greedy(const Observations& new_state);
 
+        /// Set the buffer of transitions to replay (copies of this brain
+        /// share it, and so can the brains of a team)
+        /// @param buffer the buffer, or none to learn online only
+        void setReplayBuffer(ReplayBufferPtr buffer) { mReplay = buffer; }
+
+        /// Get the buffer of transitions to replay
+        ReplayBufferPtr getReplayBuffer() const { return mReplay; }
+
+        /// Set the number of transitions replayed at a time
+        void setReplayBatchSize(size_t n) { mReplayBatchSize = n; }
+
+        /// Get the number of transitions replayed at a time
+        size_t getReplayBatchSize() const { return mReplayBatchSize; }
+
+        /// Set the number of transitions added between replays
+        void setReplayFrequency(size_t n) { AssertMsg(n > 0, "the replay frequency must be positive"); mReplayFrequency = n; mReplayCountdown = n; }
+
+        /// Get the number of transitions added between replays
+        size_t getReplayFrequency() const { return mReplayFrequency; }
+
+        /// Use a neural network approximator (instead of a table or tiles)
+        /// from the next initialize on; continuous action dimensions are
+        /// still split into the action bins
+        /// @param n the number of hidden units, or 0 for no network
+        void setHiddenUnits(int n) { AssertMsg(n >= 0, "the number of hidden units must not be negative"); num_hidden = n; }
+
+        /// Get the number of hidden units of the neural network approximator
+        /// @return the number of hidden units, or 0 if there is no network
+        int getHiddenUnits() const { return num_hidden; }
+
+        /// write the Q table of a tabular agent to a binary file
+        bool save_table(const std::string& filename) const;
+
+        /// read the Q table of a tabular agent from a file written by save_table
+        bool load_table(const std::string& filename);
+
         /// load this object from a template
         bool LoadFromTemplate( ObjectTemplatePtr objTemplate, const SimEntityData& data ) 
 			{ return false; /* TODO: implement when we have better template */ }
@@ -166,6 +246,10 @@ namespace OpenNero
             ar & BOOST_SERIALIZATION_NVP(state_bins);
             ar & BOOST_SERIALIZATION_NVP(num_tiles);
             ar & BOOST_SERIALIZATION_NVP(num_weights);
+            if (version > 0)
+            {
+                ar & BOOST_SERIALIZATION_NVP(num_hidden);
+            }
             ar & BOOST_SERIALIZATION_NVP(mInfo);
             ar & BOOST_SERIALIZATION_NVP(action_list);
             ar & BOOST_SERIALIZATION_NVP(mApproximator);
@@ -173,4 +257,6 @@ namespace OpenNero
     };
 } // namespace OpenNero
 
+BOOST_CLASS_VERSION(OpenNero::TDBrain, 1)
+
 #endif // _OPENNERO_AI_RL_TD_H_
@@ -0,0 +1,154 @@
+#include <cmath>
+
+#include "core/Common.h"
+#include "TileCoder.h"
+#include "tiles2.h"
+
+namespace OpenNero
+{
+    namespace
+    {
+        /// the offset GetTiles adds to the coordinate at each position before hashing
+        const long kHashIncrement = 449;
+
+        /// the number of random numbers in the hash table (a power of two)
+        const long kHashTableSize = 2048;
+    }
+
+    TileCoder::TileCoder()
+        : mNumTilings(0)
+        , mMemorySize(1)
+        , mHasState(false)
+    {
+    }
+
+    /// @param info the sensors and actions of the agent
+    /// @param num_tilings the number of tilings (and tiles per state-action pair)
+    /// @param memory_size the number of possible tiles
+    TileCoder::TileCoder(const AgentInitInfo& info, size_t num_tilings, size_t memory_size)
+        : mNumTilings(num_tilings)
+        , mMemorySize(static_cast<long>(memory_size))
+        , mHasState(false)
+    {
+        Assert(num_tilings > 0 && memory_size > 0);
+        // GetTiles hashes the floats, then the number of the tiling, then the ints
+        size_t position = 0;
+        for (size_t i = 0; i < info.sensors.size(); ++i)
+        {
+            if (!info.sensors.isDiscrete(i))
+            {
+                Variable v = { i, position++ };
+                mStateFloats.push_back(v);
+            }
+        }
+        for (size_t i = 0; i < info.actions.size(); ++i)
+        {
+            if (!info.actions.isDiscrete(i))
+            {
+                Variable v = { i, position++ };
+                mActionFloats.push_back(v);
+            }
+        }
+        size_t tiling_position = position++;
+        for (size_t i = 0; i < info.sensors.size(); ++i)
+        {
+            if (info.sensors.isDiscrete(i))
+            {
+                Variable v = { i, position++ };
+                mStateInts.push_back(v);
+            }
+        }
+        for (size_t i = 0; i < info.actions.size(); ++i)
+        {
+            if (info.actions.isDiscrete(i))
+            {
+                Variable v = { i, position++ };
+                mActionInts.push_back(v);
+            }
+        }
+
+        const unsigned int* rndseq = hash_UNH_table();
+        mTilingSums.resize(num_tilings);
+        for (size_t j = 0; j < num_tilings; ++j)
+        {
+            long index = (static_cast<long>(j) + kHashIncrement * static_cast<long>(tiling_position)) & (kHashTableSize - 1);
+            mTilingSums[j] = static_cast<long>(rndseq[index]);
+        }
+    }
+
+    /// use this state for the following calls to getTiles
+    void TileCoder::setState(const FeatureVector& sensors)
+    {
+        if (mHasState && sensors == mState)
+        {
+            return;
+        }
+        mState = sensors;
+        mHasState = true;
+        mStateSums = mTilingSums;
+        addInts(mStateInts, sensors, mStateSums);
+        addFloats(mStateFloats, sensors, mStateSums);
+    }
+
+    /// the tiles of the current state and the given actions
+    void TileCoder::getTiles(const FeatureVector& actions, std::vector<int>& tiles)
+    {
+        Assert(mHasState);
+        mSums = mStateSums;
+        addInts(mActionInts, actions, mSums);
+        addFloats(mActionFloats, actions, mSums);
+        tiles.resize(mNumTilings);
+        for (size_t j = 0; j < mNumTilings; ++j)
+        {
+            // the sums are positive, so this is the index hash_UNH returns
+            tiles[j] = static_cast<int>(mSums[j] % mMemorySize);
+        }
+    }
+
+    /// add the hashes of the continuous variables to sums, one per tiling
+    void TileCoder::addFloats(const std::vector<Variable>& floats, const FeatureVector& values, std::vector<long>& sums) const
+    {
+        const unsigned int* rndseq = hash_UNH_table();
+        const int num_tilings = static_cast<int>(mNumTilings);
+        for (size_t i = 0; i < floats.size(); ++i)
+        {
+            // quantize the variable as GetTiles does (tile width == number of tilings)
+            float value = static_cast<float>(values[floats[i].index]);
+            int q = static_cast<int>(floor(value * static_cast<float>(mNumTilings)));
+            long offset = kHashIncrement * static_cast<long>(floats[i].position);
+            // each tiling is displaced by step from the previous one, so
+            // mod(q - base, num_tilings) can be updated without dividing
+            int step = static_cast<int>((1 + 2 * floats[i].position) % mNumTilings);
+            int r = q % num_tilings;
+            if (r < 0)
+            {
+                r += num_tilings;
+            }
+            for (size_t j = 0; j < mNumTilings; ++j)
+            {
+                sums[j] += static_cast<long>(rndseq[(q - r + offset) & (kHashTableSize - 1)]);
+                r -= step;
+                if (r < 0)
+                {
+                    r += num_tilings;
+                }
+            }
+        }
+    }
+
+    /// add the hashes of the discrete variables to sums, one per tiling
+    void TileCoder::addInts(const std::vector<Variable>& ints, const FeatureVector& values, std::vector<long>& sums) const
+    {
+        const unsigned int* rndseq = hash_UNH_table();
+        long sum = 0;
+        for (size_t i = 0; i < ints.size(); ++i)
+        {
+            long value = static_cast<int>(values[ints[i].index]);
+            sum += static_cast<long>(rndseq[(value + kHashIncrement * static_cast<long>(ints[i].position)) & (kHashTableSize - 1)]);
+        }
+        for (size_t j = 0; j < mNumTilings; ++j)
+        {
+            sums[j] += sum;
+        }
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef _OPENNERO_AI_RL_TILECODER_H_
+#define _OPENNERO_AI_RL_TILECODER_H_
+
+#include <vector>
+#include "core/Common.h"
+#include "ai/AI.h"
+
+namespace OpenNero
+{
+    /// Computes the same tiles as GetTiles (tiles2.h) for state-action pairs,
+    /// where the floats are the continuous sensors and then the continuous
+    /// actions, and the ints are the discrete sensors and then the discrete
+    /// actions.
+    ///
+    /// The tile of each tiling is a sum of random numbers, one for each
+    /// variable, so the part of the sums that comes from the state is worked
+    /// out once by set_state and shared by all of the actions evaluated in
+    /// that state. Each variable is added to the sums of all of the tilings
+    /// in one loop without divisions.
+    class TileCoder
+    {
+    public:
+        /// constructor
+        TileCoder();
+
+        /// constructor
+        /// @param info the sensors and actions of the agent
+        /// @param num_tilings the number of tilings (and tiles per state-action pair)
+        /// @param memory_size the number of possible tiles
+        TileCoder(const AgentInitInfo& info, size_t num_tilings, size_t memory_size);
+
+        /// the number of tilings
+        size_t getNumTilings() const { return mNumTilings; }
+
+        /// use this state for the following calls to getTiles
+        /// (does nothing if it is the state of the previous call)
+        void setState(const FeatureVector& sensors);
+
+        /// the tiles of the current state and the given actions
+        /// @param tiles set to one tile for each tiling
+        void getTiles(const FeatureVector& actions, std::vector<int>& tiles);
+
+    private:
+        /// a variable of the tile coding
+        struct Variable
+        {
+            size_t index; ///< index of the variable in the sensors or actions
+            size_t position; ///< position of the variable in the coordinates hashed by GetTiles
+        };
+
+        /// add the hashes of the continuous variables to sums, one per tiling
+        void addFloats(const std::vector<Variable>& floats, const FeatureVector& values, std::vector<long>& sums) const;
+
+        /// add the hashes of the discrete variables to sums, one per tiling
+        void addInts(const std::vector<Variable>& ints, const FeatureVector& values, std::vector<long>& sums) const;
+
+        size_t mNumTilings; ///< number of tilings
+        long mMemorySize; ///< number of possible tiles
+        std::vector<Variable> mStateFloats; ///< continuous sensors
+        std::vector<Variable> mStateInts; ///< discrete sensors
+        std::vector<Variable> mActionFloats; ///< continuous actions
+        std::vector<Variable> mActionInts; ///< discrete actions
+        std::vector<long> mTilingSums; ///< hash of the tiling number of each tiling
+        FeatureVector mState; ///< the current state
+        bool mHasState; ///< has setState been called?
+        std::vector<long> mStateSums; ///< sums of the tiling and the state for each tiling
+        std::vector<long> mSums; ///< sums of the tiling, the state and the action for each tiling
+    };
+}
+
+#endif // _OPENNERO_AI_RL_TILECODER_H_
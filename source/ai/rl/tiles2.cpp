@@ -77,14 +77,12 @@ void GetTiles(
 }
 
 
-/// Takes an array of integers and returns the corresponding tile after hashing 
-int hash_UNH(const std::vector<int>& ints, long m, int increment)
+/// The 2048 random numbers summed by hash_UNH
+const unsigned int* hash_UNH_table()
 {
     static unsigned int rndseq[2048];
     static int first_call =  1;
     int i,k;
-    long index;
-    long sum = 0;
 
     /* if first call to hashing, initialize table of random numbers */
     if (first_call)
@@ -97,6 +95,16 @@ int hash_UNH(const std::vector<int>& ints, long m, int increment)
         }
         first_call = 0;
     }
+    return rndseq;
+}
+
+/// Takes an array of integers and returns the corresponding tile after hashing 
+int hash_UNH(const std::vector<int>& ints, long m, int increment)
+{
+    const unsigned int* rndseq = hash_UNH_table();
+    int i;
+    long index;
+    long sum = 0;
 
     for (i = 0; i < ints.size(); i++)
     {
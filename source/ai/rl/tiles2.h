@@ -26,5 +26,8 @@ void GetTiles(
 
 int hash_UNH(const std::vector<int>& ints, long m, int increment);
 
+/// The 2048 random numbers summed by hash_UNH
+const unsigned int* hash_UNH_table();
+
 #endif
 
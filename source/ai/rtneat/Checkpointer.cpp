@@ -0,0 +1,156 @@
+/// @file
+/// Background checkpointing of rtNEAT populations.
+
+#include "core/Common.h"
+#include "core/ONTime.h"
+#include "ai/rtneat/Checkpointer.h"
+#include "rtneat/snapshot.h"
+#include <cstdio>
+#include <algorithm>
+#include <boost/bind.hpp>
+
+namespace OpenNero
+{
+    /// keep the last num_kept checkpoint files
+    Checkpointer::Checkpointer( size_t num_kept )
+        : mThread()
+        , mMutex()
+        , mPending()
+        , mBusy(false)
+        , mNumKept(num_kept > 0 ? num_kept : 1)
+        , mFiles()
+        , mLastFile()
+        , mLastSucceeded(false)
+        , mLastDuration(0)
+        , mNumCompleted(0)
+    {
+    }
+
+    /// wait for the checkpoint in progress
+    Checkpointer::~Checkpointer()
+    {
+        Wait();
+    }
+
+    /// start writing a frozen population to filename in the background
+    bool Checkpointer::Start( NEAT::PopulationPtr frozen, const std::string& filename )
+    {
+        {
+            boost::mutex::scoped_lock lock(mMutex);
+            if (mBusy)
+            {
+                return false;
+            }
+            mBusy = true;
+            mPending = frozen;
+        }
+        // the previous thread has finished its work, so this does not block
+        if (mThread.joinable())
+        {
+            mThread.join();
+        }
+        mThread = boost::thread(boost::bind(&Checkpointer::Run, this, filename));
+        return true;
+    }
+
+    /// is a checkpoint still being written?
+    bool Checkpointer::IsBusy() const
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        return mBusy;
+    }
+
+    /// wait for the checkpoint in progress (if any) to finish
+    void Checkpointer::Wait()
+    {
+        if (mThread.joinable())
+        {
+            mThread.join();
+        }
+    }
+
+    /// the number of checkpoint files to keep
+    size_t Checkpointer::GetNumKept() const
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        return mNumKept;
+    }
+
+    /// set the number of checkpoint files to keep
+    void Checkpointer::SetNumKept( size_t num_kept )
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        mNumKept = num_kept > 0 ? num_kept : 1;
+        if (!mBusy)
+        {
+            RemoveOldFiles();
+        }
+    }
+
+    /// the file of the last completed checkpoint ("" if none)
+    std::string Checkpointer::GetLastFile() const
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        return mLastFile;
+    }
+
+    /// did the last completed checkpoint succeed?
+    bool Checkpointer::GetLastSucceeded() const
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        return mLastSucceeded;
+    }
+
+    /// how long the last completed checkpoint took to write, in seconds
+    F64 Checkpointer::GetLastDuration() const
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        return mLastDuration;
+    }
+
+    /// the number of checkpoints written successfully
+    size_t Checkpointer::GetNumCompleted() const
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        return mNumCompleted;
+    }
+
+    /// write one checkpoint (on the background thread)
+    void Checkpointer::Run( const std::string& filename )
+    {
+        NEAT::PopulationPtr frozen;
+        {
+            boost::mutex::scoped_lock lock(mMutex);
+            frozen.swap(mPending);
+        }
+        TimerPtr timer = GetTimer();
+        bool succeeded = NEAT::PopulationSnapshot::save(frozen, filename, true);
+        // let go of the shared genomes before reporting that we are done
+        frozen.reset();
+        F64 duration = timer->getMicroseconds() / 1e6;
+
+        boost::mutex::scoped_lock lock(mMutex);
+        mLastFile = filename;
+        mLastSucceeded = succeeded;
+        mLastDuration = duration;
+        if (succeeded)
+        {
+            ++mNumCompleted;
+            mFiles.erase(std::remove(mFiles.begin(), mFiles.end(), filename), mFiles.end());
+            mFiles.push_back(filename);
+            RemoveOldFiles();
+        }
+        mBusy = false;
+    }
+
+    /// remove the oldest files until at most mNumKept remain
+    void Checkpointer::RemoveOldFiles()
+    {
+        while (mFiles.size() > mNumKept)
+        {
+            std::remove(mFiles.front().c_str());
+            mFiles.pop_front();
+        }
+    }
+
+} //end OpenNero
@@ -0,0 +1,91 @@
+/// @file
+/// Background checkpointing of rtNEAT populations.
+
+#ifndef _OPENNERO_AI_RTNEAT_CHECKPOINTER_H_
+#define _OPENNERO_AI_RTNEAT_CHECKPOINTER_H_
+
+#include "core/BoostCommon.h"
+#include "core/ONTypes.h"
+#include "rtneat/neat.h"
+#include <string>
+#include <deque>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+
+namespace OpenNero
+{
+    /// @cond
+    BOOST_SHARED_DECL( Checkpointer );
+    /// @endcond
+
+    /**
+     * Saves populations to snapshot files on a background thread. Each
+     * checkpoint is a frozen copy of the population (see
+     * NEAT::PopulationSnapshot::freeze) that is written to a temporary file,
+     * flushed to the disk and renamed, so a checkpoint file is never half
+     * written. Only the most recent checkpoints are kept; older files are
+     * removed once a newer one is complete.
+     */
+    class Checkpointer : boost::noncopyable
+    {
+    public:
+        /// keep the last num_kept checkpoint files
+        explicit Checkpointer( size_t num_kept );
+
+        /// wait for the checkpoint in progress
+        ~Checkpointer();
+
+        /// start writing a frozen population to filename in the background
+        /// @return false (and do nothing) if a checkpoint is still in progress
+        bool Start( NEAT::PopulationPtr frozen, const std::string& filename );
+
+        /// is a checkpoint still being written?
+        bool IsBusy() const;
+
+        /// wait for the checkpoint in progress (if any) to finish
+        void Wait();
+
+        /// the number of checkpoint files to keep
+        size_t GetNumKept() const;
+
+        /// set the number of checkpoint files to keep
+        void SetNumKept( size_t num_kept );
+
+        /// the file of the last completed checkpoint ("" if none)
+        std::string GetLastFile() const;
+
+        /// did the last completed checkpoint succeed?
+        bool GetLastSucceeded() const;
+
+        /// how long the last completed checkpoint took to write, in seconds
+        F64 GetLastDuration() const;
+
+        /// the number of checkpoints written successfully
+        size_t GetNumCompleted() const;
+
+    private:
+
+        /// write one checkpoint (on the background thread)
+        void Run( const std::string& filename );
+
+        /// remove the oldest files until at most mNumKept remain
+        void RemoveOldFiles();
+
+    private:
+
+        boost::thread mThread;          ///< thread writing the current checkpoint
+        mutable boost::mutex mMutex;    ///< protects all of the fields below
+        NEAT::PopulationPtr mPending;   ///< frozen population handed to the thread
+        bool mBusy;                     ///< set while a checkpoint is being written
+        size_t mNumKept;                ///< number of checkpoint files to keep
+        std::deque<std::string> mFiles; ///< the checkpoint files kept, oldest first
+        std::string mLastFile;          ///< file of the last completed checkpoint
+        bool mLastSucceeded;            ///< whether the last checkpoint succeeded
+        F64 mLastDuration;              ///< duration of the last checkpoint in seconds
+        size_t mNumCompleted;           ///< number of successful checkpoints
+    };
+
+} //end OpenNero
+
+#endif // _OPENNERO_AI_RTNEAT_CHECKPOINTER_H_
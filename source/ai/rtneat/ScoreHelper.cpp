@@ -9,9 +9,8 @@ namespace OpenNero {
     ScoreHelper::ScoreHelper(const RewardInfo& reward_info)
         : m_SampleSize(0)
         , m_Zero(reward_info.getInstance())
-        , m_Total(m_Zero)
-        , m_SumOfSquares(m_Zero)
         , m_Average(m_Zero)
+        , m_SquaredDeviations(m_Zero)
         , m_StandardDeviation(m_Zero)
         , m_Min(m_Zero)
         , m_Max(m_Zero)
@@ -30,9 +29,8 @@ namespace OpenNero {
     void ScoreHelper::reset()
     {
         m_SampleSize = 0;
-        m_Total = m_Zero;
-        m_SumOfSquares = m_Zero;
         m_Average = m_Zero;
+        m_SquaredDeviations = m_Zero;
         m_StandardDeviation = m_Zero;    
         for (size_t i = 0; i < m_Min.size(); ++i)
         {
@@ -42,25 +40,12 @@ namespace OpenNero {
     }
     
     void ScoreHelper::doCalculations()
-    {
-        calculateAverages();
-        calculateStandardDeviations();
-    }
-    
-    void ScoreHelper::calculateAverages()
-    {
-        if (m_SampleSize > 0) {
-            m_Average = m_Total / (double)m_SampleSize;
-        } else {
-            m_Average = m_Zero;
-        }
-    }
-    
-    void ScoreHelper::calculateStandardDeviations()
     {
         if (m_SampleSize > 0) {
             for (size_t i = 0; i < m_StandardDeviation.size(); ++i) {
-                m_StandardDeviation[i] = sqrt( m_SumOfSquares[i] / m_SampleSize - m_Average[i] * m_Average[i]);
+                // removing samples can leave a tiny negative rounding error
+                double variance = m_SquaredDeviations[i] / m_SampleSize;
+                m_StandardDeviation[i] = variance > 0 ? sqrt(variance) : 0;
             }
         } else {
             m_StandardDeviation = m_Zero;
@@ -68,25 +53,53 @@ namespace OpenNero {
     }
     
     /// add a reward sample
-    void ScoreHelper::addSample(Reward sample)
+    void ScoreHelper::addSample(const Reward& sample)
     {
-        m_Total += sample;
+        ++m_SampleSize;
         for (size_t i = 0; i < sample.size(); ++i)
         {
-            m_SumOfSquares[i] += (sample[i] * sample[i]);
+            double delta = sample[i] - m_Average[i];
+            m_Average[i] += delta / m_SampleSize;
+            m_SquaredDeviations[i] += delta * (sample[i] - m_Average[i]);
             if (m_Min[i] > sample[i])
                 m_Min[i] = sample[i];
             if (m_Max[i] < sample[i])
                 m_Max[i] = sample[i];
         }
-        
-        ++m_SampleSize;
+    }
+
+    /// remove a reward sample that was added before
+    void ScoreHelper::removeSample(const Reward& sample)
+    {
+        AssertMsg(m_SampleSize > 0, "removing a sample from an empty ScoreHelper");
+        if (m_SampleSize <= 1)
+        {
+            // start over exactly rather than keep the rounding errors
+            m_SampleSize = 0;
+            m_Average = m_Zero;
+            m_SquaredDeviations = m_Zero;
+            return;
+        }
+        --m_SampleSize;
+        for (size_t i = 0; i < sample.size(); ++i)
+        {
+            double delta = sample[i] - m_Average[i];
+            m_Average[i] -= delta / m_SampleSize;
+            m_SquaredDeviations[i] -= delta * (sample[i] - m_Average[i]);
+        }
     }
 
     /// preferred generic method
     Reward ScoreHelper::getRelativeScore(Reward absoluteScore) const
     {
-        Reward result(absoluteScore);
+        Reward result(absoluteScore.size());
+        getRelativeScore(absoluteScore, result);
+        return result;
+    }
+
+    void ScoreHelper::getRelativeScore(const Reward& absoluteScore, Reward& result) const
+    {
+        result.resize(absoluteScore.size());
         for (size_t i = 0; i < absoluteScore.size(); ++i)
         {
             if (m_StandardDeviation[i] > 0) {
@@ -95,7 +108,6 @@ namespace OpenNero {
                 result[i] = m_Zero[i];
             }
         }
-        return result;
     }
 
     /// Number of trials processed over the unit's lifetime
@@ -10,14 +10,16 @@ namespace OpenNero
 
 
     /// Holdings scoring information
+    /// The mean and standard deviation are kept up to date as samples are
+    /// added and removed (Welford's method), so a sample set that changes a
+    /// little at a time does not need to be added up again.
     class ScoreHelper {
     private:
 
         size_t m_SampleSize;
         Reward m_Zero;
-        Reward m_Total;
-        Reward m_SumOfSquares;
         Reward m_Average;
+        Reward m_SquaredDeviations; ///< sum of squared differences from the mean
         Reward m_StandardDeviation;
         Reward m_Min;
         Reward m_Max;
@@ -28,17 +30,20 @@ namespace OpenNero
         ~ScoreHelper();
 
         void reset();
+
+        /// update the standard deviations after adding or removing samples
         void doCalculations();
-        void calculateAverages();
-        void calculateStandardDeviations();
 
         /// add a reward sample
-        void addSample(Reward sample);
+        void addSample(const Reward& sample);
+
+        /// remove a reward sample that was added before
+        void removeSample(const Reward& sample);
 
         /// average scores in all dimensions
         const Reward& getAverage() const { return m_Average; }
         
-        /// standard deviation of scores in all dimensions
+        /// standard deviation of scores in all dimensions (as of the last doCalculations)
         const Reward& getStandardDeviation() const { return m_StandardDeviation; }
         
         /// the number of samples
@@ -46,9 +51,16 @@ namespace OpenNero
 
         /// get the relative (scaled) Z-scores along the dimensions
         Reward getRelativeScore(Reward absoluteScore) const;
+
+        /// get the relative (scaled) Z-scores along the dimensions
+        /// @param absoluteScore the scores to scale
+        /// @param result set to the Z-scores
+        void getRelativeScore(const Reward& absoluteScore, Reward& result) const;
         
+        /// the smallest score of the samples added since the last reset
         const Reward& getMin() const { return m_Min; }
         
+        /// the largest score of the samples added since the last reset
         const Reward& getMax() const { return m_Max; }
     };
     
@@ -7,10 +7,15 @@
 #include "ai/rtneat/rtNEAT.h"
 #include "rtneat/population.h"
 #include "rtneat/network.h"
+#include "rtneat/snapshot.h"
 #include "scripting/scriptIncludes.h"
 #include "math/Random.h"
+#include "core/ONTime.h"
+#include "core/Profiler.h"
 #include <ostream>
 #include <fstream>
+#include <sstream>
+#include <stdexcept>
 
 namespace OpenNero
 {
@@ -27,6 +32,9 @@ namespace OpenNero
         const size_t kNumSpeciesTarget = 5; ///< target number of species in the population
         const double kCompatMod = 0.1; ///< compatibility threshold modifier
         const double kMinCompatThreshold = 0.3; // minimum species compatibility threshold
+        const size_t kNumCheckpointsKept = 3; ///< default number of checkpoint files to keep
+        const size_t kSampleChangesPerRebuild = 64; ///< changes to the fitness statistics per brain before adding them up again
+        const S32 kIslandConnectTimeout = 5000; ///< milliseconds to wait for the island coordinator to answer
 
         /// compare two organisms by fitness
         bool fitness_less(OrganismPtr a, OrganismPtr b)
@@ -59,8 +67,18 @@ namespace OpenNero
         , mRewardInfo(reward_info)
         , mFitnessWeights(reward_info.size())
         , mEvolutionEnabled(true)
+        , mScoreHelper(reward_info)
+        , mScoresStale(true)
+        , mSampleChanges(0)
         , mChampionId(-1)
         , mGenerational(generational)
+        , mCheckpointer()
+        , mNumCheckpointsKept(kNumCheckpointsKept)
+        , mNumCheckpoints(0)
+        , mIslandClient()
+        , mMigrantsPerExchange(0)
+        , mMigrationInterval(0)
+        , mMigrants()
     {
         NEAT::load_neat_params(Kernel::findResource(param_file));
         NEAT::pop_size = population_size;
@@ -69,12 +87,7 @@ namespace OpenNero
         AssertMsg(mPopulation, "initial population creation failed");
         mOffspringCount = mPopulation->organisms.size();
         AssertMsg(mOffspringCount == population_size, "population has " << mOffspringCount << " organisms instead of " << population_size);
-        for (size_t i = 0; i < mPopulation->organisms.size(); ++i)
-        {
-            PyOrganismPtr brain(new PyOrganism(mPopulation->organisms[i], reward_info));
-            mWaitingBrainList.push(brain);
-            mBrainList.push_back(brain);
-        }
+        createBrains();
     }
 
     /// Constructor
@@ -105,7 +118,17 @@ namespace OpenNero
         , mRewardInfo(reward_info)
         , mFitnessWeights(reward_info.size())
         , mEvolutionEnabled(true)
+        , mScoreHelper(reward_info)
+        , mScoresStale(true)
+        , mSampleChanges(0)
         , mGenerational(generational)
+        , mCheckpointer()
+        , mNumCheckpointsKept(kNumCheckpointsKept)
+        , mNumCheckpoints(0)
+        , mIslandClient()
+        , mMigrantsPerExchange(0)
+        , mMigrationInterval(0)
+        , mMigrants()
     {
         NEAT::load_neat_params(Kernel::findResource(param_file));
         NEAT::pop_size = population_size;
@@ -114,12 +137,7 @@ namespace OpenNero
         AssertMsg(mPopulation, "initial population creation failed");
         mOffspringCount = mPopulation->organisms.size();
         AssertMsg(mOffspringCount == population_size, "population has " << mOffspringCount << " organisms instead of " << population_size);
-        for (size_t i = 0; i < mPopulation->organisms.size(); ++i)
-        {
-            PyOrganismPtr brain(new PyOrganism(mPopulation->organisms[i], reward_info));
-            mWaitingBrainList.push(brain);
-            mBrainList.push_back(brain);
-        }
+        createBrains();
     }
 
     /// Destructor
@@ -178,10 +196,58 @@ namespace OpenNero
     bool RTNEAT::load_population(const std::string& pop_file)
     {
         std::string fname = Kernel::findResource(pop_file, false);
-        mPopulation.reset(new Population(fname));
+        if (PopulationSnapshot::is_snapshot(fname))
+        {
+            mPopulation = PopulationSnapshot::load(fname);
+        }
+        else
+        {
+            mPopulation.reset(new Population(fname));
+        }
+        if (mIslandClient)
+        {
+            mIslandClient->claim_numbers(mPopulation);
+        }
+        createBrains();
         return true;
     }
 
+    /// make this population one island of a multi-process island model
+    bool RTNEAT::join_islands(const std::string& socket_path, size_t migrants, size_t interval)
+    {
+        IslandClientPtr client(new IslandClient());
+        if (!client->connect(socket_path, kIslandConnectTimeout))
+        {
+            return false;
+        }
+        client->claim_numbers(mPopulation);
+        mIslandClient = client;
+        mMigrantsPerExchange = migrants;
+        mMigrationInterval = interval > 0 ? interval : 1;
+        LOG_F_MSG("ai.rtneat", "joined the island model at " << socket_path << " as island " << client->get_island_id());
+        return true;
+    }
+
+    /// the number of this island (-1 if it is not part of an island model)
+    S32 RTNEAT::get_island_id() const
+    {
+        return mIslandClient ? mIslandClient->get_island_id() : -1;
+    }
+
+    /// convert a population file between the text and the snapshot formats
+    bool RTNEAT::convert_population(const std::string& from_file, const std::string& to_file)
+    {
+        std::string fname = Kernel::findResource(from_file, false);
+        if (PopulationSnapshot::is_snapshot(fname))
+        {
+            return PopulationSnapshot::snapshot_to_text(fname, to_file);
+        }
+        else
+        {
+            return PopulationSnapshot::text_to_snapshot(fname, to_file);
+        }
+    }
+
     /// are we ready to spawn a new organism?
     bool RTNEAT::ready()
     {
@@ -233,6 +299,104 @@ namespace OpenNero
         }
     }
 
+    /// activate the networks of many agents at once
+    void RTNEAT::activate_networks(const std::vector<AgentBrainPtr>& agents,
+                                   const std::vector<F64>& observations,
+                                   std::vector<F64>& outputs)
+    {
+        outputs.clear();
+        if (agents.empty())
+        {
+            return;
+        }
+        size_t num_inputs = observations.size() / agents.size();
+        if (num_inputs * agents.size() != observations.size())
+        {
+            std::ostringstream message;
+            message << "Got " << observations.size() << " observations for " << agents.size() << " agents";
+            throw std::invalid_argument(message.str());
+        }
+
+        std::vector<NetworkPtr> nets(agents.size());
+        for (size_t i = 0; i < agents.size(); ++i)
+        {
+            nets[i] = get_organism(agents[i])->GetOrganism()->net;
+            if (nets[i]->inputs.size() != num_inputs)
+            {
+                std::ostringstream message;
+                message << "Got " << num_inputs << " observations for agent " << i
+                        << " whose network has " << nets[i]->inputs.size() << " inputs";
+                throw std::invalid_argument(message.str());
+            }
+        }
+        for (size_t i = 0; i < nets.size(); ++i)
+        {
+            nets[i]->load_sensors(std::vector<F64>(observations.begin() + i * num_inputs,
+                                                   observations.begin() + (i + 1) * num_inputs));
+        }
+
+        std::vector<bool> results;
+        Network::activate_all(nets, results);
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            if (!results[i])
+            {
+                std::ostringstream message;
+                message << "The network of agent " << i << " could not be activated: its outputs are not connected to its inputs";
+                throw std::runtime_error(message.str());
+            }
+        }
+
+        for (size_t i = 0; i < nets.size(); ++i)
+        {
+            std::vector<NNodePtr>::const_iterator iter;
+            for (iter = nets[i]->outputs.begin(); iter != nets[i]->outputs.end(); ++iter)
+            {
+                outputs.push_back((*iter)->get_active_out());
+            }
+        }
+    }
+
+    /// activate the networks of many agents at once
+    py::list RTNEAT::activate_all(py::list agents, py::list observations)
+    {
+        if (py::len(observations) != py::len(agents))
+        {
+            throw std::invalid_argument("activate_all needs one row of observations per agent");
+        }
+        std::vector<AgentBrainPtr> brains;
+        std::vector<F64> inputs;
+        for (py::ssize_t i = 0; i < py::len(agents); ++i)
+        {
+            brains.push_back(py::extract<AgentBrainPtr>(agents[i]));
+            py::object row = observations[i];
+            if (py::len(row) != py::len(observations[0]))
+            {
+                throw std::invalid_argument("activate_all needs the same number of observations for every agent");
+            }
+            for (py::ssize_t j = 0; j < py::len(row); ++j)
+            {
+                inputs.push_back(py::extract<double>(row[j]));
+            }
+        }
+
+        std::vector<F64> outputs;
+        activate_networks(brains, inputs, outputs);
+
+        py::list result;
+        size_t num_outputs = brains.empty() ? 0 : outputs.size() / brains.size();
+        for (size_t i = 0; i < brains.size(); ++i)
+        {
+            py::list l;
+            for (size_t j = 0; j < num_outputs; ++j)
+            {
+                l.append(outputs[i * num_outputs + j]);
+            }
+            result.append(l);
+        }
+        return result;
+    }
+
     /// save a population to a file
     std::string RTNEAT::save_population(const std::string& pop_file)
     {
@@ -258,6 +422,106 @@ namespace OpenNero
         }
     }
 
+    /// save a population to a binary snapshot file
+    std::string RTNEAT::save_population_snapshot(const std::string& pop_file)
+    {
+        // try looking for the filename as is
+        std::string fname = pop_file;
+        if (!PopulationSnapshot::save(mPopulation, fname)) {
+            // try again with our findResource method
+            fname = Kernel::findResource(pop_file, false);
+            if (!PopulationSnapshot::save(mPopulation, fname)) {
+                LOG_ERROR("Could not open file: " << fname);
+                return "";
+            }
+        }
+        LOG_F_MSG("ai.rtneat", "Saved population snapshot to file: " << fname);
+        return fname;
+    }
+
+    /// start saving a copy of the population to a snapshot file in the background
+    bool RTNEAT::checkpoint_population(const std::string& pop_file)
+    {
+        if (!mCheckpointer)
+        {
+            mCheckpointer.reset(new Checkpointer(mNumCheckpointsKept));
+        }
+        if (mCheckpointer->IsBusy())
+        {
+            LOG_F_WARNING("ai.rtneat", "Skipping checkpoint, the previous one is still being written");
+            return false;
+        }
+        std::ostringstream fname;
+        fname << Kernel::findResource(pop_file, false) << "." << mNumCheckpoints++;
+
+        TimerPtr timer = GetTimer();
+        PopulationPtr frozen = PopulationSnapshot::freeze(mPopulation);
+        LOG_F_DEBUG("ai.rtneat", "Froze population for checkpoint " << fname.str() << " in " << timer->getMicroseconds() << " us");
+        return mCheckpointer->Start(frozen, fname.str());
+    }
+
+    /// set the number of checkpoint files to keep
+    void RTNEAT::set_checkpoints_kept(size_t num_kept)
+    {
+        mNumCheckpointsKept = num_kept;
+        if (mCheckpointer)
+        {
+            mCheckpointer->SetNumKept(num_kept);
+        }
+    }
+
+    /// is a checkpoint still being written?
+    bool RTNEAT::checkpoint_in_progress() const
+    {
+        return mCheckpointer && mCheckpointer->IsBusy();
+    }
+
+    /// wait for the checkpoint in progress (if any) to be written
+    void RTNEAT::wait_for_checkpoint()
+    {
+        if (mCheckpointer)
+        {
+            mCheckpointer->Wait();
+        }
+    }
+
+    /// the file of the last completed checkpoint
+    std::string RTNEAT::get_last_checkpoint_file() const
+    {
+        return mCheckpointer ? mCheckpointer->GetLastFile() : "";
+    }
+
+    /// did the last completed checkpoint succeed?
+    bool RTNEAT::get_last_checkpoint_succeeded() const
+    {
+        return mCheckpointer && mCheckpointer->GetLastSucceeded();
+    }
+
+    /// how long it took to write the last completed checkpoint
+    F64 RTNEAT::get_last_checkpoint_duration() const
+    {
+        return mCheckpointer ? mCheckpointer->GetLastDuration() : 0;
+    }
+
+    void RTNEAT::createBrains()
+    {
+        // the old brains hold organisms that are no longer in the population,
+        // so the fielded agents get new ones the next time they ask
+        mWaitingBrainList = queue<PyOrganismPtr>();
+        mBrainList.clear();
+        mBrainBodyMap.clear();
+        mScoreHelper.reset();
+        mScoresStale = true;
+        mSampleChanges = 0;
+        mChampionId = -1;
+        for (size_t i = 0; i < mPopulation->organisms.size(); ++i)
+        {
+            PyOrganismPtr brain(new PyOrganism(mPopulation->organisms[i], mRewardInfo));
+            mWaitingBrainList.push(brain);
+            mBrainList.push_back(brain);
+        }
+    }
+
     void RTNEAT::deleteUnit(PyOrganismPtr brain)
     {
         if (mEvolutionEnabled) {
@@ -298,11 +562,14 @@ namespace OpenNero
 
     void RTNEAT::ProcessTick( float32_t incAmt )
     {
+        PROFILE_ZONE("RTNEAT::ProcessTick");
+
         // Increment the spawn tick and evolution tick counters
         ++mSpawnTickCount;
         ++mEvolutionTickCount;
 
         if (mEvolutionEnabled) {
+            PROFILE_ZONE("RTNEAT::evaluateAll");
             tallyAll();
             // Evaluate all brains' scores
             evaluateAll();
@@ -315,6 +582,7 @@ namespace OpenNero
             && mEvolutionTickCount >= mTimeBetweenEvolutions)
         {
             //Judgment day!
+            PROFILE_ZONE("RTNEAT::evolveAll");
             evolveAll();
             mEvolutionTickCount = 0;
         }
@@ -322,30 +590,51 @@ namespace OpenNero
 
     void RTNEAT::evaluateAll()
     {
-        // Calculate the Z-score
-        ScoreHelper scoreHelper(mRewardInfo);
-
-
-        for (vector<PyOrganismPtr>::iterator iter = mBrainList.begin(); iter != mBrainList.end(); ++iter)
+        // Only the brains that started a new trial, became old enough to be
+        // judged or got a new organism change the statistics
+        for (vector<PyOrganismPtr>::const_iterator iter = mBrainList.begin(); iter != mBrainList.end(); ++iter)
         {
-            PyOrganismPtr brain = *iter;
-            if (brain->GetOrganism()->time_alive >= NEAT::time_alive_minimum) {
-                size_t time_alive = brain->GetOrganism()->time_alive;
+            PyOrganism& brain = **iter;
+            size_t time_alive = brain.GetOrganism()->time_alive;
+            if (time_alive >= NEAT::time_alive_minimum) {
                 if ( time_alive % NEAT::time_alive_minimum == 0 && time_alive > 0 )
                 {
-                    stringstream ss;
-                    ss << "NEW TRIAL: brain: " << brain->GetId();
-                    ss << " stats: " << brain->mStats;
-                    ss << " time_alive: " << time_alive << "/" << NEAT::time_alive_minimum;
-                    brain->mStats.startNextTrial();
-                    ss << " new stats: " << brain->mStats;
-                    LOG_F_DEBUG("ai.rtneat", ss.str());
+                    brain.mStats.startNextTrial();
+                    LOG_F_DEBUG("ai.rtneat",
+                                "NEW TRIAL: brain: " << brain.GetId() <<
+                                " new stats: " << brain.mStats <<
+                                " time_alive: " << time_alive << "/" << NEAT::time_alive_minimum);
+                    updateSample(brain, true);
                 }
-                Reward stats = brain->mStats.getStats();
-                scoreHelper.addSample(stats);
+                else if (!brain.mSampled)
+                {
+                    updateSample(brain, true);
+                }
+            } else if (brain.mSampled) {
+                updateSample(brain, false);
+            }
+        }
+
+        // The fitness of every brain depends on the statistics, but if they
+        // did not change neither did the fitness
+        if (!mScoresStale)
+            return;
+        mScoresStale = false;
+
+        if (mSampleChanges > kSampleChangesPerRebuild * mBrainList.size())
+        {
+            // add the samples up again to drop the accumulated rounding
+            mScoreHelper.reset();
+            for (vector<PyOrganismPtr>::const_iterator iter = mBrainList.begin(); iter != mBrainList.end(); ++iter)
+            {
+                if ((*iter)->mSampled)
+                    mScoreHelper.addSample((*iter)->mSample);
             }
+            mSampleChanges = 0;
         }
 
+        // Calculate the Z-score
+        ScoreHelper& scoreHelper = mScoreHelper;
         scoreHelper.doCalculations();
 
         F32 minAbsoluteScore = 0; // min of 0, min abs score
@@ -355,15 +644,16 @@ namespace OpenNero
 
         PyOrganismPtr champ;
 
+        Reward relative_score;
+
         for (vector<PyOrganismPtr>::iterator iter = mBrainList.begin(); iter != mBrainList.end(); ++iter) {
             PyOrganismPtr brain = *iter;
             // reset champion flag
             brain->champion = false;
-            if (brain->GetOrganism()->time_alive >= NEAT::time_alive_minimum) {
+            if (brain->mSampled) {
                 brain->mAbsoluteScore = 0;
                 ++evaluated;
-                Reward stats = brain->mStats.getStats();
-                Reward relative_score = scoreHelper.getRelativeScore(stats);
+                scoreHelper.getRelativeScore(brain->mSample, relative_score);
                 for (size_t i = 0; i < relative_score.size(); ++i)
                 {
                     brain->mAbsoluteScore += relative_score[i] * mFitnessWeights[i];
@@ -406,7 +696,7 @@ namespace OpenNero
         //}
 
         for (vector<PyOrganismPtr>::iterator iter = mBrainList.begin(); iter != mBrainList.end(); ++iter) {
-            if ((*iter)->GetOrganism()->time_alive >= NEAT::time_alive_minimum) {
+            if ((*iter)->mSampled) {
                 F32 modifiedFitness = (*iter)->mAbsoluteScore - (minAbsoluteScore < 0 ? minAbsoluteScore : 0);
 
                 if (!((*iter)->GetOrganism()->smited)) {
@@ -414,10 +704,25 @@ namespace OpenNero
                 } else {
                     (*iter)->GetOrganism()->fitness = 0.01 * modifiedFitness;
                 }
+                (*iter)->UpdateSpecies();
             }
         }
     }
 
+    void RTNEAT::updateSample(PyOrganism& brain, bool judged)
+    {
+        if (brain.mSampled)
+            mScoreHelper.removeSample(brain.mSample);
+        brain.mSampled = judged;
+        if (judged)
+        {
+            brain.mSample = brain.mStats.getStats();
+            mScoreHelper.addSample(brain.mSample);
+        }
+        ++mSampleChanges;
+        mScoresStale = true;
+    }
+
     void RTNEAT::evolveAll()
     {
         // Remove the worst organism
@@ -440,9 +745,7 @@ namespace OpenNero
             NEAT::OrganismPtr new_org;
 
             // Estimate all species' fitnesses
-            for (vector<SpeciesPtr>::iterator curspec = (mPopulation->species).begin(); curspec != (mPopulation->species).end(); ++curspec) {
-                (*curspec)->estimate_average();
-            }
+            mPopulation->estimate_all_averages();
 
             // TODO: milestoning is not implemented for now
             //m_Population->memory_pool->isEmpty();
@@ -454,11 +757,27 @@ namespace OpenNero
             //else
             //{
 
-            // Reproduce a single new organism to replace the one killed off.
-            new_org = (mPopulation->choose_parent_species())->reproduce_one(mOffspringCount, mPopulation, mPopulation->species, 0,0);
+            if (!mMigrants.empty())
+            {
+                // A champion of another island takes the place of the one killed off
+                GenomePtr migrant = mMigrants.front();
+                mMigrants.pop_front();
+                migrant->genome_id = mOffspringCount;
+                new_org.reset(new Organism(0.0, migrant, mOffspringCount));
+                mPopulation->add_organism(new_org);
+            }
+            else
+            {
+                // Reproduce a single new organism to replace the one killed off.
+                new_org = (mPopulation->choose_parent_species())->reproduce_one(mOffspringCount, mPopulation, mPopulation->species, 0,0);
+            }
             //}
             ++mOffspringCount;
 
+            if (mIslandClient && mOffspringCount % mMigrationInterval == 0) {
+                exchangeMigrants();
+            }
+
             //Every compat_adjust_frequency reproductions, reassign the population to new species
             if (mOffspringCount % compat_adjust_frequency == 0) {
 
@@ -482,6 +801,11 @@ namespace OpenNero
                 }
             }
 
+            //Every population's worth of reproductions, forget the innovations that have not been repeated lately
+            if (mOffspringCount % mBrainList.size() == 0) {
+                mPopulation->innovations.next_epoch();
+            }
+
             // Iterate through all of the Brains
             //   - find the one whose Organism was killed off
             //   - link that Brain to the newly created Organism, effectively
@@ -493,6 +817,8 @@ namespace OpenNero
                     LOG_F_DEBUG("ai.rtneat", "  DELETING Organims #"<< brain->GetId() << " Fitness: " << brain->GetFitness() << " Time: "<< brain->GetTimeAlive());
                     brain->SetOrganism(new_org);
                     brain->mStats.resetAll();
+                    if (brain->mSampled)
+                        updateSample(*brain, false);
                     deleteUnit(brain);
                     //break;
                 } else {
@@ -502,6 +828,24 @@ namespace OpenNero
         }
     }
 
+    void RTNEAT::exchangeMigrants()
+    {
+        if (!mIslandClient->is_connected())
+        {
+            LOG_F_WARNING("ai.rtneat", "lost the connection to the island coordinator, evolving alone");
+            mIslandClient.reset();
+            return;
+        }
+        mIslandClient->send_migrants(mPopulation, mMigrantsPerExchange);
+        mIslandClient->receive_migrants(mPopulation, mMigrants);
+
+        // keep only the latest migrants if they arrive faster than organisms are removed
+        while (mMigrants.size() > mMigrantsPerExchange)
+        {
+            mMigrants.pop_front();
+        }
+    }
+
     /// set the lifetime so that we can ensure that the units have been alive
     /// at least that long before evaluating them
     void RTNEAT::set_lifetime(size_t lifetime)
@@ -525,4 +869,11 @@ namespace OpenNero
         return mOrganism->species.lock()->id;
     }
 
+    void PyOrganism::UpdateSpecies()
+    {
+        SpeciesPtr species = mOrganism->species.lock();
+        if (species)
+            species->update_org(mOrganism);
+    }
+
 }
@@ -6,12 +6,15 @@
 
 #include "core/Preprocessor.h"
 #include "rtneat/population.h"
+#include "rtneat/island.h"
 #include "scripting/scripting.h"
 #include "ai/AI.h"
 #include "ai/Environment.h"
 #include "ai/rtneat/ScoreHelper.h"
+#include "ai/rtneat/Checkpointer.h"
 #include <string>
 #include <set>
+#include <deque>
 #include <queue>
 #include <iostream>
 #include <boost/python.hpp>
@@ -49,9 +52,22 @@ namespace OpenNero
         FeatureVector mFitnessWeights; ///< fitness weights
         bool mEvolutionEnabled; ///< whether the evolution is enabled
 
+        ScoreHelper mScoreHelper; ///< statistics of the lifetime averages of the brains old enough to be judged
+        bool mScoresStale; ///< do the fitness values need to be computed again?
+        size_t mSampleChanges; ///< samples added to or removed from mScoreHelper since it was last rebuilt
+
         S32 mChampionId; ///< the id of the last champion of the population
 
         bool mGenerational;               ///< whether to run NEAT in generational or realtime mode
+
+        CheckpointerPtr mCheckpointer;    ///< writes checkpoints in the background (created on first use)
+        size_t mNumCheckpointsKept;       ///< number of checkpoint files to keep
+        size_t mNumCheckpoints;           ///< number of checkpoints started so far
+
+        IslandClientPtr mIslandClient;    ///< connection to the other islands (if this population is one)
+        size_t mMigrantsPerExchange;      ///< number of champions sent to the next island at a time
+        size_t mMigrationInterval;        ///< number of offspring between exchanges of migrants
+        deque<GenomePtr> mMigrants;       ///< genomes from other islands that replace the next organisms removed
     public:
         /// Constructor
         /// @param filename name of the file with the initial population genomes
@@ -101,6 +117,24 @@ namespace OpenNero
         /// release the organism that was being used by the agent
         void release_organism(AgentBrainPtr agent);
 
+        /// activate the networks of many agents at once, evaluating the
+        /// networks with the same topology together
+        /// @param agents the agents whose networks to activate
+        /// @param observations the sensor values (including the bias) for
+        ///        each agent, one row after another
+        /// @param outputs set to the output values of each network, one row after another
+        /// @throws std::invalid_argument if a row does not match the inputs of its network
+        /// @throws std::runtime_error if a network could not be activated
+        void activate_networks(const std::vector<AgentBrainPtr>& agents,
+                               const std::vector<F64>& observations,
+                               std::vector<F64>& outputs);
+
+        /// activate the networks of many agents at once
+        /// @param agents list of agents whose networks to activate
+        /// @param observations list of lists of sensor values (including the bias), one per agent
+        /// @return list of lists of output values, one per agent
+        py::list activate_all(py::list agents, py::list observations);
+
         /// Called every step by the OpenNERO system
         virtual void ProcessTick( float32_t incAmt );
 
@@ -108,14 +142,57 @@ namespace OpenNero
 		/// return the name of the file the population was saved to
 		std::string save_population(const std::string& population_file);
 
-        /// load a population from a file
+        /// save the current population to a binary snapshot file
+        /// return the name of the file the population was saved to
+        std::string save_population_snapshot(const std::string& population_file);
+
+        /// load a population from a file (text or binary snapshot), replacing
+        /// the brains of the old organisms with brains for the new ones
         bool load_population(const std::string& population_file);
 
+        /// start saving a copy of the current population to a snapshot file on a
+        /// background thread; successive checkpoints go to population_file.0,
+        /// population_file.1, ... and only the last few files are kept
+        /// @return false if the previous checkpoint is still being written
+        bool checkpoint_population(const std::string& population_file);
+
+        /// set the number of checkpoint files to keep
+        void set_checkpoints_kept(size_t num_kept);
+
+        /// is a checkpoint still being written?
+        bool checkpoint_in_progress() const;
+
+        /// wait for the checkpoint in progress (if any) to be written
+        void wait_for_checkpoint();
+
+        /// the file of the last completed checkpoint ("" if none)
+        std::string get_last_checkpoint_file() const;
+
+        /// did the last completed checkpoint succeed?
+        bool get_last_checkpoint_succeeded() const;
+
+        /// how long it took to write the last completed checkpoint, in seconds
+        F64 get_last_checkpoint_duration() const;
+
+        /// make this population one island of a multi-process island model
+        /// @param socket_path the Unix socket of the IslandCoordinator
+        /// @param migrants number of champions to send to the next island at a time
+        /// @param interval number of offspring between exchanges of migrants
+        /// @return false if the coordinator could not be reached
+        bool join_islands(const std::string& socket_path, size_t migrants, size_t interval);
+
+        /// the number of this island (-1 if it is not part of an island model)
+        S32 get_island_id() const;
+
+        /// convert a population file between the text format and the binary snapshot format
+        /// (the direction is given by the format of the source file)
+        static bool convert_population(const std::string& from_file, const std::string& to_file);
+
         /// get the weight vector
         const FeatureVector& get_weights() const { return mFitnessWeights; }
 
         /// set the i'th weight
-        void set_weight(size_t i, double weight) { mFitnessWeights[i] = weight; }
+        void set_weight(size_t i, double weight) { mFitnessWeights[i] = weight; mScoresStale = true; }
 
         /// set the lifetime so that we can ensure that the units have been alive
         /// at least that long before evaluating them
@@ -144,10 +221,21 @@ namespace OpenNero
 		/// evaluate all brains by compiling their stats
 		void evaluateAll();
 
+        /// put the current lifetime average of a brain into the statistics
+        /// (or take it out if the brain is too young to be judged)
+        void updateSample(PyOrganism& brain, bool judged);
+
 		/// evolution step that potentially replaces an organism with an
 		/// offspring
 		void evolveAll();
 
+        /// send champions to the next island and collect the migrants that arrived
+        void exchangeMigrants();
+
+        /// make a brain for every organism of the population, dropping the old
+        /// brains and the agents they were given to
+        void createBrains();
+
 		/// Delete the unit which is currently associated with the specified
 		/// brain and move the brain back to waiting list.
 		void deleteUnit(PyOrganismPtr brain);
@@ -210,6 +298,12 @@ namespace OpenNero
         /// we keep our own champion flag
         bool champion;
 
+        /// is the lifetime average of the organism in the fitness statistics?
+        bool mSampled;
+
+        /// the lifetime average last put into the fitness statistics
+        Reward mSample;
+
 		/// constructor for a PyOrganism
         /// @param org rtNEAT organism to wrap
         /// @param reward_info the info about the multidimensional reward
@@ -217,13 +311,17 @@ namespace OpenNero
             mOrganism(org),
             mAbsoluteScore(0),
             mStats(reward_info),
-            champion(false)
+            champion(false),
+            mSampled(false),
+            mSample()
         { }
 
         /// set the fitness of the organism
         void SetFitness(double fitness) {
-            if (mOrganism->fitness == 0)
+            if (mOrganism->fitness == 0) {
                 mOrganism->fitness = fitness;
+                UpdateSpecies();
+            }
         }
 
         /// get the fitness of the organism
@@ -236,11 +334,14 @@ namespace OpenNero
         int GetSpeciesId() const;
 
         /// set the amount of time the organism has to live
-    	void SetTimeAlive(int time_alive) { mOrganism->time_alive = time_alive; }
+    	void SetTimeAlive(int time_alive) { mOrganism->time_alive = time_alive; UpdateSpecies(); }
 
         /// get the amount of time that the organism has to live
         int GetTimeAlive() const { return mOrganism->time_alive; }
 
+        /// tell the species of the organism that its fitness or time alive changed
+        void UpdateSpecies();
+
         /// save this organism to a file
         bool Save(const std::string& fname) const { return mOrganism->print_to_file(fname); }
 
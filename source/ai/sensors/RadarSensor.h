@@ -28,9 +28,6 @@ namespace OpenNero
         //! cumulative value for the observation
         double value;
 
-        //! bookkeeping for resetting the value
-        bool observed;
-
         //! whether or not the sensor is displayed on screen
         bool vis;
         
@@ -41,7 +38,6 @@ namespace OpenNero
             , bottombound(0), topbound(0)
             , radius(0)
             , value(0)
-            , observed(false)
             , vis(false)
         {}
     
@@ -68,6 +64,9 @@ namespace OpenNero
         //! get the maximum possible observation
         double getMax();
 
+        //! Only objects within the radius of the sector are of interest
+        double getRadius() const { return radius; }
+
         //! Process an object of interest
         bool process(SimEntityPtr source, SimEntityPtr target);
         
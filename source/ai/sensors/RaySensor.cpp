@@ -19,8 +19,6 @@ namespace OpenNero {
     //! Get the value computed for this sensor given the filtered objects
     double RaySensor::getObservation(SimEntityPtr source)
     {
-        SimEntityData hitEntity;
-        Vector3f hitPos;
         Vector3f sourcePos(source->GetPosition());
         Vector3f toTarget(x,y,z);
         toTarget = ConvertNeroToIrrlichtPosition(toTarget);
@@ -30,9 +28,14 @@ namespace OpenNero {
         toTarget = ConvertIrrlichtToNeroPosition(toTarget);
         toTarget.setLength(radius);
         Vector3f targetPos = sourcePos + toTarget;
-        if (Kernel::GetSimContext()->FindInRay(hitEntity, hitPos, sourcePos, targetPos, getTypes(), vis))
+        // use the batched ray casting so that the collision hierarchy is shared
+        // between all the ray sensors of all the agents
+        rays.resize(1);
+        rays[0] = RayQuery(sourcePos, targetPos, getTypes());
+        Kernel::GetSimContext()->FindInRays(rays, hits, vis);
+        if (hits[0].id != kInvalidSimId)
         {
-            Vector3f toHit = hitPos - sourcePos;
+            Vector3f toHit = hits[0].position - sourcePos;
             //return toHit.getLength()/radius;
             double retval = radius / (toHit.getLength() * 10);
             if (retval < 0)
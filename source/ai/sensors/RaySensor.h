@@ -3,6 +3,7 @@
 
 #include "core/Common.h"
 #include "ai/sensors/Sensor.h"
+#include "game/SimContext.h"
 #include <iostream>
 
 namespace OpenNero
@@ -25,6 +26,12 @@ namespace OpenNero
 
         //! whether or not the sensor is displayed on screen
         bool vis;
+
+        //! reused ray query buffer
+        RayQueryVector rays;
+
+        //! reused ray hit buffer
+        RayHitVector hits;
         
     public:
         RaySensor() : Sensor(1,0), x(0), y(0), z(0), radius(0), vis(false) {}
@@ -46,6 +53,9 @@ namespace OpenNero
         //! get the maximum possible observation
         double getMax() { return radius; }
 
+        //! The ray does not extend beyond its radius
+        double getRadius() const { return radius; }
+
         //! Process an object of interest
         bool process(SimEntityPtr source, SimEntityPtr target);
         
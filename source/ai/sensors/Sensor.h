@@ -48,6 +48,10 @@ namespace OpenNero
         //! Get the types of objects this sensor needs to look at
         U32 getTypes() const { return types; }
 
+        //! Get the distance beyond which objects are of no interest to this 
+        //! sensor, or 0 if every object of the right type should be processed
+        virtual double getRadius() const { return 0; }
+
         //! get the minimal possible observation
         virtual double getMin() = 0;
         
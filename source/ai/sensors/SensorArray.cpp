@@ -1,4 +1,5 @@
 #include "core/Common.h"
+#include "core/Profiler.h"
 #include "game/Kernel.h"
 #include "ai/sensors/SensorArray.h"
 #include "game/SimContext.h"
@@ -13,16 +14,33 @@ namespace OpenNero
 
     void SensorArray::getObservations(Observations& observations)
     {
+        PROFILE_ZONE("SensorArray::getObservations");
         std::vector<SensorPtr>::iterator sensIter;
+        SimulationPtr sim = Kernel::instance().GetSimContext()->getSimulation();
         size_t i = 0;
         for (sensIter = sensors.begin(); sensIter != sensors.end(); ++sensIter) 
         {
             AssertMsg(i < observations.size(), "There are more built-in sensors than observations in AgentInitInfo");
-            SimEntitySet::const_iterator entIter;
-            const SimEntitySet entSet = Kernel::instance().GetSimContext()->getSimulation()->GetEntities((*sensIter)->getTypes());
-            for (entIter = entSet.begin(); entIter != entSet.end(); ++entIter) 
+            double radius = (*sensIter)->getRadius();
+            if (radius > 0)
             {
-                (*sensIter)->process(GetEntity(), (*entIter));
+                // only look at the objects that are close enough to matter
+                candidates.clear();
+                sim->GetEntitiesInRadius(GetEntity()->GetPosition(), radius, (*sensIter)->getTypes(), candidates);
+                SimEntityVector::const_iterator entIter;
+                for (entIter = candidates.begin(); entIter != candidates.end(); ++entIter) 
+                {
+                    (*sensIter)->process(GetEntity(), (*entIter));
+                }
+            }
+            else
+            {
+                SimEntitySet::const_iterator entIter;
+                const SimEntitySet entSet = sim->GetEntities((*sensIter)->getTypes());
+                for (entIter = entSet.begin(); entIter != entSet.end(); ++entIter) 
+                {
+                    (*sensIter)->process(GetEntity(), (*entIter));
+                }
             }
             observations[i] = (*sensIter)->getObservation(GetEntity());
             i++;
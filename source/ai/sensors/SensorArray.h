@@ -15,6 +15,7 @@ namespace OpenNero {
         : public SimEntityComponent
     {
         std::vector<SensorPtr> sensors;
+        SimEntityVector candidates; ///< reused buffer for the objects near the entity
     public:
         explicit SensorArray(SimEntityPtr parent) : SimEntityComponent(parent) {}
         size_t getNumSensors() { return sensors.size(); }
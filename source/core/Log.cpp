@@ -6,8 +6,15 @@
 #include "core/Common.h"
 #include "Log.h"
 #include "LogConnections.h"
+#include "LogRingBuffer.h"
 #include "scripting/scriptIncludes.h"
 #include "game/Kernel.h"
+#include <boost/date_time/posix_time/posix_time.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/tss.hpp>
+#include <algorithm>
+#include <cstring>
 #include <vector>
 #include <iostream>
 
@@ -15,12 +22,79 @@ namespace OpenNero
 {
 	namespace Log
 	{
+        /// the number of messages that can wait for the log writer thread
+        static const size_t kQueueCapacity = 8192;
+
+        /// the levels logged unless SetLevelMask says otherwise
+        static const int kDefaultLevelMask = NERO_DEBUG ? kLogAll : (kLogAll & ~kLogDebug);
+
 		static ILogConnectionVector sLogConnections;
-        static FilterList           sFilterList;
+        static boost::mutex         sConnectionMutex;           ///< protects sLogConnections and the connections
+        static volatile size_t      sNumSyncConnections = 0;    ///< connections that are not thread safe
+        static volatile int         sLevelMask = kDefaultLevelMask;
+        static const FilterList* volatile sFilterList = NULL;   ///< the current filters (NULL for none)
+        static std::vector< boost::shared_ptr<FilterList> > sFilterLists;  ///< every filter list published
+        static boost::mutex         sFilterMutex;               ///< protects sFilterLists
+        static boost::thread*       sWriter = NULL;             ///< drains the queue to the connections
+        static volatile bool        sWriterRunning = false;     ///< is sWriter taking messages?
+        static volatile bool        sStopWriter = false;        ///< should sWriter exit once the queue is empty?
+        static volatile LogRingBuffer::Index sDelivered = 0;    ///< messages sWriter has sent to the connections
+        static boost::thread::id    sMainThread;                ///< the thread that set up the log system
+        static bool                 sDeliveringSync = false;    ///< is the main thread inside a connection that is not thread safe?
 
         /// helper utility functions
         namespace LogUtil
         {
+            /// the streams messages are formatted into on one thread
+            struct ThreadStreams
+            {
+                std::vector<std::ostringstream*> streams;   ///< one per nesting level
+                size_t depth;                               ///< number of messages being formatted
+                LogRecord record;                           ///< reused to hand messages to the queue
+
+                ThreadStreams() : streams(), depth(0), record() {}
+                ~ThreadStreams()
+                {
+                    for (size_t i = 0; i < streams.size(); ++i)
+                        delete streams[i];
+                }
+            };
+
+            /// the streams of the calling thread
+            ThreadStreams& GetThreadStreams()
+            {
+                // never deleted, so that messages logged during static destruction still work
+                static boost::thread_specific_ptr<ThreadStreams>* sStreams = new boost::thread_specific_ptr<ThreadStreams>();
+                ThreadStreams* streams = sStreams->get();
+                if (!streams)
+                {
+                    streams = new ThreadStreams();
+                    sStreams->reset(streams);
+                }
+                return *streams;
+            }
+
+            /// an empty stream of the calling thread for the next message
+            std::ostringstream& AcquireStream()
+            {
+                ThreadStreams& streams = GetThreadStreams();
+                if( streams.depth == streams.streams.size() )
+                {
+                    streams.streams.push_back(new std::ostringstream());
+                }
+                std::ostringstream& stream = *streams.streams[streams.depth++];
+                stream.str(std::string());
+                stream.clear();
+                return stream;
+            }
+
+            /// the messages waiting for the log writer thread
+            LogRingBuffer& GetQueue()
+            {
+                static LogRingBuffer sQueue(kQueueCapacity);
+                return sQueue;
+            }
+
             /**
              * Find a given log connection by its name
              * @param connectionName the connection to search for
@@ -39,25 +113,46 @@ namespace OpenNero
             /// define a pointer to member method of ILogConnection
             typedef void (ILogConnection::*MemberLogFunc)( const char* msg );
 
-            /// output a message to a member method of ILogConnection on an instance of ILogConnection
-            /// @param func the member function to call
-            /// @param msgType the type of message
-            /// @param connectionName the name of the connection
-            /// @param msg the message to output
-            void OutputToLogFunc( MemberLogFunc func, const char* msgType, const char* connectionName, const char* msg )
+            /// the member method of ILogConnection for a level
+            MemberLogFunc GetLogFunc( int level )
             {
-                if( msgType )
+                switch (level)
                 {
-                    // if the message type is in the filter list, then ignore it
-                    // if we do not contain the 'all' receiver or the msgType receiver, exit
-                    if( std::find( sFilterList.begin(), sFilterList.end(), msgType )   != sFilterList.end() )
-                    {
-                        return;
-                    }
+                case kLogDebug:     return &ILogConnection::LogDebug;
+                case kLogMsg:       return &ILogConnection::LogMsg;
+                case kLogWarning:   return &ILogConnection::LogWarning;
+                default:            return &ILogConnection::LogError;
                 }
+            }
+
+            /// format the complete line of a message
+            void FormatLine( const LogRecord& record, std::string& line )
+            {
+                if( record.tag )
+                {
+                    line = boost::posix_time::to_simple_string(record.time);
+                    line += record.tag;
+                    line += record.text;
+                }
+                else
+                {
+                    line = record.text;
+                }
+            }
+
+            /**
+             * Send a message to the connections that are thread safe.
+             * The caller must hold sConnectionMutex.
+             * @param record the message
+             * @param line scratch space for the complete line
+            */
+            void Deliver( const LogRecord& record, std::string& line )
+            {
+                FormatLine(record, line);
+                MemberLogFunc func = GetLogFunc(record.level);
 
-                // if the connectionName is null, broadcast to all
-                if( !connectionName )
+                // if the target is empty, broadcast to all
+                if( record.target.empty() )
                 {
                     ILogConnectionVector::iterator itr = sLogConnections.begin();
 			        ILogConnectionVector::iterator end = sLogConnections.end();
@@ -65,24 +160,302 @@ namespace OpenNero
 			        for( ; itr != end; ++itr )
 			        {
                         Assert( *itr );
-
-                        // Ok, this line looks complicated.
-                        // 1) Get a reference to the ILogConnection instance
-                        // 2) Call a member method on it with the provided member method pointer
-                        // 3) Pass msg to that method
-                        ((*(*itr)).*func)(msg);
+                        if( (*itr)->isThreadSafe() )
+                        {
+                            // Ok, this line looks complicated.
+                            // 1) Get a reference to the ILogConnection instance
+                            // 2) Call a member method on it with the provided member method pointer
+                            // 3) Pass msg to that method
+                            ((*(*itr)).*func)(line.c_str());
+                        }
 			        }
                 }
 
-                // if the connectionName is valid, output to that connection
+                // if the target is valid, output to that connection
                 else
                 {
-                    if( ILogConnectionPtr c = LogUtil::find(connectionName) )
+                    ILogConnectionPtr c = LogUtil::find(record.target);
+                    if( c && c->isThreadSafe() )
                     {
-                        ((*c).*func)(msg);
+                        ((*c).*func)(line.c_str());
                     }
                 }
             }
+
+            /// clears sDeliveringSync however the connections return
+            struct SyncDeliveryGuard
+            {
+                SyncDeliveryGuard() { sDeliveringSync = true; }
+                ~SyncDeliveryGuard() { sDeliveringSync = false; }
+            };
+
+            /**
+             * Send a message to the connections that are not thread safe (such
+             * as Python). They are only called on the main thread, without
+             * sConnectionMutex held, and a message they log themselves does
+             * not come back to them.
+             * @param record the message
+            */
+            void DeliverSync( const LogRecord& record )
+            {
+                if( sDeliveringSync ||
+                    (sMainThread != boost::thread::id() && boost::this_thread::get_id() != sMainThread) )
+                {
+                    return;
+                }
+
+                ILogConnectionVector targets;
+                {
+                    boost::mutex::scoped_lock lock(sConnectionMutex);
+                    if( record.target.empty() )
+                    {
+                        ILogConnectionVector::const_iterator itr;
+                        for( itr = sLogConnections.begin(); itr != sLogConnections.end(); ++itr )
+                        {
+                            if( !(*itr)->isThreadSafe() )
+                            {
+                                targets.push_back(*itr);
+                            }
+                        }
+                    }
+                    else
+                    {
+                        ILogConnectionPtr c = LogUtil::find(record.target);
+                        if( c && !c->isThreadSafe() )
+                        {
+                            targets.push_back(c);
+                        }
+                    }
+                }
+                if( targets.empty() )
+                {
+                    return;
+                }
+
+                std::string line;
+                FormatLine(record, line);
+                MemberLogFunc func = GetLogFunc(record.level);
+                SyncDeliveryGuard guard;
+                for( size_t i = 0; i < targets.size(); ++i )
+                {
+                    ((*targets[i]).*func)(line.c_str());
+                }
+            }
+
+            /// the loop of the log writer thread
+            void WriterLoop()
+            {
+                LogRecord record;
+                std::string line;
+                LogRingBuffer& queue = GetQueue();
+                for (;;)
+                {
+                    bool delivered = false;
+                    while( queue.pop(record) )
+                    {
+                        {
+                            boost::mutex::scoped_lock lock(sConnectionMutex);
+                            Deliver(record, line);
+                        }
+                        sDelivered = sDelivered + 1;
+                        delivered = true;
+                    }
+                    if( sStopWriter && queue.popped() == queue.pushed() )
+                    {
+                        break;
+                    }
+                    if( !delivered )
+                    {
+                        boost::this_thread::sleep(boost::posix_time::milliseconds(1));
+                    }
+                }
+            }
+
+            /// hand a message to the connections
+            /// @param record the message, whose strings are swapped with ones from the queue
+            void Submit( LogRecord& record )
+            {
+                if( sNumSyncConnections > 0 )
+                {
+                    DeliverSync(record);
+                }
+
+                if( sWriterRunning )
+                {
+                    // push swaps the record with the one in the buffer
+                    bool error = record.level == kLogError;
+                    LogRingBuffer& queue = GetQueue();
+                    bool queued = queue.push(record);
+                    while( !queued && sWriterRunning )
+                    {
+                        // the writer is behind, wait for it rather than lose the message
+                        boost::this_thread::yield();
+                        queued = queue.push(record);
+                    }
+                    if( queued )
+                    {
+                        if( error )
+                        {
+                            // whatever happens next, the error should be in the log
+                            Flush();
+                        }
+                        return;
+                    }
+                }
+
+                // no writer thread, send the message right away
+                std::string line;
+                boost::mutex::scoped_lock lock(sConnectionMutex);
+                Deliver(record, line);
+            }
+
+            /// queue a complete message logged with one of the functions below
+            void SubmitText( int level, const char* type, const char* connectionName, const char* msg )
+            {
+                if( !IsEnabled(level, type) )
+                {
+                    return;
+                }
+                LogRecord record;
+                record.level = level;
+                record.tag = NULL;
+                record.type = type ? type : "";
+                record.target = connectionName ? connectionName : "";
+                record.text = msg;
+                Submit(record);
+            }
+
+            /// count the connections that are not thread safe
+            void CountSyncConnections()
+            {
+                size_t count = 0;
+                ILogConnectionVector::const_iterator itr;
+                for( itr = sLogConnections.begin(); itr != sLogConnections.end(); ++itr )
+                {
+                    if( !(*itr)->isThreadSafe() )
+                    {
+                        ++count;
+                    }
+                }
+                sNumSyncConnections = count;
+            }
+
+            /// start the log writer thread
+            void StartWriter()
+            {
+                if( !sWriter )
+                {
+                    sStopWriter = false;
+                    sWriter = new boost::thread(&WriterLoop);
+                    sWriterRunning = true;
+                }
+            }
+
+            /// deliver the messages in the queue and stop the log writer thread
+            void StopWriter()
+            {
+                if( sWriter )
+                {
+                    // new messages go straight to the connections from now on
+                    sWriterRunning = false;
+                    sStopWriter = true;
+                    sWriter->join();
+                    delete sWriter;
+                    sWriter = NULL;
+
+                    // deliver whatever was queued while the writer was exiting
+                    LogRecord record;
+                    std::string line;
+                    LogRingBuffer& queue = GetQueue();
+                    while( queue.pop(record) )
+                    {
+                        boost::mutex::scoped_lock lock(sConnectionMutex);
+                        Deliver(record, line);
+                    }
+                }
+            }
+        }
+
+        /// @param level one of the LogLevel values
+        /// @param tag the level marker put after the time stamp (a literal)
+        /// @param type the filter type, or NULL
+        /// @param target the name of the connection to send to, or NULL for all
+        LogRecordBuilder::LogRecordBuilder( int level, const char* tag, const char* type, const char* target )
+            : mLevel(level)
+            , mTag(tag)
+            , mType(type)
+            , mTarget(target)
+            , mStream(LogUtil::AcquireStream())
+        {
+        }
+
+        /// queue the message
+        LogRecordBuilder::~LogRecordBuilder()
+        {
+            LogUtil::ThreadStreams& streams = LogUtil::GetThreadStreams();
+            --streams.depth;
+            // a message logged while formatting another one gets its own record
+            LogRecord nested;
+            LogRecord& record = streams.depth == 0 ? streams.record : nested;
+            record.level = mLevel;
+            record.tag = mTag;
+            record.time = boost::posix_time::microsec_clock::local_time();
+            record.type = mType ? mType : "";
+            record.target = mTarget ? mTarget : "";
+            record.text = streams.streams[streams.depth]->str();
+            LogUtil::Submit(record);
+        }
+
+        /// will a message of the given level and filter type reach the connections?
+        /// @param level one of the LogLevel values
+        /// @param type the filter type, or NULL
+        bool IsEnabled( int level, const char* type )
+        {
+            if( !(sLevelMask & level) )
+            {
+                return false;
+            }
+            const FilterList* filters = sFilterList;
+            if( type && filters )
+            {
+                // if the message type is in the filter list, then ignore it
+                FilterList::const_iterator itr;
+                for( itr = filters->begin(); itr != filters->end(); ++itr )
+                {
+                    if( strcmp(itr->c_str(), type) == 0 )
+                    {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
+        /// set the levels of messages that are logged
+        /// @param mask a combination of LogLevel values
+        void SetLevelMask( int mask )
+        {
+            sLevelMask = mask;
+        }
+
+        /// the levels of messages that are logged
+        int GetLevelMask()
+        {
+            return sLevelMask;
+        }
+
+        /// wait until the messages logged so far have reached the connections
+        void Flush()
+        {
+            if( !sWriterRunning || boost::this_thread::get_id() == sWriter->get_id() )
+            {
+                return;
+            }
+            LogRingBuffer::Index target = LogUtil::GetQueue().pushed();
+            while( sWriterRunning && static_cast<int32_t>(sDelivered - target) < 0 )
+            {
+                boost::this_thread::yield();
+            }
         }
 
 		/**
@@ -93,7 +466,9 @@ namespace OpenNero
 		{
 			if(conn)
 			{
+                boost::mutex::scoped_lock lock(sConnectionMutex);
 				sLogConnections.push_back(conn);
+                LogUtil::CountSyncConnections();
 			}
 		}
 
@@ -103,7 +478,9 @@ namespace OpenNero
 	    */
 		void RemoveLogConnection( ILogConnectionPtr conn )
 		{
-            std::remove( sLogConnections.begin(), sLogConnections.end(), conn );
+            boost::mutex::scoped_lock lock(sConnectionMutex);
+            sLogConnections.erase( std::remove( sLogConnections.begin(), sLogConnections.end(), conn ), sLogConnections.end() );
+            LogUtil::CountSyncConnections();
 		}
 
         /// Log a debug message
@@ -112,7 +489,7 @@ namespace OpenNero
         /// @param msg the message to log
         void LogDebug( const char* type, const char* connectionName, const char* msg )
         {
-            LogUtil::OutputToLogFunc( &ILogConnection::LogDebug, type, connectionName, msg );
+            LogUtil::SubmitText( kLogDebug, type, connectionName, msg );
         }
 
         /// Log a normal message
@@ -121,7 +498,7 @@ namespace OpenNero
         /// @param msg the message to log
         void LogMsg( const char* type, const char* connectionName, const char* msg )
         {
-            LogUtil::OutputToLogFunc( &ILogConnection::LogMsg, type, connectionName, msg );
+            LogUtil::SubmitText( kLogMsg, type, connectionName, msg );
         }
 
         /// Log a warning message
@@ -130,7 +507,7 @@ namespace OpenNero
         /// @param msg the message to log
         void LogWarning( const char* type, const char* connectionName, const char* msg )
         {
-            LogUtil::OutputToLogFunc( &ILogConnection::LogWarning, type, connectionName, msg );
+            LogUtil::SubmitText( kLogWarning, type, connectionName, msg );
         }
 
         /// Log an error message
@@ -139,10 +516,11 @@ namespace OpenNero
         /// @param msg the message to log
         void LogError( const char* type, const char* connectionName, const char* msg )
         {
-            LogUtil::OutputToLogFunc( &ILogConnection::LogError, type, connectionName, msg );
+            LogUtil::SubmitText( kLogError, type, connectionName, msg );
         }
 
-        /// Setup the log system by adding a file log and a console log
+        /// Setup the log system by adding a file log and a console log, and
+        /// start the thread that writes to them
 		void LogSystemInit( const std::string& logFileName )
 		{
             // initialize the connections
@@ -153,18 +531,29 @@ namespace OpenNero
 
 			AddLogConnection(fileLog);
             AddLogConnection(stdioLog);
+
+            sMainThread = boost::this_thread::get_id();
+            LogUtil::StartWriter();
 		}
 
         /// Set the list of filters we want to ignore
         void LogSystemSpecifyFilters( const FilterList& flist )
         {
-            sFilterList = flist;
+            // threads may be reading the current list, so it is replaced rather than changed
+            boost::shared_ptr<FilterList> filters( new FilterList(flist) );
+            boost::mutex::scoped_lock lock(sFilterMutex);
+            sFilterLists.push_back(filters);
+            sFilterList = filters.get();
         }
 
-        /// clear all the log connections
+        /// write out the queued messages, stop the writer thread and clear
+        /// all the log connections
 		void LogSystemShutdown()
 		{
+            LogUtil::StopWriter();
+            boost::mutex::scoped_lock lock(sConnectionMutex);
 			sLogConnections.clear();
+            sNumSyncConnections = 0;
 		}
 
 	} // end Log
@@ -8,6 +8,7 @@
 
 #include "core/Common.h"
 #include "core/Preprocessor.h"
+#include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
 #include <sstream>
 #include <string>
@@ -45,6 +46,11 @@ namespace OpenNero
 
             /// get an identifying name for this connection
             virtual const std::string getConnectionName() const = 0;
+
+            /// can this connection be called from the log writer thread? Connections
+            /// that cannot (e.g. ones that call Python) get their messages on the
+            /// thread that logs them instead
+            virtual bool isThreadSafe() const { return true; }
         };
         
         typedef boost::shared_ptr<ILogConnection> ILogConnectionPtr;
@@ -71,25 +77,87 @@ namespace OpenNero
         /// Allow ALL messages of any type to come through the logger
         extern const std::string kLogFilterAcceptAll;
 
+        /// the priority of a message, as a bit of a level mask
+        enum LogLevel
+        {
+            kLogDebug   = 1 << 0,   ///< low priority
+            kLogMsg     = 1 << 1,   ///< normal priority
+            kLogWarning = 1 << 2,   ///< medium priority
+            kLogError   = 1 << 3,   ///< high priority
+            kLogAll     = kLogDebug | kLogMsg | kLogWarning | kLogError
+        };
+
+        /// will a message of the given level and filter type reach the connections?
+        /// (checked by the macros below before the message is formatted)
+        extern bool IsEnabled( int level, const char* type );
+
+        /// set the levels of messages that are logged (debug messages are
+        /// only logged by default in debug builds, where the connections print them)
+        extern void SetLevelMask( int mask );
+
+        /// the levels of messages that are logged
+        extern int GetLevelMask();
+
+        /// wait until the messages logged so far have reached the connections
+        extern void Flush();
+
+        /**
+         * Formats one message into a stream owned by the calling thread and
+         * hands it to the log system when it goes out of scope. Messages are
+         * queued for the log writer thread, except for errors, which have
+         * reached the connections by the time the destructor returns.
+        */
+        class LogRecordBuilder : boost::noncopyable
+        {
+        public:
+            /// @param level one of the LogLevel values
+            /// @param tag the level marker put after the time stamp (a literal)
+            /// @param type the filter type, or NULL
+            /// @param target the name of the connection to send to, or NULL for all
+            LogRecordBuilder( int level, const char* tag, const char* type, const char* target );
+
+            /// queue the message
+            ~LogRecordBuilder();
+
+            /// the stream to format the message into
+            std::ostream& stream() { return mStream; }
+
+        private:
+            int mLevel;             ///< one of the LogLevel values
+            const char* mTag;       ///< the level marker
+            const char* mType;      ///< the filter type, or NULL
+            const char* mTarget;    ///< the connection to send to, or NULL
+            std::ostream& mStream;  ///< the stream of the calling thread
+        };
+
     } // end Log
 
 // some semi-ugly defines
 
 #if NERO_ENABLE_LOGS
 
+    // the levels of messages compiled in; define NERO_LOG_LEVELS to a mask of
+    // LogLevel values to remove the others from the code altogether
+    #ifndef NERO_LOG_LEVELS
+    #define NERO_LOG_LEVELS OpenNero::Log::kLogAll
+    #endif
+
+    // checks the level and filter type first, so filtered messages are never formatted
+    #define LOG_RECORD( level, tag, type, target, msg ) do { if( ((NERO_LOG_LEVELS) & (level)) && OpenNero::Log::IsEnabled( (level), (type) ) ) { OpenNero::Log::LogRecordBuilder nero_log_record( (level), (tag), (type), (target) ); nero_log_record.stream() << msg; } } while(0)
+
     // default broadcasting logger macros - sends the message to every log connection regardless of target or type
-    #define LOG_DEBUG_EVERY(t, msg) do { static int counter = 0; if (++counter % t == 0) { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (D) " << msg; OpenNero::Log::LogDebug( NULL, NULL, cmsg.str().c_str() ); } } while (0)
-    #define LOG_DEBUG( msg )   do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (D) " << msg; OpenNero::Log::LogDebug  ( NULL, NULL, cmsg.str().c_str() ); } while(0)
-    #define LOG_ERROR( msg )   do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (!) " << msg; OpenNero::Log::LogError  ( NULL, NULL, cmsg.str().c_str() ); } while(0)
-    #define LOG_MSG( msg )     do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (M) " << msg; OpenNero::Log::LogMsg    ( NULL, NULL, cmsg.str().c_str() ); } while(0)
-    #define LOG_WARNING( msg ) do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (*) " << msg; OpenNero::Log::LogWarning( NULL, NULL, cmsg.str().c_str() ); } while(0)
+    #define LOG_DEBUG_EVERY(t, msg) do { static int counter = 0; if (++counter % t == 0) { LOG_DEBUG( msg ); } } while (0)
+    #define LOG_DEBUG( msg )   LOG_RECORD( OpenNero::Log::kLogDebug,   " (D) ", NULL, NULL, msg )
+    #define LOG_ERROR( msg )   LOG_RECORD( OpenNero::Log::kLogError,   " (!) ", NULL, NULL, msg )
+    #define LOG_MSG( msg )     LOG_RECORD( OpenNero::Log::kLogMsg,     " (M) ", NULL, NULL, msg )
+    #define LOG_WARNING( msg ) LOG_RECORD( OpenNero::Log::kLogWarning, " (*) ", NULL, NULL, msg )
 
     // destination based logs - send the message to a certain connection
     // Example: LOG_D_DEBUG( "texture_loader_connection", "A texture load as failed" )
-    #define LOG_D_DEBUG( name, msg )   do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (!) " << msg; OpenNero::Log::LogDebug  ( NULL, (name), cmsg.str().c_str() ); } while(0)
-    #define LOG_D_ERROR( name, msg )   do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (!) " << msg; OpenNero::Log::LogError  ( NULL, (name), cmsg.str().c_str() ); } while(0)
-    #define LOG_D_MSG( name, msg )     do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (M) " << msg; OpenNero::Log::LogMsg    ( NULL, (name), cmsg.str().c_str() ); } while(0)
-    #define LOG_D_WARNING( name, msg ) do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (*) " << msg; OpenNero::Log::LogWarning( NULL, (name), cmsg.str().c_str() ); } while(0)
+    #define LOG_D_DEBUG( name, msg )   LOG_RECORD( OpenNero::Log::kLogDebug,   " (!) ", NULL, (name), msg )
+    #define LOG_D_ERROR( name, msg )   LOG_RECORD( OpenNero::Log::kLogError,   " (!) ", NULL, (name), msg )
+    #define LOG_D_MSG( name, msg )     LOG_RECORD( OpenNero::Log::kLogMsg,     " (M) ", NULL, (name), msg )
+    #define LOG_D_WARNING( name, msg ) LOG_RECORD( OpenNero::Log::kLogWarning, " (*) ", NULL, (name), msg )
 
     // filter based logs - send the message only to receivers of certain types
     
@@ -101,16 +169,16 @@ namespace OpenNero
     //   This message only gets sent to developers that have the "render" type enabled in their filter list
     //   as setup by the LogSystemSpecifyFilters method
 
-    #define LOG_F_DEBUG( type, msg )   do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (!) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogDebug(   (type), NULL, cmsg.str().c_str() ); } while(0)
-    #define LOG_F_ERROR( type, msg )   do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (!) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogError(   (type), NULL, cmsg.str().c_str() ); } while(0)
-    #define LOG_F_MSG( type, msg )     do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (M) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogMsg(     (type), NULL, cmsg.str().c_str() ); } while(0)
-    #define LOG_F_WARNING( type, msg ) do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (*) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogWarning( (type), NULL, cmsg.str().c_str() ); } while(0)
+    #define LOG_F_DEBUG( type, msg )   LOG_RECORD( OpenNero::Log::kLogDebug,   " (!) ", (type), NULL, LOG_FILTER_TOKEN(type) << msg )
+    #define LOG_F_ERROR( type, msg )   LOG_RECORD( OpenNero::Log::kLogError,   " (!) ", (type), NULL, LOG_FILTER_TOKEN(type) << msg )
+    #define LOG_F_MSG( type, msg )     LOG_RECORD( OpenNero::Log::kLogMsg,     " (M) ", (type), NULL, LOG_FILTER_TOKEN(type) << msg )
+    #define LOG_F_WARNING( type, msg ) LOG_RECORD( OpenNero::Log::kLogWarning, " (*) ", (type), NULL, LOG_FILTER_TOKEN(type) << msg )
 
     // filter and destination based logs - send the message only to the given connection only to receivers of certain types
-    #define LOG_FD_DEBUG( type, target, msg )   do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (!) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogDebug(   (type), (target), cmsg.str().c_str() ); } while(0)
-    #define LOG_FD_ERROR( type, target, msg )   do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (!) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogError(   (type), (target), cmsg.str().c_str() ); } while(0)
-    #define LOG_FD_MSG( type, target, msg )     do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (M) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogMsg(     (type), (target), cmsg.str().c_str() ); } while(0)
-    #define LOG_FD_WARNING( type, target, msg ) do { std::stringstream cmsg; GetStaticTimer().stamp(cmsg); cmsg << " (*) " << LOG_FILTER_TOKEN(type) << msg; OpenNero::Log::LogWarning( (type), (target), cmsg.str().c_str() ); } while(0)
+    #define LOG_FD_DEBUG( type, target, msg )   LOG_RECORD( OpenNero::Log::kLogDebug,   " (!) ", (type), (target), LOG_FILTER_TOKEN(type) << msg )
+    #define LOG_FD_ERROR( type, target, msg )   LOG_RECORD( OpenNero::Log::kLogError,   " (!) ", (type), (target), LOG_FILTER_TOKEN(type) << msg )
+    #define LOG_FD_MSG( type, target, msg )     LOG_RECORD( OpenNero::Log::kLogMsg,     " (M) ", (type), (target), LOG_FILTER_TOKEN(type) << msg )
+    #define LOG_FD_WARNING( type, target, msg ) LOG_RECORD( OpenNero::Log::kLogWarning, " (*) ", (type), (target), LOG_FILTER_TOKEN(type) << msg )
 
 #else
 
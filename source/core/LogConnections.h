@@ -183,6 +183,9 @@ namespace OpenNero
 
             /// get the name of the connection
             const std::string getConnectionName() const;
+
+            /// Python may only be called with the interpreter lock held
+            bool isThreadSafe() const { return false; }
         };
     } // end Log
      
@@ -0,0 +1,163 @@
+//---------------------------------------------------
+// Name: OpenNero : LogRingBuffer
+// Desc:  lock-free queue of log records
+//---------------------------------------------------
+
+#include "core/Common.h"
+#include "core/LogRingBuffer.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#pragma intrinsic(_InterlockedCompareExchange, _ReadWriteBarrier)
+#endif
+
+namespace OpenNero
+{
+    namespace Log
+    {
+        namespace
+        {
+            typedef LogRingBuffer::Index Index;
+
+            /// read an index shared with other threads, seeing the writes made before it was stored
+            inline Index LoadAcquire( const volatile Index* p )
+            {
+#if defined(_MSC_VER)
+                Index v = *p;       // volatile reads have acquire semantics in MSVC
+                _ReadWriteBarrier();
+                return v;
+#else
+                Index v = *p;
+                __sync_synchronize();
+                return v;
+#endif
+            }
+
+            /// write an index shared with other threads, publishing the writes made before it
+            inline void StoreRelease( volatile Index* p, Index v )
+            {
+#if defined(_MSC_VER)
+                _ReadWriteBarrier();
+                *p = v;             // volatile writes have release semantics in MSVC
+#else
+                __sync_synchronize();
+                *p = v;
+#endif
+            }
+
+            /// set *p to desired if it is expected
+            /// @return true if *p was expected
+            inline bool CompareAndSwap( volatile Index* p, Index expected, Index desired )
+            {
+#if defined(_MSC_VER)
+                return _InterlockedCompareExchange(p, desired, expected) == expected;
+#else
+                return __sync_bool_compare_and_swap(p, expected, desired);
+#endif
+            }
+
+            /// a - b as a signed number, correct across the wrap-around of the indices
+            inline int32_t Difference( Index a, Index b )
+            {
+                return static_cast<int32_t>(static_cast<uint32_t>(a) - static_cast<uint32_t>(b));
+            }
+
+            /// swap the contents of two records
+            inline void SwapRecords( LogRecord& a, LogRecord& b )
+            {
+                std::swap(a.level, b.level);
+                std::swap(a.tag, b.tag);
+                std::swap(a.time, b.time);
+                a.type.swap(b.type);
+                a.target.swap(b.target);
+                a.text.swap(b.text);
+            }
+        }
+
+        /// @param capacity number of records held, rounded up to a power of two
+        LogRingBuffer::LogRingBuffer( size_t capacity )
+            : mCells()
+            , mMask(0)
+            , mEnqueuePos(0)
+            , mDequeuePos(0)
+        {
+            size_t size = 2;
+            while (size < capacity)
+            {
+                size *= 2;
+            }
+            mCells.resize(size);
+            mMask = static_cast<Index>(size - 1);
+            for (size_t i = 0; i < size; ++i)
+            {
+                mCells[i].sequence = static_cast<Index>(i);
+            }
+        }
+
+        /// add a record, swapping its strings into the buffer
+        bool LogRingBuffer::push( LogRecord& record )
+        {
+            Cell* cell;
+            Index pos = LoadAcquire(&mEnqueuePos);
+            for (;;)
+            {
+                cell = &mCells[pos & mMask];
+                Index seq = LoadAcquire(&cell->sequence);
+                int32_t diff = Difference(seq, pos);
+                if (diff == 0)
+                {
+                    // the slot is free for this position, claim it
+                    if (CompareAndSwap(&mEnqueuePos, pos, pos + 1))
+                    {
+                        break;
+                    }
+                    pos = LoadAcquire(&mEnqueuePos);
+                }
+                else if (diff < 0)
+                {
+                    // the slot still holds the record from one lap ago
+                    return false;
+                }
+                else
+                {
+                    // another producer claimed the slot first
+                    pos = LoadAcquire(&mEnqueuePos);
+                }
+            }
+            SwapRecords(cell->record, record);
+            StoreRelease(&cell->sequence, pos + 1);
+            return true;
+        }
+
+        /// take the oldest record (only one thread may pop)
+        bool LogRingBuffer::pop( LogRecord& record )
+        {
+            Index pos = mDequeuePos;
+            Cell* cell = &mCells[pos & mMask];
+            Index seq = LoadAcquire(&cell->sequence);
+            if (Difference(seq, pos + 1) < 0)
+            {
+                // the producer of this position has not finished yet
+                return false;
+            }
+            SwapRecords(cell->record, record);
+            StoreRelease(&mDequeuePos, pos + 1);
+            StoreRelease(&cell->sequence, pos + mMask + 1);
+            return true;
+        }
+
+        /// the number of records ever popped
+        LogRingBuffer::Index LogRingBuffer::popped() const
+        {
+            return LoadAcquire(&mDequeuePos);
+        }
+
+        /// the number of records ever pushed
+        LogRingBuffer::Index LogRingBuffer::pushed() const
+        {
+            return LoadAcquire(&mEnqueuePos);
+        }
+
+    } // end Log
+
+} //end OpenNero
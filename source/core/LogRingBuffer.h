@@ -0,0 +1,90 @@
+//---------------------------------------------------
+// Name: OpenNero : LogRingBuffer
+// Desc:  lock-free queue of log records
+//---------------------------------------------------
+
+#ifndef _OPEN_NERO_LOG_RING_BUFFER_H_
+#define _OPEN_NERO_LOG_RING_BUFFER_H_
+
+#include "core/ONTypes.h"
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <boost/noncopyable.hpp>
+#include <string>
+#include <vector>
+
+namespace OpenNero
+{
+    namespace Log
+    {
+        /// one message on its way to the log connections
+        struct LogRecord
+        {
+            int level;                          ///< one of the LogLevel values
+            const char* tag;                    ///< level marker such as " (M) " (a literal), or NULL if text is complete
+            boost::posix_time::ptime time;      ///< when the message was logged
+            std::string type;                   ///< filter type, empty for none
+            std::string target;                 ///< name of the connection to send to, empty for all
+            std::string text;                   ///< the message
+        };
+
+        /**
+         * A bounded queue of log records that any number of threads can push
+         * to without locking while one thread pops. Each slot carries a
+         * sequence number that tells producers and the consumer whose turn it
+         * is (after Dmitry Vyukov's bounded MPMC queue), so a producer only
+         * contends on one compare-and-swap of the tail index. The strings of
+         * a slot keep their capacity from one record to the next.
+         */
+        class LogRingBuffer : boost::noncopyable
+        {
+        public:
+#if defined(_MSC_VER)
+            typedef long Index;                 ///< index type the interlocked functions work on
+#else
+            typedef uint32_t Index;             ///< index type the atomic builtins work on
+#endif
+
+            /// constructor
+            /// @param capacity number of records held, rounded up to a power of two
+            explicit LogRingBuffer( size_t capacity );
+
+            /// the number of records held
+            size_t capacity() const { return mCells.size(); }
+
+            /// add a record, swapping its strings into the buffer
+            /// @return false (and leaves record alone) if the buffer is full
+            bool push( LogRecord& record );
+
+            /// take the oldest record (only one thread may pop)
+            /// @param record receives the record, swapping its strings with the buffer
+            /// @return false if the buffer is empty
+            bool pop( LogRecord& record );
+
+            /// the number of records ever popped
+            Index popped() const;
+
+            /// the number of records ever pushed
+            Index pushed() const;
+
+        private:
+            /// a slot of the buffer
+            struct Cell
+            {
+                volatile Index sequence;        ///< pos when free for the push at pos, pos + 1 when full for the pop at pos
+                LogRecord record;               ///< the record held
+            };
+
+            std::vector<Cell> mCells;           ///< the slots
+            Index mMask;                        ///< number of slots - 1
+            char mPad0[64];                     ///< keep the indices on their own cache lines
+            volatile Index mEnqueuePos;         ///< the position of the next push
+            char mPad1[64];
+            volatile Index mDequeuePos;         ///< the position of the next pop
+            char mPad2[64];
+        };
+
+    } // end Log
+
+} //end OpenNero
+
+#endif // _OPEN_NERO_LOG_RING_BUFFER_H_
@@ -0,0 +1,392 @@
+//--------------------------------------------------------
+// OpenNero : Profiler
+//  scoped timing of the phases of each frame
+//--------------------------------------------------------
+
+#include "core/Common.h"
+#include "core/Profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+namespace OpenNero
+{
+    namespace
+    {
+        /// the number of frames kept unless SetHistorySize says otherwise
+        const size_t kDefaultHistorySize = 300;
+
+        /// write s as a JSON string
+        void WriteJSONString( std::ostream& out, const char* s )
+        {
+            out << '"';
+            for ( ; s && *s; ++s)
+            {
+                unsigned char c = static_cast<unsigned char>(*s);
+                if (c == '"' || c == '\\')
+                {
+                    out << '\\' << *s;
+                }
+                else if (c < 0x20)
+                {
+                    char escaped[8];
+                    sprintf(escaped, "\\u%04x", c);
+                    out << escaped;
+                }
+                else
+                {
+                    out << *s;
+                }
+            }
+            out << '"';
+        }
+
+        /// orders the zones with the same parent by decreasing total time
+        struct MoreTotal
+        {
+            const std::vector<ProfileStat>& stats;
+            explicit MoreTotal(const std::vector<ProfileStat>& s) : stats(s) {}
+            bool operator()(size_t a, size_t b) const { return stats[a].total > stats[b].total; }
+        };
+
+        /// append the zones under parent at the given depth to order, each followed by its own children
+        void AppendChildren( const std::vector<ProfileStat>& stats, const std::string& parent, uint32_t depth,
+                             std::vector<size_t>& order )
+        {
+            std::vector<size_t> children;
+            for (size_t i = 0; i < stats.size(); ++i)
+            {
+                if (stats[i].depth == depth && stats[i].parent == parent)
+                {
+                    children.push_back(i);
+                }
+            }
+            std::stable_sort(children.begin(), children.end(), MoreTotal(stats));
+            for (size_t i = 0; i < children.size(); ++i)
+            {
+                order.push_back(children[i]);
+                AppendChildren(stats, stats[children[i]].name, depth + 1, order);
+            }
+        }
+    }
+
+    Profiler& Profiler::instance()
+    {
+        static Profiler me;
+        return me;
+    }
+
+    Profiler::Profiler()
+        : mTimer(GetTimer())
+        , mEnabled(false)
+        , mInFrame(false)
+        , mFrames(kDefaultHistorySize)
+        , mNext(0)
+        , mNumFrames(0)
+        , mFrameNumber(0)
+        , mNumThreads(0)
+        , mThreadState()
+        , mMutex()
+    {
+    }
+
+    /// start or stop recording frames
+    void Profiler::SetEnabled( bool enabled )
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        if (enabled)
+        {
+            LOG_F_MSG("core", "Profiler enabled");
+        }
+        else
+        {
+            LOG_F_MSG("core", "Profiler disabled");
+            mInFrame = false;
+        }
+        mEnabled = enabled;
+    }
+
+    /// set the number of frames kept (dropping the recorded ones)
+    void Profiler::SetHistorySize( size_t frames )
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        mFrames.assign(std::max(frames, (size_t)1), ProfileFrame());
+        mNext = 0;
+        mNumFrames = 0;
+        mInFrame = false;
+    }
+
+    /// the number of frames recorded and still kept
+    size_t Profiler::GetNumFrames() const
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        return mNumFrames;
+    }
+
+    /// drop all of the recorded frames
+    void Profiler::Clear()
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        mNext = 0;
+        mNumFrames = 0;
+        mInFrame = false;
+    }
+
+    /// start timing a frame
+    void Profiler::BeginFrame()
+    {
+        if (!mEnabled)
+        {
+            return;
+        }
+        boost::mutex::scoped_lock lock(mMutex);
+        ProfileFrame& frame = mFrames[mNext];
+        frame.number = mFrameNumber++;
+        frame.start = Now();
+        frame.duration = 0;
+        frame.events.clear();
+        mInFrame = true;
+    }
+
+    /// finish timing the current frame
+    void Profiler::EndFrame()
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        if (!mInFrame)
+        {
+            return;
+        }
+        ProfileFrame& frame = mFrames[mNext];
+        frame.duration = Now() - frame.start;
+        mNext = (mNext + 1) % mFrames.size();
+        mNumFrames = std::min(mNumFrames + 1, mFrames.size());
+        mInFrame = false;
+    }
+
+    /// the zones open on the calling thread
+    Profiler::ThreadState& Profiler::GetThreadState()
+    {
+        ThreadState* state = mThreadState.get();
+        if (!state)
+        {
+            state = new ThreadState();
+            {
+                boost::mutex::scoped_lock lock(mMutex);
+                state->index = mNumThreads++;
+            }
+            mThreadState.reset(state);
+        }
+        return *state;
+    }
+
+    /// record a zone that ended
+    void Profiler::Record( const ProfileEvent& event )
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        if (mInFrame)
+        {
+            mFrames[mNext].events.push_back(event);
+        }
+    }
+
+    /// the index in mFrames of the frame recorded n frames before the latest one
+    size_t Profiler::FrameIndex( size_t n ) const
+    {
+        return (mNext + mFrames.size() - 1 - n) % mFrames.size();
+    }
+
+    /// sum the times of each zone over the last frames recorded
+    size_t Profiler::GetStats( size_t frames, std::vector<ProfileStat>& stats ) const
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        if (frames == 0 || frames > mNumFrames)
+        {
+            frames = mNumFrames;
+        }
+
+        std::vector<ProfileStat> found;
+        std::map<std::string, size_t> index;    // zone, parent, depth and category -> entry in found
+        std::vector<uint64_t> frame_totals;     // time of each entry in found during the frame
+        std::vector<size_t> touched;            // the entries with a time during the frame
+        for (size_t n = frames; n-- > 0; )
+        {
+            const ProfileFrame& frame = mFrames[FrameIndex(n)];
+            touched.clear();
+            std::vector<ProfileEvent>::const_iterator event;
+            for (event = frame.events.begin(); event != frame.events.end(); ++event)
+            {
+                std::ostringstream key;
+                key << event->depth << '\n' << (event->parent ? event->parent : "") << '\n'
+                    << event->name << '\n' << event->category;
+                std::map<std::string, size_t>::iterator found_at = index.find(key.str());
+                size_t i;
+                if (found_at == index.end())
+                {
+                    i = found.size();
+                    index[key.str()] = i;
+                    ProfileStat stat;
+                    stat.name = event->name;
+                    stat.category = event->category;
+                    stat.parent = event->parent ? event->parent : "";
+                    stat.depth = event->depth;
+                    stat.calls = 0;
+                    stat.total = 0;
+                    stat.max = 0;
+                    found.push_back(stat);
+                    frame_totals.push_back(0);
+                }
+                else
+                {
+                    i = found_at->second;
+                }
+                if (frame_totals[i] == 0)
+                {
+                    touched.push_back(i);
+                }
+                found[i].calls += 1;
+                found[i].total += event->duration;
+                // zones shorter than a microsecond still count as touched
+                frame_totals[i] += std::max(event->duration, (uint64_t)1);
+            }
+            for (size_t t = 0; t < touched.size(); ++t)
+            {
+                ProfileStat& stat = found[touched[t]];
+                stat.max = std::max(stat.max, frame_totals[touched[t]]);
+                frame_totals[touched[t]] = 0;
+            }
+        }
+
+        // zones that ran on threads with no enclosing zone are roots too
+        std::vector<size_t> order;
+        AppendChildren(found, "", 0, order);
+        stats.clear();
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            stats.push_back(found[order[i]]);
+        }
+        return frames;
+    }
+
+    /// the durations in microseconds of the last frames recorded, oldest first
+    void Profiler::GetFrameTimes( size_t frames, std::vector<uint64_t>& times ) const
+    {
+        boost::mutex::scoped_lock lock(mMutex);
+        if (frames == 0 || frames > mNumFrames)
+        {
+            frames = mNumFrames;
+        }
+        times.clear();
+        for (size_t n = frames; n-- > 0; )
+        {
+            times.push_back(mFrames[FrameIndex(n)].duration);
+        }
+    }
+
+    /// a table of the times of each zone over the last frames recorded
+    std::string Profiler::GetReport( size_t frames ) const
+    {
+        std::vector<uint64_t> times;
+        GetFrameTimes(frames, times);
+        std::vector<ProfileStat> stats;
+        size_t summed = GetStats(times.size(), stats);
+
+        std::ostringstream out;
+        if (summed == 0)
+        {
+            out << "no frames profiled" << std::endl;
+            return out.str();
+        }
+        uint64_t total = 0, slowest = 0;
+        for (size_t i = 0; i < times.size(); ++i)
+        {
+            total += times[i];
+            slowest = std::max(slowest, times[i]);
+        }
+        out << std::fixed << std::setprecision(3)
+            << summed << " frames: " << total / 1000.0 / summed << " ms per frame on average, "
+            << slowest / 1000.0 << " ms at most" << std::endl;
+        out << std::left << std::setw(48) << "zone" << std::right
+            << ' ' << std::setw(12) << "calls/frame"
+            << ' ' << std::setw(12) << "ms/frame"
+            << ' ' << std::setw(12) << "max ms" << std::endl;
+        for (size_t i = 0; i < stats.size(); ++i)
+        {
+            std::string label = std::string(2 * stats[i].depth, ' ') + stats[i].name;
+            if (stats[i].category != "engine")
+            {
+                label += " (" + stats[i].category + ")";
+            }
+            // long labels push the columns over rather than being cut
+            out << std::left << std::setw(48) << label << std::right
+                << ' ' << std::setw(12) << std::setprecision(2) << double(stats[i].calls) / summed
+                << ' ' << std::setw(12) << std::setprecision(3) << stats[i].total / 1000.0 / summed
+                << ' ' << std::setw(12) << stats[i].max / 1000.0 << std::endl;
+        }
+        return out.str();
+    }
+
+    /// write the frames kept in the Chrome trace event format
+    bool Profiler::WriteChromeTrace( const std::string& filename ) const
+    {
+        std::ofstream out(filename.c_str());
+        if (!out)
+        {
+            LOG_F_ERROR("core", "could not open " << filename << " to write the profile");
+            return false;
+        }
+        boost::mutex::scoped_lock lock(mMutex);
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        for (size_t n = mNumFrames; n-- > 0; )
+        {
+            const ProfileFrame& frame = mFrames[FrameIndex(n)];
+            out << (first ? "\n" : ",\n");
+            first = false;
+            out << "{\"name\":\"frame " << frame.number << "\",\"cat\":\"frame\",\"ph\":\"X\",\"pid\":1,\"tid\":0"
+                << ",\"ts\":" << frame.start << ",\"dur\":" << frame.duration << "}";
+            std::vector<ProfileEvent>::const_iterator event;
+            for (event = frame.events.begin(); event != frame.events.end(); ++event)
+            {
+                out << ",\n{\"name\":";
+                WriteJSONString(out, event->name);
+                out << ",\"cat\":";
+                WriteJSONString(out, event->category);
+                out << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << event->thread
+                    << ",\"ts\":" << event->start << ",\"dur\":" << event->duration << "}";
+            }
+        }
+        out << "\n]}\n";
+        return out.good();
+    }
+
+    /// open a zone on the calling thread
+    void ProfileZone::Open( const char* name, const char* category )
+    {
+        Profiler& profiler = Profiler::instance();
+        Profiler::ThreadState& state = profiler.GetThreadState();
+        mEvent.name = name;
+        mEvent.category = category;
+        mEvent.parent = state.zones.empty() ? NULL : state.zones.back();
+        mEvent.thread = state.index;
+        mEvent.depth = static_cast<uint32_t>(state.zones.size());
+        state.zones.push_back(name);
+        mEvent.start = profiler.Now();
+    }
+
+    /// close the zone, recording its time
+    void ProfileZone::Close()
+    {
+        Profiler& profiler = Profiler::instance();
+        mEvent.duration = profiler.Now() - mEvent.start;
+        Profiler::ThreadState& state = profiler.GetThreadState();
+        if (!state.zones.empty())
+        {
+            state.zones.pop_back();
+        }
+        profiler.Record(mEvent);
+    }
+
+} //end OpenNero
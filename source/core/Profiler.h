@@ -0,0 +1,185 @@
+//--------------------------------------------------------
+// OpenNero : Profiler
+//  scoped timing of the phases of each frame
+//--------------------------------------------------------
+
+#ifndef _CORE_PROFILER_H_
+#define _CORE_PROFILER_H_
+
+#include "core/BoostCommon.h"
+#include "core/ONTime.h"
+#include <string>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <boost/preprocessor/cat.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+namespace OpenNero
+{
+    /// one timed run of a zone of code
+    struct ProfileEvent
+    {
+        const char* name;       ///< name of the zone (must outlive the profiler, e.g. a literal)
+        const char* category;   ///< kind of work, e.g. "engine" or "python"
+        const char* parent;     ///< name of the enclosing zone on the same thread, or NULL
+        uint64_t start;         ///< microseconds since the profiler was created
+        uint64_t duration;      ///< microseconds
+        uint32_t thread;        ///< index of the thread (0 is the first one to record a zone)
+        uint32_t depth;         ///< number of enclosing zones on the same thread
+    };
+
+    /// the zones timed during one frame
+    struct ProfileFrame
+    {
+        uint64_t number;        ///< number of the frame since profiling started
+        uint64_t start;         ///< microseconds since the profiler was created
+        uint64_t duration;      ///< microseconds
+        std::vector<ProfileEvent> events;   ///< zones in the order they ended
+    };
+
+    /// the times of one zone under one parent, summed over a number of frames
+    struct ProfileStat
+    {
+        std::string name;       ///< name of the zone
+        std::string category;   ///< kind of work
+        std::string parent;     ///< name of the enclosing zone, empty for none
+        uint32_t depth;         ///< number of enclosing zones
+        uint64_t calls;         ///< number of times the zone ran
+        uint64_t total;         ///< microseconds spent in the zone
+        uint64_t max;           ///< most microseconds spent in the zone in one frame
+    };
+
+    /**
+     * A hierarchical profiler for the frames of the simulation. Code marks
+     * zones with PROFILE_ZONE; between BeginFrame and EndFrame the time of
+     * each zone is recorded along with the zone that encloses it on the same
+     * thread. The last GetHistorySize() frames are kept in a ring buffer,
+     * which can be summarized with GetStats or GetReport, or written out as
+     * a Chrome trace (chrome://tracing) with WriteChromeTrace. When the
+     * profiler is disabled a zone costs one flag check.
+     */
+    class Profiler : boost::noncopyable
+    {
+    public:
+        /// singleton instance of class
+        static Profiler& instance();
+
+        /// start or stop recording frames
+        void SetEnabled( bool enabled );
+
+        /// are frames being recorded?
+        bool IsEnabled() const { return mEnabled; }
+
+        /// set the number of frames kept (dropping the recorded ones)
+        void SetHistorySize( size_t frames );
+
+        /// the number of frames kept
+        size_t GetHistorySize() const { return mFrames.size(); }
+
+        /// the number of frames recorded and still kept
+        size_t GetNumFrames() const;
+
+        /// drop all of the recorded frames
+        void Clear();
+
+        /// start timing a frame
+        void BeginFrame();
+
+        /// finish timing the current frame
+        void EndFrame();
+
+        /// microseconds since the profiler was created
+        uint64_t Now() const { return mTimer->getMicroseconds(); }
+
+        /// sum the times of each zone over the last frames recorded
+        /// @param frames the number of frames (0 for all of the ones kept)
+        /// @param stats set to one entry per zone and parent, parents before their children
+        /// @return the number of frames summed
+        size_t GetStats( size_t frames, std::vector<ProfileStat>& stats ) const;
+
+        /// the durations in microseconds of the last frames recorded, oldest first
+        void GetFrameTimes( size_t frames, std::vector<uint64_t>& times ) const;
+
+        /// a table of the times of each zone over the last frames recorded
+        std::string GetReport( size_t frames ) const;
+
+        /// write the frames kept in the Chrome trace event format
+        bool WriteChromeTrace( const std::string& filename ) const;
+
+    private:
+        friend class ProfileZone;
+
+        /// the zones open on one thread
+        struct ThreadState
+        {
+            uint32_t index;                     ///< index of the thread
+            std::vector<const char*> zones;     ///< names of the open zones, innermost last
+        };
+
+        Profiler();
+
+        /// the zones open on the calling thread
+        ThreadState& GetThreadState();
+
+        /// record a zone that ended
+        void Record( const ProfileEvent& event );
+
+        /// the index in mFrames of the frame recorded n frames before the latest one
+        size_t FrameIndex( size_t n ) const;
+
+    private:
+        TimerPtr mTimer;                    ///< the clock of all of the times
+        volatile bool mEnabled;             ///< are frames being recorded?
+        volatile bool mInFrame;             ///< is a frame being recorded?
+        std::vector<ProfileFrame> mFrames;  ///< ring buffer of frames
+        size_t mNext;                       ///< index in mFrames of the next frame
+        size_t mNumFrames;                  ///< number of frames in mFrames
+        uint64_t mFrameNumber;              ///< number of the next frame
+        uint32_t mNumThreads;               ///< number of threads that recorded a zone
+        boost::thread_specific_ptr<ThreadState> mThreadState;  ///< zones open on each thread
+        mutable boost::mutex mMutex;        ///< protects the frames and the thread count
+    };
+
+    /// times the scope it is declared in as a profiler zone
+    class ProfileZone : boost::noncopyable
+    {
+    public:
+        /// open a zone if the profiler is recording
+        /// @param name the name of the zone (must outlive the profiler, e.g. a literal)
+        /// @param category the kind of work, e.g. "engine" or "python"
+        explicit ProfileZone( const char* name, const char* category = "engine" )
+            : mActive(Profiler::instance().IsEnabled())
+        {
+            if (mActive)
+            {
+                Open(name, category);
+            }
+        }
+
+        /// close the zone, recording its time
+        ~ProfileZone()
+        {
+            if (mActive)
+            {
+                Close();
+            }
+        }
+
+    private:
+        void Open( const char* name, const char* category );
+        void Close();
+
+        bool mActive;           ///< was the profiler recording when the zone opened?
+        ProfileEvent mEvent;    ///< the zone
+    };
+
+} //end OpenNero
+
+/// time the rest of the enclosing scope as a profiler zone
+#define PROFILE_ZONE(name) ::OpenNero::ProfileZone BOOST_PP_CAT(profile_zone_, __LINE__)(name)
+
+/// time the rest of the enclosing scope as a profiler zone of a given category
+#define PROFILE_ZONE_CATEGORY(name, category) ::OpenNero::ProfileZone BOOST_PP_CAT(profile_zone_, __LINE__)(name, category)
+
+#endif // _CORE_PROFILER_H_
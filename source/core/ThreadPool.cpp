@@ -0,0 +1,132 @@
+//--------------------------------------------------------
+// OpenNero : ThreadPool
+//  a fixed set of worker threads for data-parallel loops
+//--------------------------------------------------------
+
+#include "core/Common.h"
+#include "core/ThreadPool.h"
+#include <boost/bind.hpp>
+
+namespace OpenNero
+{
+    /// start a pool that runs loops on num_threads threads (including the caller)
+    ThreadPool::ThreadPool( size_t num_threads )
+        : mNumThreads(num_threads > 0 ? num_threads : 1)
+        , mWorkers()
+        , mMutex()
+        , mWorkReady()
+        , mWorkDone()
+        , mTask(NULL)
+        , mCount(0)
+        , mGeneration(0)
+        , mBusy(0)
+        , mError()
+        , mQuit(false)
+    {
+        for (size_t i = 1; i < mNumThreads; ++i)
+        {
+            mWorkers.create_thread(boost::bind(&ThreadPool::WorkerLoop, this, i));
+        }
+    }
+
+    /// stop and join all of the worker threads
+    ThreadPool::~ThreadPool()
+    {
+        {
+            boost::mutex::scoped_lock lock(mMutex);
+            mQuit = true;
+        }
+        mWorkReady.notify_all();
+        mWorkers.join_all();
+    }
+
+    /// call task(i) for every i in [0, count) and wait for all of them to finish
+    void ThreadPool::ParallelFor( size_t count, const Task& task )
+    {
+        if (mNumThreads == 1 || count <= 1)
+        {
+            for (size_t i = 0; i < count; ++i)
+            {
+                task(i);
+            }
+            return;
+        }
+
+        {
+            boost::mutex::scoped_lock lock(mMutex);
+            mTask = &task;
+            mCount = count;
+            mBusy = mNumThreads - 1;
+            ++mGeneration;
+        }
+        mWorkReady.notify_all();
+
+        RunShare(0);
+
+        boost::exception_ptr error;
+        {
+            boost::mutex::scoped_lock lock(mMutex);
+            while (mBusy > 0)
+            {
+                mWorkDone.wait(lock);
+            }
+            mTask = NULL;
+            error = mError;
+            mError = boost::exception_ptr();
+        }
+        if (error)
+        {
+            boost::rethrow_exception(error);
+        }
+    }
+
+    /// the loop of worker thread number worker
+    void ThreadPool::WorkerLoop( size_t worker )
+    {
+        size_t generation = 0;
+        while (true)
+        {
+            {
+                boost::mutex::scoped_lock lock(mMutex);
+                while (!mQuit && mGeneration == generation)
+                {
+                    mWorkReady.wait(lock);
+                }
+                if (mQuit)
+                {
+                    return;
+                }
+                generation = mGeneration;
+            }
+
+            RunShare(worker);
+
+            {
+                boost::mutex::scoped_lock lock(mMutex);
+                --mBusy;
+            }
+            mWorkDone.notify_one();
+        }
+    }
+
+    /// run the share of the current loop that belongs to a thread
+    void ThreadPool::RunShare( size_t worker )
+    {
+        try
+        {
+            for (size_t i = worker; i < mCount; i += mNumThreads)
+            {
+                (*mTask)(i);
+            }
+        }
+        catch (...)
+        {
+            boost::mutex::scoped_lock lock(mMutex);
+            if (!mError)
+            {
+                mError = boost::current_exception();
+            }
+        }
+    }
+
+} //end OpenNero
@@ -0,0 +1,77 @@
+//--------------------------------------------------------
+// OpenNero : ThreadPool
+//  a fixed set of worker threads for data-parallel loops
+//--------------------------------------------------------
+
+#ifndef _CORE_THREADPOOL_H_
+#define _CORE_THREADPOOL_H_
+
+#include "core/BoostCommon.h"
+#include <boost/exception_ptr.hpp>
+#include <boost/function.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+namespace OpenNero
+{
+    /// @cond
+    BOOST_SHARED_DECL( ThreadPool );
+    /// @endcond
+
+    /**
+     * A fixed set of worker threads that run the iterations of a loop in 
+     * parallel. The thread calling ParallelFor does its share of the work and
+     * returns once all of the iterations are done. Iteration i always runs on
+     * thread i % GetNumThreads(), so the split of the work does not depend on 
+     * timing. If an iteration throws, its thread skips the rest of its share,
+     * and ParallelFor rethrows the first such exception once every thread is
+     * done.
+     */
+    class ThreadPool : boost::noncopyable
+    {
+    public:
+        /// the body of a loop, called with the index of the iteration
+        typedef boost::function<void (size_t)> Task;
+
+        /// start a pool that runs loops on num_threads threads (including the caller)
+        explicit ThreadPool( size_t num_threads );
+
+        /// stop and join all of the worker threads
+        ~ThreadPool();
+
+        /// the number of threads loops are split among (including the caller)
+        size_t GetNumThreads() const { return mNumThreads; }
+
+        /// call task(i) for every i in [0, count) and wait for all of them to finish,
+        /// rethrowing the first exception thrown by any of them
+        void ParallelFor( size_t count, const Task& task );
+
+    private:
+
+        /// the loop of worker thread number worker
+        void WorkerLoop( size_t worker );
+
+        /// run the share of the current loop that belongs to a thread,
+        /// recording the exception that stops it, if any
+        void RunShare( size_t worker );
+
+    private:
+
+        size_t mNumThreads;                 ///< number of threads including the caller
+        boost::thread_group mWorkers;       ///< the worker threads
+        boost::mutex mMutex;                ///< protects all of the fields below
+        boost::condition_variable mWorkReady;   ///< signalled when a new loop starts
+        boost::condition_variable mWorkDone;    ///< signalled when a worker finishes its share
+        const Task* mTask;                  ///< the body of the current loop
+        size_t mCount;                      ///< number of iterations in the current loop
+        size_t mGeneration;                 ///< incremented for every loop
+        size_t mBusy;                       ///< number of workers still running the current loop
+        boost::exception_ptr mError;        ///< the first exception thrown by the current loop
+        bool mQuit;                         ///< set when the workers should exit
+    };
+
+} //end OpenNero
+
+#endif // _CORE_THREADPOOL_H_
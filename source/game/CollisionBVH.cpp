@@ -0,0 +1,220 @@
+//--------------------------------------------------------
+// OpenNero : CollisionBVH
+//  bounding volume hierarchy over collision triangles
+//--------------------------------------------------------
+
+#include "core/Common.h"
+#include "game/CollisionBVH.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace OpenNero
+{
+    namespace
+    {
+        /// orders triangle indices by the centroid coordinate along an axis
+        struct CentroidLess
+        {
+            const std::vector<Vector3f>& centroids;
+            int axis;
+            CentroidLess(const std::vector<Vector3f>& c, int a) : centroids(c), axis(a) {}
+            bool operator()(uint32_t a, uint32_t b) const
+            {
+                const Vector3f& ca = centroids[a];
+                const Vector3f& cb = centroids[b];
+                switch (axis) {
+                    case 0: return ca.X < cb.X;
+                    case 1: return ca.Y < cb.Y;
+                    default: return ca.Z < cb.Z;
+                }
+            }
+        };
+
+        /// the maximum depth of the traversal stack
+        const size_t kMaxStackDepth = 64;
+    }
+
+    /// remove all the triangles
+    void CollisionBVH::Clear()
+    {
+        mTriangles.clear();
+        mOwners.clear();
+        mNodes.clear();
+    }
+
+    /// add a triangle owned by the specified object
+    void CollisionBVH::AddTriangle( const Triangle3f& tri, uint32_t owner )
+    {
+        mTriangles.push_back(tri);
+        mOwners.push_back(owner);
+    }
+
+    /// build the hierarchy over the triangles added since the last Clear()
+    void CollisionBVH::Build()
+    {
+        mNodes.clear();
+        if (mTriangles.empty()) {
+            return;
+        }
+
+        size_t n = mTriangles.size();
+        mCentroids.resize(n);
+        mOrder.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            const Triangle3f& tri = mTriangles[i];
+            mCentroids[i] = (tri.pointA + tri.pointB + tri.pointC) / 3.0f;
+            mOrder[i] = static_cast<uint32_t>(i);
+        }
+
+        mNodes.reserve(2 * n / kMaxLeafSize + 1);
+        BuildNode(0, static_cast<uint32_t>(n));
+
+        // store the triangles in leaf order so that leaves are contiguous
+        std::vector<Triangle3f> triangles(n);
+        std::vector<uint32_t> owners(n);
+        for (size_t i = 0; i < n; ++i) {
+            triangles[i] = mTriangles[mOrder[i]];
+            owners[i] = mOwners[mOrder[i]];
+        }
+        mTriangles.swap(triangles);
+        mOwners.swap(owners);
+    }
+
+    /// build the subtree over mOrder[begin, end) and return its index
+    uint32_t CollisionBVH::BuildNode( uint32_t begin, uint32_t end )
+    {
+        uint32_t index = static_cast<uint32_t>(mNodes.size());
+        mNodes.push_back(Node());
+
+        const Triangle3f& first = mTriangles[mOrder[begin]];
+        BBoxf box(first.pointA);
+        BBoxf centroid_box(mCentroids[mOrder[begin]]);
+        for (uint32_t i = begin; i < end; ++i) {
+            const Triangle3f& tri = mTriangles[mOrder[i]];
+            box.addInternalPoint(tri.pointA);
+            box.addInternalPoint(tri.pointB);
+            box.addInternalPoint(tri.pointC);
+            centroid_box.addInternalPoint(mCentroids[mOrder[i]]);
+        }
+        mNodes[index].box = box;
+
+        if (end - begin <= kMaxLeafSize) {
+            mNodes[index].first = begin;
+            mNodes[index].count = end - begin;
+            return index;
+        }
+
+        // split at the median centroid along the longest axis
+        Vector3f extent = centroid_box.getExtent();
+        int axis = 0;
+        if (extent.Y > extent.X) axis = 1;
+        if (extent.Z > extent.X && extent.Z > extent.Y) axis = 2;
+        uint32_t mid = begin + (end - begin) / 2;
+        std::nth_element(mOrder.begin() + begin, mOrder.begin() + mid, mOrder.begin() + end,
+                         CentroidLess(mCentroids, axis));
+
+        BuildNode(begin, mid); // the left child always follows its parent
+        uint32_t right = BuildNode(mid, end);
+        mNodes[index].first = right;
+        mNodes[index].count = 0;
+        return index;
+    }
+
+    /// Find the intersection of the segment from start to end closest to start
+    bool CollisionBVH::Intersect( const Vector3f& start, const Vector3f& end, Vector3f& hitPos, uint32_t& hitOwner ) const
+    {
+        if (mNodes.empty()) {
+            return false;
+        }
+
+        Vector3f dir = end - start;
+        Vector3f inv_dir(1.0f / dir.X, 1.0f / dir.Y, 1.0f / dir.Z);
+        float32_t best_t = 1.0f;
+        bool found = false;
+
+        uint32_t stack[kMaxStackDepth];
+        size_t top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = mNodes[stack[--top]];
+            if (!SegmentHitsBox(node.box, start, inv_dir, best_t)) {
+                continue;
+            }
+            if (node.count > 0) {
+                for (uint32_t i = node.first; i < node.first + node.count; ++i) {
+                    float32_t t;
+                    if (SegmentHitsTriangle(mTriangles[i], start, dir, t) && t <= best_t) {
+                        best_t = t;
+                        hitOwner = mOwners[i];
+                        found = true;
+                    }
+                }
+            } else {
+                AssertMsg(top + 2 <= kMaxStackDepth, "CollisionBVH is too deep");
+                uint32_t left = static_cast<uint32_t>(&node - &mNodes[0]) + 1;
+                stack[top++] = node.first;
+                stack[top++] = left;
+            }
+        }
+
+        if (found) {
+            hitPos = start + dir * best_t;
+        }
+        return found;
+    }
+
+    /// does the segment start + t * dir with t in [0, tmax] cross the box?
+    bool CollisionBVH::SegmentHitsBox( const BBoxf& box, const Vector3f& start, const Vector3f& inv_dir, float32_t tmax )
+    {
+        float32_t tmin = 0;
+        const float32_t starts[3] = { start.X, start.Y, start.Z };
+        const float32_t invs[3] = { inv_dir.X, inv_dir.Y, inv_dir.Z };
+        const float32_t mins[3] = { box.MinEdge.X, box.MinEdge.Y, box.MinEdge.Z };
+        const float32_t maxs[3] = { box.MaxEdge.X, box.MaxEdge.Y, box.MaxEdge.Z };
+        for (int i = 0; i < 3; ++i) {
+            if (std::fabs(invs[i]) == HUGE_VAL || invs[i] != invs[i]) {
+                // parallel to this slab - has to start inside of it
+                if (starts[i] < mins[i] || starts[i] > maxs[i]) {
+                    return false;
+                }
+                continue;
+            }
+            float32_t t0 = (mins[i] - starts[i]) * invs[i];
+            float32_t t1 = (maxs[i] - starts[i]) * invs[i];
+            if (t0 > t1) std::swap(t0, t1);
+            tmin = std::max(tmin, t0);
+            tmax = std::min(tmax, t1);
+            if (tmin > tmax) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// intersect the segment with a triangle (Moller-Trumbore, both sides)
+    bool CollisionBVH::SegmentHitsTriangle( const Triangle3f& tri, const Vector3f& start, const Vector3f& dir, float32_t& t )
+    {
+        Vector3f e1 = tri.pointB - tri.pointA;
+        Vector3f e2 = tri.pointC - tri.pointA;
+        Vector3f p = dir.crossProduct(e2);
+        float32_t det = e1.dotProduct(p);
+        if (std::fabs(det) < 1e-12f) {
+            return false;
+        }
+        float32_t inv_det = 1.0f / det;
+        Vector3f s = start - tri.pointA;
+        float32_t u = s.dotProduct(p) * inv_det;
+        if (u < 0 || u > 1) {
+            return false;
+        }
+        Vector3f q = s.crossProduct(e1);
+        float32_t v = dir.dotProduct(q) * inv_det;
+        if (v < 0 || u + v > 1) {
+            return false;
+        }
+        t = e2.dotProduct(q) * inv_det;
+        return t >= 0 && t <= 1;
+    }
+
+} //end OpenNero
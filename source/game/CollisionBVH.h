@@ -0,0 +1,83 @@
+//--------------------------------------------------------
+// OpenNero : CollisionBVH
+//  bounding volume hierarchy over collision triangles
+//--------------------------------------------------------
+
+#ifndef _GAME_COLLISION_BVH_H_
+#define _GAME_COLLISION_BVH_H_
+
+#include <vector>
+#include "core/IrrUtil.h"
+#include "core/ONTypes.h"
+#include "core/BoostCommon.h"
+
+namespace OpenNero
+{
+    /// @cond
+    BOOST_SHARED_DECL( CollisionBVH );
+    /// @endcond
+
+    /// A bounding volume hierarchy over a soup of triangles, each tagged with
+    /// the id of the object that owns it. It is built once from the output of
+    /// a triangle selector and then answers many segment queries, which is a
+    /// lot cheaper than walking the scene graph for every ray.
+    class CollisionBVH
+    {
+    public:
+
+        /// the largest number of triangles stored in a leaf
+        static const size_t kMaxLeafSize = 4;
+
+        CollisionBVH() {}
+
+        /// remove all the triangles (keeps the storage around for rebuilding)
+        void Clear();
+
+        /// add a triangle owned by the specified object
+        void AddTriangle( const Triangle3f& tri, uint32_t owner );
+
+        /// build the hierarchy over the triangles added since the last Clear()
+        void Build();
+
+        /// the number of triangles in the hierarchy
+        size_t GetTriangleCount() const { return mTriangles.size(); }
+
+        /// Find the intersection of the segment from start to end closest to start
+        /// @param start the start of the segment
+        /// @param end the end of the segment
+        /// @param hitPos set to the closest intersection, if any
+        /// @param hitOwner set to the owner of the triangle intersected, if any
+        /// @return true iff the segment intersects any of the triangles
+        bool Intersect( const Vector3f& start, const Vector3f& end, Vector3f& hitPos, uint32_t& hitOwner ) const;
+
+    private:
+
+        /// a node of the hierarchy
+        struct Node
+        {
+            BBoxf box;      ///< bounds of all the triangles under this node
+            uint32_t first; ///< index of the first triangle (leaf) or of the left child (inner)
+            uint32_t count; ///< number of triangles (leaf) or 0 (inner)
+        };
+
+        /// build the subtree over mOrder[begin, end) and return its index
+        uint32_t BuildNode( uint32_t begin, uint32_t end );
+
+        /// does the segment start + t * dir with t in [0, tmax] cross the box?
+        static bool SegmentHitsBox( const BBoxf& box, const Vector3f& start, const Vector3f& inv_dir, float32_t tmax );
+
+        /// intersect the segment with a triangle, giving the segment parameter t
+        static bool SegmentHitsTriangle( const Triangle3f& tri, const Vector3f& start, const Vector3f& dir, float32_t& t );
+
+    private:
+
+        std::vector<Triangle3f> mTriangles;     ///< triangles in leaf order after Build()
+        std::vector<uint32_t>   mOwners;        ///< owner of each triangle
+        std::vector<Vector3f>   mCentroids;     ///< centroid of each triangle (used while building)
+        std::vector<uint32_t>   mOrder;         ///< triangle permutation (used while building)
+        std::vector<Node>       mNodes;         ///< the nodes of the hierarchy, root first
+    };
+
+} //end OpenNero
+
+#endif // _GAME_COLLISION_BVH_H_
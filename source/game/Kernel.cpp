@@ -152,7 +152,16 @@ namespace OpenNero
             float32_t fullDT = (curTime - prevFullFrameTime)/1000.0f; // full frame length
             float32_t frameDelay = mCurMod->context->GetFrameDelay(); // expected frame delay
             
-            if (fullDT >= frameDelay) {
+            if (mCurMod->context->GetFastForwardTicks() > 0) {
+                // run the requested AI ticks back to back, then pick up the clock again
+                mCurMod->context->RunFastForward();
+                curTime = GetStaticTimer().getMilliseconds();
+                prevFullFrameTime = curTime;
+            } else if (mCurMod->context->IsHeadless()) {
+                // no animation frames in between AI ticks
+                mCurMod->context->ProcessHeadlessTick(dt);
+                prevFullFrameTime = curTime;
+            } else if (fullDT >= frameDelay) {
                 mCurMod->context->ProcessTick(dt);
                 prevFullFrameTime = curTime;
             } else {
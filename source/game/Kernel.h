@@ -98,6 +98,9 @@ namespace OpenNero
 
         /// request a mod switch next frame
         void RequestModSwitch( IrrlichtDevice_IPtr device, const std::string& name, const std::string& mode, const std::string& path );
+
+        /// has a mod switch been requested for the next frame?
+        bool IsModSwitchPending() const { return mTransitionInfo.mActive; }
         
         /// Sets the part of the window title after OpenNero - ModName
         void SetWindowCaption(const std::string& caption);
@@ -4,6 +4,8 @@
 //--------------------------------------------------------
 
 #include "core/Common.h"
+#include "core/Profiler.h"
+#include "utils/Config.h"
 
 #include "game/SimContext.h"
 #include "game/SimEntity.h"
@@ -70,6 +72,12 @@ namespace OpenNero
     SimContext::SimContext()
         : mClearColor(255, 100, 101, 140)
         , mInputReceiver( kIR_Game )
+        , mHeadless( GetAppConfig().RenderType == "null" )
+        , mKilled(false)
+        , mFastForwardTicks(0)
+        , mTicksPerSecond(0)
+        , mTickCount(0)
+        , mTickTimer( GetTimer() )
     {}
 
     /// basic destructor
@@ -162,6 +170,7 @@ namespace OpenNero
     void SimContext::KillGame()
     {
         AssertMsg( mIrr.getDevice(), "Invalid irrlicht device" );
+        mKilled = true;
         mIrr.getDevice()->closeDevice();
     }
 
@@ -267,47 +276,135 @@ namespace OpenNero
     /// @param dt the time to increment by
     void SimContext::ProcessTick(float32_t dt)
     {
-        // This will cause Irrlicht to render the objects
-        UpdateRenderSystem(dt);
+        Profiler::instance().BeginFrame();
+        {
+            // This will cause Irrlicht to render the objects
+            PROFILE_ZONE("SimContext::UpdateRenderSystem");
+            UpdateRenderSystem(dt);
+        }
         
         // clear our lineset
         LineSet::instance().ClearSegments();
 
-        // This will look at any input from the user that happened since the 
-        // previous call and run the corresponding (Python) actions. This can
-        // potentially change a lot of things such as which mod we want to run.
-        UpdateInputSystem(dt);
+        {
+            // This will look at any input from the user that happened since the 
+            // previous call and run the corresponding (Python) actions. This can
+            // potentially change a lot of things such as which mod we want to run.
+            PROFILE_ZONE("SimContext::UpdateInputSystem");
+            UpdateInputSystem(dt);
+        }
 
-        // Call the ProcessTick method of the global AI manager
-        AIManager::instance().ProcessTick(dt);
+        {
+            // Call the ProcessTick method of the global AI manager
+            PROFILE_ZONE("AIManager::ProcessTick");
+            AIManager::instance().ProcessTick(dt);
+        }
 
-        // This will loop through all the objects in the simulation, calling
-        // their ProcessTick method. We need to know the actual position of
-        // each object before this, and we will know the desired position after this.
-        UpdateSimulation(dt);
+        {
+            // This will loop through all the objects in the simulation, calling
+            // their ProcessTick method. We need to know the actual position of
+            // each object before this, and we will know the desired position after this.
+            PROFILE_ZONE("SimContext::UpdateSimulation");
+            UpdateSimulation(dt);
+        }
+
+        {
+            // This will trigger scheduled events in the Python script,
+            // as well as ModTick(dt) if it is defined
+            PROFILE_ZONE("SimContext::UpdateScriptingSystem");
+            UpdateScriptingSystem(dt);
+        }
 
-        // This will trigger scheduled events in the Python script,
-        // as well as ModTick(dt) if it is defined
-        UpdateScriptingSystem(dt);
+        CountTick();
+        Profiler::instance().EndFrame();
+    }
+
+    /// Update all the objects without rendering
+    /// @param dt the time to increment by
+    void SimContext::ProcessHeadlessTick(float32_t dt)
+    {
+        Profiler::instance().BeginFrame();
+        {
+            // Move the scene nodes and resolve their collisions, but draw nothing
+            PROFILE_ZONE("SimContext::AnimateScene");
+            AnimateScene(dt);
+        }
+
+        // nobody will draw the lines the objects add
+        LineSet::instance().ClearSegments();
+
+        {
+            PROFILE_ZONE("AIManager::ProcessTick");
+            AIManager::instance().ProcessTick(dt);
+        }
+
+        {
+            PROFILE_ZONE("SimContext::UpdateSimulation");
+            UpdateSimulation(dt);
+        }
+
+        {
+            PROFILE_ZONE("SimContext::UpdateScriptingSystem");
+            UpdateScriptingSystem(dt);
+        }
+
+        CountTick();
+        Profiler::instance().EndFrame();
+    }
+
+    /// Run the fast-forward ticks back to back
+    void SimContext::RunFastForward()
+    {
+        TimerPtr timer = GetTimer();
+        uint64_t prevTime = 0;
+        uint32_t ticks = 0;
+        // ticks requested while these run wait for the next frame
+        uint32_t requested = mFastForwardTicks;
+        mFastForwardTicks = 0;
+        while( ticks < requested && !mKilled && !Kernel::instance().IsModSwitchPending() )
+        {
+            // use the AI frame length if there is one, otherwise the actual time
+            uint64_t curTime = timer->getMicroseconds();
+            float32_t dt = GetFrameDelay() > 0 ? GetFrameDelay() : (curTime - prevTime) / 1e6f;
+            prevTime = curTime;
+            ProcessHeadlessTick(dt);
+            ++ticks;
+        }
+
+        uint64_t elapsed = timer->getMicroseconds();
+        if( ticks > 0 && elapsed > 0 )
+        {
+            mTicksPerSecond = ticks * 1e6 / elapsed;
+        }
+        LOG_F_MSG( "game", "Fast-forwarded " << ticks << " ticks at " << mTicksPerSecond << " ticks per second" );
     }
     
     /// Update all the objects and render
     /// @param dt the time to increment by
     void SimContext::ProcessAnimationTick(float32_t dt, float32_t frac)
     {
-        // This will cause Irrlicht to render the objects
-        UpdateRenderSystem(dt);
+        Profiler::instance().BeginFrame();
+        {
+            // This will cause Irrlicht to render the objects
+            PROFILE_ZONE("SimContext::UpdateRenderSystem");
+            UpdateRenderSystem(dt);
+        }
 
-        // This will look at any input from the user that happened since the 
-        // previous call and run the corresponding (Python) actions. This can
-        // potentially change a lot of things such as which mod we want to run.
-        UpdateInputSystem(dt);
+        {
+            // This will look at any input from the user that happened since the 
+            // previous call and run the corresponding (Python) actions. This can
+            // potentially change a lot of things such as which mod we want to run.
+            PROFILE_ZONE("SimContext::UpdateInputSystem");
+            UpdateInputSystem(dt);
+        }
         
         // update the simulation
         if( mpSimulation )
         {
+            PROFILE_ZONE("Simulation::ProcessAnimationTick");
             mpSimulation->ProcessAnimationTick(frac);
         }
+        Profiler::instance().EndFrame();
     }
     
     /// Update the input system
@@ -331,6 +428,12 @@ namespace OpenNero
         mIrr.getSceneManager()->drawAll();
         mIrr.getGuiEnv()->drawAll();
 
+        // drawing updated the absolute positions of the scene nodes
+        if( mpSimulation )
+        {
+            mpSimulation->InvalidateCollisionBVHs();
+        }
+
         mFPSCounter.registerFrame();
         std::stringstream sstr;
         sstr << mFPSCounter.getFPS();
@@ -340,6 +443,34 @@ namespace OpenNero
 
     }
 
+    /// Update the scene graph without drawing it
+    void SimContext::AnimateScene(float32_t dt)
+    {
+        // this runs the collision response animators and updates the
+        // absolute positions of the scene nodes, which is all that drawAll
+        // does that the simulation depends on
+        irr::scene::ISceneNode* root = mIrr.getSceneManager()->getRootSceneNode();
+        root->OnAnimate( mIrr.getDevice()->getTimer()->getTime() );
+
+        if( mpSimulation )
+        {
+            mpSimulation->InvalidateCollisionBVHs();
+        }
+    }
+
+    /// Count an AI tick, updating the ticks per second about once a second
+    void SimContext::CountTick()
+    {
+        ++mTickCount;
+        uint64_t elapsed = mTickTimer->getMicroseconds();
+        if( elapsed >= 1000000 )
+        {
+            mTicksPerSecond = mTickCount * 1e6 / elapsed;
+            mTickCount = 0;
+            mTickTimer->resetMicroseconds();
+        }
+    }
+
     /// Update the scripting system by a bit
     void SimContext::UpdateScriptingSystem(float32_t dt)
     {
@@ -496,6 +627,88 @@ namespace OpenNero
         }        
     }
 
+    /// @param rays the rays to cast
+    /// @param hits the first intersection for each of the rays, in the same order
+    /// @param vis show rays?
+    /// @param foundColor the color to use if vis is true and an intersection is found
+    /// @param noneColor the color to use if vis is true 
+    ///
+    /// Rays with a type mask are tested against a bounding volume hierarchy
+    /// of the triangles of matching objects which is built once per frame,
+    /// instead of walking the scene graph for each ray. Rays without a type
+    /// mask fall back to FindInRay.
+    void SimContext::FindInRays( const RayQueryVector& rays,
+                                 RayHitVector& hits,
+                                 const bool vis,
+                                 const SColor& foundColor,
+                                 const SColor& noneColor
+                               )
+    {
+        hits.resize(rays.size());
+        for (size_t i = 0; i < rays.size(); ++i)
+        {
+            const RayQuery& ray = rays[i];
+            RayHit& hit = hits[i];
+            hit.id = kInvalidSimId;
+            hit.position = ray.target;
+            if (ray.type == 0)
+            {
+                SimEntityData hitEntity;
+                Vector3f hitPos;
+                if (FindInRay(hitEntity, hitPos, ray.origin, ray.target, ray.type, vis, foundColor, noneColor))
+                {
+                    hit.id = hitEntity.GetId();
+                    hit.position = hitPos;
+                }
+                continue;
+            }
+            const CollisionBVH& bvh = getSimulation()->GetCollisionBVH(ray.type);
+            Vector3f hitPos;
+            uint32_t owner = kInvalidSimId;
+            if (bvh.Intersect(ConvertNeroToIrrlichtPosition(ray.origin), ConvertNeroToIrrlichtPosition(ray.target), hitPos, owner)
+                && getSimulation()->Find(owner))
+            {
+                hit.id = owner;
+                hit.position = ConvertIrrlichtToNeroPosition(hitPos);
+                if (vis)
+                {
+                    LineSet::instance().AddSegment(ray.origin, hit.position, foundColor);
+                }
+            }
+            else if (vis)
+            {
+                LineSet::instance().AddSegment(ray.origin, ray.target, noneColor);
+            }
+        }
+    }
+
+    /// Find the first object that intersects each of the specified rays
+    /// @param rays list of (origin, target, type) tuples
+    /// @param vis show rays?
+    /// @return list of (id, hit) tuples in the same order as rays, with id 0 for no hit
+    boost::python::list SimContext::PyFindInRays( const boost::python::list& rays, const bool vis )
+    {
+        RayQueryVector queries(boost::python::len(rays));
+        for (size_t i = 0; i < queries.size(); ++i)
+        {
+            boost::python::tuple ray = boost::python::extract<boost::python::tuple>(rays[i]);
+            queries[i].origin = boost::python::extract<Vector3f>(ray[0]);
+            queries[i].target = boost::python::extract<Vector3f>(ray[1]);
+            if (boost::python::len(ray) > 2)
+            {
+                queries[i].type = boost::python::extract<uint32_t>(ray[2]);
+            }
+        }
+        RayHitVector hits;
+        FindInRays(queries, hits, vis);
+        boost::python::list result;
+        for (size_t i = 0; i < hits.size(); ++i)
+        {
+            result.append(boost::python::make_tuple(hits[i].id, hits[i].position));
+        }
+        return result;
+    }
+
     /// @param x screen x-coordinate for active camera
     /// @param y screen y-coordinate for active camera
     /// @return Approximate 3d position of the click
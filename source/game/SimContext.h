@@ -9,6 +9,7 @@
 #include "core/Common.h"
 #include "core/BoostCommon.h"
 #include "core/IrrUtil.h"
+#include "core/ONTime.h"
 #include "game/objects/PropertyMap.h"
 #include "game/Kernel.h"
 #include "game/Mod.h"
@@ -28,6 +29,29 @@ namespace OpenNero
     BOOST_PTR_DECL( GuiManager );
     /// @endcond
 
+    /// A ray to cast with SimContext::FindInRays
+    struct RayQuery
+    {
+        Vector3f origin;    ///< origin of the ray
+        Vector3f target;    ///< target of the ray
+        uint32_t type;      ///< bitmask of the objects to care about or 0 for 'check all'
+        RayQuery() : origin(), target(), type(0) {}
+        RayQuery(const Vector3f& o, const Vector3f& t, uint32_t type) : origin(o), target(t), type(type) {}
+    };
+
+    /// The result of casting a ray with SimContext::FindInRays
+    struct RayHit
+    {
+        SimId id;           ///< id of the first object hit or kInvalidSimId
+        Vector3f position;  ///< position of the hit (or the target of the ray)
+    };
+
+    /// a batch of rays
+    typedef std::vector<RayQuery> RayQueryVector;
+
+    /// the results for a batch of rays
+    typedef std::vector<RayHit> RayHitVector;
+
     /**
      * The SimContext is the entire game state. It stores all the objects in
      * in the simulation.
@@ -119,6 +143,18 @@ namespace OpenNero
                                           const SColor& noneColor = SColor(255,255,255,0)
                                         );
 
+        /// Find the first object that intersects each of the specified rays
+        void FindInRays( const RayQueryVector& rays,
+                         RayHitVector& hits,
+                         const bool vis = false,
+                         const SColor& foundColor = SColor(255,255,0,0),
+                         const SColor& noneColor = SColor(255,255,255,0)
+                       );
+
+        /// Find the first object that intersects each of the specified rays
+        boost::python::list PyFindInRays( const boost::python::list& rays,
+                                          const bool vis = false );
+
         /// Get (approximate) 3d position of the click
         Vector3f GetClickedPosition(const int32_t& x, const int32_t& y);
 
@@ -199,6 +235,36 @@ namespace OpenNero
         /// process the animation frame thats frac between two AI frames
         void ProcessAnimationTick(float32_t dt, float32_t frac);
 
+        /// move the world forward by time dt without rendering, animating,
+        /// drawing the GUI or reading the input
+        void ProcessHeadlessTick(float32_t dt);
+
+        /// run the fast-forward ticks requested so far back to back, stopping
+        /// early if the game is killed or a mod switch is requested; ticks
+        /// requested during the run are left for the next frame
+        void RunFastForward();
+
+        /// @name Headless and fast-forward modes
+        /// @{
+
+        /// true if every frame is a headless AI tick (no animation frames)
+        bool IsHeadless() const { return mHeadless; }
+
+        /// make every frame a headless AI tick (or go back to rendering)
+        void SetHeadless(bool headless) { mHeadless = headless; }
+
+        /// run ticks AI ticks back to back at the next frame, with no rendering,
+        /// animation, GUI or input work in between
+        void FastForward(uint32_t ticks) { mFastForwardTicks += ticks; }
+
+        /// the number of fast-forward ticks still to run
+        uint32_t GetFastForwardTicks() const { return mFastForwardTicks; }
+
+        /// AI ticks per second over the last fast-forward or the last second
+        float64_t GetTicksPerSecond() const { return mTicksPerSecond; }
+
+        /// @}
+
         /// return the simulation
         SimulationPtr getSimulation() { return mpSimulation; }
 
@@ -221,6 +287,10 @@ namespace OpenNero
         void UpdateScriptingSystem(float32_t dt);
 		/// update simulation
         void UpdateSimulation(float32_t dt);
+        /// update the scene graph (and its collisions) without drawing it
+        void AnimateScene(float32_t dt);
+        /// count an AI tick towards the ticks per second
+        void CountTick();
 
         /// @}
 
@@ -257,6 +327,13 @@ namespace OpenNero
         InputReceiver       mInputReceiver;             ///< The current input receiver
 
         FPSCounter          mFPSCounter;                ///< Frames Per Second counter
+
+        bool                mHeadless;                  ///< every frame is a headless AI tick
+        bool                mKilled;                    ///< KillGame has been called
+        uint32_t            mFastForwardTicks;          ///< fast-forward ticks still to run
+        float64_t           mTicksPerSecond;            ///< measured AI ticks per second
+        uint32_t            mTickCount;                 ///< AI ticks since mTickTimer was reset
+        TimerPtr            mTickTimer;                 ///< measures the ticks per second
     };
 
     /**
@@ -31,6 +31,9 @@ namespace OpenNero
     /// List of SimEntities
     typedef std::list<SimEntityPtr> SimEntityList;
 
+    /// Vector of SimEntities
+    typedef std::vector<SimEntityPtr> SimEntityVector;
+
     /// an unique identifier that used to identify objects locally
     typedef uint32_t SimId;
 
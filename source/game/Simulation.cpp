@@ -1,7 +1,9 @@
 #include "core/Common.h"
+#include "core/Profiler.h"
 #include "utils/Config.h"
 
 #include <vector>
+#include <iterator>
 
 #include "game/Simulation.h"
 #include "game/SimEntity.h"
@@ -17,6 +19,9 @@ namespace OpenNero
     /// Constructor - initialize variables
     Simulation::Simulation( const IrrHandles& irr )
         : mIrr(irr)
+        , mTicking(false)
+        , mClearPending(false)
+        , mSceneVersion(0)
         , mMaxId(kFirstSimId)
         , mFrameDelay(GetAppConfig().FrameDelay)
     {
@@ -47,6 +52,8 @@ namespace OpenNero
         mSimIdHashedEntities[ ent->GetSimId() ] = ent;
         mEntities.insert(ent);
         mEntitiesAdded.push_back(ent);
+        mPendingAdds.push_back(ent);
+        mSpatialIndex.Insert(ent);
         uint32_t ent_type = ent->GetType();
         for (size_t i = 0; i < sizeof(uint32_t); ++i) {
             uint32_t t = 1 << i;
@@ -71,6 +78,7 @@ namespace OpenNero
         }
         
         GetCollisionTriangleSelector(ent_type);
+        InvalidateCollisionBVHs();
         AssertMsg( Find(ent->GetSimId()) == ent, "The entity with id " << ent->GetSimId() << " could not be properly added" );
     }
 
@@ -82,8 +90,9 @@ namespace OpenNero
     void Simulation::Remove( SimId id )
     {
         SimEntityPtr ent = Find(id);
-        if (ent) {
+        if (ent && !ent->IsRemoved()) {
             ent->SetRemoved();
+            mPendingRemovals.push_back(ent);
         }
     }
 
@@ -98,6 +107,20 @@ namespace OpenNero
         // clear out iteration order list
         mEntities.clear();
 
+        // clear out the tick array - if we are in the middle of a tick, 
+        // wait until the tick boundary to do so
+        if (mTicking) {
+            mClearPending = true;
+        } else {
+            mTickEntities.clear();
+        }
+        mPendingAdds.clear();
+        mPendingRemovals.clear();
+        mEntitiesAdded.clear();
+
+        // clear out the spatial index
+        mSpatialIndex.Clear();
+
         // clear out triangle selector cache
         {
             hash_map<uint32_t, IMetaTriangleSelector_IPtr>::iterator iter;
@@ -105,6 +128,7 @@ namespace OpenNero
                 iter->second->removeAllTriangleSelectors();
             }
             mCollisionSelectors.clear();
+            mCollisionBVHs.clear();
         }
 
         // clear out type set cache
@@ -142,108 +166,291 @@ namespace OpenNero
     /// move the simulation forward by time dt
     void Simulation::ProcessTick( float32_t dt )
     {
-        // this step will allow mSimIdHashedEntities to be modified during the ticks
-        SimIdHashMap entities_to_tick(mSimIdHashedEntities.begin(), mSimIdHashedEntities.end());
-        SimIdHashMap::const_iterator itr;
+        FlushPendingAdds();
+
+        // entities added or removed during this tick are queued until the 
+        // next tick boundary, so mTickEntities will not change under us
+        mTicking = true;
+        SimEntityVector::const_iterator itr;
         
         // render all objects
-        for(itr = entities_to_tick.begin() ; itr != entities_to_tick.end(); ++itr ) {
-			SimEntityPtr ent = itr->second;
-            if (!ent->IsRemoved()) {
-                ent->BeforeTick(dt);
-                ent->TickScene(dt);
+        {
+            PROFILE_ZONE("Simulation::TickScene");
+            for(itr = mTickEntities.begin() ; itr != mTickEntities.end(); ++itr ) {
+                const SimEntityPtr& ent = *itr;
+                if (!ent->IsRemoved()) {
+                    ent->BeforeTick(dt);
+                    ent->TickScene(dt);
+                }
             }
         }
         
         // make AI decisions
         if (AIManager::instance().IsEnabled())
         {
-            for(itr = entities_to_tick.begin() ; itr != entities_to_tick.end(); ++itr ) {
-                SimEntityPtr ent = itr->second;
-                if (!ent->IsRemoved()) {
-                    ent->TickAI(dt);
+            PROFILE_ZONE("Simulation::TickAI");
+            {
+                // index the positions the sensors will see, including the 
+                // entities that have been added since the tick started
+                PROFILE_ZONE("SpatialIndex::Rebuild");
+                mSpatialIndex.Rebuild(mTickEntities);
+                for(itr = mPendingAdds.begin() ; itr != mPendingAdds.end(); ++itr ) {
+                    mSpatialIndex.Insert(*itr);
+                }
+            }
+
+            SimEntityList::const_iterator added_itr = mEntitiesAdded.begin();
+            ThreadPoolPtr pool = AIManager::instance().GetThreadPool();
+            if (pool) {
+                added_itr = TickAIInParallel(dt, *pool);
+            } else {
+                for(itr = mTickEntities.begin() ; itr != mTickEntities.end(); ++itr ) {
+                    const SimEntityPtr& ent = *itr;
+                    if (!ent->IsRemoved()) {
+                        ent->TickAI(dt);
+                        mSpatialIndex.Update(ent);
+                    }
                 }
             }
-            SimEntityList::const_iterator added_itr;
             
             // iterate over the freshly added entities as well to ensure that they move if they need to
-            for (added_itr = mEntitiesAdded.begin(); added_itr != mEntitiesAdded.end(); ++added_itr)
+            for ( ; added_itr != mEntitiesAdded.end(); ++added_itr)
             {
                 SimEntityPtr ent = *added_itr;
                 if (!ent->IsRemoved())
                 {
                     ent->BeforeTick(dt);
                     ent->TickAI(dt);
+                    mSpatialIndex.Update(ent);
                 }
             }
         }                
         
         mEntitiesAdded.clear();
         
-        // iterate over all the entities deleting those marked for removal
-        for (itr = entities_to_tick.begin(); itr != entities_to_tick.end(); ++itr) {
-            SimId id = itr->first;
-            SimEntityPtr ent = itr->second;
-            if (ent->IsRemoved()) {
-                SimIdHashMap::iterator simItr = mSimIdHashedEntities.find(id);
-                
-                if( simItr != mSimIdHashedEntities.end() ) {
-                    SimEntityPtr simE = simItr->second;
-					AIObjectPtr brain = simE->GetAIObject();
-					if (brain) {
-						brain->getBrain()->destroy();
-					}
-                    AssertMsg( simE, "Invalid SimEntity on delete, id: " << id );
-                    // remove also from entities set
-                    SimEntitySet::iterator simInSet = mEntities.find(simE);
-                    if (simInSet != mEntities.end()) {
-                        mEntities.erase(simInSet);
-                    }
-                    
-                    // remove also from the type-indexed set
-                    uint32_t ent_type = simE->GetType();
-                    for (size_t i = 0; i < sizeof(uint32_t); ++i) {
-                        uint32_t t = 1 << i;
-                        if (t > ent_type) break; // shortcut
-                        if (ent_type & t) {
-                            simInSet = mEntityTypes[t].find(simE);
-                            if (simInSet != mEntityTypes[t].end()) {
-                                mEntityTypes[t].erase(simE);
-                            }
-                        }
-                    }
+        {
+            // delete the entities marked for removal
+            PROFILE_ZONE("Simulation::FlushPendingRemovals");
+            FlushPendingRemovals();
+        }
 
-                    { // also make sure to remove the triangle selector for this object from 
-                      // all relevant meta selectors
-                        hash_map<uint32_t, IMetaTriangleSelector_IPtr>::iterator iter;
-                        for (iter = mCollisionSelectors.begin(); iter != mCollisionSelectors.end(); ++iter) {
-                            // if the entity type matches the stored mask
-                            if (iter->first & ent_type) {
-                                // remove the triangles from that selector
-                                iter->second->removeTriangleSelector(ent->GetSceneObject()->GetTriangleSelector().get());
-                            }
-                        }
-                    }
+        mTicking = false;
+    }
+    
+    namespace
+    {
+        /// makes the decision of one of the agents in a list
+        struct DecideTask
+        {
+            const std::vector<AIObjectPtr>& agents;
+            float32_t dt;
+            DecideTask(const std::vector<AIObjectPtr>& a, float32_t t) : agents(a), dt(t) {}
+            void operator()(size_t i) const { PROFILE_ZONE("AIObject::Decide"); agents[i]->Decide(dt); }
+        };
+    }
 
-                    mSimIdHashedEntities.erase(simItr);
+    /**
+     * Tick the AI of the entities in the tick array and of the ones added so far
+     * during this tick, making the decisions of C++ brains on the thread pool.
+     * All of the agents sense the world first, one after another on this thread
+     * since sensors and environments may be implemented in Python. Nothing 
+     * moves until all of the decisions are made, so the decisions see a frozen
+     * snapshot of the world. Python brains decide on this thread, the rest on
+     * the pool. Finally the actions are applied through Environment::step in the
+     * tick order, same as in the serial AI phase.
+     * @return the first entity added during this tick that still needs its AI ticked
+     */
+    SimEntityList::const_iterator Simulation::TickAIInParallel( float32_t dt, ThreadPool& pool )
+    {
+        mAITickEntities.clear();
+        SimEntityVector::const_iterator itr;
+        for(itr = mTickEntities.begin() ; itr != mTickEntities.end(); ++itr ) {
+            if (!(*itr)->IsRemoved()) {
+                mAITickEntities.push_back(*itr);
+            }
+        }
+        SimEntityList::const_iterator added_itr;
+        size_t num_added = mEntitiesAdded.size();
+        for (added_itr = mEntitiesAdded.begin(); added_itr != mEntitiesAdded.end(); ++added_itr) {
+            if (!(*added_itr)->IsRemoved()) {
+                (*added_itr)->BeforeTick(dt);
+                mAITickEntities.push_back(*added_itr);
+            }
+        }
+
+        // sense, and make the decisions that need the interpreter lock
+        mAIActing.clear();
+        mAIDeciding.clear();
+        {
+            PROFILE_ZONE("Simulation::SenseAndDecideSerially");
+            for(itr = mAITickEntities.begin() ; itr != mAITickEntities.end(); ++itr ) {
+                AIObjectPtr ai = (*itr)->GetAIObject();
+                if (ai && !(*itr)->IsRemoved() && ai->BeginTick(dt)) {
+                    mAIActing.push_back(*itr);
+                    if (ai->CanDecideInParallel()) {
+                        mAIDeciding.push_back(ai);
+                    } else {
+                        ai->Decide(dt);
+                    }
                 }
+            }
+        }
 
-                AssertMsg( !Find(id), "Did not properly remove entity from simulation!" );
+        {
+            // make all the other decisions in parallel
+            PROFILE_ZONE("Simulation::DecideInParallel");
+            pool.ParallelFor(mAIDeciding.size(), DecideTask(mAIDeciding, dt));
+        }
+
+        {
+            // act in order, skipping the entities that an earlier agent's
+            // action removed, as the serial AI phase does
+            PROFILE_ZONE("Simulation::Act");
+            for(itr = mAIActing.begin() ; itr != mAIActing.end(); ++itr ) {
+                if (!(*itr)->IsRemoved()) {
+                    (*itr)->GetAIObject()->FinishTick(dt);
+                }
+            }
+            for(itr = mAITickEntities.begin() ; itr != mAITickEntities.end(); ++itr ) {
+                if (!(*itr)->IsRemoved()) {
+                    mSpatialIndex.Update(*itr);
+                }
             }
         }
+
+        mAITickEntities.clear();
+        mAIActing.clear();
+        mAIDeciding.clear();
+        
+        // entities added while we were busy are ticked the serial way
+        added_itr = mEntitiesAdded.begin();
+        std::advance(added_itr, num_added);
+        return added_itr;
     }
     
     void Simulation::ProcessAnimationTick( float32_t frac )
     {
-        // this step will allow mSimIdHashedEntities to be modified during the ticks
-        SimIdHashMap entities_to_tick(mSimIdHashedEntities.begin(), mSimIdHashedEntities.end());
-        SimIdHashMap::const_iterator itr = entities_to_tick.begin();
-        SimIdHashMap::const_iterator end = entities_to_tick.end();
+        FlushPendingAdds();
+
+        mTicking = true;
+        SimEntityVector::const_iterator itr = mTickEntities.begin();
+        SimEntityVector::const_iterator end = mTickEntities.end();
         
         for( ; itr != end; ++itr ) {
-			SimEntityPtr ent = itr->second;
-            ent->ProcessAnimationTick(frac); // tick only if not removed
+            (*itr)->ProcessAnimationTick(frac); // tick only if not removed
+        }
+
+        if (mClearPending) {
+            mTickEntities.clear();
+            mClearPending = false;
         }
+        mTicking = false;
+    }
+
+    /// move entities added since the last tick boundary into the tick array
+    void Simulation::FlushPendingAdds()
+    {
+        if (mClearPending) {
+            mTickEntities.clear();
+            mClearPending = false;
+        }
+        mTickEntities.insert(mTickEntities.end(), mPendingAdds.begin(), mPendingAdds.end());
+        mPendingAdds.clear();
+    }
+
+    /**
+     * Remove the entities marked for removal that were ticked this time around.
+     * Entities that were added during this tick stay queued until the end of the
+     * next one, same as the ones marked while we were busy removing.
+     */
+    void Simulation::FlushPendingRemovals()
+    {
+        if (mClearPending) {
+            // everything in the tick array is gone already
+            mTickEntities.clear();
+            mClearPending = false;
+        }
+
+        if (mPendingRemovals.empty()) {
+            return;
+        }
+
+        // compact the tick array in place, preserving the iteration order
+        SimEntityVector::iterator write = mTickEntities.begin();
+        for (SimEntityVector::iterator read = mTickEntities.begin(); read != mTickEntities.end(); ++read) {
+            if ((*read)->IsRemoved()) {
+                RemoveNow(*read);
+            } else {
+                if (write != read) {
+                    *write = *read;
+                }
+                ++write;
+            }
+        }
+        mTickEntities.erase(write, mTickEntities.end());
+
+        // keep the removals of entities that are still around for the next tick
+        SimEntityVector::iterator keep = mPendingRemovals.begin();
+        for (SimEntityVector::iterator iter = mPendingRemovals.begin(); iter != mPendingRemovals.end(); ++iter) {
+            if (Find((*iter)->GetSimId()) == *iter) {
+                *keep++ = *iter;
+            }
+        }
+        mPendingRemovals.erase(keep, mPendingRemovals.end());
+    }
+
+    /// remove an entity from all of the simulation containers right away
+    void Simulation::RemoveNow( SimEntityPtr ent )
+    {
+        SimId id = ent->GetSimId();
+        SimIdHashMap::iterator simItr = mSimIdHashedEntities.find(id);
+        
+        if( simItr != mSimIdHashedEntities.end() ) {
+            SimEntityPtr simE = simItr->second;
+            AssertMsg( simE, "Invalid SimEntity on delete, id: " << id );
+            AIObjectPtr brain = simE->GetAIObject();
+            if (brain) {
+                brain->getBrain()->destroy();
+            }
+            // remove also from entities set
+            SimEntitySet::iterator simInSet = mEntities.find(simE);
+            if (simInSet != mEntities.end()) {
+                mEntities.erase(simInSet);
+            }
+            
+            // remove also from the spatial index
+            mSpatialIndex.Remove(simE);
+
+            // remove also from the type-indexed set
+            uint32_t ent_type = simE->GetType();
+            for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+                uint32_t t = 1 << i;
+                if (t > ent_type) break; // shortcut
+                if (ent_type & t) {
+                    simInSet = mEntityTypes[t].find(simE);
+                    if (simInSet != mEntityTypes[t].end()) {
+                        mEntityTypes[t].erase(simE);
+                    }
+                }
+            }
+
+            { // also make sure to remove the triangle selector for this object from 
+              // all relevant meta selectors
+                hash_map<uint32_t, IMetaTriangleSelector_IPtr>::iterator iter;
+                for (iter = mCollisionSelectors.begin(); iter != mCollisionSelectors.end(); ++iter) {
+                    // if the entity type matches the stored mask
+                    if (iter->first & ent_type) {
+                        // remove the triangles from that selector
+                        iter->second->removeTriangleSelector(ent->GetSceneObject()->GetTriangleSelector().get());
+                    }
+                }
+            }
+
+            mSimIdHashedEntities.erase(simItr);
+            InvalidateCollisionBVHs();
+        }
+
+        AssertMsg( !Find(id), "Did not properly remove entity from simulation!" );
     }
     
     const SimEntitySet Simulation::GetEntities(size_t types) const
@@ -262,6 +469,12 @@ namespace OpenNero
         return result;
     }
     
+    /// Get the entities of the specified type within radius of a point
+    void Simulation::GetEntitiesInRadius( const Vector3f& center, float32_t radius, size_t types, SimEntityVector& result ) const
+    {
+        mSpatialIndex.Query(center, radius, types, result);
+    }
+
     /// get a triangle selector for all the objects matching the types mask
     IMetaTriangleSelector_IPtr Simulation::GetCollisionTriangleSelector( size_t types )
     {
@@ -294,5 +507,49 @@ namespace OpenNero
         return meta_selector;
     }
 
+    /**
+     * Get a bounding volume hierarchy over the triangles that the collision
+     * triangle selector for the types mask would return, in Irrlicht world 
+     * coordinates and tagged with the SimId of their owners. The hierarchy is
+     * rebuilt lazily the first time it is needed after the scene moves.
+     */
+    const CollisionBVH& Simulation::GetCollisionBVH( size_t types )
+    {
+        VersionedBVH& cached = mCollisionBVHs[types];
+        if (cached.second && cached.first == mSceneVersion) {
+            return *cached.second;
+        }
+        if (!cached.second) {
+            cached.second.reset(new CollisionBVH());
+        }
+        cached.first = mSceneVersion;
+
+        CollisionBVH& bvh = *cached.second;
+        bvh.Clear();
+        IMetaTriangleSelector_IPtr meta_selector = GetCollisionTriangleSelector(types);
+        for (u32 i = 0; i < meta_selector->getSelectorCount(); ++i) {
+            const ITriangleSelector* selector = meta_selector->getSelector(i);
+            ISceneNode* node = selector->getSceneNodeForTriangle(0);
+            // invisible nodes are not hit by rays
+            if (!node || !node->isVisible()) {
+                continue;
+            }
+            SimId owner = ConvertSceneIdToSimId(node->getID());
+            s32 count = selector->getTriangleCount();
+            if (count <= 0) {
+                continue;
+            }
+            mTriangleBuffer.resize(count);
+            s32 out_count = 0;
+            selector->getTriangles(&mTriangleBuffer[0], count, out_count);
+            for (s32 j = 0; j < out_count; ++j) {
+                bvh.AddTriangle(mTriangleBuffer[j], owner);
+            }
+        }
+        bvh.Build();
+        LOG_F_DEBUG("collision", "built ray-casting hierarchy for mask " 
+            << types << " with: " << bvh.GetTriangleCount() << " triangles");
+        return bvh;
+    }
 
 } //end OpenNero
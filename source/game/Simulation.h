@@ -7,6 +7,8 @@
 #include "core/Common.h"
 #include "core/IrrUtil.h"
 #include "game/SimEntity.h"
+#include "game/SpatialIndex.h"
+#include "game/CollisionBVH.h"
 #include "render/SceneObject.h"
 
 namespace OpenNero
@@ -15,6 +17,7 @@ namespace OpenNero
     BOOST_SHARED_DECL( SimEntity );
     BOOST_SHARED_DECL( Environment );
     BOOST_SHARED_DECL( Simulation );
+    BOOST_SHARED_DECL( ThreadPool );
     /// @endcond
 
     /// The Simulation manages every object in the game that needs to be updated in any sort of way (local or remote).
@@ -57,6 +60,13 @@ namespace OpenNero
         /// Get the set of all the entities of the specified type
         const SimEntitySet GetEntities( size_t types ) const;
 
+        /// Get the entities of the specified type within radius of a point
+        /// @param center the point to search around
+        /// @param radius the distance from center to search within
+        /// @param types the type mask of the entities to find
+        /// @param result vector to append the entities to
+        void GetEntitiesInRadius( const Vector3f& center, float32_t radius, size_t types, SimEntityVector& result ) const;
+
         /// Get the next free SimId
         SimId ReserveNewId() { mMaxId += 1; return mMaxId; }
 
@@ -77,6 +87,26 @@ namespace OpenNero
         /// get a triangle selector for all the objects matching the types mask
         IMetaTriangleSelector_IPtr GetCollisionTriangleSelector( size_t types );
 
+        /// get a ray-casting hierarchy over the triangles of the objects matching the types mask
+        const CollisionBVH& GetCollisionBVH( size_t types );
+
+        /// mark the ray-casting hierarchies out of date (the scene has moved)
+        void InvalidateCollisionBVHs() { ++mSceneVersion; }
+
+    protected:
+
+        /// move entities added since the last tick boundary into the tick array
+        void FlushPendingAdds();
+
+        /// remove the entities marked for removal from the tick array
+        void FlushPendingRemovals();
+
+        /// remove an entity from all of the simulation containers right away
+        void RemoveNow( SimEntityPtr ent );
+
+        /// tick the AI of the entities, making the decisions on the thread pool
+        SimEntityList::const_iterator TickAIInParallel( float32_t dt, ThreadPool& pool );
+
     protected:
 
         /// hash map of SimEntities indexed by SimId
@@ -95,11 +125,39 @@ namespace OpenNero
 
         SimEntityList       mEntitiesAdded;         ///< Entities are added to this list at first, so that they can be ticked immediately
 
+        SimEntityVector     mTickEntities;          ///< Dense array of the entities to tick, only modified at tick boundaries
+
+        SimEntityVector     mPendingAdds;           ///< Entities added since the last tick boundary
+
+        SimEntityVector     mPendingRemovals;       ///< Entities marked for removal but not yet removed
+
+        bool                mTicking;               ///< Are we currently iterating over mTickEntities?
+
+        bool                mClearPending;          ///< Was clear() called while we were ticking?
+
         hash_map<uint32_t, SimEntitySet> mEntityTypes; ///< entity sets by type
 
+        SimEntityVector     mAITickEntities;        ///< scratch space for the parallel AI phase: entities to tick
+
+        SimEntityVector     mAIActing;              ///< scratch space for the parallel AI phase: entities whose agents act this tick
+
+        std::vector<AIObjectPtr> mAIDeciding;       ///< scratch space for the parallel AI phase: agents that decide on the pool
+
+        SpatialIndex        mSpatialIndex;          ///< entities bucketed by position for proximity queries
+
         /// the triangle selectors for objects to collide with (by type)
         mutable hash_map<uint32_t, IMetaTriangleSelector_IPtr> mCollisionSelectors;
 
+        /// a ray-casting hierarchy along with the scene version it was built for
+        typedef std::pair<uint32_t, CollisionBVHPtr> VersionedBVH;
+
+        /// the ray-casting hierarchies for objects to collide with (by type)
+        hash_map<uint32_t, VersionedBVH> mCollisionBVHs;
+
+        uint32_t            mSceneVersion;          ///< incremented every time the scene moves
+
+        std::vector<Triangle3f> mTriangleBuffer;    ///< scratch space for building the hierarchies
+
         EnvironmentPtr      mWorld;                 ///< The AI World interface
 
         SimId               mMaxId;                 ///< The maximum id of the objects in the simulation
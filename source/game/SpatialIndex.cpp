@@ -0,0 +1,181 @@
+//--------------------------------------------------------
+// OpenNero : SpatialIndex
+//  uniform grid of sim entities for proximity queries
+//--------------------------------------------------------
+
+#include "core/Common.h"
+#include "game/SpatialIndex.h"
+
+#include <cmath>
+
+namespace OpenNero
+{
+    const float32_t SpatialIndex::kDefaultCellSize = 50.0f;
+
+    /// Constructor
+    SpatialIndex::SpatialIndex( float32_t cellSize )
+        : mCellSize(cellSize)
+    {
+        AssertMsg( cellSize > 0, "Spatial index cell size must be positive" );
+    }
+
+    /// remove all the entities from the index
+    void SpatialIndex::Clear()
+    {
+        mCells.clear();
+        mEntityCells.clear();
+    }
+
+    /**
+     * Re-index all of the entities from scratch. The cells keep their storage
+     * from tick to tick, so that this does not allocate once the grid has
+     * settled down.
+     * @param entities the entities to index
+     */
+    void SpatialIndex::Rebuild( const SimEntityVector& entities )
+    {
+        CellMap::iterator cell_iter;
+        for (cell_iter = mCells.begin(); cell_iter != mCells.end(); ++cell_iter) {
+            cell_iter->second.entries.clear();
+            cell_iter->second.types = 0;
+        }
+
+        SimEntityVector::const_iterator iter;
+        for (iter = entities.begin(); iter != entities.end(); ++iter) {
+            const SimEntityPtr& ent = *iter;
+            if (ent->IsRemoved()) {
+                continue;
+            }
+            CellKey key = KeyOf(ent->GetPosition());
+            Cell& cell = mCells[key];
+            cell.entries.push_back(Entry(ent, ent->GetType()));
+            cell.types |= ent->GetType();
+            mEntityCells[ent->GetSimId()] = key;
+        }
+    }
+
+    /// add an entity at its current position
+    void SpatialIndex::Insert( const SimEntityPtr& ent )
+    {
+        CellKey key = KeyOf(ent->GetPosition());
+        Cell& cell = mCells[key];
+        cell.entries.push_back(Entry(ent, ent->GetType()));
+        cell.types |= ent->GetType();
+        mEntityCells[ent->GetSimId()] = key;
+    }
+
+    /// remove an entity from the index
+    void SpatialIndex::Remove( const SimEntityPtr& ent )
+    {
+        EntityCellMap::iterator found = mEntityCells.find(ent->GetSimId());
+        if (found == mEntityCells.end()) {
+            return;
+        }
+        CellMap::iterator cell_iter = mCells.find(found->second);
+        if (cell_iter != mCells.end()) {
+            std::vector<Entry>& entries = cell_iter->second.entries;
+            for (size_t i = 0; i < entries.size(); ++i) {
+                if (entries[i].ent == ent) {
+                    entries[i] = entries.back();
+                    entries.pop_back();
+                    break;
+                }
+            }
+        }
+        mEntityCells.erase(found);
+    }
+
+    /// move an entity to the cell of its current position
+    void SpatialIndex::Update( const SimEntityPtr& ent )
+    {
+        EntityCellMap::iterator found = mEntityCells.find(ent->GetSimId());
+        if (found == mEntityCells.end()) {
+            return;
+        }
+        CellKey key = KeyOf(ent->GetPosition());
+        if (key == found->second) {
+            // same cell, but the type might have changed
+            Cell& cell = mCells[key];
+            for (size_t i = 0; i < cell.entries.size(); ++i) {
+                if (cell.entries[i].ent == ent) {
+                    cell.entries[i].type = ent->GetType();
+                    break;
+                }
+            }
+            cell.types |= ent->GetType();
+        } else {
+            Remove(ent);
+            Insert(ent);
+        }
+    }
+
+    /**
+     * Find the entities whose type matches the mask and whose current position
+     * is within radius of center. Candidates come from the cells overlapping the
+     * bounding square of the query, so the index only needs to be as fresh as
+     * the cell an entity is in.
+     */
+    void SpatialIndex::Query( const Vector3f& center, float32_t radius, uint32_t types, SimEntityVector& result ) const
+    {
+        int32_t gx0 = ToGrid(center.X - radius);
+        int32_t gx1 = ToGrid(center.X + radius);
+        int32_t gy0 = ToGrid(center.Y - radius);
+        int32_t gy1 = ToGrid(center.Y + radius);
+        float32_t radius_sq = radius * radius;
+
+        size_t num_cells = size_t(gx1 - gx0 + 1) * size_t(gy1 - gy0 + 1);
+        if (num_cells > mCells.size()) {
+            // the query covers more cells than we have, so just look at all of them
+            CellMap::const_iterator cell_iter;
+            for (cell_iter = mCells.begin(); cell_iter != mCells.end(); ++cell_iter) {
+                int32_t gx = int32_t(cell_iter->first >> 32);
+                int32_t gy = int32_t(cell_iter->first & 0xffffffff);
+                if (gx >= gx0 && gx <= gx1 && gy >= gy0 && gy <= gy1) {
+                    QueryCell(cell_iter->second, center, radius_sq, types, result);
+                }
+            }
+        } else {
+            for (int32_t gx = gx0; gx <= gx1; ++gx) {
+                for (int32_t gy = gy0; gy <= gy1; ++gy) {
+                    CellMap::const_iterator cell_iter = mCells.find(MakeKey(gx, gy));
+                    if (cell_iter != mCells.end()) {
+                        QueryCell(cell_iter->second, center, radius_sq, types, result);
+                    }
+                }
+            }
+        }
+    }
+
+    /// append the matching entities from a cell to result
+    void SpatialIndex::QueryCell( const Cell& cell, const Vector3f& center, float32_t radius_sq, uint32_t types, SimEntityVector& result ) const
+    {
+        if (!(cell.types & types)) {
+            return;
+        }
+        std::vector<Entry>::const_iterator iter;
+        for (iter = cell.entries.begin(); iter != cell.entries.end(); ++iter) {
+            if ((iter->type & types) && iter->ent->GetPosition().getDistanceFromSQ(center) <= radius_sq) {
+                result.push_back(iter->ent);
+            }
+        }
+    }
+
+    /// grid coordinate along an axis
+    int32_t SpatialIndex::ToGrid( float32_t coord ) const
+    {
+        return int32_t(std::floor(coord / mCellSize));
+    }
+
+    /// pack grid coordinates into a key
+    SpatialIndex::CellKey SpatialIndex::MakeKey( int32_t gx, int32_t gy )
+    {
+        return (CellKey(uint32_t(gx)) << 32) | CellKey(uint32_t(gy));
+    }
+
+    /// the key of the cell containing position
+    SpatialIndex::CellKey SpatialIndex::KeyOf( const Vector3f& pos ) const
+    {
+        return MakeKey(ToGrid(pos.X), ToGrid(pos.Y));
+    }
+
+} //end OpenNero
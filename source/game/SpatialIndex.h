@@ -0,0 +1,102 @@
+//--------------------------------------------------------
+// OpenNero : SpatialIndex
+//  uniform grid of sim entities for proximity queries
+//--------------------------------------------------------
+
+#ifndef _GAME_SPATIAL_INDEX_H_
+#define _GAME_SPATIAL_INDEX_H_
+
+#include <vector>
+#include "core/HashMap.h"
+#include "core/ONTypes.h"
+#include "core/IrrUtil.h"
+#include "game/SimEntity.h"
+
+namespace OpenNero
+{
+    /// A uniform grid over the horizontal (x-y) plane that buckets sim entities
+    /// by position so that sensors only need to look at the entities near them.
+    /// Each entry remembers the type mask of its entity, so that queries can be
+    /// restricted to the types a sensor is interested in.
+    class SpatialIndex
+    {
+    public:
+
+        /// the default side length of a grid cell
+        static const float32_t kDefaultCellSize;
+
+        /// Constructor
+        /// @param cellSize the side length of a grid cell
+        explicit SpatialIndex( float32_t cellSize = kDefaultCellSize );
+
+        /// remove all the entities from the index
+        void Clear();
+
+        /// re-index all of the entities from scratch
+        void Rebuild( const SimEntityVector& entities );
+
+        /// add an entity at its current position
+        void Insert( const SimEntityPtr& ent );
+
+        /// remove an entity from the index
+        void Remove( const SimEntityPtr& ent );
+
+        /// move an entity to the cell of its current position
+        void Update( const SimEntityPtr& ent );
+
+        /// find the entities matching the types mask within radius of center
+        /// @param center the center of the query sphere
+        /// @param radius the radius of the query sphere
+        /// @param types the type mask of the entities to return
+        /// @param result vector to append the matching entities to
+        void Query( const Vector3f& center, float32_t radius, uint32_t types, SimEntityVector& result ) const;
+
+    private:
+
+        /// packed (x,y) grid coordinates of a cell
+        typedef uint64_t CellKey;
+
+        /// an indexed entity along with its type
+        struct Entry
+        {
+            SimEntityPtr ent;   ///< the indexed entity
+            uint32_t type;      ///< the type mask of the entity when it was indexed
+            Entry( const SimEntityPtr& e, uint32_t t ) : ent(e), type(t) {}
+        };
+
+        /// the contents of a grid cell
+        struct Cell
+        {
+            std::vector<Entry> entries; ///< the entities in this cell
+            uint32_t types;             ///< union of the types of the entities in this cell
+            Cell() : types(0) {}
+        };
+
+        /// grid cells by coordinates
+        typedef hash_map< CellKey, Cell > CellMap;
+
+        /// cell coordinates of the indexed entities
+        typedef hash_map< SimId, CellKey > EntityCellMap;
+
+        /// grid coordinate along an axis
+        int32_t ToGrid( float32_t coord ) const;
+
+        /// pack grid coordinates into a key
+        static CellKey MakeKey( int32_t gx, int32_t gy );
+
+        /// the key of the cell containing position
+        CellKey KeyOf( const Vector3f& pos ) const;
+
+        /// append the matching entities from a cell to result
+        void QueryCell( const Cell& cell, const Vector3f& center, float32_t radius_sq, uint32_t types, SimEntityVector& result ) const;
+
+    private:
+
+        float32_t       mCellSize;      ///< side length of a grid cell
+        CellMap         mCells;         ///< the grid cells
+        EntityCellMap   mEntityCells;   ///< which cell each entity is in
+    };
+
+} //end OpenNero
+
+#endif // _GAME_SPATIAL_INDEX_H_
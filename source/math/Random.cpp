@@ -14,10 +14,10 @@ namespace OpenNero
 {   
     using namespace boost;
 
-    RandomNumberGenerator::RandomNumberGenerator() : _randomness()    {
+    RandomNumberGenerator::RandomNumberGenerator() : _randomness(), _lock()    {
     }
 
-    RandomNumberGenerator::RandomNumberGenerator( const boost::uint32_t& seed ) : _randomness(seed)
+    RandomNumberGenerator::RandomNumberGenerator( const boost::uint32_t& seed ) : _randomness(seed), _lock()
     {
     }
     
@@ -31,37 +31,44 @@ namespace OpenNero
 
     uint32_t  RandomNumberGenerator::randI() const 
     {
+        boost::mutex::scoped_lock lock(_lock);
         return generate<boost::uniform_int<uint32_t>, uint32_t>(_randomness, 1);
     }
     
     uint32_t  RandomNumberGenerator::randI(const uint32_t& n) const 
     {
+        boost::mutex::scoped_lock lock(_lock);
         return generate<boost::uniform_int<uint32_t>, uint32_t>(_randomness, n);
     }
 
     float32_t RandomNumberGenerator::randF() const
     {
+        boost::mutex::scoped_lock lock(_lock);
         return generate<boost::uniform_real<float32_t>, float32_t>(_randomness, 1);
     }
 
     float32_t RandomNumberGenerator::randF(const float32_t& n) const
     {
+        boost::mutex::scoped_lock lock(_lock);
         return generate<boost::uniform_real<float32_t>, float32_t>(_randomness, n);
     }
 
     double    RandomNumberGenerator::randD() const
     {
+        boost::mutex::scoped_lock lock(_lock);
         return generate<boost::uniform_real<float32_t>, float32_t>(_randomness, 1);
     }
     
     double    RandomNumberGenerator::randD(const double& n) const
     {
+        boost::mutex::scoped_lock lock(_lock);
         return generate<boost::uniform_real<double>, double>(_randomness, n);
     }
     
     /// normal real number with mean and variance
     float32_t    RandomNumberGenerator::normalF(const float32_t& mu, const float32_t& sigma) const
     {
+        boost::mutex::scoped_lock lock(_lock);
         normal_distribution<float32_t> dist(mu, sigma);
         boost::variate_generator<boost::mt19937&, normal_distribution<float32_t> > vg(_randomness, dist);
         return vg();
@@ -70,6 +77,7 @@ namespace OpenNero
     /// normal real number with mean and variance
     double       RandomNumberGenerator::normalD(const double& mu, const double& sigma) const
     {
+        boost::mutex::scoped_lock lock(_lock);
         normal_distribution<double> dist(mu, sigma);
         boost::variate_generator<boost::mt19937&, normal_distribution<double> > vg(_randomness, dist);
         return vg();
@@ -10,10 +10,11 @@
 #include "core/Common.h"
 #include "core/ONTypes.h"
 #include <boost/random/mersenne_twister.hpp>
+#include <boost/thread/mutex.hpp>
 
 namespace OpenNero 
 {
-    /// Custom random number generator
+    /// Custom random number generator (safe to share between threads)
     class RandomNumberGenerator
     {
     public:
@@ -38,10 +39,12 @@ namespace OpenNero
         /// normal real number with mean and deviation
         double       normalD(const double& mu, const double& sigma) const;
         /// seed with a value
-        void seed(const boost::uint32_t& seed) { _randomness.seed(seed); }
+        void seed(const boost::uint32_t& seed) { boost::mutex::scoped_lock lock(_lock); _randomness.seed(seed); }
     private:
         /// random number generator
         mutable boost::mt19937 _randomness;
+        /// serializes access to the generator from agents deciding in parallel
+        mutable boost::mutex _lock;
     };
     
     extern RandomNumberGenerator RANDOM;
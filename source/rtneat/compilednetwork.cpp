@@ -0,0 +1,402 @@
+#include "core/Common.h"
+#include <map>
+#include <cmath>
+#include <algorithm>
+#include <boost/functional/hash.hpp>
+
+#include "compilednetwork.h"
+
+using namespace NEAT;
+using namespace std;
+
+CompiledNetworkPtr CompiledNetwork::compile(const vector<NNodePtr> &all_nodes)
+{
+    CompiledNetworkPtr net(new CompiledNetwork());
+    size_t n = all_nodes.size();
+
+    // number the nodes in the order in which they are activated
+    map<const NNode*, U32> index;
+    for (size_t i = 0; i < n; ++i)
+    {
+        index[all_nodes[i].get()] = static_cast<U32>(i);
+    }
+
+    net->first_link.reserve(n + 1);
+    net->sensor.resize(n);
+    net->ftype.resize(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        const NNodePtr& node = all_nodes[i];
+        net->first_link.push_back(static_cast<U32>(net->links.size()));
+        net->sensor[i] = (node->type == SENSOR);
+        net->ftype[i] = node->ftype;
+
+        // SENSORS ignore their incoming links
+        if (node->type == SENSOR)
+            continue;
+
+        vector<LinkPtr>::const_iterator curlink;
+        for (curlink = node->incoming.begin(); curlink != node->incoming.end(); ++curlink)
+        {
+            map<const NNode*, U32>::const_iterator src = index.find((*curlink)->get_in_node().get());
+            if (src == index.end())
+                return CompiledNetworkPtr();
+            Connection c;
+            c.src = src->second;
+            c.weight = (*curlink)->weight;
+            c.time_delay = (*curlink)->time_delay;
+            net->links.push_back(c);
+        }
+    }
+    net->first_link.push_back(static_cast<U32>(net->links.size()));
+
+    // hash everything but the weights
+    net->signature = 0;
+    boost::hash_combine(net->signature, n);
+    for (size_t i = 0; i < n; ++i)
+    {
+        boost::hash_combine(net->signature, net->first_link[i + 1]);
+        boost::hash_combine(net->signature, static_cast<bool>(net->sensor[i]));
+        boost::hash_combine(net->signature, static_cast<int>(net->ftype[i]));
+    }
+    for (size_t j = 0; j < net->links.size(); ++j)
+    {
+        boost::hash_combine(net->signature, net->links[j].src);
+        boost::hash_combine(net->signature, net->links[j].time_delay);
+    }
+
+    net->activesum.resize(n);
+    net->activation.resize(n);
+    net->last_activation.resize(n);
+    net->last_activation2.resize(n);
+    net->activation_count.resize(n);
+    net->active_flag.resize(n);
+    net->override.resize(n);
+    net->override_value.resize(n);
+
+    return net;
+}
+
+void CompiledNetwork::load_weights(const vector<NNodePtr> &all_nodes)
+{
+    // the links are stored in the same order in which compile() visited them
+    vector<Connection>::iterator c = links.begin();
+    for (size_t i = 0; i < all_nodes.size(); ++i)
+    {
+        if (sensor[i])
+            continue;
+        vector<LinkPtr>::const_iterator curlink;
+        for (curlink = all_nodes[i]->incoming.begin(); curlink != all_nodes[i]->incoming.end(); ++curlink, ++c)
+        {
+            c->weight = (*curlink)->weight;
+        }
+    }
+}
+
+void CompiledNetwork::load_state(const vector<NNodePtr> &all_nodes)
+{
+    for (size_t i = 0; i < all_nodes.size(); ++i)
+    {
+        const NNode& node = *all_nodes[i];
+        activesum[i] = node.activesum;
+        activation[i] = node.activation;
+        last_activation[i] = node.last_activation;
+        last_activation2[i] = node.last_activation2;
+        activation_count[i] = node.activation_count;
+        active_flag[i] = node.active_flag;
+        override[i] = node.override;
+        override_value[i] = node.override_value;
+    }
+}
+
+void CompiledNetwork::store_state(const vector<NNodePtr> &all_nodes) const
+{
+    // activation never changes the state of SENSORS
+    for (size_t i = 0; i < all_nodes.size(); ++i)
+    {
+        if (sensor[i])
+            continue;
+        NNode& node = *all_nodes[i];
+        node.activesum = activesum[i];
+        node.activation = activation[i];
+        node.last_activation = last_activation[i];
+        node.last_activation2 = last_activation2[i];
+        node.activation_count = activation_count[i];
+        node.active_flag = active_flag[i];
+        node.override = override[i];
+    }
+}
+
+// If all nodes are not active then return true
+bool CompiledNetwork::nodesoff() const
+{
+    for (size_t i = 0; i < activation_count.size(); ++i)
+    {
+        if (activation_count[i] == 0)
+            return true;
+    }
+    return false;
+}
+
+// Activates the net such that all outputs are active
+// Returns true on success;
+// This is a transcription of Network::activate for non-adaptable networks
+bool CompiledNetwork::activate(const vector<NNodePtr> &all_nodes)
+{
+    AssertMsg(all_nodes.size() == ftype.size(), "Activating a compiled network of "
+        << ftype.size() << " nodes with " << all_nodes.size() << " nodes");
+
+    load_state(all_nodes);
+
+    size_t n = ftype.size();
+    bool onetime = false; //Make sure we at least activate once
+    S32 abortcount = 0; //Used in case the output is somehow truncated from the network
+    bool success = true;
+
+    while (nodesoff() || !onetime)
+    {
+        ++abortcount;
+
+        if (abortcount == 20)
+        {
+            success = false;
+            break;
+        }
+
+        // For each node, compute the sum of its incoming activation
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (sensor[i])
+                continue;
+
+            F64 sum = 0;
+            bool flag = false;
+            active_flag[i] = false; // a node may feed itself
+            for (U32 j = first_link[i]; j < first_link[i + 1]; ++j)
+            {
+                const Connection& c = links[j];
+                if (!c.time_delay)
+                {
+                    // get_active_out
+                    sum += c.weight * (activation_count[c.src] > 0 ? activation[c.src] : 0.0);
+                    if (active_flag[c.src] || sensor[c.src])
+                        flag = true;
+                }
+                else
+                {
+                    // get_active_out_td
+                    sum += c.weight * (activation_count[c.src] > 1 ? last_activation[c.src] : 0.0);
+                }
+            }
+            activesum[i] = sum;
+            active_flag[i] = flag;
+        }
+
+        // Now activate all the non-sensor nodes off their incoming activation
+        for (size_t i = 0; i < n; ++i)
+        {
+            //Only activate if some active input came in
+            if (sensor[i] || !active_flag[i])
+                continue;
+
+            //Keep a memory of activations for potential time delayed connections
+            last_activation2[i] = last_activation[i];
+            last_activation[i] = activation[i];
+
+            if (override[i])
+            {
+                //Set activation to the override value and turn off override
+                activation[i] = override_value[i];
+                override[i] = false;
+            }
+            else if (ftype[i] == SIGMOID)
+            {
+                activation[i] = fsigmoid(activesum[i], 4.924273, 2.4621365);
+            }
+            else if (ftype[i] == LINEAR)
+            {
+                activation[i] = flinear(activesum[i], 1.0, 0.0);
+            }
+
+            activation_count[i]++;
+        }
+
+        onetime = true;
+    }
+
+    store_state(all_nodes);
+
+    return success;
+}
+
+bool CompiledNetwork::same_topology(const CompiledNetwork &other) const
+{
+    if (signature != other.signature ||
+        first_link != other.first_link ||
+        sensor != other.sensor ||
+        ftype != other.ftype)
+        return false;
+    for (size_t j = 0; j < links.size(); ++j)
+    {
+        if (links[j].src != other.links[j].src ||
+            links[j].time_delay != other.links[j].time_delay)
+            return false;
+    }
+    return true;
+}
+
+bool CompiledNetwork::can_batch(const vector<NNodePtr> &all_nodes) const
+{
+    for (size_t i = 0; i < all_nodes.size(); ++i)
+    {
+        if (all_nodes[i]->activation_count == 0 || all_nodes[i]->override)
+            return false;
+    }
+    return true;
+}
+
+// Activates a group of networks with the same topology.
+// Once all of the nodes of a network have been activated, Network::activate
+// makes exactly one pass over the network.  This does that pass for all the
+// networks in the group at once: the state of node i (or the weight of link
+// j) in network k is kept at [i * B + k], so that the innermost loops run over
+// the networks in contiguous memory and can be vectorized by the compiler.
+void CompiledNetwork::activate_batch(const vector<CompiledNetwork*> &group,
+                                     const vector<const vector<NNodePtr>*> &nodes)
+{
+    if (group.empty())
+        return;
+
+    const CompiledNetwork& topology = *group[0];
+    const size_t B = group.size();
+    const size_t n = topology.ftype.size();
+    const size_t m = topology.links.size();
+
+    vector<F64> weight(m * B);
+    vector<F64> activesum(n * B), activation(n * B), last_activation(n * B), last_activation2(n * B);
+    vector<S32> activation_count(n * B);
+    vector<U8> active_flag(n * B);
+    vector<F64> sum(B), squashed(B);
+
+    // gather the weights and the state of all the networks
+    for (size_t k = 0; k < B; ++k)
+    {
+        AssertMsg(group[k]->same_topology(topology), "Batching networks with different topologies");
+        const vector<Connection>& links = group[k]->links;
+        for (size_t j = 0; j < m; ++j)
+        {
+            weight[j * B + k] = links[j].weight;
+        }
+        const vector<NNodePtr>& all_nodes = *nodes[k];
+        for (size_t i = 0; i < n; ++i)
+        {
+            const NNode& node = *all_nodes[i];
+            activation[i * B + k] = node.activation;
+            last_activation[i * B + k] = node.last_activation;
+            last_activation2[i * B + k] = node.last_activation2;
+            activation_count[i * B + k] = node.activation_count;
+            active_flag[i * B + k] = node.active_flag;
+        }
+    }
+
+    // For each node, compute the sum of its incoming activation
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (topology.sensor[i])
+            continue;
+
+        U8* flag = &active_flag[i * B];
+        std::fill(sum.begin(), sum.end(), 0.0);
+        std::fill(flag, flag + B, 0);
+        for (U32 j = topology.first_link[i]; j < topology.first_link[i + 1]; ++j)
+        {
+            const Connection& c = topology.links[j];
+            const F64* w = &weight[j * B];
+            if (!c.time_delay)
+            {
+                // every node is active, so get_active_out is the activation
+                const F64* in = &activation[c.src * B];
+                for (size_t k = 0; k < B; ++k)
+                    sum[k] += w[k] * in[k];
+                if (topology.sensor[c.src])
+                {
+                    std::fill(flag, flag + B, 1);
+                }
+                else
+                {
+                    const U8* in_flag = &active_flag[c.src * B];
+                    for (size_t k = 0; k < B; ++k)
+                        flag[k] |= in_flag[k];
+                }
+            }
+            else
+            {
+                const F64* in = &last_activation[c.src * B];
+                const S32* count = &activation_count[c.src * B];
+                for (size_t k = 0; k < B; ++k)
+                    sum[k] += w[k] * (count[k] > 1 ? in[k] : 0.0);
+            }
+        }
+        std::copy(sum.begin(), sum.end(), activesum.begin() + i * B);
+    }
+
+    // Now activate all the non-sensor nodes off their incoming activation
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (topology.sensor[i])
+            continue;
+
+        const U8* flag = &active_flag[i * B];
+        const F64* in = &activesum[i * B];
+        F64* act = &activation[i * B];
+        F64* last = &last_activation[i * B];
+        F64* last2 = &last_activation2[i * B];
+        S32* count = &activation_count[i * B];
+
+        if (topology.ftype[i] == SIGMOID)
+        {
+            // the plain sigmoid of fsigmoid
+            for (size_t k = 0; k < B; ++k)
+                squashed[k] = 1 / (1 + exp(-in[k]));
+        }
+        else if (topology.ftype[i] == LINEAR)
+        {
+            // the identity of flinear
+            std::copy(in, in + B, squashed.begin());
+        }
+        else
+        {
+            std::copy(act, act + B, squashed.begin());
+        }
+
+        //Only activate if some active input came in
+        for (size_t k = 0; k < B; ++k)
+        {
+            if (flag[k])
+            {
+                last2[k] = last[k];
+                last[k] = act[k];
+                act[k] = squashed[k];
+                count[k]++;
+            }
+        }
+    }
+
+    // store the new state back into the nodes
+    for (size_t k = 0; k < B; ++k)
+    {
+        const vector<NNodePtr>& all_nodes = *nodes[k];
+        for (size_t i = 0; i < n; ++i)
+        {
+            if (topology.sensor[i])
+                continue;
+            NNode& node = *all_nodes[i];
+            node.activesum = activesum[i * B + k];
+            node.activation = activation[i * B + k];
+            node.last_activation = last_activation[i * B + k];
+            node.last_activation2 = last_activation2[i * B + k];
+            node.activation_count = activation_count[i * B + k];
+            node.active_flag = active_flag[i * B + k] != 0;
+        }
+    }
+}
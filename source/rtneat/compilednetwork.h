@@ -0,0 +1,103 @@
+#ifndef _COMPILEDNETWORK_H_
+#define _COMPILEDNETWORK_H_
+
+#include <vector>
+#include "neat.h"
+#include "nnode.h"
+
+namespace NEAT
+{
+    class CompiledNetwork;
+    typedef boost::shared_ptr<CompiledNetwork> CompiledNetworkPtr;
+
+    /// A COMPILEDNETWORK is a Network lowered into flat arrays: the state of
+    ///   every node is kept in contiguous arrays indexed by the position of the
+    ///   node in Network::all_nodes, and the incoming links of each node are
+    ///   stored as a CSR list of (source, weight, time delay).  Activation
+    ///   follows exactly the same steps as Network::activate, but the inner
+    ///   loops do not chase any pointers.  The nodes stay the authority on
+    ///   the network state: it is loaded from them before each activation
+    ///   and written back to them afterwards, so sensors, overrides, flushing
+    ///   and output reading keep working on the NNodes.
+    class CompiledNetwork
+    {
+        public:
+
+            /// Lower the nodes of a network into flat arrays
+            /// @return the compiled network, or an empty pointer if some link
+            ///         comes from a node that is not in the list
+            static CompiledNetworkPtr compile(const std::vector<NNodePtr> &all_nodes);
+
+            /// Activates the net such that all outputs are active
+            /// (the same nodes as given to compile() must be passed in)
+            bool activate(const std::vector<NNodePtr> &all_nodes);
+
+            /// Copy the current link weights of the nodes into the compiled network
+            /// (after they were changed by learning)
+            void load_weights(const std::vector<NNodePtr> &all_nodes);
+
+            /// Activates a group of networks that share one topology in a single
+            /// pass over their links.  Every network in the group must be in its
+            /// steady state (see can_batch) and the same_topology as the first.
+            static void activate_batch(const std::vector<CompiledNetwork*> &group,
+                                       const std::vector<const std::vector<NNodePtr>*> &nodes);
+
+            /// Can the network be activated in a batch?  Only networks all of
+            /// whose nodes have been activated before and that have no
+            /// overridden outputs are: their activation is a single pass.
+            bool can_batch(const std::vector<NNodePtr> &all_nodes) const;
+
+            /// Do the two compiled networks have the same nodes and links?
+            /// (the weights do not matter)
+            bool same_topology(const CompiledNetwork &other) const;
+
+            /// A hash of the topology, equal for all the networks with the same_topology
+            size_t topology_hash() const { return signature; }
+
+            /// Number of nodes in the compiled network
+            size_t nodecount() const { return ftype.size(); }
+
+            /// Number of links in the compiled network
+            size_t linkcount() const { return links.size(); }
+
+        private:
+
+            CompiledNetwork() {}
+
+            /// Copy the activation state of the nodes into the arrays
+            void load_state(const std::vector<NNodePtr> &all_nodes);
+
+            /// Copy the activation state in the arrays back to the nodes
+            void store_state(const std::vector<NNodePtr> &all_nodes) const;
+
+            /// If all nodes are not active then return true
+            bool nodesoff() const;
+
+            /// A connection into a node
+            struct Connection
+            {
+                U32 src; ///< index of the input node
+                F64 weight; ///< weight of the connection
+                bool time_delay; ///< use the activation from the previous time step
+            };
+
+            size_t signature; ///< hash of the topology of the network
+
+            std::vector<U32> first_link; ///< CSR offsets of the incoming links of each node (one extra at the end)
+            std::vector<Connection> links; ///< incoming links of all the nodes, grouped by node
+            std::vector<bool> sensor; ///< whether each node is a SENSOR
+            std::vector<functype> ftype; ///< activation function of each node
+
+            std::vector<F64> activesum; ///< the incoming activity before being processed
+            std::vector<F64> activation; ///< the current activation of each node
+            std::vector<F64> last_activation; ///< the previous step's activation of each node
+            std::vector<F64> last_activation2; ///< the activation before the previous step
+            std::vector<S32> activation_count; ///< how many times each node has been activated
+            std::vector<bool> active_flag; ///< whether each node has any active inputs
+            std::vector<bool> override; ///< whether each node's output is being overridden
+            std::vector<F64> override_value; ///< the value to override each node's output with
+    };
+
+} // namespace NEAT
+
+#endif
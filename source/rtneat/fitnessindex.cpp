@@ -0,0 +1,266 @@
+#include "core/Common.h"
+#include <boost/thread/mutex.hpp>
+#include "fitnessindex.h"
+#include "organism.h"
+
+using namespace NEAT;
+using namespace std;
+
+namespace
+{
+    // The running sum of fitness is added up again after this many
+    //   changes per judged member, to drop the accumulated rounding
+    const size_t RESUM_PERIOD = 64;
+
+    // The last number given to a build of an index
+    U32 last_build = 0;
+    boost::mutex last_build_mutex;
+
+    // A number for a new build of an index
+    U32 next_build()
+    {
+        boost::mutex::scoped_lock lock(last_build_mutex);
+        if (++last_build == 0)
+            ++last_build;
+        return last_build;
+    }
+
+    // Is the organism old enough to be judged?
+    bool is_judged(const Organism& org)
+    {
+        return org.time_alive >= static_cast<S32>(NEAT::time_alive_minimum);
+    }
+}
+
+FitnessIndex::FitnessIndex() :
+    heap(),
+    num_members(0),
+    total_fitness(0),
+    changes_since_sum(0),
+    time_alive_minimum(NEAT::time_alive_minimum),
+    build(0)
+{
+}
+
+FitnessIndex::FitnessIndex(const FitnessIndex&) :
+    heap(),
+    num_members(0),
+    total_fitness(0),
+    changes_since_sum(0),
+    time_alive_minimum(NEAT::time_alive_minimum),
+    build(0)
+{
+}
+
+FitnessIndex& FitnessIndex::operator=(const FitnessIndex&)
+{
+    invalidate();
+    return *this;
+}
+
+FitnessIndex::~FitnessIndex()
+{
+}
+
+bool FitnessIndex::is_valid(size_t members) const
+{
+    return build != 0 && num_members == members && time_alive_minimum == NEAT::time_alive_minimum;
+}
+
+void FitnessIndex::rebuild(const vector<OrganismPtr>& members)
+{
+    invalidate();
+    build = next_build();
+    time_alive_minimum = NEAT::time_alive_minimum;
+    for (vector<OrganismPtr>::const_iterator curorg = members.begin(); curorg != members.end(); ++curorg)
+    {
+        insert(*curorg);
+    }
+}
+
+void FitnessIndex::invalidate()
+{
+    // the slots of the members are left as they are, but no longer match
+    heap.clear();
+    num_members = 0;
+    total_fitness = 0;
+    changes_since_sum = 0;
+    build = 0;
+}
+
+void FitnessIndex::insert(const OrganismPtr& org)
+{
+    if (build == 0 || is_member(*org))
+        return;
+    org->fitness_slot.owner = this;
+    org->fitness_slot.build = build;
+    org->fitness_slot.pos = -1;
+    ++num_members;
+    update(org);
+}
+
+void FitnessIndex::erase(const OrganismPtr& org)
+{
+    if (!is_member(*org))
+        return;
+    if (org->fitness_slot.pos >= 0)
+        remove_at(org->fitness_slot.pos);
+    org->fitness_slot = FitnessIndexSlot();
+    --num_members;
+}
+
+void FitnessIndex::update(const OrganismPtr& org)
+{
+    if (!is_member(*org))
+        return;
+    FitnessIndexSlot& slot = org->fitness_slot;
+
+    if (org->smited)
+    {
+        //get the next time multiple
+        U32 nextMultiple;
+        if (org->time_alive % NEAT::time_alive_minimum == 0)
+            nextMultiple = org->time_alive;
+        else
+            nextMultiple = NEAT::time_alive_minimum * (org->time_alive / NEAT::time_alive_minimum + 1);
+        org->time_alive = nextMultiple;
+    }
+
+    if (!is_judged(*org))
+    {
+        if (slot.pos >= 0)
+            remove_at(slot.pos);
+        return;
+    }
+
+    if (slot.pos < 0)
+    {
+        push(org);
+        return;
+    }
+
+    Entry& entry = heap[slot.pos];
+    if (entry.fitness == org->fitness && entry.smited == org->smited)
+        return;
+    total_fitness += org->fitness - entry.fitness;
+    ++changes_since_sum;
+    entry.fitness = org->fitness;
+    entry.smited = org->smited;
+    sift_up(slot.pos);
+    sift_down(slot.pos);
+    if (changes_since_sum > RESUM_PERIOD * heap.size())
+        resum();
+}
+
+OrganismPtr FitnessIndex::worst() const
+{
+    return heap.empty() ? OrganismPtr() : heap.front().org;
+}
+
+bool FitnessIndex::worst_smited() const
+{
+    return !heap.empty() && heap.front().smited;
+}
+
+double FitnessIndex::worst_fitness() const
+{
+    return heap.empty() ? 0 : heap.front().fitness;
+}
+
+double FitnessIndex::average() const
+{
+    return heap.empty() ? 0 : total_fitness / heap.size();
+}
+
+bool FitnessIndex::worse(const Entry& a, const Entry& b)
+{
+    if (a.smited != b.smited)
+        return a.smited;
+    return a.fitness < b.fitness;
+}
+
+bool FitnessIndex::is_member(const Organism& org) const
+{
+    return build != 0 && org.fitness_slot.owner == this && org.fitness_slot.build == build;
+}
+
+void FitnessIndex::push(const OrganismPtr& org)
+{
+    Entry entry;
+    entry.org = org;
+    entry.fitness = org->fitness;
+    entry.smited = org->smited;
+    heap.push_back(entry);
+    org->fitness_slot.pos = static_cast<S32>(heap.size() - 1);
+    total_fitness += entry.fitness;
+    ++changes_since_sum;
+    sift_up(heap.size() - 1);
+}
+
+void FitnessIndex::remove_at(size_t pos)
+{
+    total_fitness -= heap[pos].fitness;
+    ++changes_since_sum;
+    heap[pos].org->fitness_slot.pos = -1;
+    size_t last = heap.size() - 1;
+    if (pos != last)
+    {
+        swap_entries(pos, last);
+        heap.pop_back();
+        sift_up(pos);
+        sift_down(pos);
+    }
+    else
+    {
+        heap.pop_back();
+    }
+    if (heap.empty())
+        resum();
+}
+
+void FitnessIndex::sift_up(size_t pos)
+{
+    while (pos > 0)
+    {
+        size_t parent = (pos - 1) / 2;
+        if (!worse(heap[pos], heap[parent]))
+            break;
+        swap_entries(pos, parent);
+        pos = parent;
+    }
+}
+
+void FitnessIndex::sift_down(size_t pos)
+{
+    for (;;)
+    {
+        size_t child = 2 * pos + 1;
+        if (child >= heap.size())
+            break;
+        if (child + 1 < heap.size() && worse(heap[child + 1], heap[child]))
+            ++child;
+        if (!worse(heap[child], heap[pos]))
+            break;
+        swap_entries(pos, child);
+        pos = child;
+    }
+}
+
+void FitnessIndex::swap_entries(size_t a, size_t b)
+{
+    heap[a].org.swap(heap[b].org);
+    std::swap(heap[a].fitness, heap[b].fitness);
+    std::swap(heap[a].smited, heap[b].smited);
+    heap[a].org->fitness_slot.pos = static_cast<S32>(a);
+    heap[b].org->fitness_slot.pos = static_cast<S32>(b);
+}
+
+void FitnessIndex::resum()
+{
+    total_fitness = 0;
+    for (size_t i = 0; i < heap.size(); ++i)
+    {
+        total_fitness += heap[i].fitness;
+    }
+    changes_since_sum = 0;
+}
@@ -0,0 +1,116 @@
+#ifndef _FITNESSINDEX_H_
+#define _FITNESSINDEX_H_
+
+#include <vector>
+#include "neat.h"
+
+namespace NEAT
+{
+    class FitnessIndex;
+
+    // Where an Organism is in the FitnessIndex of its Species.
+    //   Copies of an Organism are not in any index, so copying a slot
+    //   gives an empty one.
+    struct FitnessIndexSlot
+    {
+        const FitnessIndex* owner; // The index the Organism is a member of
+        U32 build; // Which build of that index
+        S32 pos; // Position in the heap, -1 if too young to be judged
+
+        FitnessIndexSlot() : owner(NULL), build(0), pos(-1) {}
+        FitnessIndexSlot(const FitnessIndexSlot&) : owner(NULL), build(0), pos(-1) {}
+        FitnessIndexSlot& operator=(const FitnessIndexSlot&) { return *this; }
+    };
+
+    // ------------------------------------------------------------
+    // A FITNESSINDEX keeps the members of a Species that have been
+    //   alive for at least NEAT::time_alive_minimum in a binary heap
+    //   with the worst one on top (smited Organisms first, then the
+    //   lowest fitness), along with the sum of their fitness.  This
+    //   gives the real-time methods the Organism to remove and the
+    //   average fitness estimate of a Species without going through
+    //   all of its members.
+    //
+    //   The index holds a copy of the fitness of each Organism, so it
+    //   has to be told with update() whenever the fitness, the time
+    //   alive or the smited flag of a member changes.  Copies of an
+    //   index are invalid, and an index is also invalid once
+    //   NEAT::time_alive_minimum changes; Species rebuilds it then.
+    // ------------------------------------------------------------
+    class FitnessIndex
+    {
+        public:
+            FitnessIndex();
+            FitnessIndex(const FitnessIndex&);
+            FitnessIndex& operator=(const FitnessIndex&);
+            ~FitnessIndex();
+
+            // Is this an index of a Species with this many members?
+            bool is_valid(size_t num_members) const;
+
+            // Index the given members from scratch
+            void rebuild(const std::vector<OrganismPtr>& members);
+
+            // Forget all members, so the next is_valid fails
+            void invalidate();
+
+            // Add a new member
+            void insert(const OrganismPtr& org);
+
+            // Remove a member
+            void erase(const OrganismPtr& org);
+
+            // Re-file a member after a change to its fitness, time alive
+            //   or smited flag (Organisms that are not members are ignored)
+            //   Smited Organisms are judged at the next multiple of
+            //   NEAT::time_alive_minimum, so their time alive is rounded up.
+            void update(const OrganismPtr& org);
+
+            // The member to remove first, NULL if none is old enough
+            OrganismPtr worst() const;
+
+            // Was the worst member smited?
+            bool worst_smited() const;
+
+            // The fitness of the worst member
+            double worst_fitness() const;
+
+            // The number of members old enough to be judged
+            size_t num_judged() const { return heap.size(); }
+
+            // The average fitness of the members old enough to be judged
+            //   (0 if there are none)
+            double average() const;
+
+        private:
+            struct Entry
+            {
+                OrganismPtr org;
+                double fitness;
+                bool smited;
+            };
+
+            // Should a be removed before b?
+            static bool worse(const Entry& a, const Entry& b);
+
+            // Is the organism a member of this build of the index?
+            bool is_member(const Organism& org) const;
+
+            void push(const OrganismPtr& org);
+            void remove_at(size_t pos);
+            void sift_up(size_t pos);
+            void sift_down(size_t pos);
+            void swap_entries(size_t a, size_t b);
+            void resum();
+
+            std::vector<Entry> heap; // The judged members, worst first
+            size_t num_members; // All members, judged or not
+            double total_fitness; // Sum of the fitness in the heap
+            size_t changes_since_sum; // Changes to total_fitness since it was last summed up
+            U32 time_alive_minimum; // NEAT::time_alive_minimum when the index was built
+            U32 build; // Tells the members of this build from those of earlier ones, 0 if invalid
+    };
+
+} // namespace NEAT
+
+#endif
@@ -8,20 +8,20 @@ using namespace std;
 
 Gene::Gene(double w, NNodePtr inode, NNodePtr onode, bool recur, double innov,
            double mnum) :
-    lnk(new Link(w, inode, onode, recur)), innovation_num(innov), mutation_num(mnum),
+    lnk(pooled(new Link(w, inode, onode, recur))), innovation_num(innov), mutation_num(mnum),
         enable(true), frozen(false)
 {
 }
 
 Gene::Gene(TraitPtr tp, double w, const NNodePtr inode, const NNodePtr onode,
            bool recur, double innov, double mnum) :
-    lnk(new Link(tp,w,inode,onode,recur)), innovation_num(innov), mutation_num(mnum),
+    lnk(pooled(new Link(tp,w,inode,onode,recur))), innovation_num(innov), mutation_num(mnum),
         enable(true), frozen(false)
 {
 }
 
 Gene::Gene(GenePtr g, TraitPtr tp, const NNodePtr inode, const NNodePtr onode) :
-    lnk(new Link(tp,(g->lnk)->weight,inode,onode,(g->lnk)->is_recurrent)), innovation_num(g->innovation_num),
+    lnk(pooled(new Link(tp,(g->lnk)->weight,inode,onode,(g->lnk)->is_recurrent))), innovation_num(g->innovation_num),
         mutation_num(g->mutation_num), enable(g->enable), frozen(g->frozen)
 {
 }
@@ -80,13 +80,13 @@ Gene::Gene(istream &args, vector<TraitPtr> &traits, vector<NNodePtr> &nodes)
         ++curnode;
     onode=(*curnode);
 
-    lnk.reset(new Link(traitptr,weight,inode,onode,recur != 0));
+    lnk=pooled(new Link(traitptr,weight,inode,onode,recur != 0));
 
 }
 
 // new Gene(0,0,0,0,0,0,0)
 Gene::Gene() :
-  lnk(new Link(TraitPtr(), 0, NNodePtr(), NNodePtr(), false)), 
+  lnk(pooled(new Link(TraitPtr(), 0, NNodePtr(), NNodePtr(), false))), 
   innovation_num(0), mutation_num(0), enable(true), frozen(false)
 {
 }
@@ -98,7 +98,7 @@ Gene::Gene(const Gene& gene)
     enable = gene.enable;
     frozen = gene.frozen;
 
-    lnk.reset(new Link(*gene.lnk));
+    lnk=pooled(new Link(*gene.lnk));
 }
 
 Gene::~Gene()
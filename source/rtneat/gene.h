@@ -6,11 +6,12 @@
 #include "link.h"
 #include "network.h"
 #include "XMLSerializable.h"
+#include "pooled.h"
 
 namespace NEAT
 {
 
-    class Gene : public XMLSerializable
+    class Gene : public XMLSerializable, public Pooled<Gene>
     {
             friend class boost::serialization::access;
 
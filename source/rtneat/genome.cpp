@@ -35,7 +35,7 @@ Genome::Genome(S32 id, vector<TraitPtr> t, vector<NNodePtr> n, vector<LinkPtr> l
     for (curlink=links.begin(); curlink!=links.end(); ++curlink)
     {
         //Create genes one at a time
-        GenePtr tempgene(new Gene((*curlink)->linktrait, (*curlink)->weight,(*curlink)->get_in_node(),(*curlink)->get_out_node(),(*curlink)->is_recurrent,1.0,0.0));
+        GenePtr tempgene(pooled(new Gene((*curlink)->linktrait, (*curlink)->weight,(*curlink)->get_in_node(),(*curlink)->get_out_node(),(*curlink)->is_recurrent,1.0,0.0)));
         genes.push_back(tempgene);
     }
 
@@ -50,7 +50,7 @@ Genome::Genome(const Genome& genome)
 
     for (curtrait=genome.traits.begin(); curtrait!=genome.traits.end(); ++curtrait)
     {
-        TraitPtr p(new Trait(**curtrait));
+        TraitPtr p(pooled(new Trait(**curtrait)));
         traits.push_back(p);
     }
 
@@ -69,7 +69,7 @@ Genome::Genome(const Genome& genome)
             assoc_trait=(*curtrait);
         }
 
-        NNodePtr newnode(new NNode(*curnode,assoc_trait));
+        NNodePtr newnode(pooled(new NNode(*curnode,assoc_trait)));
 
         (*curnode)->dup=newnode; //Remember this node's old copy
         //    (*curnode)->activation_count=55;
@@ -99,10 +99,17 @@ Genome::Genome(const Genome& genome)
             assoc_trait=(*curtrait);
         }
 
-        GenePtr newgene(new Gene(*curgene,assoc_trait,inode,onode));
+        GenePtr newgene(pooled(new Gene(*curgene,assoc_trait,inode,onode)));
         genes.push_back(newgene);
 
     }
+
+    //Let go of the copies, or every node would keep its latest copy
+    //(and everything reachable from that) alive
+    for (curnode=genome.nodes.begin(); curnode!=genome.nodes.end(); ++curnode)
+    {
+        (*curnode)->dup.reset();
+    }
 }
 
 Genome::Genome(S32 id, std::ifstream &iFile)
@@ -142,14 +149,14 @@ Genome::Genome(S32 id, std::ifstream &iFile)
         //Read in a trait
         else if (curword == "trait")
         {
-            TraitPtr newtrait(new Trait(line));
+            TraitPtr newtrait(pooled(new Trait(line)));
             //Add trait to vector of traits
             traits.push_back(newtrait);
         }
         //Read in a node
         else if (curword == "node")
         {
-            NNodePtr newnode(new NNode(line,traits));
+            NNodePtr newnode(pooled(new NNode(line,traits)));
             //Add the node to the list of nodes
             nodes.push_back(newnode);
         }
@@ -157,7 +164,7 @@ Genome::Genome(S32 id, std::ifstream &iFile)
         else if (curword == "gene")
         {
             //Allocate the new Gene
-            GenePtr newgene(new Gene(line,traits,nodes));
+            GenePtr newgene(pooled(new Gene(line,traits,nodes)));
 
             //Add the gene to the genome
             genes.push_back(newgene);
@@ -214,7 +221,7 @@ Genome::Genome(S32 new_id, S32 i, S32 o, S32 n, S32 nmax, bool r, F64 linkprob)
     }
 
     //Create a dummy trait (this is for future expansion of the system)
-    TraitPtr newtrait(new Trait(1,0,0,0,0,0,0,0,0,0));
+    TraitPtr newtrait(pooled(new Trait(1,0,0,0,0,0,0,0,0,0)));
     traits.push_back(newtrait);
 
     //Build the input nodes
@@ -222,9 +229,9 @@ Genome::Genome(S32 new_id, S32 i, S32 o, S32 n, S32 nmax, bool r, F64 linkprob)
     {
         NNodePtr newnode;
         if (ncount<i)
-            newnode.reset(new NNode(SENSOR,ncount,INPUT));
+            newnode=pooled(new NNode(SENSOR,ncount,INPUT));
         else
-            newnode.reset(new NNode(SENSOR,ncount,BIAS));
+            newnode=pooled(new NNode(SENSOR,ncount,BIAS));
 
         newnode->nodetrait=newtrait;
 
@@ -235,7 +242,7 @@ Genome::Genome(S32 new_id, S32 i, S32 o, S32 n, S32 nmax, bool r, F64 linkprob)
     //Build the hidden nodes
     for (ncount=i+1; ncount<=i+n; ncount++)
     {
-        NNodePtr newnode(new NNode(NEURON,ncount,HIDDEN));
+        NNodePtr newnode(pooled(new NNode(NEURON,ncount,HIDDEN)));
         newnode->nodetrait=newtrait;
         //Add the node to the list of nodes
         nodes.push_back(newnode);
@@ -244,7 +251,7 @@ Genome::Genome(S32 new_id, S32 i, S32 o, S32 n, S32 nmax, bool r, F64 linkprob)
     //Build the output nodes
     for (ncount=first_output; ncount<=totalnodes; ncount++)
     {
-        NNodePtr newnode(new NNode(NEURON,ncount,OUTPUT));
+        NNodePtr newnode(pooled(new NNode(NEURON,ncount,OUTPUT)));
         newnode->nodetrait=newtrait;
         //Add the node to the list of nodes
         nodes.push_back(newnode);
@@ -288,7 +295,7 @@ Genome::Genome(S32 new_id, S32 i, S32 o, S32 n, S32 nmax, bool r, F64 linkprob)
                     //Create the gene
                     new_weight=randposneg()*randfloat();
                     GenePtr
-                        newgene(new Gene(newtrait,new_weight, in_node, out_node, false, count, new_weight));
+                        newgene(pooled(new Gene(newtrait,new_weight, in_node, out_node, false, count, new_weight)));
 
                     //Add the gene to the genome
                     genes.push_back(newgene);
@@ -314,7 +321,7 @@ Genome::Genome(S32 new_id, S32 i, S32 o, S32 n, S32 nmax, bool r, F64 linkprob)
                     //Create the gene
                     new_weight=randposneg()*randfloat();
                     GenePtr
-                        newgene(new Gene(newtrait,new_weight, in_node, out_node, true,count,new_weight));
+                        newgene(pooled(new Gene(newtrait,new_weight, in_node, out_node, true,count,new_weight)));
 
                     //Add the gene to the genome
                     genes.push_back(newgene);
@@ -352,7 +359,7 @@ Genome::Genome(S32 num_in, S32 num_out, S32 num_hidden, S32 type)
     int ncount;
 
     //Create a dummy trait (this is for future expansion of the system)
-    TraitPtr newtrait(new Trait(1,0,0,0,0,0,0,0,0,0));
+    TraitPtr newtrait(pooled(new Trait(1,0,0,0,0,0,0,0,0,0)));
     traits.push_back(newtrait);
 
     //Adjust hidden number
@@ -368,10 +375,10 @@ Genome::Genome(S32 num_in, S32 num_out, S32 num_hidden, S32 type)
     {
         NNodePtr newnode;
         if (ncount<num_in)
-            newnode.reset(new NNode(SENSOR,ncount,INPUT));
+            newnode=pooled(new NNode(SENSOR,ncount,INPUT));
         else
         {
-            newnode.reset(new NNode(SENSOR,ncount,BIAS));
+            newnode=pooled(new NNode(SENSOR,ncount,BIAS));
             bias=newnode;
         }
 
@@ -385,7 +392,7 @@ Genome::Genome(S32 num_in, S32 num_out, S32 num_hidden, S32 type)
     //Build the hidden nodes
     for (ncount=num_in+1; ncount<=num_in+num_hidden; ncount++)
     {
-        NNodePtr newnode(new NNode(NEURON,ncount,HIDDEN));
+        NNodePtr newnode(pooled(new NNode(NEURON,ncount,HIDDEN)));
         //Add the node to the list of nodes
         nodes.push_back(newnode);
         hidden.push_back(newnode);
@@ -394,7 +401,7 @@ Genome::Genome(S32 num_in, S32 num_out, S32 num_hidden, S32 type)
     //Build the output nodes
     for (ncount=num_in+num_hidden+1; ncount<=num_in+num_hidden+num_out; ncount++)
     {
-        NNodePtr newnode(new NNode(NEURON,ncount,OUTPUT));
+        NNodePtr newnode(pooled(new NNode(NEURON,ncount,OUTPUT)));
         //Add the node to the list of nodes
         nodes.push_back(newnode);
         outputs.push_back(newnode);
@@ -414,7 +421,7 @@ Genome::Genome(S32 num_in, S32 num_out, S32 num_hidden, S32 type)
             for (curnode2=inputs.begin(); curnode2!=inputs.end(); ++curnode2)
             {
                 //Connect each input to each output
-                GenePtr newgene(new Gene(newtrait,0, *curnode2, *curnode1, false, count,0));
+                GenePtr newgene(pooled(new Gene(newtrait,0, *curnode2, *curnode1, false, count,0)));
 
                 //Add the gene to the genome
                 genes.push_back(newgene);
@@ -440,14 +447,14 @@ Genome::Genome(S32 num_in, S32 num_out, S32 num_hidden, S32 type)
             {
 
                 //Connect Input to hidden
-                GenePtr newgene(new Gene(newtrait,0, *curnode2, *curnode1, false,count,0));
+                GenePtr newgene(pooled(new Gene(newtrait,0, *curnode2, *curnode1, false,count,0)));
                 //Add the gene to the genome
                 genes.push_back(newgene);
 
                 count++; //Next gene
 
                 //Connect hidden to output
-                newgene.reset(new Gene(newtrait,0, *curnode3, *curnode1, false,count,0));
+                newgene=pooled(new Gene(newtrait,0, *curnode3, *curnode1, false,count,0));
                 //Add the gene to the genome
                 genes.push_back(newgene);
 
@@ -471,7 +478,7 @@ Genome::Genome(S32 num_in, S32 num_out, S32 num_hidden, S32 type)
             for (curnode2=inputs.begin(); curnode2!=inputs.end(); ++curnode2)
             {
                 //Connect each input to each hidden
-                GenePtr newgene(new Gene(newtrait,0, *curnode2, *curnode1,false,count,0));
+                GenePtr newgene(pooled(new Gene(newtrait,0, *curnode2, *curnode1,false,count,0)));
 
                 //Add the gene to the genome
                 genes.push_back(newgene);
@@ -488,7 +495,7 @@ Genome::Genome(S32 num_in, S32 num_out, S32 num_hidden, S32 type)
             for (curnode2=hidden.begin(); curnode2!=hidden.end(); ++curnode2)
             {
                 //Connect each input to each hidden
-                GenePtr newgene(new Gene(newtrait,0, *curnode2, *curnode1,false,count,0));
+                GenePtr newgene(pooled(new Gene(newtrait,0, *curnode2, *curnode1,false,count,0)));
 
                 //Add the gene to the genome
                 genes.push_back(newgene);
@@ -501,7 +508,7 @@ Genome::Genome(S32 num_in, S32 num_out, S32 num_hidden, S32 type)
         //Connect the bias to all outputs
         for (curnode1=outputs.begin(); curnode1!=outputs.end(); ++curnode1)
         {
-            GenePtr newgene(new Gene(newtrait,0, bias, *curnode1,false,count,0));
+            GenePtr newgene(pooled(new Gene(newtrait,0, bias, *curnode1,false,count,0)));
 
             //Add the gene to the genome
             genes.push_back(newgene);
@@ -516,7 +523,7 @@ Genome::Genome(S32 num_in, S32 num_out, S32 num_hidden, S32 type)
             for (curnode2=hidden.begin(); curnode2!=hidden.end(); ++curnode2)
             {
                 //Connect each hidden to each hidden
-                GenePtr newgene(new Gene(newtrait,0, *curnode2, *curnode1,true,count,0));
+                GenePtr newgene(pooled(new Gene(newtrait,0, *curnode2, *curnode1,true,count,0)));
 
                 //Add the gene to the genome
                 genes.push_back(newgene);
@@ -604,7 +611,7 @@ NetworkPtr Genome::genesis(S32 id)
     //Create the nodes
     for (curnode=nodes.begin(); curnode!=nodes.end(); ++curnode)
     {
-        NNodePtr newnode(new NNode((*curnode)->type,(*curnode)->node_id,(*curnode)->gen_node_label,(*curnode)->ftype));
+        NNodePtr newnode(pooled(new NNode((*curnode)->type,(*curnode)->node_id,(*curnode)->gen_node_label,(*curnode)->ftype)));
 
         //Derive the node parameters from the trait pointed to
         curtrait=(*curnode)->nodetrait;
@@ -637,7 +644,7 @@ NetworkPtr Genome::genesis(S32 id)
             onode=curlink->get_out_node()->analogue;
             //NOTE: This line could be run through a recurrency check if desired
             // (no need to in the current implementation of NEAT)
-            newlink.reset(new Link(curlink->weight,inode,onode,curlink->is_recurrent));
+            newlink=pooled(new Link(curlink->weight,inode,onode,curlink->is_recurrent));
 
             (onode->incoming).push_back(newlink);
             (inode->outgoing).push_back(newlink);
@@ -666,6 +673,9 @@ NetworkPtr Genome::genesis(S32 id)
 
     newnet->maxweight=maxweight;
 
+    //Lower the network into its flat-array form for activation
+    newnet->compile();
+
     return newnet;
 
 }
@@ -881,7 +891,7 @@ GenomePtr Genome::duplicate(S32 new_id)
     //Duplicate the traits
     for (curtrait=traits.begin(); curtrait!=traits.end(); ++curtrait)
     {
-        TraitPtr newtrait(new Trait(*curtrait));
+        TraitPtr newtrait(pooled(new Trait(*curtrait)));
         traits_dup.push_back(newtrait);
     }
 
@@ -899,7 +909,7 @@ GenomePtr Genome::duplicate(S32 new_id)
             assoc_trait=(*curtrait);
         }
 
-        NNodePtr newnode(new NNode(*curnode,assoc_trait));
+        NNodePtr newnode(pooled(new NNode(*curnode,assoc_trait)));
 
         (*curnode)->dup=newnode; //Remember this node's old copy
         //    (*curnode)->activation_count=55;
@@ -926,11 +936,17 @@ GenomePtr Genome::duplicate(S32 new_id)
             assoc_trait=(*curtrait);
         }
 
-        GenePtr newgene(new Gene(*curgene,assoc_trait,inode,onode));
+        GenePtr newgene(pooled(new Gene(*curgene,assoc_trait,inode,onode)));
         genes_dup.push_back(newgene);
 
     }
 
+    //Let go of the copies (see the copy constructor)
+    for (curnode=nodes.begin(); curnode!=nodes.end(); ++curnode)
+    {
+        (*curnode)->dup.reset();
+    }
+
     { // Duplicate Factors
         vector<FactorPtr>::iterator curfactor;
         for (curfactor = factors.begin(); curfactor != factors.end(); 
@@ -1144,6 +1160,8 @@ void Genome::mutate_link_weights(F64 power, F64 rate, mutator mut_type)
 
     } //end for loop
 
+    //The mutation numbers have changed
+    invalidate_gene_keys();
 
 }
 
@@ -1207,7 +1225,7 @@ void Genome::mutate_gene_reenable()
 
 }
 
-bool Genome::mutate_add_node(vector<InnovationPtr> &innovs, S32 &curnode_id,
+bool Genome::mutate_add_node(InnovationRegistry &innovs, S32 &curnode_id,
                              F64 &curinnov)
 {
     vector<GenePtr>::iterator thegene; //random gene containing the original link
@@ -1216,8 +1234,7 @@ bool Genome::mutate_add_node(vector<InnovationPtr> &innovs, S32 &curnode_id,
     NNodePtr out_node;
     LinkPtr thelink; //The link inside the random gene
 
-    vector<InnovationPtr>::iterator theinnov; //For finding a historical match
-    bool done=false;
+    InnovationPtr theinnov; //For finding a historical match
 
     GenePtr newgene1; //The new Genes
     GenePtr newgene2;
@@ -1311,84 +1328,76 @@ bool Genome::mutate_add_node(vector<InnovationPtr> &innovs, S32 &curnode_id,
     //Innovations are used to make sure the same innovation in
     //two separate genomes in the same generation receives
     //the same innovation number.
-    theinnov=innovs.begin();
+    theinnov=innovs.find_node(in_node->node_id,out_node->node_id,(*thegene)->innovation_num);
 
-    while (!done)
+    if (!theinnov)
     {
 
-        if (theinnov==innovs.end())
-        {
-
-            //The innovation is totally novel
+        //The innovation is totally novel
 
-            //Get the old link's trait
-            traitptr=thelink->linktrait;
+        //Get the old link's trait
+        traitptr=thelink->linktrait;
 
-            //Create the new NNode
-            //By convention, it will point to the first trait
-            newnode.reset(new NNode(NEURON,curnode_id++,HIDDEN));
-            newnode->nodetrait=(*(traits.begin()));
+        //Create the new NNode
+        //By convention, it will point to the first trait
+        newnode=pooled(new NNode(NEURON,curnode_id++,HIDDEN));
+        newnode->nodetrait=(*(traits.begin()));
 
-            //Create the new Genes
-            if (thelink->is_recurrent)
-            {
-                newgene1.reset(new Gene(traitptr,1.0,in_node,newnode,true,curinnov,0));
-                newgene2.reset(new Gene(traitptr,oldweight*0.3,newnode,out_node,false,curinnov+1,0));
-                curinnov+=2.0;
-            }
-            else
-            {
-                newgene1.reset(new Gene(traitptr,1.0,in_node,newnode,false,curinnov,0));
-                newgene2.reset(new Gene(traitptr,oldweight*0.3,newnode,out_node,false,curinnov+1,0));
-                curinnov+=2.0;
-            }
-
-            //Add the innovations (remember what was done)
-            InnovationPtr
-                p(new Innovation(in_node->node_id,out_node->node_id,curinnov-2.0,curinnov-1.0,newnode->node_id,(*thegene)->innovation_num));
-            innovs.push_back(p);
-
-            done=true;
+        //Create the new Genes
+        if (thelink->is_recurrent)
+        {
+            newgene1=pooled(new Gene(traitptr,1.0,in_node,newnode,true,curinnov,0));
+            newgene2=pooled(new Gene(traitptr,oldweight*0.3,newnode,out_node,false,curinnov+1,0));
+            curinnov+=2.0;
         }
-
-        // We check to see if an innovation already occured that was:
-        //   -A new node
-        //   -Stuck between the same nodes as were chosen for this mutation
-        //   -Splitting the same gene as chosen for this mutation 
-        //   If so, we know this mutation is not a novel innovation
-        //   in this generation
-        //   so we make it match the original, identical mutation which occured
-        //   elsewhere in the population by coincidence 
-        else if (((*theinnov)->innovation_type==NEWNODE)&&((*theinnov)->node_in_id==(in_node->node_id))&&((*theinnov)->node_out_id==(out_node->node_id))&&((*theinnov)->old_innov_num==(*thegene)->innovation_num))
+        else
         {
+            newgene1=pooled(new Gene(traitptr,1.0,in_node,newnode,false,curinnov,0));
+            newgene2=pooled(new Gene(traitptr,oldweight*0.3,newnode,out_node,false,curinnov+1,0));
+            curinnov+=2.0;
+        }
 
-            //Here, the innovation has been done before
+        //Add the innovations (remember what was done)
+        InnovationPtr
+            p(pooled(new Innovation(in_node->node_id,out_node->node_id,curinnov-2.0,curinnov-1.0,newnode->node_id,(*thegene)->innovation_num)));
+        innovs.add(p);
 
-            //Get the old link's trait
-            traitptr=thelink->linktrait;
+    }
 
-            //Create the new NNode
-            newnode.reset(new NNode(NEURON,(*theinnov)->newnode_id,HIDDEN));
-            //By convention, it will point to the first trait
-            //Note: In future may want to change this
-            newnode->nodetrait=(*(traits.begin()));
+    // We check to see if an innovation already occured that was:
+    //   -A new node
+    //   -Stuck between the same nodes as were chosen for this mutation
+    //   -Splitting the same gene as chosen for this mutation 
+    //   If so, we know this mutation is not a novel innovation
+    //   in this generation
+    //   so we make it match the original, identical mutation which occured
+    //   elsewhere in the population by coincidence 
+    else
+    {
 
-            //Create the new Genes
-            if (thelink->is_recurrent)
-            {
-                newgene1.reset(new Gene(traitptr,1.0,in_node,newnode,true,(*theinnov)->innovation_num1,0));
-                newgene2.reset(new Gene(traitptr,oldweight*0.3,newnode,out_node,false,(*theinnov)->innovation_num2,0));
-            }
-            else
-            {
-                newgene1.reset(new Gene(traitptr,1.0,in_node,newnode,false,(*theinnov)->innovation_num1,0));
-                newgene2.reset(new Gene(traitptr,oldweight*0.3,newnode,out_node,false,(*theinnov)->innovation_num2,0));
-            }
+        //Here, the innovation has been done before
 
-            done=true;
+        //Get the old link's trait
+        traitptr=thelink->linktrait;
+
+        //Create the new NNode
+        newnode=pooled(new NNode(NEURON,theinnov->newnode_id,HIDDEN));
+        //By convention, it will point to the first trait
+        //Note: In future may want to change this
+        newnode->nodetrait=(*(traits.begin()));
+
+        //Create the new Genes
+        if (thelink->is_recurrent)
+        {
+            newgene1=pooled(new Gene(traitptr,1.0,in_node,newnode,true,theinnov->innovation_num1,0));
+            newgene2=pooled(new Gene(traitptr,oldweight*0.3,newnode,out_node,false,theinnov->innovation_num2,0));
         }
         else
-            ++theinnov;
+        {
+            newgene1=pooled(new Gene(traitptr,1.0,in_node,newnode,false,theinnov->innovation_num1,0));
+            newgene2=pooled(new Gene(traitptr,oldweight*0.3,newnode,out_node,false,theinnov->innovation_num2,0));
+        }
+
     }
 
     //Now add the new NNode and new Genes to the Genome
@@ -1402,7 +1411,7 @@ bool Genome::mutate_add_node(vector<InnovationPtr> &innovs, S32 &curnode_id,
 
 }
 
-bool Genome::mutate_add_link(vector<InnovationPtr> &innovs, F64 &curinnov,
+bool Genome::mutate_add_link(InnovationRegistry &innovs, F64 &curinnov,
                              S32 tries)
 {
 
@@ -1414,7 +1423,7 @@ bool Genome::mutate_add_link(vector<InnovationPtr> &innovs, F64 &curinnov,
     NNodePtr nodep2; //Pointers to the nodes
     vector<GenePtr>::iterator thegene; //Searches for existing link
     bool found=false; //Tells whether an open pair was found
-    vector<InnovationPtr>::iterator theinnov; //For finding a historical match
+    InnovationPtr theinnov; //For finding a historical match
     S32 recurflag; //Indicates whether proposed link is recurrent
     GenePtr newgene; //The new Gene
 
@@ -1423,7 +1432,6 @@ bool Genome::mutate_add_link(vector<InnovationPtr> &innovs, F64 &curinnov,
 
     F64 newweight; //The new weight for the new link
 
-    bool done;
     bool do_recur;
     bool loop_recur;
     S32 first_nonsensor;
@@ -1610,86 +1618,69 @@ bool Genome::mutate_add_link(vector<InnovationPtr> &innovs, F64 &curinnov,
     if (found)
     {
 
-        //Check to see if this innovation already occured in the population
-        theinnov=innovs.begin();
-
         //If it was supposed to be recurrent, make sure it gets labeled that way
         if (do_recur)
             recurflag=1;
 
-        done=false;
+        //Check to see if this innovation already occured in the population
+        theinnov=innovs.find_link(nodep1->node_id,nodep2->node_id,recurflag != 0);
 
-        while (!done)
+        //The innovation is totally novel
+        if (!theinnov)
         {
 
-            //The innovation is totally novel
-            if (theinnov==innovs.end())
-            {
+            Assert(phenotype.lock());
 
-                Assert(phenotype.lock());
+            //Useful for debugging
+            //cout<<"nodep1 id: "<<nodep1->node_id<<endl;
+            //cout<<"nodep1: "<<nodep1<<endl;
+            //cout<<"nodep1 analogue: "<<nodep1->analogue<<endl;
+            //cout<<"nodep2 id: "<<nodep2->node_id<<endl;
+            //cout<<"nodep2: "<<nodep2<<endl;
+            //cout<<"nodep2 analogue: "<<nodep2->analogue<<endl;
+            //cout<<"recurflag: "<<recurflag<<endl;
 
-                //Useful for debugging
-                //cout<<"nodep1 id: "<<nodep1->node_id<<endl;
-                //cout<<"nodep1: "<<nodep1<<endl;
-                //cout<<"nodep1 analogue: "<<nodep1->analogue<<endl;
-                //cout<<"nodep2 id: "<<nodep2->node_id<<endl;
-                //cout<<"nodep2: "<<nodep2<<endl;
-                //cout<<"nodep2 analogue: "<<nodep2->analogue<<endl;
-                //cout<<"recurflag: "<<recurflag<<endl;
+            //NOTE: Something like this could be used for time delays,
+            //      which are not yet supported.  However, this does not
+            //      have an application with recurrency.
+            //If not recurrent, randomize recurrency
+            //if (!recurflag) 
+            //  if (randfloat()<recur_prob) recurflag=1;
 
-                //NOTE: Something like this could be used for time delays,
-                //      which are not yet supported.  However, this does not
-                //      have an application with recurrency.
-                //If not recurrent, randomize recurrency
-                //if (!recurflag) 
-                //  if (randfloat()<recur_prob) recurflag=1;
-
-                //Choose a random trait
-                traitnum=randint(0, static_cast<S32>(traits.size())-1);
-                thetrait=traits.begin();
-
-                //Choose the new weight
-                //newweight=(gaussrand())/1.5;  //Could use a gaussian
-                newweight=randposneg()*randfloat()*1.0; //used to be 10.0
+            //Choose a random trait
+            traitnum=randint(0, static_cast<S32>(traits.size())-1);
+            thetrait=traits.begin();
 
-                //Create the new gene
-                newgene.reset(new Gene(((thetrait[traitnum])),newweight,nodep1,nodep2,recurflag != 0,curinnov,newweight));
+            //Choose the new weight
+            //newweight=(gaussrand())/1.5;  //Could use a gaussian
+            newweight=randposneg()*randfloat()*1.0; //used to be 10.0
 
-                //Add the innovation
-                InnovationPtr
-                    p(new Innovation(nodep1->node_id,nodep2->node_id,curinnov,newweight,traitnum));
-                innovs.push_back(p);
+            //Create the new gene
+            newgene=pooled(new Gene(((thetrait[traitnum])),newweight,nodep1,nodep2,recurflag != 0,curinnov,newweight));
 
-                curinnov=curinnov+1.0;
+            //Add the innovation
+            InnovationPtr
+                p(pooled(new Innovation(nodep1->node_id,nodep2->node_id,curinnov,newweight,traitnum)));
+            innovs.add(p);
 
-                done=true;
-            }
-            //OTHERWISE, match the innovation in the innovs list
-            else if ( (*theinnov)->innovation_type ==NEWLINK && 
-                      (*theinnov)->node_in_id == nodep1->node_id && 
-                      (*theinnov)->node_out_id == nodep2->node_id && 
-                      (*theinnov)->recur_flag == (recurflag != 0) )
-            {
+            curinnov=curinnov+1.0;
 
-                thetrait=traits.begin();
+        }
+        //OTHERWISE, match the innovation in the innovs list
+        else
+        {
 
-                //Create new gene
-                newgene.reset(new Gene(
-                    thetrait[(*theinnov)->new_traitnum],
-                    (*theinnov)->new_weight,
-                    nodep1, nodep2, 
-                    recurflag != 0,
-                    (*theinnov)->innovation_num1,
-                    0));
+            thetrait=traits.begin();
 
-                done=true;
+            //Create new gene
+            newgene=pooled(new Gene(
+                thetrait[theinnov->new_traitnum],
+                theinnov->new_weight,
+                nodep1, nodep2, 
+                recurflag != 0,
+                theinnov->innovation_num1,
+                0));
 
-            }
-            else
-            {
-                //Keep looking for a matching innovation from this generation
-                ++theinnov;
-            }
         }
 
         //Now add the new Genes to the Genome
@@ -1705,7 +1696,7 @@ bool Genome::mutate_add_link(vector<InnovationPtr> &innovs, F64 &curinnov,
 
 }
 
-void Genome::mutate_add_sensor(vector<InnovationPtr> &innovs, double &curinnov)
+void Genome::mutate_add_sensor(InnovationRegistry &innovs, double &curinnov)
 {
 
     vector<NNodePtr> sensors;
@@ -1720,14 +1711,12 @@ void Genome::mutate_add_sensor(vector<InnovationPtr> &innovs, double &curinnov)
 
     bool found;
 
-    bool done;
-
     size_t outputConnections;
 
     vector<TraitPtr>::iterator thetrait;
     int traitnum;
 
-    vector<InnovationPtr>::iterator theinnov; //For finding a historical match
+    InnovationPtr theinnov; //For finding a historical match
 
     //Find all the sensors and outputs
     for (size_t i = 0; i < nodes.size(); i++)
@@ -1787,59 +1776,48 @@ void Genome::mutate_add_sensor(vector<InnovationPtr> &innovs, double &curinnov)
         //Record the innovation
         if (!found)
         {
-            theinnov=innovs.begin();
-            done=false;
+            theinnov=innovs.find_link(sensor->node_id,output->node_id,false);
 
-            while (!done)
+            //The innovation is novel
+            if (!theinnov)
             {
-                //The innovation is novel
-                if (theinnov==innovs.end())
-                {
 
-                    //Choose a random trait
-                    traitnum=randint(0, static_cast<S32>(traits.size())-1);
-                    thetrait=traits.begin();
-
-                    //Choose the new weight
-                    //newweight=(gaussrand())/1.5;  //Could use a gaussian
-                    newweight=randposneg()*randfloat()*3.0; //used to be 10.0
-                    // The above value of 3.0 is not changed to NEAT::max_link_weight, which is set
-                    // large enough to protect weights of advice network, since we don't want such
-                    // large changes in weight mutations.
-
-                    //Create the new gene
-                    newgene.reset(new Gene(((thetrait[traitnum])),
-                        newweight,sensor,output,false,
-                        curinnov,newweight));
-
-                    //Add the innovation
-                    InnovationPtr
-                        p(new Innovation(sensor->node_id,output->node_id,curinnov,newweight,traitnum));
-                    innovs.push_back(p);
-
-                    curinnov=curinnov+1.0;
-
-                    done=true;
-                } //end novel innovation case
-                //OTHERWISE, match the innovation in the innovs list
-                else if (((*theinnov)->innovation_type==NEWLINK)&&((*theinnov)->node_in_id==(sensor->node_id))&&((*theinnov)->node_out_id==(output->node_id))&&((*theinnov)->recur_flag==false))
-                {
+                //Choose a random trait
+                traitnum=randint(0, static_cast<S32>(traits.size())-1);
+                thetrait=traits.begin();
 
-                    thetrait=traits.begin();
+                //Choose the new weight
+                //newweight=(gaussrand())/1.5;  //Could use a gaussian
+                newweight=randposneg()*randfloat()*3.0; //used to be 10.0
+                // The above value of 3.0 is not changed to NEAT::max_link_weight, which is set
+                // large enough to protect weights of advice network, since we don't want such
+                // large changes in weight mutations.
+
+                //Create the new gene
+                newgene=pooled(new Gene(((thetrait[traitnum])),
+                    newweight,sensor,output,false,
+                    curinnov,newweight));
 
-                    //Create new gene
-                    newgene.reset(new Gene(((thetrait[(*theinnov)->new_traitnum])),
-                        (*theinnov)->new_weight,sensor,output,
-                        false,(*theinnov)->innovation_num1,0));
+                //Add the innovation
+                InnovationPtr
+                    p(pooled(new Innovation(sensor->node_id,output->node_id,curinnov,newweight,traitnum)));
+                innovs.add(p);
 
-                    done=true;
+                curinnov=curinnov+1.0;
 
-                } //end prior innovation case
-                //Keep looking for matching innovation
-                else
-                    ++theinnov;
+            } //end novel innovation case
+            //OTHERWISE, match the innovation in the innovs list
+            else
+            {
 
-            } //end while
+                thetrait=traits.begin();
+
+                //Create new gene
+                newgene=pooled(new Gene(((thetrait[theinnov->new_traitnum])),
+                    theinnov->new_weight,sensor,output,
+                    false,theinnov->innovation_num1,0));
+
+            } //end prior innovation case
 
             //genes.push_back(newgene);
             add_gene(genes, newgene); //adds the gene in correct order
@@ -1866,6 +1844,9 @@ void Genome::add_gene(vector<GenePtr> &glist, GenePtr g)
 
     glist.insert(curgene, g);
 
+    if (&glist == &genes)
+        invalidate_gene_keys();
+
 }
 
 void Genome::node_insert(vector<NNodePtr> &nlist, NNodePtr n)
@@ -1927,7 +1908,7 @@ GenomePtr Genome::mate_multipoint(GenomePtr g, S32 genomeid, F64 fitness1,
     p2trait=(g->traits).begin();
     for (p1trait=traits.begin(); p1trait!=traits.end(); ++p1trait)
     {
-        TraitPtr newtrait(new Trait(*p1trait,*p2trait)); //Construct by averaging
+        TraitPtr newtrait(pooled(new Trait(*p1trait,*p2trait))); //Construct by averaging
         newtraits.push_back(newtrait);
         ++p2trait;
     }
@@ -1958,7 +1939,7 @@ GenomePtr Genome::mate_multipoint(GenomePtr g, S32 genomeid, F64 fitness1,
                 nodetraitnum=(((*curnode)->nodetrait)->trait_id)-(*(traits.begin()))->trait_id;
 
             //Create a new node off the sensor or output
-            new_onode.reset(new NNode((*curnode),newtraits[nodetraitnum]));
+            new_onode=pooled(new NNode((*curnode),newtraits[nodetraitnum]));
 
             //Add the new node
             node_insert(newnodes, new_onode);
@@ -2089,7 +2070,7 @@ GenomePtr Genome::mate_multipoint(GenomePtr g, S32 genomeid, F64 fitness1,
                     else
                         nodetraitnum=((inode->nodetrait)->trait_id)-((*(traits.begin()))->trait_id);
 
-                    new_inode.reset(new NNode(inode,newtraits[nodetraitnum]));
+                    new_inode=pooled(new NNode(inode,newtraits[nodetraitnum]));
                     node_insert(newnodes, new_inode);
 
                 }
@@ -2113,7 +2094,7 @@ GenomePtr Genome::mate_multipoint(GenomePtr g, S32 genomeid, F64 fitness1,
                     else
                         nodetraitnum=((onode->nodetrait)->trait_id)-(*(traits.begin()))->trait_id;
 
-                    new_onode.reset(new NNode(onode,newtraits[nodetraitnum]));
+                    new_onode=pooled(new NNode(onode,newtraits[nodetraitnum]));
 
                     node_insert(newnodes, new_onode);
 
@@ -2140,7 +2121,7 @@ GenomePtr Genome::mate_multipoint(GenomePtr g, S32 genomeid, F64 fitness1,
                     else
                         nodetraitnum=((onode->nodetrait)->trait_id)-(*(traits.begin()))->trait_id;
 
-                    new_onode.reset(new NNode(onode,newtraits[nodetraitnum]));
+                    new_onode=pooled(new NNode(onode,newtraits[nodetraitnum]));
                     //newnodes.push_back(new_onode);
                     node_insert(newnodes, new_onode);
 
@@ -2164,7 +2145,7 @@ GenomePtr Genome::mate_multipoint(GenomePtr g, S32 genomeid, F64 fitness1,
                     else
                         nodetraitnum=((inode->nodetrait)->trait_id)-(*(traits.begin()))->trait_id;
 
-                    new_inode.reset(new NNode(inode,newtraits[nodetraitnum]));
+                    new_inode=pooled(new NNode(inode,newtraits[nodetraitnum]));
 
                     node_insert(newnodes, new_inode);
 
@@ -2178,7 +2159,7 @@ GenomePtr Genome::mate_multipoint(GenomePtr g, S32 genomeid, F64 fitness1,
             } //End NNode checking section- NNodes are now in new Genome
 
             //Add the Gene
-            GenePtr newgene(new Gene(chosengene,newtraits[traitnum],new_inode,new_onode));
+            GenePtr newgene(pooled(new Gene(chosengene,newtraits[traitnum],new_inode,new_onode)));
             if (disable)
             {
                 newgene->enable=false;
@@ -2242,14 +2223,14 @@ GenomePtr Genome::mate_multipoint_avg(GenomePtr g, S32 genomeid, F64 fitness1,
     p2trait=(g->traits).begin();
     for (p1trait=traits.begin(); p1trait!=traits.end(); ++p1trait)
     {
-        TraitPtr newtrait(new Trait(*p1trait,*p2trait)); //Construct by averaging
+        TraitPtr newtrait(pooled(new Trait(*p1trait,*p2trait))); //Construct by averaging
         newtraits.push_back(newtrait);
         ++p2trait;
     }
 
     //This Gene is used to hold the average of the two genes to be averaged
     //Set up the avgene
-    GenePtr avgene(new Gene());
+    GenePtr avgene(pooled(new Gene()));
 
     //NEW 3/17/03 Make sure all sensors and outputs are included
     for (curnode=(g->nodes).begin(); curnode!=(g->nodes).end(); ++curnode)
@@ -2262,7 +2243,7 @@ GenomePtr Genome::mate_multipoint_avg(GenomePtr g, S32 genomeid, F64 fitness1,
                 nodetraitnum=(((*curnode)->nodetrait)->trait_id)-(*(traits.begin()))->trait_id;
 
             //Create a new node off the sensor or output
-            new_onode.reset(new NNode((*curnode),newtraits[nodetraitnum]));
+            new_onode=pooled(new NNode((*curnode),newtraits[nodetraitnum]));
 
             //Add the new node
             node_insert(newnodes, new_onode);
@@ -2432,7 +2413,7 @@ GenomePtr Genome::mate_multipoint_avg(GenomePtr g, S32 genomeid, F64 fitness1,
                     else
                         nodetraitnum=((inode->nodetrait)->trait_id)-((*(traits.begin()))->trait_id);
 
-                    new_inode.reset(new NNode(inode,newtraits[nodetraitnum]));
+                    new_inode=pooled(new NNode(inode,newtraits[nodetraitnum]));
 
                     node_insert(newnodes, new_inode);
                 }
@@ -2455,7 +2436,7 @@ GenomePtr Genome::mate_multipoint_avg(GenomePtr g, S32 genomeid, F64 fitness1,
                         nodetraitnum=0;
                     else
                         nodetraitnum=((onode->nodetrait)->trait_id)-(*(traits.begin()))->trait_id;
-                    new_onode.reset(new NNode(onode,newtraits[nodetraitnum]));
+                    new_onode=pooled(new NNode(onode,newtraits[nodetraitnum]));
 
                     node_insert(newnodes, new_onode);
                 }
@@ -2480,7 +2461,7 @@ GenomePtr Genome::mate_multipoint_avg(GenomePtr g, S32 genomeid, F64 fitness1,
                     else
                         nodetraitnum=((onode->nodetrait)->trait_id)-(*(traits.begin()))->trait_id;
 
-                    new_onode.reset(new NNode(onode,newtraits[nodetraitnum]));
+                    new_onode=pooled(new NNode(onode,newtraits[nodetraitnum]));
 
                     node_insert(newnodes, new_onode);
                 }
@@ -2502,7 +2483,7 @@ GenomePtr Genome::mate_multipoint_avg(GenomePtr g, S32 genomeid, F64 fitness1,
                     else
                         nodetraitnum=((inode->nodetrait)->trait_id)-(*(traits.begin()))->trait_id;
 
-                    new_inode.reset(new NNode(inode,newtraits[nodetraitnum]));
+                    new_inode=pooled(new NNode(inode,newtraits[nodetraitnum]));
 
                     node_insert(newnodes, new_inode);
                 }
@@ -2515,7 +2496,7 @@ GenomePtr Genome::mate_multipoint_avg(GenomePtr g, S32 genomeid, F64 fitness1,
             } //End NNode checking section- NNodes are now in new Genome
 
             //Add the Gene
-            GenePtr newgene(new Gene(chosengene,newtraits[traitnum],new_inode,new_onode));
+            GenePtr newgene(pooled(new Gene(chosengene,newtraits[traitnum],new_inode,new_onode)));
 
             newgenes.push_back(newgene);
 
@@ -2574,13 +2555,13 @@ GenomePtr Genome::mate_singlepoint(GenomePtr g, S32 genomeid)
     p2trait=(g->traits).begin();
     for (p1trait=traits.begin(); p1trait!=traits.end(); ++p1trait)
     {
-        TraitPtr newtrait(new Trait(*p1trait,*p2trait)); //Construct by averaging
+        TraitPtr newtrait(pooled(new Trait(*p1trait,*p2trait))); //Construct by averaging
         newtraits.push_back(newtrait);
         ++p2trait;
     }
 
     //Set up the avgene
-    avgene.reset(new Gene());
+    avgene=pooled(new Gene());
 
     //Decide where to cross  (p1gene will always be in smaller Genome)
     if (genes.size() < g->genes.size())
@@ -2755,7 +2736,7 @@ GenomePtr Genome::mate_singlepoint(GenomePtr g, S32 genomeid)
                     else
                         nodetraitnum=((inode->nodetrait)->trait_id)-((*(traits.begin()))->trait_id);
 
-                    new_inode.reset(new NNode(inode,newtraits[nodetraitnum]));
+                    new_inode=pooled(new NNode(inode,newtraits[nodetraitnum]));
 
                     node_insert(newnodes, new_inode);
                 }
@@ -2778,7 +2759,7 @@ GenomePtr Genome::mate_singlepoint(GenomePtr g, S32 genomeid)
                     else
                         nodetraitnum=((onode->nodetrait)->trait_id)-(*(traits.begin()))->trait_id;
 
-                    new_onode.reset(new NNode(onode,newtraits[nodetraitnum]));
+                    new_onode=pooled(new NNode(onode,newtraits[nodetraitnum]));
                     node_insert(newnodes, new_onode);
 
                 }
@@ -2803,7 +2784,7 @@ GenomePtr Genome::mate_singlepoint(GenomePtr g, S32 genomeid)
                     else
                         nodetraitnum=((onode->nodetrait)->trait_id)-(*(traits.begin()))->trait_id;
 
-                    new_onode.reset(new NNode(onode,newtraits[nodetraitnum]));
+                    new_onode=pooled(new NNode(onode,newtraits[nodetraitnum]));
                     node_insert(newnodes, new_onode);
                 }
                 else
@@ -2825,7 +2806,7 @@ GenomePtr Genome::mate_singlepoint(GenomePtr g, S32 genomeid)
                     else
                         nodetraitnum=((inode->nodetrait)->trait_id)-(*(traits.begin()))->trait_id;
 
-                    new_inode.reset(new NNode(inode,newtraits[nodetraitnum]));
+                    new_inode=pooled(new NNode(inode,newtraits[nodetraitnum]));
                     //newnodes.push_back(new_inode);
                     node_insert(newnodes, new_inode);
                 }
@@ -2837,7 +2818,7 @@ GenomePtr Genome::mate_singlepoint(GenomePtr g, S32 genomeid)
             } //End NNode checking section- NNodes are now in new Genome
 
             //Add the Gene
-            GenePtr p(new Gene(chosengene,newtraits[traitnum],new_inode,new_onode));
+            GenePtr p(pooled(new Gene(chosengene,newtraits[traitnum],new_inode,new_onode)));
             newgenes.push_back(p);
 
         } //End of if (!skip)
@@ -2858,9 +2839,29 @@ F64 Genome::compatibility(GenomePtr g)
 {
 	assert(g);
 	
+    return compatibility(gene_keys(), g->gene_keys());
+}
+
+const vector<Genome::GeneKey>& Genome::gene_keys()
+{
+    //The keys are out of date after a mutation cleared them or Genes were added
+    if (keys.size() != genes.size())
+    {
+        keys.resize(genes.size());
+        for (size_t i = 0; i < genes.size(); ++i)
+        {
+            keys[i].innovation_num = genes[i]->innovation_num;
+            keys[i].mutation_num = genes[i]->mutation_num;
+        }
+    }
+    return keys;
+}
+
+F64 Genome::compatibility(const vector<GeneKey> &keys1, const vector<GeneKey> &keys2)
+{
     //iterators for moving through the two potential parents' Genes
-    vector<GenePtr>::iterator p1gene;
-    vector<GenePtr>::iterator p2gene;
+    vector<GeneKey>::const_iterator p1gene;
+    vector<GeneKey>::const_iterator p2gene;
 
     //Innovation numbers
     F64 p1innov;
@@ -2875,27 +2876,19 @@ F64 Genome::compatibility(GenomePtr g)
     F64 mut_diff_total=0.0;
     F64 num_matching=0.0; //Used to normalize mutation_num differences
 
-    F64 max_genome_size; //Size of larger Genome
-
-    //Get the length of the longest Genome for percentage computations
-    if (genes.size() < g->genes.size())
-        max_genome_size=(g->genes).size();
-    else
-        max_genome_size=static_cast<S32>(genes.size());
-
     //Now move through the Genes of each potential parent 
     //until both Genomes end
-    p1gene=genes.begin();
-    p2gene=(g->genes).begin();
-    while (!((p1gene==genes.end())&&(p2gene==(g->genes).end())))
+    p1gene=keys1.begin();
+    p2gene=keys2.begin();
+    while (!((p1gene==keys1.end())&&(p2gene==keys2.end())))
     {
 
-        if (p1gene==genes.end())
+        if (p1gene==keys1.end())
         {
             ++p2gene;
             num_excess+=1.0;
         }
-        else if (p2gene==(g->genes).end())
+        else if (p2gene==keys2.end())
         {
             ++p1gene;
             num_excess+=1.0;
@@ -2903,13 +2896,13 @@ F64 Genome::compatibility(GenomePtr g)
         else
         {
             //Extract current innovation numbers
-            p1innov=(*p1gene)->innovation_num;
-            p2innov=(*p2gene)->innovation_num;
+            p1innov=p1gene->innovation_num;
+            p2innov=p2gene->innovation_num;
 
             if (p1innov==p2innov)
             {
                 num_matching+=1.0;
-                mut_diff=((*p1gene)->mutation_num)-((*p2gene)->mutation_num);
+                mut_diff=(p1gene->mutation_num)-(p2gene->mutation_num);
                 if (mut_diff<0.0)
                     mut_diff=0.0-mut_diff;
                 //mut_diff+=trait_compare((*p1gene)->lnk->linktrait,(*p2gene)->lnk->linktrait); //CONSIDER TRAIT DIFFERENCES
@@ -2944,8 +2937,6 @@ F64 Genome::compatibility(GenomePtr g)
 
     //Look at disjointedness and excess in the absolute (ignoring size)
 
-    //cout<<"COMPAT: size = "<<max_genome_size<<" disjoint = "<<num_disjoint<<" excess = "<<num_excess<<" diff = "<<mut_diff_total<<"  TOTAL = "<<(disjoint_coeff*(num_disjoint/1.0)+excess_coeff*(num_excess/1.0)+mutdiff_coeff*(mut_diff_total/num_matching))<<endl;
-
     return (disjoint_coeff*(num_disjoint/1.0)+excess_coeff*(num_excess/1.0)
         +mutdiff_coeff*(mut_diff_total/num_matching));
 }
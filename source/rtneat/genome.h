@@ -10,6 +10,8 @@
 
 namespace NEAT
 {
+    class InnovationRegistry;
+
     enum mutator
     {
         GAUSSIAN = 0,
@@ -45,6 +47,13 @@ namespace NEAT
 
             NetworkWeakPtr phenotype; //Allows Genome to be matched with its Network
 
+            // What compatibility checking needs to know about a Gene
+            struct GeneKey
+            {
+                F64 innovation_num; // Historical marker of the Gene
+                F64 mutation_num; // How much the Gene has mutated
+            };
+
             S32 get_last_node_id(); //Return id of final NNode in Genome
             F64 get_last_gene_innovnum(); //Return last innovation number in Genome
 
@@ -134,14 +143,14 @@ namespace NEAT
             //   Generally, if they fail, they can be called again if desired.
 
             // Mutate genome by adding a node respresentation
-            bool mutate_add_node(std::vector<InnovationPtr> &innovs,
+            bool mutate_add_node(InnovationRegistry &innovs,
                                  S32 &curnode_id, F64 &curinnov);
 
             // Mutate the genome by adding a new link between 2 random NNodes
-            bool mutate_add_link(std::vector<InnovationPtr> &innovs,
+            bool mutate_add_link(InnovationRegistry &innovs,
                                  F64 &curinnov, S32 tries);
 
-            void mutate_add_sensor(std::vector<InnovationPtr> &innovs,
+            void mutate_add_sensor(InnovationRegistry &innovs,
                                    double &curinnov);
 
             // ****** MATING METHODS *****
@@ -181,6 +190,21 @@ namespace NEAT
             //   The 3 coefficients are global system parameters
             F64 compatibility(GenomePtr g);
 
+            // The same measure computed from the keys of the Genes of the
+            //   two Genomes (see gene_keys)
+            static F64 compatibility(const std::vector<GeneKey> &keys1,
+                                     const std::vector<GeneKey> &keys2);
+
+            // The innovation and mutation numbers of the Genes, in the same
+            //   order as the Genes.  They are cached in one flat array that
+            //   is rebuilt when needed, so compatibility checks do not have
+            //   to go through the Gene pointers.  The cache is not thread
+            //   safe: build it before comparing Genomes on several threads.
+            const std::vector<GeneKey>& gene_keys();
+
+            // Drop the cached gene keys (call after changing the Genes directly)
+            void invalidate_gene_keys() { keys.clear(); }
+
             F64 trait_compare(TraitPtr t1, TraitPtr t2);
 
             // Return number of non-disabled genes
@@ -213,6 +237,8 @@ namespace NEAT
             //*correct order* into the list of genes in the genome
             void add_gene(std::vector<GenePtr> &glist, GenePtr g);
 
+            // Cached keys of the Genes, empty when they need to be rebuilt
+            std::vector<GeneKey> keys;
     };
 
     //Calls special constructor that creates a Genome of 3 possible types:
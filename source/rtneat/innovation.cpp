@@ -1,7 +1,10 @@
 #include "core/Common.h"
+#include <algorithm>
+#include <boost/functional/hash.hpp>
 #include "innovation.h"
 
 using namespace NEAT;
+using namespace std;
 
 Innovation::Innovation(int nin, int nout, double num1, double num2, int newid,
                        double oldinnov)
@@ -50,3 +53,137 @@ Innovation::Innovation(int nin, int nout, double num1, double w, int t,
     newnode_id=0;
     recur_flag=recur;
 }
+
+// The fields a mutation compares to decide that it repeats an Innovation
+InnovationKey InnovationKey::of(const Innovation &innov)
+{
+    InnovationKey key;
+    key.innovation_type=innov.innovation_type;
+    key.node_in_id=innov.node_in_id;
+    key.node_out_id=innov.node_out_id;
+    key.old_innov_num=(innov.innovation_type==NEWNODE) ? innov.old_innov_num : 0;
+    key.recur_flag=(innov.innovation_type==NEWLINK) ? innov.recur_flag : false;
+    return key;
+}
+
+bool InnovationKey::operator==(const InnovationKey &other) const
+{
+    return innovation_type==other.innovation_type &&
+           node_in_id==other.node_in_id &&
+           node_out_id==other.node_out_id &&
+           old_innov_num==other.old_innov_num &&
+           recur_flag==other.recur_flag;
+}
+
+size_t InnovationKeyHash::operator()(const InnovationKey &key) const
+{
+    size_t seed=0;
+    boost::hash_combine(seed, static_cast<int>(key.innovation_type));
+    boost::hash_combine(seed, key.node_in_id);
+    boost::hash_combine(seed, key.node_out_id);
+    boost::hash_combine(seed, key.old_innov_num);
+    boost::hash_combine(seed, key.recur_flag);
+    return seed;
+}
+
+InnovationPtr InnovationRegistry::find(const InnovationKey &key)
+{
+    InnovationMap::iterator found=index.find(key);
+    if (found==index.end())
+        return InnovationPtr();
+    found->second.last_used=epoch;
+    return found->second.innovation;
+}
+
+InnovationPtr InnovationRegistry::find_node(int nin, int nout, double oldinnov)
+{
+    InnovationKey key;
+    key.innovation_type=NEWNODE;
+    key.node_in_id=nin;
+    key.node_out_id=nout;
+    key.old_innov_num=oldinnov;
+    key.recur_flag=false;
+    return find(key);
+}
+
+InnovationPtr InnovationRegistry::find_link(int nin, int nout, bool recur)
+{
+    InnovationKey key;
+    key.innovation_type=NEWLINK;
+    key.node_in_id=nin;
+    key.node_out_id=nout;
+    key.old_innov_num=0;
+    key.recur_flag=recur;
+    return find(key);
+}
+
+void InnovationRegistry::add(InnovationPtr innov)
+{
+    Entry entry;
+    entry.innovation=innov;
+    entry.last_used=epoch;
+    entry.order=sequence++;
+
+    //If an Innovation with the same key is already there, a search of the
+    //list would always have found that one first, so it is kept
+    index.insert(InnovationMap::value_type(InnovationKey::of(*innov), entry));
+}
+
+void InnovationRegistry::clear()
+{
+    index.clear();
+}
+
+void InnovationRegistry::next_epoch()
+{
+    ++epoch;
+    if (NEAT::innovation_max_age==0)
+        return;
+
+    InnovationMap::iterator entry=index.begin();
+    while (entry!=index.end())
+    {
+        if (epoch-entry->second.last_used>=NEAT::innovation_max_age)
+            entry=index.erase(entry);
+        else
+            ++entry;
+    }
+}
+
+namespace
+{
+    bool added_before(const pair<size_t, InnovationPtr> &a, const pair<size_t, InnovationPtr> &b)
+    {
+        return a.first<b.first;
+    }
+}
+
+vector<InnovationPtr> InnovationRegistry::get_innovations() const
+{
+    return get_innovations(0);
+}
+
+vector<InnovationPtr> InnovationRegistry::get_innovations(U32 since) const
+{
+    vector< pair<size_t, InnovationPtr> > ordered;
+    ordered.reserve(index.size());
+    for (InnovationMap::const_iterator entry=index.begin(); entry!=index.end(); ++entry)
+    {
+        if (entry->second.last_used>=since)
+            ordered.push_back(make_pair(entry->second.order, entry->second.innovation));
+    }
+    sort(ordered.begin(), ordered.end(), added_before);
+
+    vector<InnovationPtr> innovs;
+    innovs.reserve(ordered.size());
+    for (size_t i=0; i<ordered.size(); ++i)
+        innovs.push_back(ordered[i].second);
+    return innovs;
+}
+
+void InnovationRegistry::set_innovations(const vector<InnovationPtr> &innovs)
+{
+    clear();
+    for (size_t i=0; i<innovs.size(); ++i)
+        add(innovs[i]);
+}
@@ -1,8 +1,11 @@
 #ifndef _INNOVATION_H_
 #define _INNOVATION_H_
 
+#include <vector>
+#include <boost/unordered_map.hpp>
 #include "neat.h"
 #include "XMLSerializable.h"
+#include "pooled.h"
 
 namespace NEAT
 {
@@ -25,7 +28,7 @@ namespace NEAT
     //  nodes fully specify the innovation and where it must have
     //  occured.  (Between them)                                     
     // ------------------------------------------------------------ 
-    class Innovation : public XMLSerializable
+    class Innovation : public XMLSerializable, public Pooled<Innovation>
     {
         private:
             friend class boost::serialization::access;
@@ -79,6 +82,97 @@ namespace NEAT
             }
     };
 
+    // ------------------------------------------------------------
+    // An INNOVATIONKEY is what makes two Innovations the same: their
+    //   type, the two nodes and either the split link (for a new node)
+    //   or the recurrence (for a new link)
+    // ------------------------------------------------------------
+    struct InnovationKey
+    {
+        innovtype innovation_type;
+        int node_in_id;
+        int node_out_id;
+        double old_innov_num; // for NEWNODE
+        bool recur_flag; // for NEWLINK
+
+        // The key of an Innovation
+        static InnovationKey of(const Innovation &innov);
+
+        bool operator==(const InnovationKey &other) const;
+    };
+
+    struct InnovationKeyHash
+    {
+        size_t operator()(const InnovationKey &key) const;
+    };
+
+    // ------------------------------------------------------------
+    // The INNOVATIONREGISTRY holds the Innovations of a Population,
+    //   indexed by what they are (their type, the two nodes and either
+    //   the split link or the recurrence) so that a mutation can find a
+    //   historical match without scanning all of them.
+    //
+    //   Real-time evolution never starts a new generation, so instead
+    //   of clearing the registry it is aged: every call to next_epoch
+    //   forgets the Innovations that have not been created or matched
+    //   during the last NEAT::innovation_max_age epochs.
+    // ------------------------------------------------------------
+    class InnovationRegistry
+    {
+        public:
+            InnovationRegistry() : epoch(0), sequence(0) {}
+
+            // Find an earlier new node between the two nodes that split the
+            //   link with innovation number old_innov (empty if none)
+            InnovationPtr find_node(int nin, int nout, double oldinnov);
+
+            // Find an earlier new link between the two nodes (empty if none)
+            InnovationPtr find_link(int nin, int nout, bool recur);
+
+            // Remember a new Innovation
+            void add(InnovationPtr innov);
+
+            // Forget all of the Innovations (at the end of a generation)
+            void clear();
+
+            // Start a new epoch, forgetting the Innovations that have not been
+            //   used in the last NEAT::innovation_max_age epochs
+            void next_epoch();
+
+            // Number of Innovations remembered
+            size_t size() const { return index.size(); }
+
+            // The current epoch
+            U32 get_epoch() const { return epoch; }
+
+            // All of the Innovations, in the order they were added
+            std::vector<InnovationPtr> get_innovations() const;
+
+            // The Innovations created or matched in the given epoch or
+            //   later, in the order they were added
+            std::vector<InnovationPtr> get_innovations(U32 since) const;
+
+            // Replace the Innovations by the given ones
+            void set_innovations(const std::vector<InnovationPtr> &innovs);
+
+        private:
+            struct Entry
+            {
+                InnovationPtr innovation;
+                U32 last_used; // The last epoch it was created or matched in
+                size_t order; // When it was added
+            };
+
+            typedef boost::unordered_map<InnovationKey, Entry, InnovationKeyHash> InnovationMap;
+
+            // Look up a key, marking it as used in this epoch
+            InnovationPtr find(const InnovationKey &key);
+
+            InnovationMap index;
+            U32 epoch;
+            size_t sequence;
+    };
+
 } // namespace NEAT
 
 #endif
@@ -0,0 +1,725 @@
+#include "core/Common.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#ifndef _WIN32
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "island.h"
+#include "population.h"
+#include "snapshot.h"
+#include "gene.h"
+
+using namespace NEAT;
+using namespace std;
+
+namespace
+{
+    const size_t HEADER_SIZE = sizeof(U32) + sizeof(U8);
+    const U32 MAX_MESSAGE_SIZE = 64 * 1024 * 1024;
+    const size_t READ_CHUNK = 64 * 1024;
+    const S32 WAIT_STEP = 50; // milliseconds
+
+#ifdef MSG_NOSIGNAL
+    const int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+    const int SEND_FLAGS = 0;
+#endif
+
+    template <typename T>
+    void append_value(vector<char>& buffer, const T& value)
+    {
+        const char* bytes = reinterpret_cast<const char*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    T extract_value(const char*& pos, const char* end)
+    {
+        if (static_cast<size_t>(end - pos) < sizeof(T))
+            throw runtime_error("Truncated island message");
+        T value;
+        memcpy(&value, pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+
+    // The payload of an ISLAND_MIGRANTS message
+    void append_migrants(vector<char>& payload,
+                         const vector<InnovationPtr>& innovs,
+                         const vector<GenomePtr>& genomes)
+    {
+        append_value(payload, static_cast<U32>(innovs.size()));
+        for (size_t i = 0; i < innovs.size(); ++i)
+            PopulationSnapshot::append_innovation(payload, *innovs[i]);
+        append_value(payload, static_cast<U32>(genomes.size()));
+        for (size_t i = 0; i < genomes.size(); ++i)
+            PopulationSnapshot::append_genome(payload, *genomes[i]);
+    }
+
+    // Read an ISLAND_MIGRANTS message (throws std::runtime_error if it is cut short)
+    void extract_migrants(const vector<char>& payload,
+                          vector<InnovationPtr>& innovs,
+                          vector<GenomePtr>& genomes)
+    {
+        const char* pos = payload.empty() ? NULL : &payload[0];
+        const char* end = pos + payload.size();
+        U32 num_innovs = extract_value<U32>(pos, end);
+        for (U32 i = 0; i < num_innovs; ++i)
+            innovs.push_back(PopulationSnapshot::extract_innovation(pos, end));
+        U32 num_genomes = extract_value<U32>(pos, end);
+        for (U32 i = 0; i < num_genomes; ++i)
+            genomes.push_back(PopulationSnapshot::extract_genome(pos, end));
+    }
+
+    bool gene_order(const GenePtr& a, const GenePtr& b)
+    {
+        return a->innovation_num < b->innovation_num;
+    }
+
+    bool node_order(const NNodePtr& a, const NNodePtr& b)
+    {
+        return a->node_id < b->node_id;
+    }
+
+    bool fitter(const OrganismPtr& a, const OrganismPtr& b)
+    {
+        return a->fitness > b->fitness;
+    }
+
+#ifndef _WIN32
+    bool set_nonblocking(int fd)
+    {
+#ifdef SO_NOSIGPIPE
+        int on = 1;
+        setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+        int flags = fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    bool make_address(const string& path, sockaddr_un& address)
+    {
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path))
+            return false;
+        strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+        return true;
+    }
+
+    int open_listener(const string& path)
+    {
+        sockaddr_un address;
+        if (!make_address(path, address))
+            return -1;
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            return -1;
+        unlink(path.c_str());
+        if (bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(fd, MAX_ISLANDS) != 0 ||
+            !set_nonblocking(fd))
+        {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    int accept_connection(int listener)
+    {
+        for (;;)
+        {
+            int fd = accept(listener, NULL, NULL);
+            if (fd >= 0 || errno != EINTR)
+                return fd;
+        }
+    }
+
+    int connect_to(const string& path)
+    {
+        sockaddr_un address;
+        if (!make_address(path, address))
+            return -1;
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            return -1;
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+        {
+            ::close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    // Wait until one of the sockets can be read or written
+    void wait_for(const vector<int>& readers, const vector<int>& writers, S32 timeout_ms)
+    {
+        vector<pollfd> fds;
+        for (size_t i = 0; i < readers.size(); ++i)
+        {
+            pollfd p = { readers[i], POLLIN, 0 };
+            fds.push_back(p);
+        }
+        for (size_t i = 0; i < writers.size(); ++i)
+        {
+            pollfd p = { writers[i], POLLOUT, 0 };
+            fds.push_back(p);
+        }
+        if (!fds.empty())
+            ::poll(&fds[0], fds.size(), timeout_ms);
+    }
+#else
+    // Unix sockets are not supported on Windows
+    bool set_nonblocking(int) { return false; }
+    int open_listener(const string&) { return -1; }
+    int accept_connection(int) { return -1; }
+    int connect_to(const string&) { return -1; }
+    void wait_for(const vector<int>&, const vector<int>&, S32) {}
+#endif
+}
+
+IslandChannel::IslandChannel(int fd) :
+    fd(fd),
+    outgoing(),
+    sent(0),
+    incoming()
+{
+    if (fd >= 0 && !set_nonblocking(fd))
+        close();
+}
+
+IslandChannel::~IslandChannel()
+{
+    close();
+}
+
+void IslandChannel::send(U8 type, const vector<char>& payload)
+{
+    if (!is_open())
+        return;
+    append_value(outgoing, static_cast<U32>(payload.size() + sizeof(U8)));
+    append_value(outgoing, type);
+    outgoing.insert(outgoing.end(), payload.begin(), payload.end());
+    flush();
+}
+
+bool IslandChannel::flush()
+{
+#ifndef _WIN32
+    while (is_open() && sent < outgoing.size())
+    {
+        ssize_t count = ::send(fd, &outgoing[sent], outgoing.size() - sent, SEND_FLAGS);
+        if (count > 0)
+            sent += count;
+        else if (count < 0 && errno == EINTR)
+            continue;
+        else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        else
+            close();
+    }
+#endif
+    if (sent == outgoing.size() || !is_open())
+    {
+        outgoing.clear();
+        sent = 0;
+    }
+    else if (sent > outgoing.size() / 2)
+    {
+        outgoing.erase(outgoing.begin(), outgoing.begin() + sent);
+        sent = 0;
+    }
+    return is_open();
+}
+
+bool IslandChannel::receive(U8& type, vector<char>& payload)
+{
+#ifndef _WIN32
+    char chunk[READ_CHUNK];
+    while (is_open())
+    {
+        ssize_t count = recv(fd, chunk, sizeof(chunk), 0);
+        if (count > 0)
+            incoming.insert(incoming.end(), chunk, chunk + count);
+        else if (count < 0 && errno == EINTR)
+            continue;
+        else if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        else
+            close(); // the messages that came before are still returned
+    }
+#endif
+    if (incoming.size() < HEADER_SIZE)
+        return false;
+    U32 size;
+    memcpy(&size, &incoming[0], sizeof(size));
+    if (size < sizeof(U8) || size > MAX_MESSAGE_SIZE)
+    {
+        LOG_F_WARNING("rtneat.island", "dropping a connection that sent a bad message size: " << size);
+        close();
+        incoming.clear();
+        return false;
+    }
+    if (incoming.size() < sizeof(U32) + size)
+        return false;
+    type = static_cast<U8>(incoming[sizeof(U32)]);
+    payload.assign(incoming.begin() + HEADER_SIZE, incoming.begin() + sizeof(U32) + size);
+    incoming.erase(incoming.begin(), incoming.begin() + sizeof(U32) + size);
+    return true;
+}
+
+bool IslandChannel::wait(S32 timeout_ms)
+{
+    if (!is_open())
+        return false;
+#ifndef _WIN32
+    pollfd p = { fd, POLLIN, 0 };
+    return ::poll(&p, 1, timeout_ms) > 0;
+#else
+    return false;
+#endif
+}
+
+void IslandChannel::close()
+{
+#ifndef _WIN32
+    if (fd >= 0)
+        ::close(fd);
+#endif
+    fd = -1;
+}
+
+void InnovationMerger::add_innovations(U32 island, const vector<InnovationPtr>& innovs)
+{
+    for (vector<InnovationPtr>::const_iterator curinnov = innovs.begin(); curinnov != innovs.end(); ++curinnov)
+    {
+        const Innovation& innov = **curinnov;
+        if (by_innovation.find(innov.innovation_num1) != by_innovation.end())
+            continue; // reported before
+
+        InnovationKey key = InnovationKey::of(innov);
+        key.node_in_id = first_node(innov.node_in_id);
+        key.node_out_id = first_node(innov.node_out_id);
+        if (innov.innovation_type == NEWNODE)
+            key.old_innov_num = first_innovation(innov.old_innov_num);
+
+        Numbers numbers;
+        numbers.innovation_num1 = innov.innovation_num1;
+        numbers.innovation_num2 = innov.innovation_num2;
+        numbers.newnode_id = innov.newnode_id;
+
+        size_t group;
+        boost::unordered_map<InnovationKey, size_t, InnovationKeyHash>::const_iterator found = by_key.find(key);
+        if (found != by_key.end())
+        {
+            //A twin of an Innovation from another island (if the island made
+            //it twice, it keeps the numbers it was first reported with)
+            group = found->second;
+            groups[group].islands.insert(make_pair(island, numbers));
+        }
+        else
+        {
+            group = groups.size();
+            Group newgroup;
+            newgroup.first = pooled(new Innovation(innov));
+            newgroup.first->node_in_id = key.node_in_id;
+            newgroup.first->node_out_id = key.node_out_id;
+            if (innov.innovation_type == NEWNODE)
+                newgroup.first->old_innov_num = key.old_innov_num;
+            newgroup.first_numbers = numbers;
+            newgroup.islands[island] = numbers;
+            groups.push_back(newgroup);
+            by_key[key] = group;
+        }
+
+        Place place = { group, 1 };
+        by_innovation[innov.innovation_num1] = place;
+        if (innov.innovation_type == NEWNODE)
+        {
+            place.which = 2;
+            by_innovation[innov.innovation_num2] = place;
+            by_node[innov.newnode_id] = group;
+        }
+    }
+}
+
+void InnovationMerger::translate(Genome& genome, U32 island, vector<InnovationPtr>& unseen)
+{
+    vector<size_t> used;
+
+    for (vector<NNodePtr>::iterator curnode = genome.nodes.begin(); curnode != genome.nodes.end(); ++curnode)
+    {
+        boost::unordered_map<S32, size_t>::const_iterator found = by_node.find((*curnode)->node_id);
+        if (found == by_node.end())
+            continue;
+        (*curnode)->node_id = numbers_for(groups[found->second], island).newnode_id;
+        used.push_back(found->second);
+    }
+
+    for (vector<GenePtr>::iterator curgene = genome.genes.begin(); curgene != genome.genes.end(); ++curgene)
+    {
+        boost::unordered_map<F64, Place>::const_iterator found = by_innovation.find((*curgene)->innovation_num);
+        if (found == by_innovation.end())
+            continue;
+        const Numbers& numbers = numbers_for(groups[found->second.group], island);
+        (*curgene)->innovation_num = found->second.which == 1 ? numbers.innovation_num1 : numbers.innovation_num2;
+        used.push_back(found->second.group);
+    }
+
+    //Tell the island about the Innovations it did not know, oldest first,
+    //so that a new node comes before the links that use it
+    sort(used.begin(), used.end());
+    used.erase(unique(used.begin(), used.end()), used.end());
+    for (vector<size_t>::const_iterator curgroup = used.begin(); curgroup != used.end(); ++curgroup)
+    {
+        Group& group = groups[*curgroup];
+        if (group.islands.find(island) != group.islands.end())
+            continue;
+        InnovationPtr innov(pooled(new Innovation(*group.first)));
+        innov->node_in_id = island_node(innov->node_in_id, island);
+        innov->node_out_id = island_node(innov->node_out_id, island);
+        if (innov->innovation_type == NEWNODE)
+            innov->old_innov_num = island_innovation(innov->old_innov_num, island);
+        group.islands[island] = group.first_numbers;
+        unseen.push_back(innov);
+    }
+
+    //Genomes keep their nodes and genes in order
+    stable_sort(genome.nodes.begin(), genome.nodes.end(), node_order);
+    stable_sort(genome.genes.begin(), genome.genes.end(), gene_order);
+    genome.invalidate_gene_keys();
+}
+
+const InnovationMerger::Numbers& InnovationMerger::numbers_for(const Group& group, U32 island) const
+{
+    boost::unordered_map<U32, Numbers>::const_iterator found = group.islands.find(island);
+    return found == group.islands.end() ? group.first_numbers : found->second;
+}
+
+S32 InnovationMerger::first_node(S32 node_id) const
+{
+    boost::unordered_map<S32, size_t>::const_iterator found = by_node.find(node_id);
+    return found == by_node.end() ? node_id : groups[found->second].first->newnode_id;
+}
+
+F64 InnovationMerger::first_innovation(F64 innovation_num) const
+{
+    boost::unordered_map<F64, Place>::const_iterator found = by_innovation.find(innovation_num);
+    if (found == by_innovation.end())
+        return innovation_num;
+    const Innovation& first = *groups[found->second.group].first;
+    return found->second.which == 1 ? first.innovation_num1 : first.innovation_num2;
+}
+
+S32 InnovationMerger::island_node(S32 node_id, U32 island) const
+{
+    boost::unordered_map<S32, size_t>::const_iterator found = by_node.find(node_id);
+    return found == by_node.end() ? node_id : numbers_for(groups[found->second], island).newnode_id;
+}
+
+F64 InnovationMerger::island_innovation(F64 innovation_num, U32 island) const
+{
+    boost::unordered_map<F64, Place>::const_iterator found = by_innovation.find(innovation_num);
+    if (found == by_innovation.end())
+        return innovation_num;
+    const Numbers& numbers = numbers_for(groups[found->second.group], island);
+    return found->second.which == 1 ? numbers.innovation_num1 : numbers.innovation_num2;
+}
+
+IslandCoordinator::IslandCoordinator(const string& socket_path) :
+    socket_path(socket_path),
+    listener(-1),
+    islands(),
+    next_id(0),
+    merger(),
+    migrants(0)
+{
+}
+
+IslandCoordinator::~IslandCoordinator()
+{
+    close();
+}
+
+bool IslandCoordinator::listen()
+{
+    close();
+    listener = open_listener(socket_path);
+    if (listener < 0)
+    {
+        LOG_F_ERROR("rtneat.island", "could not listen for islands on " << socket_path);
+        return false;
+    }
+    return true;
+}
+
+void IslandCoordinator::poll(S32 timeout_ms)
+{
+    vector<int> readers;
+    vector<int> writers;
+    if (listener >= 0)
+        readers.push_back(listener);
+    for (size_t i = 0; i < islands.size(); ++i)
+    {
+        readers.push_back(islands[i].channel->get_fd());
+        if (islands[i].channel->has_outgoing())
+            writers.push_back(islands[i].channel->get_fd());
+    }
+    wait_for(readers, writers, timeout_ms);
+
+    accept_islands();
+
+    U8 type;
+    vector<char> payload;
+    for (size_t i = 0; i < islands.size(); ++i)
+    {
+        IslandChannel& channel = *islands[i].channel;
+        channel.flush();
+        while (channel.receive(type, payload))
+        {
+            if (type == ISLAND_HELLO)
+            {
+                vector<char> welcome;
+                append_value(welcome, islands[i].id);
+                channel.send(ISLAND_WELCOME, welcome);
+            }
+            else if (type == ISLAND_MIGRANTS)
+            {
+                pass_on(i, payload);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < islands.size(); )
+    {
+        if (islands[i].channel->is_open())
+        {
+            ++i;
+            continue;
+        }
+        LOG_F_MSG("rtneat.island", "island " << islands[i].id << " left");
+        islands.erase(islands.begin() + i);
+    }
+}
+
+void IslandCoordinator::close()
+{
+    islands.clear();
+#ifndef _WIN32
+    if (listener >= 0)
+    {
+        ::close(listener);
+        unlink(socket_path.c_str());
+    }
+#endif
+    listener = -1;
+}
+
+void IslandCoordinator::accept_islands()
+{
+    if (listener < 0)
+        return;
+    for (;;)
+    {
+        int fd = accept_connection(listener);
+        if (fd < 0)
+            return;
+        Island island;
+        island.channel.reset(new IslandChannel(fd));
+        if (next_id >= MAX_ISLANDS)
+        {
+            LOG_F_WARNING("rtneat.island", "turning away an island, there can be at most " << MAX_ISLANDS);
+            continue;
+        }
+        island.id = next_id++;
+        islands.push_back(island);
+        LOG_F_MSG("rtneat.island", "island " << island.id << " joined");
+    }
+}
+
+void IslandCoordinator::pass_on(size_t from, const vector<char>& payload)
+{
+    vector<InnovationPtr> innovs;
+    vector<GenomePtr> genomes;
+    try
+    {
+        extract_migrants(payload, innovs, genomes);
+    }
+    catch (const runtime_error& e)
+    {
+        LOG_F_WARNING("rtneat.island", "bad migrants from island " << islands[from].id << ": " << e.what());
+        return;
+    }
+    merger.add_innovations(islands[from].id, innovs);
+
+    if (islands.size() < 2 || genomes.empty())
+        return;
+
+    //The islands form a ring
+    const Island& to = islands[(from + 1) % islands.size()];
+    vector<InnovationPtr> unseen;
+    for (size_t i = 0; i < genomes.size(); ++i)
+        merger.translate(*genomes[i], to.id, unseen);
+
+    vector<char> message;
+    append_migrants(message, unseen, genomes);
+    to.channel->send(ISLAND_MIGRANTS, message);
+    migrants += genomes.size();
+}
+
+IslandClient::IslandClient() :
+    channel(),
+    island_id(-1),
+    sent_population(),
+    sent_epoch(0)
+{
+}
+
+IslandClient::~IslandClient()
+{
+    close();
+}
+
+bool IslandClient::connect(const string& socket_path, S32 timeout_ms)
+{
+    close();
+    int fd = connect_to(socket_path);
+    if (fd < 0)
+    {
+        LOG_F_ERROR("rtneat.island", "could not connect to the island coordinator at " << socket_path);
+        return false;
+    }
+    channel.reset(new IslandChannel(fd));
+    channel->send(ISLAND_HELLO, vector<char>());
+
+    U8 type;
+    vector<char> payload;
+    for (S32 waited = 0; island_id < 0 && channel->is_open() && waited < timeout_ms; waited += WAIT_STEP)
+    {
+        channel->flush();
+        channel->wait(WAIT_STEP);
+        while (island_id < 0 && channel->receive(type, payload))
+        {
+            if (type != ISLAND_WELCOME)
+                continue;
+            const char* pos = payload.empty() ? NULL : &payload[0];
+            try
+            {
+                island_id = static_cast<S32>(extract_value<U32>(pos, pos + payload.size()));
+            }
+            catch (const runtime_error&)
+            {
+                channel->close();
+            }
+        }
+    }
+
+    if (island_id < 0)
+    {
+        LOG_F_ERROR("rtneat.island", "the island coordinator at " << socket_path << " did not answer");
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool IslandClient::is_connected() const
+{
+    return channel && channel->is_open() && island_id >= 0;
+}
+
+void IslandClient::claim_numbers(PopulationPtr pop) const
+{
+    if (island_id < 0)
+        return;
+    S32 node_base = island_id * ISLAND_NODE_RANGE;
+    F64 innov_base = island_id * ISLAND_INNOVATION_RANGE;
+    if (pop->cur_node_id < node_base)
+        pop->cur_node_id = node_base;
+    if (pop->cur_innov_num < innov_base)
+        pop->cur_innov_num = innov_base;
+}
+
+bool IslandClient::send_migrants(PopulationPtr pop, size_t count)
+{
+    if (!is_connected())
+        return false;
+
+    vector<OrganismPtr> judged;
+    for (vector<OrganismPtr>::const_iterator curorg = pop->organisms.begin(); curorg != pop->organisms.end(); ++curorg)
+    {
+        if ((*curorg)->time_alive >= static_cast<S32>(NEAT::time_alive_minimum))
+            judged.push_back(*curorg);
+    }
+    count = min(count, judged.size());
+    if (count == 0)
+        return true;
+    partial_sort(judged.begin(), judged.begin() + count, judged.end(), fitter);
+
+    vector<GenomePtr> genomes;
+    for (size_t i = 0; i < count; ++i)
+        genomes.push_back(judged[i]->gnome);
+
+    //The coordinator keeps the Innovations it was sent, so after the first
+    //send only the ones made or matched since the last one go along (those
+    //of that epoch again, since it may have gone on after the send)
+    vector<InnovationPtr> innovs;
+    if (sent_population.lock() == pop)
+        innovs = pop->innovations.get_innovations(sent_epoch);
+    else
+        innovs = pop->innovations.get_innovations();
+    sent_population = pop;
+    sent_epoch = pop->innovations.get_epoch();
+
+    vector<char> payload;
+    append_migrants(payload, innovs, genomes);
+    channel->send(ISLAND_MIGRANTS, payload);
+    return channel->is_open();
+}
+
+void IslandClient::receive_migrants(PopulationPtr pop, deque<GenomePtr>& migrants)
+{
+    if (!channel)
+        return;
+    channel->flush();
+
+    U8 type;
+    vector<char> payload;
+    while (channel->receive(type, payload))
+    {
+        if (type != ISLAND_MIGRANTS)
+            continue;
+        vector<InnovationPtr> innovs;
+        vector<GenomePtr> genomes;
+        try
+        {
+            extract_migrants(payload, innovs, genomes);
+        }
+        catch (const runtime_error& e)
+        {
+            LOG_F_WARNING("rtneat.island", "bad migrants from the coordinator: " << e.what());
+            continue;
+        }
+        //Later mutations on this island reuse the numbers of the migrants
+        for (size_t i = 0; i < innovs.size(); ++i)
+            pop->innovations.add(innovs[i]);
+        migrants.insert(migrants.end(), genomes.begin(), genomes.end());
+    }
+}
+
+void IslandClient::close()
+{
+    if (channel)
+        channel->close();
+    channel.reset();
+    island_id = -1;
+    sent_population.reset();
+}
@@ -0,0 +1,254 @@
+#ifndef _ISLAND_H_
+#define _ISLAND_H_
+
+#include <deque>
+#include <string>
+#include <vector>
+#include <boost/noncopyable.hpp>
+#include <boost/unordered_map.hpp>
+#include <boost/weak_ptr.hpp>
+#include "neat.h"
+#include "innovation.h"
+
+namespace NEAT
+{
+    // ------------------------------------------------------------
+    // ISLAND MODEL:
+    //   Several processes each evolve their own Population (an island)
+    //   and every so often send copies of their best Genomes to an
+    //   IslandCoordinator over a Unix socket.  The coordinator passes
+    //   them on to the next island in a ring.
+    //
+    //   All islands have to start from the same starting Genome.  When
+    //   an island joins, the coordinator gives it a number, and the
+    //   island moves its node and innovation counters into a range of
+    //   its own (island * ISLAND_NODE_RANGE and island *
+    //   ISLAND_INNOVATION_RANGE), so that node ids and innovation
+    //   numbers made on different islands never clash.  The same
+    //   mutation made on two islands still gets two numbers; the
+    //   coordinator finds such twins by comparing the Innovations the
+    //   islands send along, and renumbers each migrant so that it
+    //   lines up with the Genomes of the island it goes to.
+    //
+    //   Messages are a U32 length, a U8 type and the payload.  Genomes
+    //   and Innovations are written as in a PopulationSnapshot.
+    // ------------------------------------------------------------
+
+    const F64 ISLAND_INNOVATION_RANGE = 4294967296.0; // Innovation numbers of each island
+    const S32 ISLAND_NODE_RANGE = 1 << 24; // Node ids of each island
+    const U32 MAX_ISLANDS = 128; // So that the node ids fit into an S32
+
+    enum IslandMessageType
+    {
+        ISLAND_HELLO = 1,    // island -> coordinator: let me join
+        ISLAND_WELCOME = 2,  // coordinator -> island: U32 island number
+        ISLAND_MIGRANTS = 3  // both ways: U32 count, Innovations, U32 count, Genomes
+    };
+
+    // ------------------------------------------------------------
+    // An ISLANDCHANNEL sends and receives whole messages over a
+    //   connected non-blocking socket, keeping partial messages in
+    //   buffers until the rest arrives.
+    // ------------------------------------------------------------
+    class IslandChannel : private boost::noncopyable
+    {
+        public:
+            // Take over a connected socket
+            explicit IslandChannel(int fd);
+            ~IslandChannel();
+
+            bool is_open() const { return fd >= 0; }
+
+            int get_fd() const { return fd; }
+
+            // Queue a message and send as much of the queue as the socket takes
+            void send(U8 type, const std::vector<char>& payload);
+
+            // Send more of the queue (false if the channel is closed)
+            bool flush();
+
+            // Is anything left to send?
+            bool has_outgoing() const { return sent < outgoing.size(); }
+
+            // Read what has arrived; true if a whole message was there
+            bool receive(U8& type, std::vector<char>& payload);
+
+            // Wait up to timeout_ms for something to read
+            //   (false if the time ran out)
+            bool wait(S32 timeout_ms);
+
+            void close();
+
+        private:
+            int fd;
+            std::vector<char> outgoing; // Queued messages
+            size_t sent; // Bytes of outgoing already sent
+            std::vector<char> incoming; // Bytes read but not yet returned
+    };
+
+    typedef boost::shared_ptr<IslandChannel> IslandChannelPtr;
+
+    // ------------------------------------------------------------
+    // The INNOVATIONMERGER is how the coordinator knows that two
+    //   islands made the same Innovation under different numbers.
+    //   Innovations are grouped by what they are (as in the
+    //   InnovationRegistry), with the node ids and the split link of
+    //   the key written in the numbers of the island that reported the
+    //   group first.
+    // ------------------------------------------------------------
+    class InnovationMerger
+    {
+        public:
+            // Take in the Innovations an island has made, oldest first
+            void add_innovations(U32 island, const std::vector<InnovationPtr>& innovs);
+
+            // Renumber a Genome for an island: innovations and nodes the
+            //   island knows get its numbers, the others keep the first
+            //   numbers they were reported with.  The Innovations behind
+            //   the Genome that are new to the island are added to unseen
+            //   (in its numbers), and from then on count as known to it.
+            void translate(Genome& genome, U32 island, std::vector<InnovationPtr>& unseen);
+
+            // Number of distinct Innovations
+            size_t size() const { return groups.size(); }
+
+        private:
+            // The numbers an island gave an Innovation
+            struct Numbers
+            {
+                F64 innovation_num1;
+                F64 innovation_num2;
+                S32 newnode_id;
+            };
+
+            struct Group
+            {
+                InnovationPtr first; // As first reported, key in first numbers
+                Numbers first_numbers; // The numbers of first
+                boost::unordered_map<U32, Numbers> islands; // Numbers each island uses
+            };
+
+            // Where a number was reported: the group, and 1 or 2 for
+            //   innovation_num1 or innovation_num2
+            struct Place
+            {
+                size_t group;
+                U8 which;
+            };
+
+            // The numbers of a group on an island (the first ones if the
+            //   island does not know it)
+            const Numbers& numbers_for(const Group& group, U32 island) const;
+
+            // Node id and innovation number in the first numbers
+            S32 first_node(S32 node_id) const;
+            F64 first_innovation(F64 innovation_num) const;
+
+            // Node id and innovation number as an island knows them
+            S32 island_node(S32 node_id, U32 island) const;
+            F64 island_innovation(F64 innovation_num, U32 island) const;
+
+            std::vector<Group> groups;
+            boost::unordered_map<InnovationKey, size_t, InnovationKeyHash> by_key; // Keys in first numbers
+            boost::unordered_map<F64, Place> by_innovation; // Every reported number
+            boost::unordered_map<S32, size_t> by_node; // Every reported new node
+    };
+
+    // ------------------------------------------------------------
+    // The ISLANDCOORDINATOR listens on a Unix socket, numbers the
+    //   islands that connect and passes the migrants of each island on
+    //   to the next one.  It does all its work in poll, which has to be
+    //   called regularly.
+    // ------------------------------------------------------------
+    class IslandCoordinator : private boost::noncopyable
+    {
+        public:
+            explicit IslandCoordinator(const std::string& socket_path);
+            ~IslandCoordinator();
+
+            // Start listening (false if the socket cannot be made)
+            bool listen();
+
+            // Accept new islands and pass on migrants, waiting up to
+            //   timeout_ms for something to happen
+            void poll(S32 timeout_ms);
+
+            // Number of islands connected
+            size_t num_islands() const { return islands.size(); }
+
+            // Number of Genomes passed on so far
+            size_t num_migrants() const { return migrants; }
+
+            // Disconnect the islands and stop listening
+            void close();
+
+        private:
+            struct Island
+            {
+                U32 id;
+                IslandChannelPtr channel;
+            };
+
+            void accept_islands();
+
+            // Pass the migrants of islands[from] on to the next island
+            void pass_on(size_t from, const std::vector<char>& payload);
+
+            std::string socket_path;
+            int listener;
+            std::vector<Island> islands;
+            U32 next_id; // Numbers are not reused, since old migrants may still be around
+            InnovationMerger merger;
+            size_t migrants;
+    };
+
+    typedef boost::shared_ptr<IslandCoordinator> IslandCoordinatorPtr;
+
+    // ------------------------------------------------------------
+    // An ISLANDCLIENT is the connection of one island to the
+    //   coordinator.
+    // ------------------------------------------------------------
+    class IslandClient : private boost::noncopyable
+    {
+        public:
+            IslandClient();
+            ~IslandClient();
+
+            // Connect to the coordinator and wait up to timeout_ms for
+            //   the number of this island
+            bool connect(const std::string& socket_path, S32 timeout_ms);
+
+            bool is_connected() const;
+
+            // The number of this island (-1 if not connected)
+            S32 get_island_id() const { return island_id; }
+
+            // Move the node and innovation counters of the Population into
+            //   the range of this island (before it starts evolving)
+            void claim_numbers(PopulationPtr pop) const;
+
+            // Send copies of the Genomes of the count fittest Organisms that
+            //   are old enough to be judged, with the Innovations of the
+            //   Population that the coordinator may not have yet: all of
+            //   them the first time, then the ones created or matched
+            //   since the epoch of the last send
+            bool send_migrants(PopulationPtr pop, size_t count);
+
+            // Append the Genomes that have arrived to migrants, and add
+            //   the Innovations they came with to the Population
+            void receive_migrants(PopulationPtr pop, std::deque<GenomePtr>& migrants);
+
+            void close();
+
+        private:
+            IslandChannelPtr channel;
+            S32 island_id;
+            boost::weak_ptr<Population> sent_population; // The Population of the last send
+            U32 sent_epoch; // The epoch of its Innovations at the last send
+    };
+
+    typedef boost::shared_ptr<IslandClient> IslandClientPtr;
+
+} // namespace NEAT
+
+#endif
@@ -5,6 +5,7 @@
 #include "trait.h"
 #include "nnode.h"
 #include "XMLSerializable.h"
+#include "pooled.h"
 #include <ostream>
 #include <string>
 
@@ -14,7 +15,7 @@ namespace NEAT
     // A LINK is a connection from one node to another with an associated weight 
     // It can be marked as recurrent 
     // Its parameters are made public for efficiency 
-    class Link : public XMLSerializable
+    class Link : public XMLSerializable, public Pooled<Link>
     {
             friend class boost::serialization::access;
             Link() {}
@@ -5,12 +5,15 @@
 #include <string>
 #include "neat.h"
 #include "XMLSerializable.h"
+#include "core/ThreadPool.h"
+#include <boost/thread/tss.hpp>
 
 using namespace std;
 
 namespace NEAT
 {
     U32 time_alive_minimum = 20;
+    U32 innovation_max_age = 5; // Number of epochs an unused innovation is remembered in real-time evolution (0 for ever); kept when the parameter file leaves it out
     F64 trait_param_mut_prob = 0;
     F64 trait_mutation_power = 0; // Power of mutation on a signle trait param 
     F64 linktrait_mut_sig = 0; // Amount that mutation_num changes for a trait change inside a link
@@ -46,6 +49,45 @@ namespace NEAT
     F64 backprop_learning_rate = 0; // Learning rate of back-propagation algorithm
     F64 max_link_weight = 3; // Link weights are capped at this (and negative of this) value
     MTRand NEATRandGen((U64)time(NULL)); //TODO: we should probably move the Mersenne Twister random generator to OpenNero common
+    ThreadPoolPtr thread_pool; // Worker threads for speciation; when empty everything runs serially
+
+    namespace
+    {
+        // The generators belong to the RandGenScopes that put them in place
+        void keep_rand_gen(MTRand*) {}
+
+        boost::thread_specific_ptr<MTRand> thread_rand_gen(&keep_rand_gen);
+    }
+
+    MTRand& rand_gen()
+    {
+        MTRand* gen = thread_rand_gen.get();
+        return gen ? *gen : NEATRandGen;
+    }
+
+    RandGenScope::RandGenScope(MTRand& gen) :
+        previous(thread_rand_gen.get())
+    {
+        thread_rand_gen.reset(&gen);
+    }
+
+    RandGenScope::~RandGenScope()
+    {
+        thread_rand_gen.reset(previous);
+    }
+
+    void parallel_for(size_t count, const boost::function<void (size_t)>& body)
+    {
+        if (thread_pool)
+        {
+            thread_pool->ParallelFor(count, body);
+        }
+        else
+        {
+            for (size_t i = 0; i < count; ++i)
+                body(i);
+        }
+    }
 
     bool load_neat_params(const string& filename)
     {
@@ -126,6 +168,8 @@ namespace NEAT
         paramFile >> backprop_learning_rate;
         paramFile >> curword;
         paramFile >> max_link_weight;
+        paramFile >> curword;
+        paramFile >> innovation_max_age;
         cout << "trait_param_mut_prob="<< trait_param_mut_prob << endl;
         cout << "trait_mutation_power="<< trait_mutation_power << endl;
         cout << "linktrait_mut_sig="<< linktrait_mut_sig << endl;
@@ -160,6 +204,7 @@ namespace NEAT
         cout << "babies_stolen="<< babies_stolen << endl;
         cout << "backprop_learning_rate="<< backprop_learning_rate << endl;
         cout << "max_link_weight="<<max_link_weight<<endl;
+        cout << "innovation_max_age="<<innovation_max_age<<endl;
         paramFile.close();
         return true;
     }
@@ -168,7 +213,7 @@ namespace NEAT
     /// Uses the mersenne twister implementation
     F64 gaussrand()
     {
-        return NEATRandGen.randNorm(0, 1);
+        return rand_gen().randNorm(0, 1);
     }
 
     F64 fsigmoid(F64 activesum, F64 slope, F64 constant)
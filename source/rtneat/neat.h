@@ -5,11 +5,18 @@
 #include "mersennetwister.h"
 #include <boost/shared_ptr.hpp>
 #include <boost/weak_ptr.hpp>
+#include <boost/function.hpp>
+
+namespace OpenNero
+{
+    BOOST_SHARED_DECL( ThreadPool );
+}
 
 namespace NEAT
 {
     using namespace OpenNero;
     extern U32 time_alive_minimum; // Minimum time alive to be considered for selection or death in real-time evolution 
+    extern U32 innovation_max_age; // Number of epochs an unused innovation is remembered in real-time evolution (default 5, 0 for ever; the last entry of the parameter file)
     const S32 num_trait_params = 8;
 
     extern F64 trait_param_mut_prob;
@@ -61,10 +68,37 @@ namespace NEAT
 
     extern MTRand NEATRandGen; // Random number generator; can pass seed value as argument
 
+    // The generator the random functions use on the calling thread:
+    //   NEATRandGen, unless a RandGenScope put another one in its place
+    MTRand& rand_gen();
+
+    // ------------------------------------------------------------
+    // A RANDGENSCOPE makes the random functions of the calling thread
+    //   draw from gen until it goes out of scope, so that work done on
+    //   a worker thread can have a random stream of its own.
+    // ------------------------------------------------------------
+    class RandGenScope
+    {
+        public:
+            explicit RandGenScope(MTRand& gen);
+            ~RandGenScope();
+
+        private:
+            RandGenScope(const RandGenScope&);
+            RandGenScope& operator=(const RandGenScope&);
+
+            MTRand* previous; // The generator to put back
+    };
+
+    extern ThreadPoolPtr thread_pool; // Worker threads for speciation; when empty everything runs serially
+
+    // Call body(i) for every i in [0, count), on the thread_pool if there is one
+    void parallel_for(size_t count, const boost::function<void (size_t)>& body);
+
     // Inline Random Functions 
     extern inline S32 randposneg()
     {
-        if (NEAT::NEATRandGen.randInt()%2)
+        if (rand_gen().randInt()%2)
             return 1;
         else
             return -1;
@@ -72,12 +106,12 @@ namespace NEAT
 
     extern inline S32 randint(S32 x, S32 y)
     {
-        return NEAT::NEATRandGen.randInt()%(y-x+1)+x;
+        return rand_gen().randInt()%(y-x+1)+x;
     }
 
     extern inline F64 randfloat()
     {
-        return NEAT::NEATRandGen.rand();
+        return rand_gen().rand();
     }
 
     // SIGMOID FUNCTION ********************************
@@ -1,4 +1,5 @@
 #include "core/Common.h"
+#include <map>
 #include "network.h"
 
 using namespace NEAT;
@@ -39,7 +40,7 @@ Network::Network(const Network& network) :
     // Copy all the inputs
     for (curnode = network.inputs.begin(); curnode != network.inputs.end(); ++curnode)
     {
-        NNodePtr n(new NNode(**curnode));
+        NNodePtr n(pooled(new NNode(**curnode)));
         inputs.push_back(n);
         all_nodes.push_back(n);
     }
@@ -47,7 +48,7 @@ Network::Network(const Network& network) :
     // Copy all the outputs
     for (curnode = network.outputs.begin(); curnode != network.outputs.end(); ++curnode)
     {
-        NNodePtr n(new NNode(**curnode));
+        NNodePtr n(pooled(new NNode(**curnode)));
         outputs.push_back(n);
         all_nodes.push_back(n);
     }
@@ -162,10 +163,79 @@ void Network::print_links() const
 
 } //print_links
 
+// Lowers the net into its flat-array form
+// Returns true on success;
+bool Network::compile()
+{
+    compiled = CompiledNetwork::compile(all_nodes);
+    return bool(compiled);
+}
+
+// Activates many nets at once.  Compiled nets in their steady state are
+// grouped by topology, and each group is activated in one batch; all the
+// other nets are activated one at a time.
+void Network::activate_all(const vector<NetworkPtr> &nets, vector<bool> &results)
+{
+    typedef map<size_t, vector<size_t> > TopologyMap;
+    TopologyMap topologies;
+
+    results.resize(nets.size());
+    for (size_t i = 0; i < nets.size(); ++i)
+    {
+        Network& net = *nets[i];
+        if (!net.adaptable && !net.compiled)
+            net.compile();
+        if (!net.adaptable && net.compiled && net.compiled->can_batch(net.all_nodes))
+        {
+            topologies[net.compiled->topology_hash()].push_back(i);
+            results[i] = true; // a single pass always succeeds
+        }
+        else
+        {
+            results[i] = net.activate();
+        }
+    }
+
+    vector<CompiledNetwork*> group;
+    vector<const vector<NNodePtr>*> nodes;
+    for (TopologyMap::const_iterator iter = topologies.begin(); iter != topologies.end(); ++iter)
+    {
+        group.clear();
+        nodes.clear();
+        const vector<size_t>& members = iter->second;
+        const CompiledNetwork& topology = *nets[members[0]]->compiled;
+        for (size_t j = 0; j < members.size(); ++j)
+        {
+            Network& net = *nets[members[j]];
+            if (net.compiled->same_topology(topology))
+            {
+                group.push_back(net.compiled.get());
+                nodes.push_back(&net.all_nodes);
+            }
+            else
+            {
+                // hash collision
+                results[members[j]] = net.activate();
+            }
+        }
+        CompiledNetwork::activate_batch(group, nodes);
+    }
+}
+
 // Activates the net such that all outputs are active
 // Returns true on success;
 bool Network::activate()
 {
+    // Non-adaptable nets do not change their weights, so they can be
+    // activated off their flat-array form without visiting the nodes and links
+    if (!adaptable)
+    {
+        if (!compiled)
+            compile();
+        if (compiled)
+            return compiled->activate(all_nodes);
+    }
+
     vector<NNodePtr>::iterator curnode;
     vector<LinkPtr>::iterator curlink;
     F64 add_amount; //For adding to the activesum
@@ -384,6 +454,10 @@ bool Network::backprop()
         } //end if
     } //end for loop on nodes
 
+    // Keep the flat-array form in sync with the new weights
+    if (compiled)
+        compiled->load_weights(all_nodes);
+
     return true;
 }
 
@@ -441,6 +515,7 @@ void Network::show_output() const
 // Add an input
 void Network::add_input(NNodePtr in_node)
 {
+    compiled.reset();
     inputs.push_back(in_node);
     all_nodes.push_back(in_node);
 }
@@ -448,6 +523,7 @@ void Network::add_input(NNodePtr in_node)
 // Add an output
 void Network::add_output(NNodePtr out_node)
 {
+    compiled.reset();
     outputs.push_back(out_node);
     all_nodes.push_back(out_node);
 }
@@ -627,43 +703,18 @@ void Network::linkcounthelper(NNodePtr curnode, S32 &counter,
 
 }
 
-// Destroy will find every node in the network and subsequently
-// delete them one by one.  Since deleting a node deletes its incoming
-// links, all nodes and links associated with a network will be destructed
+// Destroy lets go of all the nodes.  The links belong to the nodes they
+// go into and only point weakly back at their input nodes, so the nodes
+// and links of the network go away with the last pointer to them,
+// without a walk through the network.
 // Note: Traits are parts of genomes and not networks, so they are not
 //       deleted here
 void Network::destroy()
 {
-    vector<NNodePtr>::iterator curnode;
-    vector<NNodePtr>::iterator location;
-    vector<NNodePtr> seenlist; //List of nodes not to doublecount
-
     // Erase all nodes from all_nodes list 
     all_nodes.clear();
 }
 
-void Network::destroy_helper(NNodePtr curnode, vector<NNodePtr> &seenlist)
-{
-    vector<LinkPtr> innodes=curnode->incoming;
-    vector<LinkPtr>::iterator curlink;
-    vector<NNodePtr>::iterator location;
-
-    if (!((curnode->type)==SENSOR))
-    {
-        for (curlink=innodes.begin(); curlink!=innodes.end(); ++curlink)
-        {
-            location=find(seenlist.begin(), seenlist.end(), ((*curlink)->get_in_node()));
-            if (location==seenlist.end())
-            {
-                seenlist.push_back((*curlink)->get_in_node());
-                destroy_helper((*curlink)->get_in_node(), seenlist);
-            }
-        }
-
-    }
-
-}
-
 // This checks a POTENTIAL link between a potential in_node and potential out_node to see if it must be recurrent 
 bool Network::is_recur(NNodePtr potin_node, NNodePtr potout_node, S32 &count,
                        S32 thresh) const
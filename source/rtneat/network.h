@@ -3,6 +3,7 @@
 
 #include "neat.h"
 #include "nnode.h"
+#include "compilednetwork.h"
 #include "XMLSerializable.h"
 
 namespace NEAT
@@ -26,9 +27,9 @@ namespace NEAT
 
             std::vector<NNodePtr>::iterator input_iter; ///< For GUILE network inputting  //PFHACK
 
+            CompiledNetworkPtr compiled; ///< Flat-array form of the net used for activation (not serialized)
+
             void destroy(); ///< Kills all nodes and links within
-            void destroy_helper(NNodePtr curnode,
-                                std::vector<NNodePtr> &seenlist); ///< helper for destroy()
 
             void nodecounthelper(const NNodePtr curnode, S32 &counter,
                                  std::vector<NNodePtr> &seenlist) const;
@@ -72,6 +73,15 @@ namespace NEAT
             /// Activates the net such that all outputs are active
             bool activate();
 
+            /// Activates many nets, evaluating the ones that share a topology together
+            /// @param nets the nets to activate
+            /// @param results set to the result of activate() for each of the nets
+            static void activate_all(const std::vector<NetworkPtr> &nets, std::vector<bool> &results);
+
+            /// Lowers the net into its flat-array form for faster activation
+            /// (adaptable nets are always activated through the nodes)
+            bool compile();
+
             /// Back-propagates error in the net such that all inputs are active
             bool backprop();
 
@@ -268,7 +268,7 @@ void NNode::error_load(F64 value)
 // Add an incoming connection a node
 void NNode::add_incoming(NNodePtr feednode, F64 weight, bool recur)
 {
-    LinkPtr newlink(new Link(weight,feednode,shared_from_this(),recur));
+    LinkPtr newlink(pooled(new Link(weight,feednode,shared_from_this(),recur)));
     incoming.push_back(newlink);
     feednode->outgoing.push_back(newlink);
 }
@@ -276,7 +276,7 @@ void NNode::add_incoming(NNodePtr feednode, F64 weight, bool recur)
 // Nonrecurrent version
 void NNode::add_incoming(NNodePtr feednode, F64 weight)
 {
-    LinkPtr newlink(new Link(weight,feednode,shared_from_this(),false));
+    LinkPtr newlink(pooled(new Link(weight,feednode,shared_from_this(),false)));
     incoming.push_back(newlink);
     feednode->outgoing.push_back(newlink);
 }
@@ -11,6 +11,7 @@
 #include "trait.h"
 #include "link.h"
 #include "XMLSerializable.h"
+#include "pooled.h"
 
 namespace NEAT
 {
@@ -43,7 +44,7 @@ namespace NEAT
     //   - If it's a sensor, it can be loaded with a value for output
     //   - If it's a neuron, it has a list of its incoming input signals (List<Link> is used) 
     // Use an activation count to avoid flushing
-    class NNode : public boost::enable_shared_from_this<NNode>, public XMLSerializable
+    class NNode : public boost::enable_shared_from_this<NNode>, public XMLSerializable, public Pooled<NNode>
     {
 
             friend class Network;
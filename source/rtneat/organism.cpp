@@ -74,6 +74,18 @@ void Organism::update_phenotype()
 
 void Organism::update_genotype()
 {
+    // A frozen copy of the population (see PopulationSnapshot::freeze) may
+    // still be reading the genome, so change a copy of it instead
+    if (!gnome.unique())
+    {
+        GenomePtr copy = gnome->duplicate(gnome->genome_id);
+        for (size_t i = 0; i < copy->nodes.size(); ++i)
+            copy->nodes[i]->analogue = gnome->nodes[i]->analogue;
+        copy->phenotype = net;
+        net->genotype = copy;
+        gnome = copy;
+    }
+
     // Import changes from phenotype into the genotype
     gnome->Lamarck();
 
@@ -5,6 +5,7 @@
 #include "genome.h"
 #include "species.h"
 #include "pool.h"
+#include "fitnessindex.h"
 #include "XMLSerializable.h"
 #include <string>
 #include <ostream>
@@ -15,6 +16,7 @@ namespace NEAT
 
     class Species;
     class Population;
+    class PopulationSnapshot;
     class Pool;
 
     /// ORGANISM CLASS:
@@ -23,6 +25,7 @@ namespace NEAT
     class Organism : public XMLSerializable
     {
             friend class boost::serialization::access;
+            friend class PopulationSnapshot;
 
             Organism() {}
         public:
@@ -68,6 +71,9 @@ namespace NEAT
 
             //Should this organism have a fitness penalty?
             bool smited;
+
+            // Where the Organism is in the FitnessIndex of its Species
+            FitnessIndexSlot fitness_slot;
             
             /// serialize this object to/from a Boost serialization archive
             template<class Archive>
@@ -0,0 +1,61 @@
+#ifndef _POOLED_H_
+#define _POOLED_H_
+
+#include <cstddef>
+#include <new>
+#include <boost/checked_delete.hpp>
+#include <boost/pool/pool_alloc.hpp>
+#include <boost/pool/singleton_pool.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace NEAT
+{
+    // ------------------------------------------------------------
+    // POOLED makes new and delete of a class take memory from a pool
+    //   of its own: large blocks cut into objects of the class, with a
+    //   free list through which the memory of deleted objects is used
+    //   again.  Every offspring needs hundreds of Genes, NNodes, Links
+    //   and Traits, so this keeps reproduction away from the heap.
+    //
+    //   The pools are shared by all threads (behind a mutex), and their
+    //   memory is kept until the program ends.  Subclasses of a
+    //   different size fall back to the heap.
+    //
+    //   Use as class Gene : public XMLSerializable, public Pooled<Gene>
+    // ------------------------------------------------------------
+    template <typename T>
+    class Pooled
+    {
+        public:
+            static void* operator new(std::size_t size)
+            {
+                if (size != sizeof(T))
+                    return ::operator new(size);
+                void* p = boost::singleton_pool<Pooled<T>, sizeof(T)>::malloc();
+                if (!p)
+                    throw std::bad_alloc();
+                return p;
+            }
+
+            static void operator delete(void* p, std::size_t size)
+            {
+                if (!p)
+                    return;
+                if (size != sizeof(T))
+                    ::operator delete(p);
+                else
+                    boost::singleton_pool<Pooled<T>, sizeof(T)>::free(p);
+            }
+    };
+
+    // Give a new Pooled object to a shared_ptr whose reference count comes
+    //   from a pool too, so that neither needs a heap allocation of its own
+    template <typename T>
+    boost::shared_ptr<T> pooled(T* p)
+    {
+        return boost::shared_ptr<T>(p, boost::checked_deleter<T>(), boost::fast_pool_allocator<T>());
+    }
+
+} // namespace NEAT
+
+#endif
@@ -6,10 +6,177 @@
 #include <string>
 #include <fstream>
 #include <stdexcept>
+#include <boost/bind.hpp>
+#include <boost/unordered_map.hpp>
 
 using namespace std;
 using namespace NEAT;
 
+namespace
+{
+    typedef vector<const vector<Genome::GeneKey>*> GeneKeysList;
+
+    // Marks an organism whose search met an empty species: like the serial
+    // search, it stops there and starts a new species
+    const size_t search_stopped = static_cast<size_t>(-1);
+
+    // The species of an organism that has not found one yet
+    const size_t no_species = static_cast<size_t>(-1);
+
+    // Continue the search for the first species compatible with organism i
+    // among the representatives it has not been compared with yet
+    void search_species(const GeneKeysList& orgs, const GeneKeysList& reps,
+                        vector<size_t>& checked, vector<size_t>& matched,
+                        size_t first, size_t i)
+    {
+        i += first;
+        if (matched[i] < reps.size() || checked[i] == search_stopped)
+            return;
+        for (size_t j = checked[i]; j < reps.size(); ++j)
+        {
+            if (!reps[j])
+            {
+                checked[i] = search_stopped;
+                return;
+            }
+            if (Genome::compatibility(*orgs[i], *reps[j]) < NEAT::compat_threshold)
+            {
+                matched[i] = j;
+                break;
+            }
+        }
+        if (checked[i] != search_stopped)
+            checked[i] = reps.size();
+    }
+
+    // Check whether a genome is compatible with representative j
+    void check_species(const vector<Genome::GeneKey>& keys, const GeneKeysList& reps,
+                       vector<U8>& compatible, size_t j)
+    {
+        compatible[j] = reps[j] && Genome::compatibility(keys, *reps[j]) < NEAT::compat_threshold;
+    }
+
+    // The offspring of one Species in a parallel epoch, with the
+    // Innovations they were made with.  New structure is numbered on from
+    // where the Population stood before breeding, the same for every Species
+    struct Brood
+    {
+        U32 seed; // Seed of the random stream of the Species
+        InnovationRegistry innovations;
+        S32 cur_node_id;
+        F64 cur_innov_num;
+        vector<OrganismPtr> babies;
+    };
+
+    // Breed Species i on its own random stream
+    void breed_species(S32 generation, const vector<SpeciesPtr>& repr_species,
+                       vector<SpeciesPtr>& sorted_species, vector<Brood>& broods, size_t i)
+    {
+        Brood& brood = broods[i];
+        MTRand gen(brood.seed);
+        RandGenScope scope(gen);
+        repr_species[i]->breed(generation, sorted_species, brood.innovations,
+                               brood.cur_node_id, brood.cur_innov_num, brood.babies);
+    }
+
+    template <typename T>
+    T renumbered(const boost::unordered_map<T, T>& numbers, T number)
+    {
+        typename boost::unordered_map<T, T>::const_iterator found = numbers.find(number);
+        return found == numbers.end() ? number : found->second;
+    }
+
+    bool gene_order(const GenePtr& a, const GenePtr& b)
+    {
+        return a->innovation_num < b->innovation_num;
+    }
+
+    bool node_order(const NNodePtr& a, const NNodePtr& b)
+    {
+        return a->node_id < b->node_id;
+    }
+
+    // Give the new nodes and innovations of a Brood their numbers in the
+    // Population: those of the same Innovation made by an earlier Species,
+    // or the next free ones.  first_node_id and first_innov_num are where
+    // the numbering of the Brood started.
+    void merge_brood(Population& pop, Brood& brood, S32 first_node_id, F64 first_innov_num)
+    {
+        boost::unordered_map<S32, S32> node_ids;
+        boost::unordered_map<F64, F64> innov_nums;
+
+        //The Innovations come oldest first, so a new node is numbered
+        //before the links that use it
+        vector<InnovationPtr> innovs = brood.innovations.get_innovations();
+        for (vector<InnovationPtr>::iterator curinnov = innovs.begin(); curinnov != innovs.end(); ++curinnov)
+        {
+            const Innovation& innov = **curinnov;
+            if (innov.innovation_num1 < first_innov_num)
+                continue; // Known to the Population before breeding
+
+            S32 nin = renumbered(node_ids, innov.node_in_id);
+            S32 nout = renumbered(node_ids, innov.node_out_id);
+            InnovationPtr match;
+            if (innov.innovation_type == NEWNODE)
+            {
+                F64 oldinnov = renumbered(innov_nums, innov.old_innov_num);
+                match = pop.innovations.find_node(nin, nout, oldinnov);
+                if (!match)
+                {
+                    match = pooled(new Innovation(nin, nout, pop.cur_innov_num, pop.cur_innov_num + 1,
+                                                  pop.cur_node_id++, oldinnov));
+                    pop.cur_innov_num += 2.0;
+                    pop.innovations.add(match);
+                }
+                innov_nums[innov.innovation_num2] = match->innovation_num2;
+                node_ids[innov.newnode_id] = match->newnode_id;
+            }
+            else
+            {
+                match = pop.innovations.find_link(nin, nout, innov.recur_flag);
+                if (!match)
+                {
+                    match = pooled(new Innovation(nin, nout, pop.cur_innov_num, innov.new_weight,
+                                                  innov.new_traitnum, innov.recur_flag));
+                    pop.cur_innov_num += 1.0;
+                    pop.innovations.add(match);
+                }
+            }
+            innov_nums[innov.innovation_num1] = match->innovation_num1;
+        }
+
+        for (vector<OrganismPtr>::iterator curbaby = brood.babies.begin(); curbaby != brood.babies.end(); ++curbaby)
+        {
+            Genome& gnome = *(*curbaby)->gnome;
+            bool changed = false;
+            for (vector<NNodePtr>::iterator curnode = gnome.nodes.begin(); curnode != gnome.nodes.end(); ++curnode)
+            {
+                if ((*curnode)->node_id >= first_node_id)
+                {
+                    (*curnode)->node_id = renumbered(node_ids, (*curnode)->node_id);
+                    changed = true;
+                }
+            }
+            for (vector<GenePtr>::iterator curgene = gnome.genes.begin(); curgene != gnome.genes.end(); ++curgene)
+            {
+                if ((*curgene)->innovation_num >= first_innov_num)
+                {
+                    (*curgene)->innovation_num = renumbered(innov_nums, (*curgene)->innovation_num);
+                    changed = true;
+                }
+            }
+            if (changed)
+            {
+                //Keep the nodes and genes in order, and the network in step
+                stable_sort(gnome.nodes.begin(), gnome.nodes.end(), node_order);
+                stable_sort(gnome.genes.begin(), gnome.genes.end(), gene_order);
+                gnome.invalidate_gene_keys();
+                (*curbaby)->net = gnome.genesis(gnome.genome_id);
+            }
+        }
+    }
+}
+
 PopulationPtr Population::copy(PopulationPtr p) {
   //FIXME - size hardcoded
   PopulationPtr np(new Population(p->organisms[0]->gnome,1));
@@ -333,72 +500,102 @@ bool Population::spawn(GenomePtr g, S32 size)
     return true;
 }
 
+// The organisms are placed in order, each in the first species whose first
+// organism is compatible with it, or in a new species when there is none.
+// The comparisons are done in rounds on the NEAT::thread_pool: every organism
+// that is not placed yet is compared with the representatives it has not seen,
+// stopping at its first match.  Then the organisms are placed in order up to
+// the first one that has no match, which starts a new species that the
+// remaining organisms are compared with in the next round.  This gives the
+// same species as comparing the organisms one by one.
 bool Population::speciate()
 {
-    vector<OrganismPtr>::iterator curorg; //For stepping through Population
-    vector<SpeciesPtr>::iterator curspecies; //Steps through species
-    OrganismPtr comporg; //Organism for comparison 
     SpeciesPtr newspecies; //For adding a new species
 
     S32 counter=0; //Species counter
 
+    //The genes of the organisms and of the first organisms of the species,
+    //gathered before the comparisons since the caches are not thread safe
+    GeneKeysList orgs(organisms.size());
+    for (size_t i = 0; i < organisms.size(); ++i)
+        orgs[i] = &organisms[i]->gnome->gene_keys();
+    GeneKeysList reps;
+    for (size_t j = 0; j < species.size(); ++j)
+    {
+        OrganismPtr comporg = species[j]->first();
+        reps.push_back(comporg ? &comporg->gnome->gene_keys() : 0);
+    }
+
+    vector<size_t> checked(organisms.size(), 0); //Number of representatives compared with
+    vector<size_t> matched(organisms.size(), no_species); //First compatible species
+
     //Step through all existing organisms
-    for (curorg=organisms.begin(); curorg!=organisms.end(); ++curorg)
+    size_t next = 0;
+    while (next < organisms.size())
     {
+        NEAT::parallel_for(organisms.size() - next,
+            boost::bind(&search_species, boost::cref(orgs), boost::cref(reps),
+                        boost::ref(checked), boost::ref(matched), next, _1));
 
-        //For each organism, search for a species it is compatible to
-        curspecies=species.begin();
-        if (curspecies==species.end())
-        {
-            //Create the first species
-            newspecies.reset(new Species(++counter));
-            species.push_back(newspecies);
-            newspecies->add_Organism(*curorg); //Add the current organism
-            (*curorg)->species=newspecies; //Point organism to its species
-        }
-        else
+        for (; next < organisms.size(); ++next)
         {
-            comporg=(*curspecies)->first();
-            while ((comporg.get()!=0)&&(curspecies!=species.end()))
+            OrganismPtr org = organisms[next];
+            if (matched[next] < reps.size())
             {
-
-                if ((((*curorg)->gnome)->compatibility(comporg->gnome))
-                    <NEAT::compat_threshold)
-                {
-
-                    //Found compatible species, so add this organism to it
-                    (*curspecies)->add_Organism(*curorg);
-                    (*curorg)->species=(*curspecies); //Point organism to its species
-                    comporg.reset(); //Note the search is over
-                }
-                else
-                {
-
-                    //Keep searching for a matching species
-                    ++curspecies;
-                    if (curspecies!=species.end())
-                        comporg=(*curspecies)->first();
-                }
+                //Found compatible species, so add this organism to it
+                species[matched[next]]->add_Organism(org);
+                org->species=species[matched[next]]; //Point organism to its species
             }
-
-            //If we didn't find a match, create a new species
-            if (comporg!=0)
+            else
             {
+                //If we didn't find a match, create a new species
                 newspecies.reset(new Species(++counter));
                 species.push_back(newspecies);
-                newspecies->add_Organism(*curorg); //Add the current organism
-                (*curorg)->species=newspecies; //Point organism to its species
-            }
+                newspecies->add_Organism(org); //Add the current organism
+                org->species=newspecies; //Point organism to its species
+                reps.push_back(orgs[next]);
 
-        } //end else 
-
-    } //end for
+                //The rest need to be compared with the new species
+                ++next;
+                break;
+            }
+        }
+    } //end while
 
     last_species=counter; //Keep track of highest species
 
     return true;
 }
 
+size_t Population::find_compatible_species(GenomePtr g)
+{
+    const vector<Genome::GeneKey>& keys = g->gene_keys();
+    GeneKeysList reps(species.size());
+    for (size_t j = 0; j < species.size(); ++j)
+    {
+        OrganismPtr comporg = species[j]->first();
+        if (comporg)
+            reps[j] = &comporg->gnome->gene_keys();
+    }
+
+    if (NEAT::thread_pool)
+    {
+        //Compare with all of the species at once and take the first match
+        vector<U8> compatible(species.size());
+        NEAT::parallel_for(species.size(),
+            boost::bind(&check_species, boost::cref(keys), boost::cref(reps),
+                        boost::ref(compatible), _1));
+        return find(compatible.begin(), compatible.end(), 1) - compatible.begin();
+    }
+
+    for (size_t j = 0; j < reps.size(); ++j)
+    {
+        if (reps[j] && Genome::compatibility(keys, *reps[j]) < NEAT::compat_threshold)
+            return j;
+    }
+    return species.size();
+}
+
 bool Population::print_to_file_by_species(ofstream& outFile)
 {
 
@@ -427,6 +624,44 @@ bool Population::print_to_file(std::ofstream &outFile)
 }
 
 
+void Population::reproduce_in_parallel(S32 generation, vector<SpeciesPtr> &repr_species,
+                                       vector<SpeciesPtr> &sorted_species)
+{
+    //Parents are compared while breeding, so fill in their gene keys
+    //before the workers read them
+    for (vector<OrganismPtr>::iterator curorg = organisms.begin(); curorg != organisms.end(); ++curorg)
+    {
+        (*curorg)->gnome->gene_keys();
+    }
+
+    //The random streams come from NEATRandGen in Species order, and the
+    //Innovations are merged in that order, so the outcome only depends on
+    //the seed, not on the threads
+    vector<Brood> broods(repr_species.size());
+    for (size_t i = 0; i < broods.size(); ++i)
+    {
+        broods[i].seed = NEATRandGen.randInt();
+        broods[i].innovations = innovations;
+        broods[i].cur_node_id = cur_node_id;
+        broods[i].cur_innov_num = cur_innov_num;
+    }
+
+    NEAT::parallel_for(repr_species.size(),
+        boost::bind(&breed_species, generation, boost::cref(repr_species),
+                    boost::ref(sorted_species), boost::ref(broods), _1));
+
+    S32 first_node_id = cur_node_id;
+    F64 first_innov_num = cur_innov_num;
+    for (vector<Brood>::iterator curbrood = broods.begin(); curbrood != broods.end(); ++curbrood)
+    {
+        merge_brood(*this, *curbrood, first_node_id, first_innov_num);
+        for (vector<OrganismPtr>::iterator curbaby = curbrood->babies.begin(); curbaby != curbrood->babies.end(); ++curbaby)
+        {
+            add_to_species(*curbaby);
+        }
+    }
+}
+
 bool Population::epoch(S32 generation)
 {
 
@@ -856,12 +1091,19 @@ bool Population::epoch(S32 generation)
     vector<SpeciesPtr> repr_species(species.begin(), species.end());
 
     //Perform reproduction.  Reproduction is done on a per-Species
-    //basis.  (So this could be paralellized potentially.)
-    for (curspecies=repr_species.begin(); curspecies!=repr_species.end(); ++curspecies)
-     {
-         assert(*curspecies);
-         (*curspecies)->reproduce(generation, shared_from_this(), sorted_species);
-     }
+    //basis, so with worker threads the Species breed at the same time.
+    if (NEAT::thread_pool)
+    {
+        reproduce_in_parallel(generation, repr_species, sorted_species);
+    }
+    else
+    {
+        for (curspecies=repr_species.begin(); curspecies!=repr_species.end(); ++curspecies)
+        {
+            assert(*curspecies);
+            (*curspecies)->reproduce(generation, shared_from_this(), sorted_species);
+        }
+    }
 
     //cout<<"Reproduction Complete"<<endl;
 
@@ -1058,39 +1300,24 @@ OrganismPtr Population::remove_worst()
 
     F64 adjusted_fitness;
     F64 min_fitness=999999;
-    vector<OrganismPtr>::iterator curorg;
+    vector<SpeciesPtr>::iterator curspecies;
     OrganismPtr org_to_kill;
-    vector<OrganismPtr>::iterator deadorg;
     SpeciesPtr orgs_species; //The species of the dead organism
 
     //Make sure the organism is deleted from its species and the population
 
     //First find the organism with minimum *adjusted* fitness
-    for (curorg=organisms.begin(); curorg!=organisms.end(); ++curorg)
+    //The organisms of a species share its size, so this is the worst
+    //organism of one of the species
+    for (curspecies=species.begin(); curspecies!=species.end(); ++curspecies)
     {
-        adjusted_fitness=((*curorg)->fitness)/((*curorg)->species.lock()->organisms.size());
-
-        if ((*curorg)->smited)
-        {
-            //get the next time multiple
-            U32 nextMultiple;
-            if ((*curorg)->time_alive % NEAT::time_alive_minimum == 0)
-                nextMultiple = (*curorg)->time_alive;
-            else
-                nextMultiple = NEAT::time_alive_minimum * ((*curorg)->time_alive / NEAT::time_alive_minimum + 1);
-
-            adjusted_fitness=-9999;
-            (*curorg)->time_alive = nextMultiple;
-        }
+        OrganismPtr worst = (*curspecies)->worst_org(adjusted_fitness);
 
-        if ( (adjusted_fitness<min_fitness)
-            &&((*curorg)->time_alive
-                >= static_cast<S32>(NEAT::time_alive_minimum) ))
+        if (worst && (adjusted_fitness<min_fitness))
         {
             min_fitness=adjusted_fitness;
-            org_to_kill=(*curorg);
-            deadorg=curorg;
-            orgs_species = (*curorg)->species.lock();
+            org_to_kill=worst;
+            orgs_species=(*curspecies);
         }
     }
 
@@ -1099,7 +1326,7 @@ OrganismPtr Population::remove_worst()
 
         //Remove the organism from its species and the population
         orgs_species->remove_org(org_to_kill); //Remove from species
-        organisms.erase(deadorg); //Remove from population list
+        organisms.erase(find(organisms.begin(), organisms.end(), org_to_kill)); //Remove from population list
 
         //Did the species become empty?
         if (orgs_species->organisms.size()==0)
@@ -1352,54 +1579,22 @@ OrganismPtr Population::reproduce_champ(S32 generation)
 //as the speciation threshold changes.
 void Population::reassign_species(OrganismPtr org)
 {
-
-    OrganismPtr comporg;
-    bool found=false; //Note we don't really need this flag but it
-    //might be useful if we change how this function works
-    vector<SpeciesPtr>::iterator curspecies;
     SpeciesPtr newspecies;
 
-    curspecies=(species).begin();
-
-    comporg=(*curspecies)->first();
-    assert(comporg->gnome);
-    while ((curspecies!=(species).end()) && (!found))
+    size_t found = find_compatible_species(org->gnome);
+    if (found < species.size())
     {
-        if (!comporg)
-        {
-            //Keep searching for a matching species
-            ++curspecies;
-            if (curspecies!=(species).end())
-                comporg=(*curspecies)->first();
-        }
-        else if (((org->gnome)->compatibility(comporg->gnome))<NEAT::compat_threshold)
-        {
-            //If we found the same species it's already in, return 0
-            if ( *curspecies == org->species.lock() )
-            {
-                found=true;
-                break;
-            }
-            //Found compatible species
-            else
-            {
-                switch_species(org, org->species.lock(), (*curspecies));
-                found=true; //Note the search is over
-            }
-        }
-        else
-        {
-            //Keep searching for a matching species
-            ++curspecies;
-            if (curspecies!=(species).end())
-                comporg=(*curspecies)->first();
-        }
-    }
+        //If we found the same species it's already in, return 0
+        if ( species[found] == org->species.lock() )
+            return;
 
+        //Found compatible species
+        switch_species(org, org->species.lock(), species[found]);
+    }
     //If we didn't find a match, create a new species, move the org to
     // that species, check if the old species is empty, 
     //re-estimate averages, and return 0
-    if (found==false)
+    else
     {
 
         //Create a new species for the org
@@ -1444,62 +1639,29 @@ void Population::switch_species(OrganismPtr org, SpeciesPtr orig_species,
 // Add an organism to the population and to the proper species.
 void Population::add_organism(OrganismPtr org)
 {
-    vector<SpeciesPtr>::iterator curspecies; //For adding org
+    add_to_species(org);
+
+    //Put the org also in the master organism list
+    organisms.push_back(org);
+}
+
+void Population::add_to_species(OrganismPtr org)
+{
     SpeciesPtr newspecies; //For orgs in new Species
-    OrganismPtr comporg; //For Species determination through comparison
-    bool found; //When a Species is found
 
-    curspecies = species.begin();
-    if (curspecies == species.end())
+    size_t found = find_compatible_species(org->gnome);
+    if (found < species.size())
     {
-        //Create the first species
-        newspecies.reset(new Species(++last_species,true));
-        species.push_back(newspecies);
-        newspecies->add_Organism(org); //Add the org
-        org->species=newspecies; //Point the org to its species
+        //Found compatible species, so add this organism to it
+        species[found]->add_Organism(org);
+        org->species=species[found]; //Point organism to its species
     }
     else
     {
-        comporg=(*curspecies)->first();
-        assert(comporg->gnome);
-        found=false;
-
-        while ( curspecies != species.end() && (!found) )
-        {
-            if (!comporg)
-            {
-                //Keep searching for a matching species
-                ++curspecies;
-                if (curspecies!=species.end())
-                    comporg=(*curspecies)->first();
-            }
-            else if (org->gnome->compatibility(comporg->gnome) < NEAT::compat_threshold )
-            {
-                //Found compatible species, so add this organism to it
-                (*curspecies)->add_Organism(org);
-                org->species=(*curspecies); //Point organism to its species
-                found=true; //Note the search is over
-            }
-            else
-            {
-                //Keep searching for a matching species
-                ++curspecies;
-                if (curspecies!=species.end())
-                    comporg=(*curspecies)->first();
-            }
-        }
-
         //If we didn't find a match, create a new species
-        if (found==false)
-        {
-            newspecies.reset(new Species(++last_species,true));
-            species.push_back(newspecies);
-            newspecies->add_Organism(org); //Add the org
-            org->species=newspecies; //Point org to its species
-        }
-
-    } //end else     
-
-    //Put the org also in the master organism list
-    organisms.push_back(org);
+        newspecies.reset(new Species(++last_species,true));
+        species.push_back(newspecies);
+        newspecies->add_Organism(org); //Add the org
+        org->species=newspecies; //Point org to its species
+    }
 }
@@ -25,6 +25,7 @@ namespace NEAT
     {
         private:
             friend class boost::serialization::access;
+            friend class PopulationSnapshot;
         
             Population() {}
         
@@ -33,6 +34,13 @@ namespace NEAT
             // The Population does not have to be empty to add Genomes 
             bool spawn(GenomePtr g, S32 size);
 
+            // The reproduction step of epoch on the NEAT::thread_pool: every
+            // Species breeds on a worker with a random stream and innovations
+            // of its own, and the offspring are numbered and placed into
+            // Species afterwards, in the order of repr_species
+            void reproduce_in_parallel(S32 generation, std::vector<SpeciesPtr> &repr_species,
+                                       std::vector<SpeciesPtr> &sorted_species);
+
         public:
 
 			PopulationPtr copy(PopulationPtr p);
@@ -42,7 +50,7 @@ namespace NEAT
             std::vector<SpeciesPtr> species; // Species in the Population. Note that the species should comprise all the genomes 
 
             // ******* Member variables used during reproduction *******
-            std::vector<InnovationPtr> innovations; // For holding the genetic innovations of the newest generation
+            InnovationRegistry innovations; // For holding the genetic innovations of the newest generation
             S32 cur_node_id; //Current label number available
             F64 cur_innov_num;
 
@@ -106,6 +114,9 @@ namespace NEAT
             // Removes worst member of population that has been around for a minimum amount of time and returns
             // a pointer to the Organism that was removed (note that the pointer will not point to anything at all,
             // since the Organism it was pointing to has been deleted from memory)
+            // Each Species keeps its members in a FitnessIndex, so this only looks at the worst
+            // member of each Species; changes to the fitness, time_alive or smited flag of an
+            // Organism have to be reported with Species::update_org
             OrganismPtr remove_worst();
 
             OrganismPtr remove_worst_probabilistic();
@@ -126,6 +137,14 @@ namespace NEAT
             // Add an organism to the population and to the proper species.
             void add_organism(OrganismPtr org);
 
+            // Add an organism to the first compatible species, or to a new one,
+            // but not to the master organism list
+            void add_to_species(OrganismPtr org);
+
+            // Index of the first species whose first organism is compatible with
+            // the Genome, or species.size() if there is none
+            size_t find_compatible_species(GenomePtr g);
+
             // Construct off of a single spawning Genome 
             Population(GenomePtr g, S32 size);
 
@@ -165,7 +184,11 @@ namespace NEAT
                 ar & BOOST_SERIALIZATION_NVP(last_species);
                 ar & BOOST_SERIALIZATION_NVP(cur_innov_num);
                 ar & BOOST_SERIALIZATION_NVP(cur_node_id);
-                ar & BOOST_SERIALIZATION_NVP(innovations);
+                // the registry is stored as the plain list of its innovations
+                std::vector<InnovationPtr> innovation_list = innovations.get_innovations();
+                ar & boost::serialization::make_nvp("innovations", innovation_list);
+                if (Archive::is_loading::value)
+                    innovations.set_innovations(innovation_list);
                 ar & BOOST_SERIALIZATION_NVP(mean_fitness);
                 ar & BOOST_SERIALIZATION_NVP(variance);
                 ar & BOOST_SERIALIZATION_NVP(standard_deviation);
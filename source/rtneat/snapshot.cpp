@@ -0,0 +1,614 @@
+#include "core/Common.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include <stdexcept>
+#include <boost/unordered_map.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include "snapshot.h"
+#include "population.h"
+#include "innovation.h"
+#include "gene.h"
+
+using namespace NEAT;
+using namespace std;
+
+namespace
+{
+    const char SNAPSHOT_MAGIC[8] = { 'N', 'E', 'A', 'T', 'S', 'N', 'A', 'P' };
+    const U32 BYTE_ORDER_MARK = 0x01020304;
+    const U32 NO_INDEX = 0xFFFFFFFF;
+
+    // Appends fields to a growing buffer
+    class SnapshotWriter
+    {
+        public:
+            template <typename T>
+            void write(const T& value)
+            {
+                const char* bytes = reinterpret_cast<const char*>(&value);
+                buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+            }
+
+            void write_bool(bool value)
+            {
+                write(static_cast<U8>(value ? 1 : 0));
+            }
+
+            void write_string(const string& value)
+            {
+                write(static_cast<U32>(value.size()));
+                buffer.insert(buffer.end(), value.begin(), value.end());
+            }
+
+            vector<char> buffer;
+    };
+
+    // Reads fields from a block of memory, checking that they are there
+    class SnapshotReader
+    {
+        public:
+            SnapshotReader(const char* begin, size_t size, const string& filename)
+                : pos(begin), end(begin + size), filename(filename) {}
+
+            template <typename T>
+            T read()
+            {
+                need(sizeof(T));
+                T value;
+                memcpy(&value, pos, sizeof(T));
+                pos += sizeof(T);
+                return value;
+            }
+
+            bool read_bool()
+            {
+                return read<U8>() != 0;
+            }
+
+            string read_string()
+            {
+                U32 size = read<U32>();
+                need(size);
+                string value(pos, pos + size);
+                pos += size;
+                return value;
+            }
+
+            // Read an index into a list of the given size
+            U32 read_index(size_t size)
+            {
+                U32 index = read<U32>();
+                if (index != NO_INDEX && index >= size)
+                    throw runtime_error("Bad index in population snapshot: " + filename);
+                return index;
+            }
+
+            const char* pos;
+
+        private:
+            void need(size_t size)
+            {
+                if (static_cast<size_t>(end - pos) < size)
+                    throw runtime_error("Truncated population snapshot: " + filename);
+            }
+
+            const char* end;
+            string filename;
+    };
+
+    U32 index_of(const vector<TraitPtr>& traits, const TraitPtr& trait)
+    {
+        for (size_t i = 0; i < traits.size(); ++i)
+        {
+            if (traits[i] == trait)
+                return static_cast<U32>(i);
+        }
+        return NO_INDEX;
+    }
+
+#ifndef _WIN32
+    // Flush the directory that holds filename to the disk, so that a rename
+    // into it is not lost in a crash
+    bool sync_parent_directory(const string& filename)
+    {
+        string::size_type slash = filename.rfind('/');
+        string directory = slash == string::npos ? "." : filename.substr(0, slash == 0 ? 1 : slash);
+        int fd = open(directory.c_str(), O_RDONLY);
+        if (fd < 0)
+            return false;
+        bool ok = fsync(fd) == 0;
+        ok = close(fd) == 0 && ok;
+        return ok;
+    }
+#endif
+
+    // Write the buffer to a temporary file next to filename, flush it to the
+    // disk and move it over filename (flushing the directory as well where
+    // the system allows it)
+    bool write_durably(const vector<char>& buffer, const string& filename)
+    {
+        string temp = filename + ".tmp";
+#ifdef _WIN32
+        FILE* file = fopen(temp.c_str(), "wb");
+        if (!file)
+            return false;
+        bool ok = fwrite(&buffer[0], 1, buffer.size(), file) == buffer.size();
+        ok = fflush(file) == 0 && ok;
+        ok = _commit(_fileno(file)) == 0 && ok;
+        ok = fclose(file) == 0 && ok;
+        if (ok)
+        {
+            remove(filename.c_str());
+            ok = rename(temp.c_str(), filename.c_str()) == 0;
+        }
+#else
+        int fd = open(temp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+            return false;
+        bool ok = true;
+        size_t written = 0;
+        while (ok && written < buffer.size())
+        {
+            ssize_t count = write(fd, &buffer[written], buffer.size() - written);
+            if (count < 0 && errno != EINTR)
+                ok = false;
+            else if (count > 0)
+                written += count;
+        }
+        ok = fsync(fd) == 0 && ok;
+        ok = close(fd) == 0 && ok;
+        ok = ok && rename(temp.c_str(), filename.c_str()) == 0;
+        if (ok)
+            return sync_parent_directory(filename);
+#endif
+        if (!ok)
+            remove(temp.c_str());
+        return ok;
+    }
+
+    void write_genome(SnapshotWriter& out, const Genome& genome)
+    {
+        out.write(genome.genome_id);
+
+        out.write(static_cast<U32>(genome.traits.size()));
+        for (size_t i = 0; i < genome.traits.size(); ++i)
+        {
+            const Trait& trait = *genome.traits[i];
+            out.write(trait.trait_id);
+            for (S32 count = 0; count < NEAT::num_trait_params; ++count)
+                out.write(trait.params[count]);
+        }
+
+        boost::unordered_map<const NNode*, U32> node_index;
+        out.write(static_cast<U32>(genome.nodes.size()));
+        for (size_t i = 0; i < genome.nodes.size(); ++i)
+        {
+            const NNode& node = *genome.nodes[i];
+            node_index[&node] = static_cast<U32>(i);
+            out.write(node.node_id);
+            out.write(index_of(genome.traits, node.nodetrait));
+            out.write(static_cast<U8>(node.type));
+            out.write(static_cast<U8>(node.gen_node_label));
+            out.write(static_cast<U8>(node.ftype));
+            out.write_bool(node.frozen);
+            out.write_string(node._sensorName);
+            out.write_string(node._sensorArgs);
+        }
+
+        out.write(static_cast<U32>(genome.genes.size()));
+        for (size_t i = 0; i < genome.genes.size(); ++i)
+        {
+            const Gene& gene = *genome.genes[i];
+            const Link& link = *gene.lnk;
+            boost::unordered_map<const NNode*, U32>::const_iterator in_node = node_index.find(link.get_in_node().get());
+            boost::unordered_map<const NNode*, U32>::const_iterator out_node = node_index.find(link.get_out_node().get());
+            out.write(index_of(genome.traits, link.linktrait));
+            out.write(in_node == node_index.end() ? NO_INDEX : in_node->second);
+            out.write(out_node == node_index.end() ? NO_INDEX : out_node->second);
+            out.write(link.weight);
+            out.write_bool(link.is_recurrent);
+            out.write_bool(link.time_delay);
+            out.write(gene.innovation_num);
+            out.write(gene.mutation_num);
+            out.write_bool(gene.enable);
+            out.write_bool(gene.frozen);
+        }
+    }
+
+    GenomePtr read_genome(SnapshotReader& in)
+    {
+        S32 genome_id = in.read<S32>();
+
+        vector<TraitPtr> traits(in.read<U32>());
+        for (size_t i = 0; i < traits.size(); ++i)
+        {
+            traits[i] = pooled(new Trait());
+            traits[i]->trait_id = in.read<S32>();
+            for (S32 count = 0; count < NEAT::num_trait_params; ++count)
+                traits[i]->params[count] = in.read<F64>();
+        }
+
+        vector<NNodePtr> nodes(in.read<U32>());
+        for (size_t i = 0; i < nodes.size(); ++i)
+        {
+            S32 node_id = in.read<S32>();
+            U32 trait = in.read_index(traits.size());
+            nodetype type = static_cast<nodetype>(in.read<U8>());
+            nodeplace place = static_cast<nodeplace>(in.read<U8>());
+            functype function = static_cast<functype>(in.read<U8>());
+            nodes[i] = pooled(new NNode(type, node_id, place, function));
+            if (trait != NO_INDEX)
+            {
+                nodes[i]->nodetrait = traits[trait];
+                nodes[i]->trait_id = traits[trait]->trait_id;
+            }
+            nodes[i]->frozen = in.read_bool();
+            nodes[i]->_sensorName = in.read_string();
+            nodes[i]->_sensorArgs = in.read_string();
+        }
+
+        vector<GenePtr> genes(in.read<U32>());
+        for (size_t i = 0; i < genes.size(); ++i)
+        {
+            U32 trait = in.read_index(traits.size());
+            U32 in_node = in.read_index(nodes.size());
+            U32 out_node = in.read_index(nodes.size());
+            F64 weight = in.read<F64>();
+            bool recur = in.read_bool();
+            bool time_delay = in.read_bool();
+            F64 innovation_num = in.read<F64>();
+            F64 mutation_num = in.read<F64>();
+            genes[i] = pooled(new Gene(trait == NO_INDEX ? TraitPtr() : traits[trait], weight,
+                                       in_node == NO_INDEX ? NNodePtr() : nodes[in_node],
+                                       out_node == NO_INDEX ? NNodePtr() : nodes[out_node],
+                                       recur, innovation_num, mutation_num));
+            genes[i]->lnk->time_delay = time_delay;
+            genes[i]->enable = in.read_bool();
+            genes[i]->frozen = in.read_bool();
+        }
+
+        return GenomePtr(new Genome(genome_id, traits, nodes, genes, vector<FactorPtr>()));
+    }
+
+    void write_innovation(SnapshotWriter& out, const Innovation& innov)
+    {
+        out.write(static_cast<S32>(innov.innovation_type));
+        out.write(static_cast<S32>(innov.node_in_id));
+        out.write(static_cast<S32>(innov.node_out_id));
+        out.write(innov.innovation_num1);
+        out.write(innov.innovation_num2);
+        out.write(innov.new_weight);
+        out.write(static_cast<S32>(innov.new_traitnum));
+        out.write(static_cast<S32>(innov.newnode_id));
+        out.write(innov.old_innov_num);
+        out.write_bool(innov.recur_flag);
+    }
+
+    InnovationPtr read_innovation(SnapshotReader& in)
+    {
+        InnovationPtr innovation(pooled(new Innovation(0, 0, 0.0, 0.0, 0, 0.0)));
+        Innovation& innov = *innovation;
+        innov.innovation_type = static_cast<innovtype>(in.read<S32>());
+        innov.node_in_id = in.read<S32>();
+        innov.node_out_id = in.read<S32>();
+        innov.innovation_num1 = in.read<F64>();
+        innov.innovation_num2 = in.read<F64>();
+        innov.new_weight = in.read<F64>();
+        innov.new_traitnum = in.read<S32>();
+        innov.newnode_id = in.read<S32>();
+        innov.old_innov_num = in.read<F64>();
+        innov.recur_flag = in.read_bool();
+        return innovation;
+    }
+}
+
+const U32 PopulationSnapshot::VERSION;
+
+bool PopulationSnapshot::save(PopulationPtr pop, const string& filename, bool durable)
+{
+    SnapshotWriter out;
+    out.buffer.insert(out.buffer.end(), SNAPSHOT_MAGIC, SNAPSHOT_MAGIC + sizeof(SNAPSHOT_MAGIC));
+    out.write(VERSION);
+    out.write(BYTE_ORDER_MARK);
+
+    //Counters and fitness statistics
+    out.write(pop->cur_node_id);
+    out.write(pop->cur_innov_num);
+    out.write(pop->last_species);
+    out.write(pop->mean_fitness);
+    out.write(pop->variance);
+    out.write(pop->standard_deviation);
+    out.write(pop->winnergen);
+    out.write(pop->highest_fitness);
+    out.write(pop->highest_last_changed);
+
+    //Innovations
+    vector<InnovationPtr> innovs = pop->innovations.get_innovations();
+    out.write(static_cast<U32>(innovs.size()));
+    for (size_t i = 0; i < innovs.size(); ++i)
+    {
+        write_innovation(out, *innovs[i]);
+    }
+
+    //Organisms and their Genomes
+    boost::unordered_map<const Organism*, U32> org_index;
+    boost::unordered_map<const Species*, U32> species_index;
+    for (size_t j = 0; j < pop->species.size(); ++j)
+        species_index[pop->species[j].get()] = static_cast<U32>(j);
+
+    out.write(static_cast<U32>(pop->organisms.size()));
+    for (size_t i = 0; i < pop->organisms.size(); ++i)
+    {
+        const Organism& org = *pop->organisms[i];
+        org_index[&org] = static_cast<U32>(i);
+        out.write(org.fitness);
+        out.write(org.orig_fitness);
+        out.write(org.error);
+        out.write_bool(org.winner);
+        out.write(static_cast<S32>(org.generation));
+        out.write(static_cast<S32>(org.time_alive));
+        out.write_bool(org.smited);
+        out.write_string(org.metadata);
+        write_genome(out, *org.gnome);
+    }
+
+    //Species and their members, in order
+    out.write(static_cast<U32>(pop->species.size()));
+    for (size_t j = 0; j < pop->species.size(); ++j)
+    {
+        const Species& species = *pop->species[j];
+        out.write(static_cast<S32>(species.id));
+        out.write(static_cast<S32>(species.age));
+        out.write(species.ave_fitness);
+        out.write(species.max_fitness);
+        out.write(species.max_fitness_ever);
+        out.write(static_cast<S32>(species.expected_offspring));
+        out.write_bool(species.novel);
+        out.write_bool(species.checked);
+        out.write_bool(species.obliterate);
+        out.write(static_cast<S32>(species.age_of_last_improvement));
+        out.write(species.average_est);
+        out.write(static_cast<U32>(species.organisms.size()));
+        for (size_t i = 0; i < species.organisms.size(); ++i)
+        {
+            boost::unordered_map<const Organism*, U32>::const_iterator found = org_index.find(species.organisms[i].get());
+            out.write(found == org_index.end() ? NO_INDEX : found->second);
+        }
+    }
+
+    if (!durable)
+    {
+        ofstream file(filename.c_str(), ios::out | ios::binary | ios::trunc);
+        if (!file)
+            return false;
+        file.write(&out.buffer[0], out.buffer.size());
+        file.close();
+        return !file.fail();
+    }
+    return write_durably(out.buffer, filename);
+}
+
+OrganismPtr PopulationSnapshot::freeze_organism(const Organism& org)
+{
+    OrganismPtr frozen(new Organism());
+    frozen->fitness = org.fitness;
+    frozen->orig_fitness = org.orig_fitness;
+    frozen->error = org.error;
+    frozen->winner = org.winner;
+    frozen->gnome = org.gnome;
+    frozen->expected_offspring = org.expected_offspring;
+    frozen->generation = org.generation;
+    frozen->eliminate = org.eliminate;
+    frozen->champion = org.champion;
+    frozen->super_champ_offspring = org.super_champ_offspring;
+    frozen->pop_champ = org.pop_champ;
+    frozen->pop_champ_child = org.pop_champ_child;
+    frozen->high_fit = org.high_fit;
+    frozen->time_alive = org.time_alive;
+    frozen->mut_struct_baby = org.mut_struct_baby;
+    frozen->mate_baby = org.mate_baby;
+    frozen->metadata = org.metadata;
+    frozen->modified = org.modified;
+    frozen->smited = org.smited;
+    return frozen;
+}
+
+PopulationPtr PopulationSnapshot::freeze(PopulationPtr pop)
+{
+    PopulationPtr frozen(new Population());
+    frozen->cur_node_id = pop->cur_node_id;
+    frozen->cur_innov_num = pop->cur_innov_num;
+    frozen->last_species = pop->last_species;
+    frozen->mean_fitness = pop->mean_fitness;
+    frozen->variance = pop->variance;
+    frozen->standard_deviation = pop->standard_deviation;
+    frozen->winnergen = pop->winnergen;
+    frozen->highest_fitness = pop->highest_fitness;
+    frozen->highest_last_changed = pop->highest_last_changed;
+    frozen->innovations = pop->innovations;
+
+    //Shallow copies of the Organisms that keep the Genomes but not the Networks
+    boost::unordered_map<const Organism*, OrganismPtr> copies;
+    frozen->organisms.reserve(pop->organisms.size());
+    for (size_t i = 0; i < pop->organisms.size(); ++i)
+    {
+        OrganismPtr org = freeze_organism(*pop->organisms[i]);
+        copies[pop->organisms[i].get()] = org;
+        frozen->organisms.push_back(org);
+    }
+
+    frozen->species.reserve(pop->species.size());
+    for (size_t j = 0; j < pop->species.size(); ++j)
+    {
+        SpeciesPtr species(new Species(*pop->species[j]));
+        for (size_t i = 0; i < species->organisms.size(); ++i)
+        {
+            boost::unordered_map<const Organism*, OrganismPtr>::const_iterator found = copies.find(species->organisms[i].get());
+            if (found == copies.end())
+                continue;
+            species->organisms[i] = found->second;
+            found->second->species = species;
+        }
+        frozen->species.push_back(species);
+    }
+
+    return frozen;
+}
+
+PopulationPtr PopulationSnapshot::load(const string& filename)
+{
+    using namespace boost::interprocess;
+
+    if (!is_snapshot(filename))
+        throw runtime_error("Not a population snapshot: " + filename);
+
+    file_mapping file(filename.c_str(), read_only);
+    mapped_region region(file, read_only);
+    SnapshotReader in(static_cast<const char*>(region.get_address()), region.get_size(), filename);
+
+    in.pos += sizeof(SNAPSHOT_MAGIC);
+    U32 version = in.read<U32>();
+    if (version != VERSION)
+        throw runtime_error("Unsupported population snapshot version in " + filename);
+    if (in.read<U32>() != BYTE_ORDER_MARK)
+        throw runtime_error("Population snapshot has a different byte order: " + filename);
+
+    PopulationPtr pop(new Population());
+
+    //Counters and fitness statistics
+    pop->cur_node_id = in.read<S32>();
+    pop->cur_innov_num = in.read<F64>();
+    pop->last_species = in.read<S32>();
+    pop->mean_fitness = in.read<F64>();
+    pop->variance = in.read<F64>();
+    pop->standard_deviation = in.read<F64>();
+    pop->winnergen = in.read<S32>();
+    pop->highest_fitness = in.read<F64>();
+    pop->highest_last_changed = in.read<S32>();
+
+    //Innovations
+    vector<InnovationPtr> innovs(in.read<U32>());
+    for (size_t i = 0; i < innovs.size(); ++i)
+    {
+        innovs[i] = read_innovation(in);
+    }
+    pop->innovations.set_innovations(innovs);
+
+    //Organisms and their Genomes
+    pop->organisms.resize(in.read<U32>());
+    for (size_t i = 0; i < pop->organisms.size(); ++i)
+    {
+        F64 fitness = in.read<F64>();
+        F64 orig_fitness = in.read<F64>();
+        F64 error = in.read<F64>();
+        bool winner = in.read_bool();
+        S32 generation = in.read<S32>();
+        S32 time_alive = in.read<S32>();
+        bool smited = in.read_bool();
+        string metadata = in.read_string();
+        OrganismPtr org(new Organism(fitness, read_genome(in), generation, metadata));
+        org->orig_fitness = orig_fitness;
+        org->error = error;
+        org->winner = winner;
+        org->time_alive = time_alive;
+        org->smited = smited;
+        pop->organisms[i] = org;
+    }
+
+    //Species and their members, in order
+    pop->species.resize(in.read<U32>());
+    for (size_t j = 0; j < pop->species.size(); ++j)
+    {
+        SpeciesPtr species(new Species(in.read<S32>()));
+        species->age = in.read<S32>();
+        species->ave_fitness = in.read<F64>();
+        species->max_fitness = in.read<F64>();
+        species->max_fitness_ever = in.read<F64>();
+        species->expected_offspring = in.read<S32>();
+        species->novel = in.read_bool();
+        species->checked = in.read_bool();
+        species->obliterate = in.read_bool();
+        species->age_of_last_improvement = in.read<S32>();
+        species->average_est = in.read<F64>();
+        U32 members = in.read<U32>();
+        for (U32 i = 0; i < members; ++i)
+        {
+            U32 index = in.read_index(pop->organisms.size());
+            if (index == NO_INDEX)
+                continue;
+            species->organisms.push_back(pop->organisms[index]);
+            pop->organisms[index]->species = species;
+        }
+        pop->species[j] = species;
+    }
+
+    return pop;
+}
+
+bool PopulationSnapshot::is_snapshot(const string& filename)
+{
+    ifstream file(filename.c_str(), ios::in | ios::binary);
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    if (!file.read(magic, sizeof(magic)))
+        return false;
+    return memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0;
+}
+
+bool PopulationSnapshot::text_to_snapshot(const string& text_file, const string& snapshot_file)
+{
+    PopulationPtr pop(new Population(text_file));
+    return save(pop, snapshot_file);
+}
+
+bool PopulationSnapshot::snapshot_to_text(const string& snapshot_file, const string& text_file)
+{
+    PopulationPtr pop = load(snapshot_file);
+    ofstream file(text_file.c_str());
+    if (!file)
+        return false;
+    pop->print_to_file(file);
+    file.close();
+    return !file.fail();
+}
+
+void PopulationSnapshot::append_genome(vector<char>& buffer, const Genome& genome)
+{
+    SnapshotWriter out;
+    out.buffer.swap(buffer);
+    write_genome(out, genome);
+    buffer.swap(out.buffer);
+}
+
+void PopulationSnapshot::append_innovation(vector<char>& buffer, const Innovation& innov)
+{
+    SnapshotWriter out;
+    out.buffer.swap(buffer);
+    write_innovation(out, innov);
+    buffer.swap(out.buffer);
+}
+
+GenomePtr PopulationSnapshot::extract_genome(const char*& pos, const char* end)
+{
+    SnapshotReader in(pos, end - pos, "genome buffer");
+    GenomePtr genome = read_genome(in);
+    pos = in.pos;
+    return genome;
+}
+
+InnovationPtr PopulationSnapshot::extract_innovation(const char*& pos, const char* end)
+{
+    SnapshotReader in(pos, end - pos, "innovation buffer");
+    InnovationPtr innov = read_innovation(in);
+    pos = in.pos;
+    return innov;
+}
@@ -0,0 +1,79 @@
+#ifndef _SNAPSHOT_H_
+#define _SNAPSHOT_H_
+
+#include <string>
+#include <vector>
+#include "neat.h"
+
+namespace NEAT
+{
+    // ------------------------------------------------------------
+    // A POPULATIONSNAPSHOT is a compact binary image of a whole
+    //   Population: the traits, nodes and genes of every Genome, the
+    //   Organisms with their fitness, the Species with their members
+    //   and statistics, the Innovations and the innovation counters.
+    //
+    //   The file starts with a magic string, a format version and a
+    //   byte order mark, followed by the fields in native byte order.
+    //   Genes refer to their nodes and traits by index, so loading
+    //   does no parsing and no searching, and the Species are restored
+    //   as they were saved instead of speciating again.  Snapshots are
+    //   loaded by mapping the file into memory.
+    //
+    //   Genome factors are not stored (the text format drops them on
+    //   load as well).
+    // ------------------------------------------------------------
+    class PopulationSnapshot
+    {
+        public:
+            // Version of the format written by save
+            static const U32 VERSION = 1;
+
+            // Write the population to a snapshot file
+            // (if durable, write a temporary file, flush it to disk and
+            //  rename it, so the file is either complete or missing)
+            static bool save(PopulationPtr pop, const std::string& filename,
+                             bool durable = false);
+
+            // A copy of the Population, its Organisms and its Species that
+            //   shares the Genomes of the original, so that it can be saved
+            //   on another thread while the original keeps evolving.
+            //   New offspring get new Genomes, and Organism::update_genotype
+            //   copies a shared Genome before changing it.
+            static PopulationPtr freeze(PopulationPtr pop);
+
+            // Read a population from a snapshot file
+            // (throws std::runtime_error if it cannot be read)
+            static PopulationPtr load(const std::string& filename);
+
+            // Does the file start like a population snapshot?
+            static bool is_snapshot(const std::string& filename);
+
+            // Convert a population from the text format to a snapshot
+            static bool text_to_snapshot(const std::string& text_file,
+                                         const std::string& snapshot_file);
+
+            // Convert a population snapshot to the text format
+            static bool snapshot_to_text(const std::string& snapshot_file,
+                                         const std::string& text_file);
+
+            // Append a Genome or an Innovation to a buffer in the form
+            //   they take in a snapshot (for sending them elsewhere)
+            static void append_genome(std::vector<char>& buffer, const Genome& genome);
+            static void append_innovation(std::vector<char>& buffer, const Innovation& innov);
+
+            // Read back what append_genome or append_innovation wrote,
+            //   moving pos past it
+            // (throws std::runtime_error if it runs past end)
+            static GenomePtr extract_genome(const char*& pos, const char* end);
+            static InnovationPtr extract_innovation(const char*& pos, const char* end);
+
+        private:
+            // A copy of an Organism that shares its Genome but has neither
+            //   a Network nor a Species
+            static OrganismPtr freeze_organism(const Organism& org);
+    };
+
+} // namespace NEAT
+
+#endif
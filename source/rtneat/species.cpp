@@ -68,34 +68,40 @@ bool Species::rank()
 
 F64 Species::estimate_average()
 {
-    vector<OrganismPtr>::iterator curorg;
-    F64 total = 0.0; //running total of fitnesses
-
     //Note: Since evolution is happening in real-time, some organisms may not
     //have been around long enough to count them in the fitness evaluation
+    //(the fitness index only holds the ones that have)
+    index_members();
+    average_est = fitness_index.average();
 
-    F64 num_orgs = 0; //counts number of orgs above the time_alive threshold
-
+    return average_est;
+}
 
-    for (curorg = organisms.begin(); curorg != organisms.end(); ++curorg)
-    {
-        //New variable time_alive
-        if (((*curorg)->time_alive) >= static_cast<S32>(NEAT::time_alive_minimum))
-        {
-            total += (*curorg)->fitness;
-            ++num_orgs;
-            //Con::printf("Est.: Organism %d fitness %f",(*curorg)->gnome->genome_id, (*curorg)->fitness);
-        }
-    }
+void Species::update_org(OrganismPtr org)
+{
+    index_members();
+    fitness_index.update(org);
+}
 
-    if (num_orgs > 0)
-        average_est = total / num_orgs;
-    else
+OrganismPtr Species::worst_org(F64& adjusted_fitness)
+{
+    index_members();
+    OrganismPtr worst = fitness_index.worst();
+    if (worst)
     {
-        average_est = 0;
+        //Smited organisms go first, whatever their fitness
+        if (fitness_index.worst_smited())
+            adjusted_fitness = -9999;
+        else
+            adjusted_fitness = fitness_index.worst_fitness() / organisms.size();
     }
+    return worst;
+}
 
-    return average_est;
+void Species::index_members()
+{
+    if (!fitness_index.is_valid(organisms.size()))
+        fitness_index.rebuild(organisms);
 }
 
 OrganismPtr Species::reproduce_one(S32 generation, PopulationPtr& pop,
@@ -513,7 +519,9 @@ bool Species::add_Organism(OrganismPtr o)
 {
     assert(o);
     assert(o->gnome);
+    index_members();
     organisms.push_back(o);
+    fitness_index.insert(o);
     return true;
 }
 
@@ -545,7 +553,9 @@ bool Species::remove_org(OrganismPtr org)
         ++curorg;
 
     assert(curorg != organisms.end());
+    index_members();
     organisms.erase(curorg);
+    fitness_index.erase(org);
     return true;
 
 }
@@ -640,6 +650,9 @@ void Species::adjust_fitness()
 
     }
 
+    //Every fitness changed, so index them again when needed
+    fitness_index.invalidate();
+
     //Sort the population and mark for death those after survival_thresh*pop_size
     sort(organisms.begin(), organisms.end(), order_orgs);
 
@@ -739,6 +752,26 @@ F64 Species::count_offspring(F64 skim)
 
 bool Species::reproduce(S32 generation, PopulationPtr pop,
                         vector<SpeciesPtr> &sorted_species)
+{
+    vector<OrganismPtr> babies;
+    vector<OrganismPtr>::iterator curbaby;
+
+    if (!breed(generation, sorted_species, pop->innovations, pop->cur_node_id,
+               pop->cur_innov_num, babies))
+        return false;
+
+    //Add each baby to its proper Species
+    //If it doesn't fit a Species, create a new one
+    for (curbaby=babies.begin(); curbaby!=babies.end(); ++curbaby)
+    {
+        pop->add_to_species(*curbaby);
+    }
+    return true;
+}
+
+bool Species::breed(S32 generation, vector<SpeciesPtr> &sorted_species,
+                    InnovationRegistry &innovations, S32 &cur_node_id,
+                    F64 &cur_innov_num, vector<OrganismPtr> &babies)
 {
     S32 count;
     vector<OrganismPtr>::iterator curorg;
@@ -753,10 +786,6 @@ bool Species::reproduce(S32 generation, PopulationPtr pop,
 
     GenomePtr new_genome; //For holding baby's genes
 
-    vector<SpeciesPtr>::iterator curspecies; //For adding baby
-    SpeciesPtr newspecies; //For babies in new Species
-    OrganismPtr comporg; //For Species determination through comparison
-
     SpeciesPtr randspecies; //For mating outside the Species
     F64 randmult;
     S32 randspeciesnum;
@@ -765,8 +794,6 @@ bool Species::reproduce(S32 generation, PopulationPtr pop,
 
     bool outside;
 
-    bool found; //When a Species is found
-
     bool champ_done=false; //Flag the preservation of the champion  
 
     OrganismPtr thechamp;
@@ -832,8 +859,8 @@ bool Species::reproduce(S32 generation, PopulationPtr pop,
                 {
                     //Sometimes we add a link to a superchamp
                     NetworkPtr net_analogue=new_genome->genesis(generation);
-                    new_genome->mutate_add_link(pop->innovations,
-                                                pop->cur_innov_num,
+                    new_genome->mutate_add_link(innovations,
+                                                cur_innov_num,
                                                 NEAT::newlink_tries);
                     mut_struct_baby=true;
                 }
@@ -902,16 +929,16 @@ bool Species::reproduce(S32 generation, PopulationPtr pop,
             if (randfloat()<NEAT::mutate_add_node_prob)
             {
                 //cout<<"mutate add node"<<endl;
-                new_genome->mutate_add_node(pop->innovations, pop->cur_node_id,
-                                            pop->cur_innov_num);
+                new_genome->mutate_add_node(innovations, cur_node_id,
+                                            cur_innov_num);
                 mut_struct_baby=true;
             }
             else if (randfloat()<NEAT::mutate_add_link_prob)
             {
                 //cout<<"mutate add link"<<endl;
                 NetworkPtr net_analogue(new_genome->genesis(generation));
-                new_genome->mutate_add_link(pop->innovations,
-                                            pop->cur_innov_num,
+                new_genome->mutate_add_link(innovations,
+                                            cur_innov_num,
                                             NEAT::newlink_tries);
                 mut_struct_baby=true;
             }
@@ -1075,17 +1102,17 @@ bool Species::reproduce(S32 generation, PopulationPtr pop,
                 //various mutations
                 if (randfloat()<NEAT::mutate_add_node_prob)
                 {
-                    new_genome->mutate_add_node(pop->innovations,
-                                                pop->cur_node_id,
-                                                pop->cur_innov_num);
+                    new_genome->mutate_add_node(innovations,
+                                                cur_node_id,
+                                                cur_innov_num);
                     //  cout<<"mutate_add_node: "<<new_genome<<endl;
                     mut_struct_baby=true;
                 }
                 else if (randfloat()<NEAT::mutate_add_link_prob)
                 {
                     NetworkPtr net_analogue=new_genome->genesis(generation);
-                    new_genome->mutate_add_link(pop->innovations,
-                                                pop->cur_innov_num,
+                    new_genome->mutate_add_link(innovations,
+                                                cur_innov_num,
                                                 NEAT::newlink_tries);
                     mut_struct_baby=true;
                 }
@@ -1138,61 +1165,10 @@ bool Species::reproduce(S32 generation, PopulationPtr pop,
 
         }
 
-        //Add the baby to its proper Species
-        //If it doesn't fit a Species, create a new one
-
         baby->mut_struct_baby=mut_struct_baby;
         baby->mate_baby=mate_baby;
 
-        curspecies=(pop->species).begin();
-        if (curspecies==(pop->species).end())
-        {
-            //Create the first species
-            newspecies.reset(new Species(++(pop->last_species),true));
-            (pop->species).push_back(newspecies);
-            newspecies->add_Organism(baby); //Add the baby
-            baby->species=newspecies; //Point the baby to its species
-        }
-        else
-        {
-            comporg=(*curspecies)->first();
-            found=false;
-            while ((curspecies!=(pop->species).end())&&(!found))
-            {
-                if (!comporg)
-                {
-                    //Keep searching for a matching species
-                    ++curspecies;
-                    if (curspecies!=(pop->species).end())
-                        comporg=(*curspecies)->first();
-                }
-                else if (((baby->gnome)->compatibility(comporg->gnome))
-                    <NEAT::compat_threshold)
-                {
-                    //Found compatible species, so add this organism to it
-                    (*curspecies)->add_Organism(baby);
-                    baby->species=(*curspecies); //Point organism to its species
-                    found=true; //Note the search is over
-                }
-                else
-                {
-                    //Keep searching for a matching species
-                    ++curspecies;
-                    if (curspecies!=(pop->species).end())
-                        comporg=(*curspecies)->first();
-                }
-            }
-
-            //If we didn't find a match, create a new species
-            if (found==false)
-            {
-                newspecies.reset(new Species(++(pop->last_species),true));
-                (pop->species).push_back(newspecies);
-                newspecies->add_Organism(baby); //Add the baby
-                baby->species=newspecies; //Point baby to its species
-            }
-
-        } //end else 
+        babies.push_back(baby);
 
     }
     return true;
@@ -9,6 +9,8 @@
 #include "population.h"
 #include "network.h"
 #include "gene.h"
+#include "innovation.h"
+#include "fitnessindex.h"
 #include "XMLSerializable.h"
 
 namespace NEAT
@@ -85,6 +87,17 @@ namespace NEAT
             bool reproduce(int generation, PopulationPtr pop,
                            std::vector<SpeciesPtr> &sorted_species);
 
+            //The mating and mutation part of reproduce: append the offspring
+            //to babies without putting them into a Species.  New nodes and
+            //innovations are numbered from cur_node_id and cur_innov_num and
+            //recorded in innovations.  Parents all come from the old
+            //generation, and the only member changed is the champion's
+            //super_champ_offspring, so several Species can breed at once if
+            //each has its own innovations and counters.
+            bool breed(int generation, std::vector<SpeciesPtr> &sorted_species,
+                       InnovationRegistry &innovations, int &cur_node_id,
+                       double &cur_innov_num, std::vector<OrganismPtr> &babies);
+
             // *** Real-time methods *** 
 
             //Place organisms in this species in order by their fitness
@@ -95,8 +108,18 @@ namespace NEAT
             //New variable: average_est, NEAT::time_alive_minimum (const) 
             //Note: Initialization requires calling estimate_average() on all species
             //      Later it should be called only when a species changes 
+            //The fitness sum is kept up to date by update_org, so this does
+            //not go through the organisms
             double estimate_average();
 
+            //Tell the species that the fitness, time_alive or smited flag
+            //of one of its organisms changed
+            void update_org(OrganismPtr org);
+
+            //The organism remove_worst would pick in this species, with its
+            //adjusted fitness (NULL if none has been alive long enough)
+            OrganismPtr worst_org(double& adjusted_fitness);
+
             //Like the usual reproduce() method except only one offspring is produced
             //Note that "generation" will be used to just count which offspring # this is over all evolution
             //Here is how to get sorted species:
@@ -114,6 +137,15 @@ namespace NEAT
             Species(int i, bool n);
 
             ~Species();
+
+        private:
+            //The members that are old enough to be judged, worst first
+            FitnessIndex fitness_index;
+
+            //Rebuild fitness_index if it does not match the members
+            void index_members();
+
+        public:
             
             /// serialize this object to/from a Boost serialization archive
             template<class Archive>
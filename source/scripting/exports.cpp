@@ -25,6 +25,7 @@
 #include "ai/sensors/RadarSensor.h"
 #include "ai/sensors/SensorArray.h"
 #include "core/IrrUtil.h"
+#include "core/Profiler.h"
 #include "game/Kernel.h"
 #include "game/objects/PropertyMap.h"
 #include "scripting/Scheduler.h"
@@ -62,6 +63,12 @@ namespace OpenNero {
 				.def_readonly("episode", &AgentBrain::episode, "Current episode count")
 				.def_readonly("fitness", &AgentBrain::fitness, "Cumulative reward for this episode")
 				.add_property("state", make_function(&AgentBrain::GetSharedState, return_value_policy<reference_existing_object>()), "Body of the agent");
+			// export the replay buffer so that the brains of a team can share one
+			py::class_<ReplayBuffer, ReplayBufferPtr, noncopyable>("ReplayBuffer", "Circular store of transitions replayed by TD agents", init<size_t>())
+				.def("__len__", &ReplayBuffer::size, "Number of transitions stored")
+				.def("clear", &ReplayBuffer::clear, "Remove all of the transitions")
+				.add_property("capacity", &ReplayBuffer::capacity, "Number of transitions kept")
+				.add_property("added", &ReplayBuffer::getNumAdded, "Number of transitions added since the buffer was created");
 			// export the interface to python so that we can override its methods there
 			py::class_<TDBrain, noncopyable, bases<AgentBrain>, TDBrainPtr >("TDBrain", "Time-Difference RL agent", no_init )
 				.def("initialize", &TDBrain::initialize, "Called before learning starts")
@@ -69,9 +76,15 @@ namespace OpenNero {
 				.def("act", &TDBrain::act, "Called for every step of the state-action loop")
 				.def("end", &TDBrain::end, "Called at the end of a learning episode")
 				.def("destroy", &TDBrain::destroy, "Called after learning ends")
+				.def("save_table", &TDBrain::save_table, "Write the Q table of a tabular agent to a binary file")
+				.def("load_table", &TDBrain::load_table, "Read the Q table of a tabular agent from a binary file")
 				.add_property("epsilon", &TDBrain::getEpsilon, &TDBrain::setEpsilon)
 				.add_property("alpha", &TDBrain::getAlpha, &TDBrain::setAlpha)
 				.add_property("gamma", &TDBrain::getGamma, &TDBrain::setGamma)
+				.add_property("replay_buffer", &TDBrain::getReplayBuffer, &TDBrain::setReplayBuffer, "Transitions to replay (None to learn online only)")
+				.add_property("replay_batch_size", &TDBrain::getReplayBatchSize, &TDBrain::setReplayBatchSize, "Number of transitions replayed at a time")
+				.add_property("replay_frequency", &TDBrain::getReplayFrequency, &TDBrain::setReplayFrequency, "Number of transitions added between replays")
+				.add_property("hidden_units", &TDBrain::getHiddenUnits, &TDBrain::setHiddenUnits, "Number of hidden units of a neural network approximator (0 for a table or tiles)")
 				.add_property("state", make_function(&TDBrain::GetSharedState, return_value_policy<reference_existing_object>()), "Body of the agent");
 			// export the interface to python so that we can override its methods there
 			py::class_<SarsaBrain, bases<TDBrain>, SarsaBrainPtr >("SarsaBrain", "SARSA RL agent", init<double, double, double, double, int, int, int, int>() )
@@ -196,6 +209,8 @@ namespace OpenNero {
 				.def(self_ns::str(self_ns::self));
 
 			// export bounded array info
+			FeatureVector (FeatureVectorInfo::*get_instance)() const = &FeatureVectorInfo::getInstance;
+			FeatureVector (FeatureVectorInfo::*get_random)() const = &FeatureVectorInfo::getRandom;
 			py::class_<FeatureVectorInfo>("FeatureVectorInfo", "Describe constraints of a feature vector")
 				.def("__len__", &FeatureVectorInfo::size, "Length of the feature vector")
 				.def(self_ns::str(self_ns::self))
@@ -211,8 +226,8 @@ namespace OpenNero {
 				.def("validate", &FeatureVectorInfo::validate, "Check whether a feature vector is valid")
 				.def("normalize", &FeatureVectorInfo::normalize, "Normalize the feature vector given this info")
 				.def("denormalize", &FeatureVectorInfo::denormalize, "Create an instance of a feature vector from a vector of values between 0 and 1")
-				.def("get_instance", &FeatureVectorInfo::getInstance, "Create a feature vector based on this information")
-				.def("random", &FeatureVectorInfo::getRandom, "Create a random feature vector uniformly distributed within bounds")
+				.def("get_instance", get_instance, "Create a feature vector based on this information")
+				.def("random", get_random, "Create a random feature vector uniformly distributed within bounds")
 				;
 
 			// export std::vector<double>
@@ -268,6 +283,75 @@ namespace OpenNero {
 			AIManager::instance().SetEnabled(false);
 		}
 
+		/// set the number of threads that make agent decisions; only brains
+		/// implemented in C++ use them
+		void set_ai_threads(size_t num_threads)
+		{
+			AIManager::instance().SetNumThreads(num_threads);
+		}
+
+		/// read a flat list of numbers, or an array('d') without copying it element by element
+		void extract_doubles(py::object values, std::vector<double>& result)
+		{
+			const void* buffer = NULL;
+			Py_ssize_t length = 0;
+			if (PyObject_HasAttrString(values.ptr(), "typecode") &&
+				py::extract<std::string>(values.attr("typecode"))() == "d" &&
+				PyObject_AsReadBuffer(values.ptr(), &buffer, &length) == 0)
+			{
+				const double* begin = static_cast<const double*>(buffer);
+				result.assign(begin, begin + length / sizeof(double));
+				return;
+			}
+			result.resize(py::len(values));
+			for (size_t i = 0; i < result.size(); ++i)
+			{
+				result[i] = py::extract<double>(values[i]);
+			}
+		}
+
+		/// make a Python array of the given type code from a contiguous buffer
+		template <typename T>
+		py::object make_array(const char* type_code, const std::vector<T>& values)
+		{
+			py::object result = py::import("array").attr("array")(type_code);
+			if (!values.empty())
+			{
+				result.attr("fromstring")(py::str(reinterpret_cast<const char*>(&values[0]), values.size() * sizeof(T)));
+			}
+			return result;
+		}
+
+		/// step a batch of agents with a flat buffer of actions, one row per agent
+		/// @return (observations, rewards, dones) as flat arrays, one row per agent
+		py::tuple step_agents(py::list agents, py::object actions)
+		{
+			std::vector<AgentBrainPtr> brains;
+			for (py::ssize_t i = 0; i < py::len(agents); ++i)
+			{
+				brains.push_back(py::extract<AgentBrainPtr>(agents[i]));
+			}
+			std::vector<double> action_buffer, observations, rewards;
+			std::vector<uint8_t> dones;
+			extract_doubles(actions, action_buffer);
+			AIManager::instance().StepAgents(brains, action_buffer, observations, rewards, dones);
+			return py::make_tuple(make_array("d", observations), make_array("d", rewards), make_array("B", dones));
+		}
+
+		/// start a new episode for a batch of agents
+		/// @return the first observations as a flat array, one row per agent
+		py::object reset_agents(py::list agents)
+		{
+			std::vector<AgentBrainPtr> brains;
+			for (py::ssize_t i = 0; i < py::len(agents); ++i)
+			{
+				brains.push_back(py::extract<AgentBrainPtr>(agents[i]));
+			}
+			std::vector<double> observations;
+			AIManager::instance().ResetAgents(brains, observations);
+			return make_array("d", observations);
+		}
+
 		/// reset environment
 		void reset_ai()
 		{
@@ -296,8 +380,11 @@ namespace OpenNero {
 			py::def("enable_ai", &enable_ai, "enable AI");
 			py::def("disable_ai", &disable_ai, "disable AI");
 			py::def("reset_ai", &reset_ai, "reset AI");
+			py::def("set_ai_threads", &set_ai_threads, "set the number of threads that make the decisions of C++ agent brains (TD, Q-learning, Sarsa, random) and speciate rtNEAT populations in parallel (1 for none); brains written in Python, including the rtNEAT agents of the mods, always decide on the main thread (use RTNEAT.activate_all to batch their networks)");
 			py::def("get_environment", &get_environment, "get the current environment");
 			py::def("set_environment", &set_environment, "set the current environment");
+			py::def("step_agents", &step_agents, "perform the actions of a list of agents given as one flat list or array('d') with a row per agent, and return (observations, rewards, dones) as flat arrays with a row per agent; agents whose episode ended start a new one");
+			py::def("reset_agents", &reset_agents, "start a new episode for a list of agents and return their first observations as a flat array with a row per agent");
 
 			py::def("get_ai", &getAI, "return AIPtr");
 			py::def("set_ai", &setAI,"set AI ptr");
@@ -352,11 +439,33 @@ namespace OpenNero {
                 .def("release_organism", &RTNEAT::release_organism, "release the organism after the agent is done")
                 .def("ready", &RTNEAT::ready, "return true iff RTNEAT is ready to produce a new organism")
                 .def("has_organism", &RTNEAT::has_organism, "return true iff RTNEAT has an organism for this agent")
+                .def("activate_all", &RTNEAT::activate_all, "load the sensors of the networks of a list of agents from a list of lists of observations, activate them all at once and return a list of lists of outputs")
                 .def("set_weight", &RTNEAT::set_weight, "set weight i to value f")
                 .def("set_lifetime", &RTNEAT::set_lifetime, "set the lifetime of an agent")
 				.def("save_population", &RTNEAT::save_population, "save the population to a file")
+				.def("save_population_snapshot", &RTNEAT::save_population_snapshot, "save the population to a binary snapshot file")
+				.def("load_population", &RTNEAT::load_population, "load the population from a text or binary snapshot file")
+				.def("convert_population", &RTNEAT::convert_population, "convert a population file between the text and binary snapshot formats")
+				.staticmethod("convert_population")
+				.def("checkpoint_population", &RTNEAT::checkpoint_population, "start saving a snapshot of the population to a numbered file in the background; returns False if the previous checkpoint is still being written")
+				.def("set_checkpoints_kept", &RTNEAT::set_checkpoints_kept, "set the number of checkpoint files to keep")
+				.def("checkpoint_in_progress", &RTNEAT::checkpoint_in_progress, "return true iff a checkpoint is still being written")
+				.def("wait_for_checkpoint", &RTNEAT::wait_for_checkpoint, "wait for the checkpoint in progress to be written")
+				.def("get_last_checkpoint_file", &RTNEAT::get_last_checkpoint_file, "the file of the last completed checkpoint")
+				.def("get_last_checkpoint_succeeded", &RTNEAT::get_last_checkpoint_succeeded, "return true iff the last completed checkpoint was written successfully")
+				.def("get_last_checkpoint_duration", &RTNEAT::get_last_checkpoint_duration, "the time it took to write the last completed checkpoint, in seconds")
+				.def("join_islands", &RTNEAT::join_islands, "make the population one island of a multi-process island model: connect to the island coordinator at a Unix socket path, then every interval offspring send the given number of champions to the next island")
+				.def("get_island_id", &RTNEAT::get_island_id, "the number of this island, or -1 if it is not part of an island model")
                 .def("enable_evolution", &RTNEAT::enable_evolution, "turn evolution on")
                 .def("disable_evolution", &RTNEAT::disable_evolution, "turn evolution off");
+
+			// export the coordinator of the rtNEAT island model
+			py::class_<IslandCoordinator, IslandCoordinatorPtr, noncopyable>("IslandCoordinator", "passes champions between rtNEAT islands evolving in separate processes", init<const std::string&>())
+				.def("listen", &IslandCoordinator::listen, "start listening for islands on the Unix socket path")
+				.def("poll", &IslandCoordinator::poll, "accept new islands and pass on migrants, waiting up to the given number of milliseconds")
+				.add_property("num_islands", &IslandCoordinator::num_islands, "number of islands connected")
+				.add_property("num_migrants", &IslandCoordinator::num_migrants, "number of genomes passed on so far")
+				.def("close", &IslandCoordinator::close, "disconnect the islands and stop listening");
 		}
         
 		/// the pickling suite for the Vector class
@@ -776,6 +885,8 @@ namespace OpenNero {
 
         BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(findInRay_overloads, PyFindInRay, 2, 6)
 
+        BOOST_PYTHON_MEMBER_FUNCTION_OVERLOADS(findInRays_overloads, PyFindInRays, 1, 2)
+
         void ExportSimContextScripts()
         {
             py::class_<SimContext>("SimContext", "The simulation context from an XML file", no_init )
@@ -812,6 +923,9 @@ namespace OpenNero {
                 .def("findInRay",
                      &SimContext::PyFindInRay,
                      findInRay_overloads("Find the first object that intersects the specified ray (origin:Vector3f, target:Vector3f, [int])") )
+                .def("findInRays",
+                     &SimContext::PyFindInRays,
+                     findInRays_overloads("Find the first object that intersects each of the rays in a list of (origin:Vector3f, target:Vector3f, type:int) tuples, returning a list of (id, hit:Vector3f) tuples with id 0 for no hit") )
                 .def("getClickedPosition",
                      &SimContext::GetClickedPosition,
                      "Approximate 3d position of the mouse click")
@@ -866,7 +980,14 @@ namespace OpenNero {
                 .def("transformVector",
                      &SimContext::TransformVector,
                      "Transform the given vector by the matrix of the object specified by id")
+                .def("fastForward",
+                     &SimContext::FastForward,
+                     "Run the given number of AI ticks back to back at the next frame, with no rendering, animation, GUI or input work")
+                .def("getTicksPerSecond",
+                     &SimContext::GetTicksPerSecond,
+                     "AI ticks per second over the last fast-forward or the last second")
                 .add_property("delay", &SimContext::GetFrameDelay, &SimContext::SetFrameDelay)
+                .add_property("headless", &SimContext::IsHeadless, &SimContext::SetHeadless)
                 ;
 
             // this is how Python can access the C++ reference to SimContext
@@ -933,6 +1054,77 @@ namespace OpenNero {
             py::def("getAppConfig", &GetAppConfig, return_value_policy<reference_existing_object>());
         }
 
+        /// start or stop recording the times of the phases of each frame
+        void set_profiling(bool enabled)
+        {
+            Profiler::instance().SetEnabled(enabled);
+        }
+
+        /// set the number of frames the profiler keeps
+        void set_profile_history(size_t frames)
+        {
+            Profiler::instance().SetHistorySize(frames);
+        }
+
+        /// the times of each profiler zone over the last frames (0 for all of the ones kept)
+        /// @return a list of dicts, parents before their children
+        py::list get_profile_stats(size_t frames)
+        {
+            std::vector<ProfileStat> stats;
+            size_t summed = Profiler::instance().GetStats(frames, stats);
+            py::list result;
+            for (size_t i = 0; i < stats.size(); ++i)
+            {
+                py::dict stat;
+                stat["name"] = stats[i].name;
+                stat["category"] = stats[i].category;
+                stat["parent"] = stats[i].parent;
+                stat["depth"] = stats[i].depth;
+                stat["calls"] = stats[i].calls;
+                stat["total_ms"] = stats[i].total / 1000.0;
+                stat["ms_per_frame"] = summed > 0 ? stats[i].total / 1000.0 / summed : 0.0;
+                stat["max_ms"] = stats[i].max / 1000.0;
+                result.append(stat);
+            }
+            return result;
+        }
+
+        /// the durations in milliseconds of the last frames profiled, oldest first
+        py::list get_frame_times(size_t frames)
+        {
+            std::vector<uint64_t> times;
+            Profiler::instance().GetFrameTimes(frames, times);
+            py::list result;
+            for (size_t i = 0; i < times.size(); ++i)
+            {
+                result.append(times[i] / 1000.0);
+            }
+            return result;
+        }
+
+        /// a table of the times of each profiler zone over the last frames
+        std::string get_profile_report(size_t frames)
+        {
+            return Profiler::instance().GetReport(frames);
+        }
+
+        /// write the frames the profiler kept as a Chrome trace
+        bool save_profile_trace(const std::string& filename)
+        {
+            return Profiler::instance().WriteChromeTrace(filename);
+        }
+
+        /// export the per-frame profiler
+        void ExportProfilerScripts()
+        {
+            py::def("set_profiling", &set_profiling, "start or stop recording the times of the phases of each frame");
+            py::def("set_profile_history", &set_profile_history, "set the number of frames the profiler keeps (drops the recorded ones)");
+            py::def("get_profile_stats", &get_profile_stats, "the times of each profiler zone summed over the last n frames (0 for all of the ones kept), as a list of dicts with parents before their children");
+            py::def("get_frame_times", &get_frame_times, "the durations in milliseconds of the last n frames profiled (0 for all of the ones kept), oldest first");
+            py::def("get_profile_report", &get_profile_report, "a table of the times of each profiler zone over the last n frames (0 for all of the ones kept)");
+            py::def("save_profile_trace", &save_profile_trace, "write the frames the profiler kept to a file in the Chrome trace format (open with chrome://tracing)");
+        }
+
         void ExportScripts()
         {
             ExportAppConfigScripts();
@@ -949,6 +1141,7 @@ namespace OpenNero {
             ExportSchedulerScripts();
             ExportSimEntityDataScripts();
             ExportSimContextScripts();
+            ExportProfilerScripts();
             ExportIOMappingScripts();
             ExportCameraScripts();
             ExportScriptingEngineScripts();
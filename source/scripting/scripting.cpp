@@ -52,6 +52,7 @@ namespace OpenNero
     }
     
     void ScriptingEngine::Tick(float32_t dt) {
+        PROFILE_ZONE_CATEGORY("ModTick", "python");
         try {
             if (_globals.has_key("ModTick")) {
                 _globals["ModTick"](dt);
@@ -103,6 +104,7 @@ namespace OpenNero
 
     bool ScriptingEngine::Exec(const string &snippet,bool supressErrors)
     {
+        PROFILE_ZONE_CATEGORY("ScriptingEngine::Exec", "python");
         try {
             python::exec(snippet.c_str(), _globals, _globals);
         }
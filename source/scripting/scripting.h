@@ -2,6 +2,7 @@
 #define _OPENNERO_SCRIPTING_SCRIPTING_H_
 
 #include "core/Common.h"
+#include "core/Profiler.h"
 #include "scripting/scriptIncludes.h"
 #include "scripting/Scheduler.h"
 
@@ -257,6 +258,7 @@ namespace OpenNero
     template<typename ExecType, typename Result>
     Result TryCall( ExecType execObj )
     {
+        PROFILE_ZONE_CATEGORY("TryCall", "python");
         python::object res;
         try
         {
@@ -286,6 +288,7 @@ namespace OpenNero
     template<typename ExecType>
     void TryCall( ExecType execObj )
     {
+        PROFILE_ZONE_CATEGORY("TryCall", "python");
         try
         {
             // execute the override
@@ -310,6 +313,7 @@ namespace OpenNero
         inline
         void TryOverride(const char* name)
         {
+            PROFILE_ZONE_CATEGORY(name, "python");
             try {
                 if (python::override f = this->get_override(name)) {
                     f();
@@ -326,6 +330,7 @@ namespace OpenNero
         inline
         void TryOverride(const char* name, Result& result)
         {
+            PROFILE_ZONE_CATEGORY(name, "python");
             try {
                 if (python::override f = this->get_override(name)) {
                     python::object res = f();
@@ -345,6 +350,7 @@ namespace OpenNero
         void TryOverride(const char* name, Result& result,
                          Param0& param0)
         {
+            PROFILE_ZONE_CATEGORY(name, "python");
             try {
                 if (python::override f = this->get_override(name)) {
                     python::object res = f(param0);
@@ -364,6 +370,7 @@ namespace OpenNero
         void TryOverride(const char* name, Result& result,
                          Param0& param0, Param1& param1)
         {
+            PROFILE_ZONE_CATEGORY(name, "python");
             try {
                 if (python::override f = this->get_override(name)) {
                     python::object res = f(param0, param1);
@@ -383,6 +390,7 @@ namespace OpenNero
         void TryOverride(const char* name, Result& result,
                            Param0& param0, Param1& param1, Param2& param2)
         {
+            PROFILE_ZONE_CATEGORY(name, "python");
             try {
                 if (python::override f = this->get_override(name)) {
                     python::object res = f(param0, param1, param2);
@@ -0,0 +1,45 @@
+#include "core/Common.h"
+#include "ai/AI.h"
+#include "math/Random.h"
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE( test_opennero )
+
+BOOST_AUTO_TEST_CASE( test_feature_vector_fill )
+{
+    using namespace OpenNero;
+    FeatureVectorInfo info;
+    info.addDiscrete(0, 4);
+    info.addContinuous(-1, 1);
+    info.addContinuous(2, 3);
+
+    // filling in place gives the same vectors as the value-returning versions
+    FeatureVector filled(7, 42.0);
+    info.getInstance(filled);
+    FeatureVector instance = info.getInstance();
+    BOOST_CHECK_EQUAL_COLLECTIONS( filled.begin(), filled.end(), instance.begin(), instance.end() );
+    BOOST_CHECK_EQUAL( filled[2], 2.0 );
+
+    // and reuses the storage of the vector it is given
+    const double* storage = &filled[0];
+    for (int i = 0; i < 100; ++i)
+    {
+        info.getRandom(filled);
+        BOOST_REQUIRE_EQUAL( filled.size(), info.size() );
+        BOOST_CHECK( info.validate(filled) );
+        info.getInstance(filled);
+    }
+    BOOST_CHECK_EQUAL( storage, &filled[0] );
+
+    // the in-place operators do not allocate either
+    FeatureVector other = info.getRandom();
+    filled += other;
+    filled *= 0.5;
+    filled -= other;
+    filled /= 2.0;
+    BOOST_CHECK_EQUAL( storage, &filled[0] );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,144 @@
+#include <cmath>
+#include <sstream>
+#include <boost/archive/text_iarchive.hpp>
+#include <boost/archive/text_oarchive.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+
+#include "core/Common.h"
+#include "ai/rl/BackpropApproximator.h"
+#include "math/Random.h"
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace OpenNero;
+
+namespace
+{
+    /// the information of an agent with two sensors and one action
+    AgentInitInfo make_info()
+    {
+        FeatureVectorInfo sensors, actions, reward;
+        sensors.addContinuous(-2, 2);
+        sensors.addDiscrete(0, 3);
+        actions.addDiscrete(0, 4);
+        reward.addContinuous(-1, 1);
+        return AgentInitInfo(sensors, actions, reward);
+    }
+
+    /// the value the tests teach the network
+    double target_value(const FeatureVector& state, const FeatureVector& action)
+    {
+        return 0.5 * state[0] - 0.25 * state[1] + 0.5 * action[0] * state[0];
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( test_opennero )
+
+BOOST_AUTO_TEST_CASE( test_dense_network_batch )
+{
+    std::vector<size_t> sizes;
+    sizes.push_back(5);
+    sizes.push_back(9);
+    sizes.push_back(6);
+    sizes.push_back(3);
+    DenseNetwork network(sizes);
+
+    // a batch gives the same outputs as its rows one at a time
+    const size_t batch = 7;
+    std::vector<double> inputs(batch * 5);
+    for (size_t i = 0; i < inputs.size(); ++i)
+    {
+        inputs[i] = RANDOM.randD(2) - 1;
+    }
+    const double* outputs = network.forward(&inputs[0], batch);
+    std::vector<double> all(outputs, outputs + batch * 3);
+    for (size_t i = 0; i < batch; ++i)
+    {
+        const double* row = network.forward(&inputs[i * 5], 1);
+        for (size_t j = 0; j < 3; ++j)
+        {
+            BOOST_CHECK_CLOSE( row[j], all[i * 3 + j], 1e-9 );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_backprop_approximator )
+{
+    AgentInitInfo info = make_info();
+    BackpropApproximator approximator(info, 16, 0.05);
+
+    std::vector<FeatureVector> action_list;
+    for (int a = 0; a <= 4; ++a)
+    {
+        action_list.push_back(FeatureVector(1, a));
+    }
+
+    // predict_all agrees with predict
+    std::vector<double> values;
+    FeatureVector state = info.sensors.getRandom();
+    approximator.predict_all(state, action_list, values);
+    BOOST_REQUIRE_EQUAL( values.size(), action_list.size() );
+    for (size_t i = 0; i < action_list.size(); ++i)
+    {
+        BOOST_CHECK_CLOSE( values[i], approximator.predict(state, action_list[i]), 1e-9 );
+    }
+
+    // minibatch updates fit a simple function
+    std::vector<FeatureVector> states, actions;
+    std::vector<double> targets;
+    for (int n = 0; n < 64; ++n)
+    {
+        states.push_back(info.sensors.getRandom());
+        actions.push_back(info.actions.getRandom());
+        targets.push_back(target_value(states.back(), actions.back()));
+    }
+    double before = 0;
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        double e = approximator.predict(states[i], actions[i]) - targets[i];
+        before += e * e;
+    }
+    for (int epoch = 0; epoch < 2000; ++epoch)
+    {
+        approximator.update_batch(states, actions, targets);
+    }
+    double after = 0;
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        double e = approximator.predict(states[i], actions[i]) - targets[i];
+        after += e * e;
+    }
+    BOOST_CHECK_LT( after, 0.1 * before );
+
+    // single updates move the prediction towards the target
+    double old_error = std::abs(approximator.predict(state, action_list[0]) - 5.0);
+    approximator.update(state, action_list[0], 5.0);
+    BOOST_CHECK_LT( std::abs(approximator.predict(state, action_list[0]) - 5.0), old_error );
+}
+
+BOOST_AUTO_TEST_CASE( test_backprop_approximator_serialization )
+{
+    AgentInitInfo info = make_info();
+    ApproximatorPtr original(new BackpropApproximator(info, 8));
+
+    std::stringstream ss;
+    {
+        boost::archive::text_oarchive oa(ss);
+        oa << original;
+    }
+    ApproximatorPtr loaded;
+    {
+        boost::archive::text_iarchive ia(ss);
+        ia >> loaded;
+    }
+    BOOST_REQUIRE( dynamic_cast<BackpropApproximator*>(loaded.get()) );
+    for (int n = 0; n < 20; ++n)
+    {
+        FeatureVector state = info.sensors.getRandom();
+        FeatureVector action = info.actions.getRandom();
+        BOOST_CHECK_CLOSE( loaded->predict(state, action), original->predict(state, action), 1e-6 );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
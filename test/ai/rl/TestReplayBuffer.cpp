@@ -0,0 +1,60 @@
+#include "core/Common.h"
+#include "ai/rl/ReplayBuffer.h"
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace OpenNero;
+
+BOOST_AUTO_TEST_SUITE( test_opennero )
+
+BOOST_AUTO_TEST_CASE( test_replay_buffer )
+{
+    ReplayBuffer buffer(10);
+    ReplayBatch batch;
+    BOOST_CHECK( !buffer.sample(4, batch) );
+    BOOST_CHECK_EQUAL( batch.size(), 0u );
+
+    // transition n goes from state (n, -n) to state (n + 1, -n - 1) with action n % 3 and reward n
+    Observations state(2), next_state(2);
+    Actions action(1), next_action(1);
+    for (int n = 0; n < 25; ++n)
+    {
+        state[0] = n;
+        state[1] = -n;
+        next_state[0] = n + 1;
+        next_state[1] = -n - 1;
+        action[0] = n % 3;
+        next_action[0] = (n + 1) % 3;
+        if (n % 5 == 4)
+            buffer.addFinal(state, action, n);
+        else
+            buffer.add(state, action, n, next_state, next_action, false);
+        BOOST_CHECK_EQUAL( buffer.size(), (size_t)std::min(n + 1, 10) );
+    }
+    BOOST_CHECK_EQUAL( buffer.getNumAdded(), 25u );
+
+    // only the last 10 transitions are left
+    BOOST_REQUIRE( buffer.sample(200, batch) );
+    BOOST_REQUIRE_EQUAL( batch.size(), 200u );
+    for (size_t k = 0; k < batch.size(); ++k)
+    {
+        int n = (int)batch.rewards[k];
+        BOOST_CHECK( n >= 15 && n < 25 );
+        BOOST_CHECK_EQUAL( batch.states[k][0], n );
+        BOOST_CHECK_EQUAL( batch.states[k][1], -n );
+        BOOST_CHECK_EQUAL( batch.actions[k][0], n % 3 );
+        BOOST_CHECK_EQUAL( batch.dones[k], n % 5 == 4 ? 1 : 0 );
+        if (!batch.dones[k])
+        {
+            BOOST_CHECK_EQUAL( batch.next_states[k][0], n + 1 );
+            BOOST_CHECK_EQUAL( batch.next_actions[k][0], (n + 1) % 3 );
+        }
+    }
+
+    buffer.clear();
+    BOOST_CHECK_EQUAL( buffer.size(), 0u );
+    BOOST_CHECK( !buffer.sample(4, batch) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
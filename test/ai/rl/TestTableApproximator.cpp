@@ -0,0 +1,159 @@
+#include "core/Common.h"
+#include "ai/rl/Approximator.h"
+#include <boost/serialization/shared_ptr.hpp>
+#include <cstdio>
+#include <sstream>
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace OpenNero;
+
+namespace
+{
+    /// two discrete and two continuous sensors, one discrete and one continuous action
+    AgentInitInfo make_info()
+    {
+        FeatureVectorInfo sensors, actions, reward;
+        sensors.addDiscrete(0, 9);
+        sensors.addDiscrete(-3, 3);
+        sensors.addContinuous(-1, 1);
+        sensors.addContinuous(0, 100);
+        actions.addDiscrete(0, 4);
+        actions.addContinuous(-1, 1);
+        reward.addContinuous(-1, 1);
+        return AgentInitInfo(sensors, actions, reward);
+    }
+
+    /// a state and an action from a few integers
+    void make_pair(int n, Observations& state, Actions& action)
+    {
+        state.resize(4);
+        action.resize(2);
+        state[0] = n % 10;
+        state[1] = (n / 10) % 7 - 3;
+        state[2] = -1 + 0.5 * ((n / 70) % 5);
+        state[3] = 25.0 * ((n / 350) % 5);
+        action[0] = (n / 1750) % 5;
+        action[1] = -1 + 0.5 * ((n / 8750) % 5);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( test_opennero )
+
+BOOST_AUTO_TEST_CASE( test_table_approximator )
+{
+    AgentInitInfo info = make_info();
+    TableApproximator table(info, 5, 5);
+    Observations state;
+    Actions action;
+
+    // every bin of every dimension is a separate entry
+    const int num_pairs = 10 * 7 * 5 * 5 * 5 * 5;
+    for (int n = 0; n < num_pairs; ++n)
+    {
+        make_pair(n, state, action);
+        BOOST_CHECK_EQUAL( table.predict(state, action), 0.0 );
+        table.update(state, action, n);
+    }
+    BOOST_CHECK_EQUAL( table.size(), (size_t)num_pairs );
+    for (int n = 0; n < num_pairs; n += 7)
+    {
+        make_pair(n, state, action);
+        BOOST_CHECK_EQUAL( table.predict(state, action), n );
+    }
+
+    // values in the same bin share an entry
+    make_pair(1234, state, action);
+    state[2] += 0.2;
+    state[3] -= 10;
+    action[1] += 0.1;
+    BOOST_CHECK_EQUAL( table.predict(state, action), 1234.0 );
+    table.update(state, action, -1);
+    make_pair(1234, state, action);
+    BOOST_CHECK_EQUAL( table.predict(state, action), -1.0 );
+    BOOST_CHECK_EQUAL( table.size(), (size_t)num_pairs );
+
+    // copies are independent
+    ApproximatorPtr copy = table.copy();
+    copy->update(state, action, 5);
+    BOOST_CHECK_EQUAL( table.predict(state, action), -1.0 );
+    BOOST_CHECK_EQUAL( copy->predict(state, action), 5.0 );
+}
+
+BOOST_AUTO_TEST_CASE( test_table_predict_all )
+{
+    AgentInitInfo info = make_info();
+    TableApproximator table(info, 5, 5);
+    Observations state;
+    Actions action;
+    std::vector<Actions> actions;
+    for (int n = 0; n < 20000; n += 3)
+    {
+        make_pair(n, state, action);
+        table.update(state, action, n);
+        if (n % 350 < 10)
+        {
+            actions.push_back(action);
+        }
+    }
+
+    std::vector<double> values;
+    for (int n = 0; n < 350; n += 11)
+    {
+        make_pair(n, state, action);
+        table.predict_all(state, actions, values);
+        BOOST_REQUIRE_EQUAL( values.size(), actions.size() );
+        for (size_t i = 0; i < actions.size(); ++i)
+        {
+            BOOST_CHECK_EQUAL( values[i], table.predict(state, actions[i]) );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_table_approximator_save )
+{
+    AgentInitInfo info = make_info();
+    TableApproximator table(info, 5, 5);
+    Observations state;
+    Actions action;
+    for (int n = 0; n < 5000; n += 3)
+    {
+        make_pair(n, state, action);
+        table.update(state, action, 0.5 * n);
+    }
+
+    // binary file
+    const std::string filename = "test_table_approximator.bin";
+    BOOST_REQUIRE( table.save_table(filename) );
+    TableApproximator loaded(info, 5, 5);
+    BOOST_REQUIRE( loaded.load_table(filename) );
+    TableApproximator other_bins(info, 3, 5);
+    BOOST_CHECK( !other_bins.load_table(filename) );
+    std::remove(filename.c_str());
+    BOOST_CHECK_EQUAL( loaded.size(), table.size() );
+
+    // boost serialization
+    std::ostringstream oss;
+    {
+        boost::archive::text_oarchive oa(oss);
+        ApproximatorPtr saved = table.copy();
+        oa << saved;
+    }
+    ApproximatorPtr restored;
+    {
+        std::istringstream iss(oss.str());
+        boost::archive::text_iarchive ia(iss);
+        ia >> restored;
+    }
+    BOOST_REQUIRE( restored );
+
+    for (int n = 0; n < 5000; ++n)
+    {
+        make_pair(n, state, action);
+        BOOST_CHECK_EQUAL( loaded.predict(state, action), table.predict(state, action) );
+        BOOST_CHECK_EQUAL( restored->predict(state, action), table.predict(state, action) );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,107 @@
+#include "core/Common.h"
+#include "ai/rl/TileCoder.h"
+#include "ai/rl/Approximator.h"
+#include "ai/rl/tiles2.h"
+#include "math/Random.h"
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace OpenNero;
+
+namespace
+{
+    /// the tiles of a state-action pair computed by GetTiles
+    std::vector<int> reference_tiles(const AgentInitInfo& info, size_t num_tilings, int memory_size,
+                                     const FeatureVector& state, const FeatureVector& action)
+    {
+        std::vector<float> floats;
+        std::vector<int> ints;
+        for (size_t i = 0; i < state.size(); ++i)
+        {
+            if (info.sensors.isDiscrete(i))
+                ints.push_back((int)state[i]);
+            else
+                floats.push_back((float)state[i]);
+        }
+        for (size_t i = 0; i < action.size(); ++i)
+        {
+            if (info.actions.isDiscrete(i))
+                ints.push_back((int)action[i]);
+            else
+                floats.push_back((float)action[i]);
+        }
+        std::vector<int> tiles(num_tilings);
+        GetTiles(tiles, memory_size, floats, ints);
+        return tiles;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( test_opennero )
+
+BOOST_AUTO_TEST_CASE( test_tile_coder )
+{
+    FeatureVectorInfo sensors, actions, reward;
+    sensors.addContinuous(-2, 2);
+    sensors.addDiscrete(-5, 5);
+    sensors.addContinuous(0, 10);
+    sensors.addDiscrete(0, 3);
+    actions.addContinuous(-1, 1);
+    actions.addDiscrete(0, 4);
+    actions.addContinuous(-3, 0);
+    reward.addContinuous(-1, 1);
+    AgentInitInfo info(sensors, actions, reward);
+
+    size_t tilings[] = { 1, 7, 16, 32 };
+    int memory_sizes[] = { 1024, 1000, 4096, 65536 };
+    for (size_t t = 0; t < 4; ++t)
+    {
+        TileCoder coder(info, tilings[t], memory_sizes[t]);
+        std::vector<int> tiles;
+        for (int n = 0; n < 50; ++n)
+        {
+            FeatureVector state = sensors.getRandom();
+            coder.setState(state);
+            // several actions share the state
+            for (int k = 0; k < 5; ++k)
+            {
+                FeatureVector action = actions.getRandom();
+                coder.getTiles(action, tiles);
+                std::vector<int> expected = reference_tiles(info, tilings[t], memory_sizes[t], state, action);
+                BOOST_CHECK_EQUAL_COLLECTIONS( tiles.begin(), tiles.end(), expected.begin(), expected.end() );
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_tiles_predict_all )
+{
+    FeatureVectorInfo sensors, actions, reward;
+    sensors.addContinuous(-2, 2);
+    sensors.addDiscrete(0, 3);
+    actions.addContinuous(-1, 1);
+    actions.addDiscrete(0, 4);
+    reward.addContinuous(-1, 1);
+    AgentInitInfo info(sensors, actions, reward);
+    TilesApproximator approximator(info, 16, 4096);
+
+    std::vector<FeatureVector> action_list;
+    for (int k = 0; k < 20; ++k)
+    {
+        action_list.push_back(actions.getRandom());
+    }
+    std::vector<double> values;
+    for (int n = 0; n < 20; ++n)
+    {
+        FeatureVector state = sensors.getRandom();
+        approximator.update(state, action_list[n], 1.0);
+        approximator.predict_all(state, action_list, values);
+        BOOST_REQUIRE_EQUAL( values.size(), action_list.size() );
+        for (size_t i = 0; i < action_list.size(); ++i)
+        {
+            BOOST_CHECK_EQUAL( values[i], approximator.predict(state, action_list[i]) );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,79 @@
+#include "core/Common.h"
+#include "ai/rtneat/Checkpointer.h"
+#include "rtneat/population.h"
+#include "rtneat/network.h"
+#include "rtneat/snapshot.h"
+#include <cstdio>
+#include <fstream>
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace OpenNero;
+using namespace NEAT;
+
+namespace
+{
+    /// does the file exist?
+    bool file_exists(const std::string& filename)
+    {
+        std::ifstream file(filename.c_str());
+        return file.good();
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( test_opennero )
+
+BOOST_AUTO_TEST_CASE( test_checkpointer )
+{
+    NEAT::NEATRandGen.seed(42);
+    GenomePtr start(new Genome(3, 2, 0, 0));
+    PopulationPtr pop(new Population(start, 20, 1.0));
+
+    // the frozen copy keeps the genomes as they were
+    PopulationPtr frozen = PopulationSnapshot::freeze(pop);
+    BOOST_REQUIRE_EQUAL( frozen->organisms.size(), pop->organisms.size() );
+    BOOST_CHECK_EQUAL( frozen->species.size(), pop->species.size() );
+    OrganismPtr org = pop->organisms[0];
+    GenomePtr shared = org->gnome;
+    F64 weight = shared->genes[0]->lnk->weight;
+    org->net->all_nodes.back()->incoming[0]->weight += 1.0;
+    org->update_genotype();
+    BOOST_CHECK( org->gnome != shared );
+    BOOST_CHECK_EQUAL( frozen->organisms[0]->gnome, shared );
+    BOOST_CHECK_EQUAL( shared->genes[0]->lnk->weight, weight );
+    BOOST_CHECK_EQUAL( org->net->genotype.lock(), org->gnome );
+
+    // checkpoints rotate, keeping the last two
+    Checkpointer checkpointer(2);
+    const char* files[] = { "test_checkpoint.0", "test_checkpoint.1", "test_checkpoint.2" };
+    for (size_t i = 0; i < 3; ++i)
+    {
+        BOOST_REQUIRE( checkpointer.Start(PopulationSnapshot::freeze(pop), files[i]) );
+        checkpointer.Wait();
+        BOOST_CHECK( !checkpointer.IsBusy() );
+        BOOST_CHECK( checkpointer.GetLastSucceeded() );
+        BOOST_CHECK_EQUAL( checkpointer.GetLastFile(), files[i] );
+        BOOST_CHECK( checkpointer.GetLastDuration() >= 0 );
+    }
+    BOOST_CHECK_EQUAL( checkpointer.GetNumCompleted(), 3u );
+    BOOST_CHECK( !file_exists(files[0]) );
+    BOOST_CHECK( file_exists(files[1]) );
+    BOOST_CHECK( file_exists(files[2]) );
+    BOOST_CHECK( !file_exists(std::string(files[2]) + ".tmp") );
+
+    PopulationPtr loaded = PopulationSnapshot::load(files[2]);
+    BOOST_REQUIRE_EQUAL( loaded->organisms.size(), pop->organisms.size() );
+    BOOST_CHECK_EQUAL( loaded->organisms[0]->gnome->genes[0]->lnk->weight, org->gnome->genes[0]->lnk->weight );
+
+    // a checkpoint that cannot be written is reported as failed
+    BOOST_REQUIRE( checkpointer.Start(frozen, "no/such/directory/test_checkpoint") );
+    checkpointer.Wait();
+    BOOST_CHECK( !checkpointer.GetLastSucceeded() );
+    BOOST_CHECK_EQUAL( checkpointer.GetNumCompleted(), 3u );
+
+    std::remove(files[1]);
+    std::remove(files[2]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
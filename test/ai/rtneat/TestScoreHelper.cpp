@@ -0,0 +1,87 @@
+#include "core/Common.h"
+#include "ai/rtneat/ScoreHelper.h"
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace OpenNero;
+
+namespace
+{
+    /// a random reward with a large offset in the first dimension
+    Reward random_reward()
+    {
+        Reward reward(2);
+        reward[0] = 1000 + rand() % 1000 / 10.0;
+        reward[1] = rand() % 1000 / 100.0 - 5;
+        return reward;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( test_opennero )
+
+BOOST_AUTO_TEST_CASE( test_score_helper )
+{
+    srand(7);
+    RewardInfo info;
+    info.addContinuous(0, 2000);
+    info.addContinuous(-5, 5);
+    ScoreHelper helper(info);
+
+    std::vector<Reward> samples;
+    for (int round = 0; round < 2000; ++round)
+    {
+        // add or replace samples, the way evaluateAll does
+        if (samples.size() < 20 || rand() % 3 == 0)
+        {
+            samples.push_back(random_reward());
+            helper.addSample(samples.back());
+        }
+        else
+        {
+            size_t i = rand() % samples.size();
+            helper.removeSample(samples[i]);
+            samples[i] = samples.back();
+            samples.pop_back();
+        }
+    }
+    helper.doCalculations();
+    BOOST_REQUIRE_EQUAL( helper.getSampleSize(), samples.size() );
+
+    // compare with adding the samples up from scratch
+    for (size_t d = 0; d < 2; ++d)
+    {
+        double mean = 0;
+        for (size_t i = 0; i < samples.size(); ++i)
+            mean += samples[i][d];
+        mean /= samples.size();
+        double variance = 0;
+        for (size_t i = 0; i < samples.size(); ++i)
+            variance += (samples[i][d] - mean) * (samples[i][d] - mean);
+        double stdev = std::sqrt(variance / samples.size());
+        BOOST_CHECK_CLOSE( helper.getAverage()[d], mean, 1e-6 );
+        BOOST_CHECK_CLOSE( helper.getStandardDeviation()[d], stdev, 1e-6 );
+    }
+
+    Reward relative;
+    helper.getRelativeScore(samples.front(), relative);
+    Reward expected = helper.getRelativeScore(samples.front());
+    BOOST_CHECK_EQUAL( relative[0], expected[0] );
+    BOOST_CHECK_EQUAL( relative[1], expected[1] );
+
+    // removing the last sample starts over
+    while (!samples.empty())
+    {
+        helper.removeSample(samples.back());
+        samples.pop_back();
+    }
+    helper.doCalculations();
+    BOOST_CHECK_EQUAL( helper.getSampleSize(), 0u );
+    BOOST_CHECK_EQUAL( helper.getAverage()[0], 0 );
+    BOOST_CHECK_EQUAL( helper.getStandardDeviation()[1], 0 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
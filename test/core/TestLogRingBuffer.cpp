@@ -0,0 +1,99 @@
+#include "core/Common.h"
+#include "core/LogRingBuffer.h"
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/thread.hpp>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+    const int kProducers = 4;
+    const int kRecordsPerProducer = 20000;
+
+    /// push numbered records, waiting whenever the buffer is full
+    void produce(OpenNero::Log::LogRingBuffer* buffer, int producer)
+    {
+        OpenNero::Log::LogRecord record;
+        for (int i = 0; i < kRecordsPerProducer; ++i)
+        {
+            record.level = producer;
+            record.tag = NULL;
+            record.target = boost::lexical_cast<std::string>(i);
+            record.text = "message";
+            while (!buffer->push(record))
+            {
+                boost::this_thread::yield();
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( test_opennero )
+
+BOOST_AUTO_TEST_CASE( test_log_ring_buffer )
+{
+    using namespace OpenNero::Log;
+    LogRingBuffer buffer(5);
+    BOOST_CHECK_EQUAL( buffer.capacity(), 8u );
+
+    // a full buffer refuses records without touching them
+    LogRecord record;
+    for (int i = 0; i < 8; ++i)
+    {
+        record.level = i;
+        record.text = "text";
+        BOOST_CHECK( buffer.push(record) );
+    }
+    record.text = "kept";
+    BOOST_CHECK( !buffer.push(record) );
+    BOOST_CHECK_EQUAL( record.text, "kept" );
+    for (int i = 0; i < 8; ++i)
+    {
+        BOOST_REQUIRE( buffer.pop(record) );
+        BOOST_CHECK_EQUAL( record.level, i );
+        BOOST_CHECK_EQUAL( record.text, "text" );
+    }
+    BOOST_CHECK( !buffer.pop(record) );
+    BOOST_CHECK_EQUAL( buffer.pushed(), buffer.popped() );
+}
+
+BOOST_AUTO_TEST_CASE( test_log_ring_buffer_threads )
+{
+    using namespace OpenNero::Log;
+    LogRingBuffer buffer(64);
+    boost::thread_group producers;
+    for (int p = 0; p < kProducers; ++p)
+    {
+        producers.create_thread(boost::bind(&produce, &buffer, p));
+    }
+
+    // every record arrives once, in the order its producer pushed it
+    std::vector<int> next(kProducers, 0);
+    int received = 0;
+    LogRecord record;
+    while (received < kProducers * kRecordsPerProducer)
+    {
+        if (!buffer.pop(record))
+        {
+            boost::this_thread::yield();
+            continue;
+        }
+        BOOST_REQUIRE( record.level >= 0 && record.level < kProducers );
+        BOOST_REQUIRE_EQUAL( boost::lexical_cast<int>(record.target), next[record.level] );
+        BOOST_CHECK_EQUAL( record.text, "message" );
+        ++next[record.level];
+        ++received;
+    }
+    producers.join_all();
+    BOOST_CHECK( !buffer.pop(record) );
+    for (int p = 0; p < kProducers; ++p)
+    {
+        BOOST_CHECK_EQUAL( next[p], kRecordsPerProducer );
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
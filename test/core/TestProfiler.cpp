@@ -0,0 +1,138 @@
+#include "core/Common.h"
+#include "core/Profiler.h"
+#include "core/ThreadPool.h"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+    /// opens a zone on a pool thread
+    struct PoolZone
+    {
+        void operator()(size_t /*i*/) const { PROFILE_ZONE("pool"); }
+    };
+
+    /// the stat of the zone with the given name
+    const OpenNero::ProfileStat* find_stat(const std::vector<OpenNero::ProfileStat>& stats, const std::string& name)
+    {
+        for (size_t i = 0; i < stats.size(); ++i)
+        {
+            if (stats[i].name == name)
+                return &stats[i];
+        }
+        return NULL;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( test_opennero )
+
+BOOST_AUTO_TEST_CASE( test_profiler )
+{
+    using namespace OpenNero;
+    Profiler& profiler = Profiler::instance();
+    profiler.SetHistorySize(4);
+
+    // nothing is recorded while the profiler is disabled
+    profiler.BeginFrame();
+    {
+        PROFILE_ZONE("ignored");
+    }
+    profiler.EndFrame();
+    BOOST_CHECK_EQUAL( profiler.GetNumFrames(), 0u );
+
+    profiler.SetEnabled(true);
+    ThreadPool pool(3);
+    for (int frame = 0; frame < 6; ++frame)
+    {
+        profiler.BeginFrame();
+        {
+            PROFILE_ZONE("outer");
+            for (int i = 0; i < 2; ++i)
+            {
+                PROFILE_ZONE_CATEGORY("inner", "python");
+            }
+            pool.ParallelFor(6, PoolZone());
+        }
+        profiler.EndFrame();
+    }
+    // zones outside of a frame are dropped
+    {
+        PROFILE_ZONE("between frames");
+    }
+    profiler.SetEnabled(false);
+
+    // only the last 4 frames are kept
+    BOOST_CHECK_EQUAL( profiler.GetNumFrames(), 4u );
+    std::vector<uint64_t> times;
+    profiler.GetFrameTimes(0, times);
+    BOOST_CHECK_EQUAL( times.size(), 4u );
+
+    std::vector<ProfileStat> stats;
+    BOOST_CHECK_EQUAL( profiler.GetStats(3, stats), 3u );
+    const ProfileStat* outer = find_stat(stats, "outer");
+    const ProfileStat* inner = find_stat(stats, "inner");
+    BOOST_REQUIRE( outer && inner );
+    BOOST_CHECK( !find_stat(stats, "between frames") );
+    BOOST_CHECK( !find_stat(stats, "ignored") );
+    BOOST_CHECK_EQUAL( outer->calls, 3u );
+    BOOST_CHECK_EQUAL( outer->depth, 0u );
+    BOOST_CHECK_EQUAL( inner->calls, 6u );
+    BOOST_CHECK_EQUAL( inner->depth, 1u );
+    BOOST_CHECK_EQUAL( inner->parent, "outer" );
+    BOOST_CHECK_EQUAL( inner->category, "python" );
+    BOOST_CHECK( inner->total <= outer->total );
+    // the parent comes right before its children
+    BOOST_CHECK( outer < inner );
+
+    // pool zones are counted whichever thread ran them
+    uint64_t pool_calls = 0;
+    for (size_t i = 0; i < stats.size(); ++i)
+    {
+        if (stats[i].name == "pool")
+            pool_calls += stats[i].calls;
+    }
+    BOOST_CHECK_EQUAL( pool_calls, 18u );
+
+    BOOST_CHECK( profiler.GetReport(0).find("inner (python)") != std::string::npos );
+
+    const char* filename = "test_profiler_trace.json";
+    BOOST_REQUIRE( profiler.WriteChromeTrace(filename) );
+    std::ifstream in(filename);
+    std::string trace((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    BOOST_CHECK_EQUAL( trace.find("{\"displayTimeUnit\":\"ms\",\"traceEvents\":["), 0u );
+    BOOST_CHECK( trace.find("\"name\":\"inner\",\"cat\":\"python\",\"ph\":\"X\"") != std::string::npos );
+    in.close();
+    std::remove(filename);
+
+    profiler.Clear();
+    BOOST_CHECK_EQUAL( profiler.GetNumFrames(), 0u );
+}
+
+BOOST_AUTO_TEST_CASE( test_profiler_report_long_names )
+{
+    using namespace OpenNero;
+    Profiler& profiler = Profiler::instance();
+
+    // zone names longer than a report line are printed in full
+    static const std::string name(300, 'z');
+    profiler.SetEnabled(true);
+    profiler.BeginFrame();
+    {
+        PROFILE_ZONE_CATEGORY(name.c_str(), "a category with a long name");
+    }
+    profiler.EndFrame();
+    profiler.SetEnabled(false);
+
+    std::string report = profiler.GetReport(0);
+    BOOST_CHECK( report.find(name + " (a category with a long name)") != std::string::npos );
+
+    profiler.Clear();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,62 @@
+#include "core/Common.h"
+#include "core/ThreadPool.h"
+#include <stdexcept>
+#include <vector>
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+    /// records the square of each index
+    struct Square
+    {
+        std::vector<size_t>& out;
+        Square(std::vector<size_t>& o) : out(o) {}
+        void operator()(size_t i) const { out[i] = i * i; }
+    };
+
+    /// fails on one index
+    struct FailAt
+    {
+        size_t bad;
+        FailAt(size_t b) : bad(b) {}
+        void operator()(size_t i) const { if (i == bad) throw std::runtime_error("bad index"); }
+    };
+}
+
+BOOST_AUTO_TEST_SUITE( test_opennero )
+
+BOOST_AUTO_TEST_CASE( test_thread_pool )
+{
+    using namespace OpenNero;
+    ThreadPool pool(4);
+    BOOST_CHECK_EQUAL( pool.GetNumThreads(), 4 );
+
+    // every iteration runs exactly once, loop after loop
+    for (size_t count = 0; count < 50; ++count)
+    {
+        std::vector<size_t> out(count, 0);
+        pool.ParallelFor(count, Square(out));
+        for (size_t i = 0; i < count; ++i)
+        {
+            BOOST_CHECK_EQUAL( out[i], i * i );
+        }
+    }
+
+    // an exception on a worker or on the caller reaches the caller,
+    // and the pool keeps working afterwards
+    BOOST_CHECK_THROW( pool.ParallelFor(20, FailAt(7)), std::runtime_error );
+    BOOST_CHECK_THROW( pool.ParallelFor(20, FailAt(0)), std::runtime_error );
+    std::vector<size_t> after(20, 0);
+    pool.ParallelFor(after.size(), Square(after));
+    BOOST_CHECK_EQUAL( after[19], 361 );
+
+    // a pool of one runs everything on the caller
+    ThreadPool serial(1);
+    std::vector<size_t> out(10, 0);
+    serial.ParallelFor(out.size(), Square(out));
+    BOOST_CHECK_EQUAL( out[9], 81 );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
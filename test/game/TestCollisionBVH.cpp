@@ -0,0 +1,42 @@
+#include "core/Common.h"
+#include "game/CollisionBVH.h"
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE( test_opennero )
+
+BOOST_AUTO_TEST_CASE( test_collision_bvh )
+{
+    using namespace OpenNero;
+    CollisionBVH bvh;
+
+    // a row of walls facing the x axis at x = 10, 20, ..., 100, owned by 1..10
+    for (uint32_t i = 1; i <= 10; ++i) {
+        float32_t x = 10.0f * i;
+        bvh.AddTriangle(Triangle3f(Vector3f(x,-5,-5), Vector3f(x,5,-5), Vector3f(x,0,5)), i);
+    }
+    bvh.Build();
+    BOOST_CHECK_EQUAL( bvh.GetTriangleCount(), 10 );
+
+    Vector3f hit;
+    uint32_t owner = 0;
+
+    // the closest wall is hit first
+    BOOST_REQUIRE( bvh.Intersect(Vector3f(0,0,0), Vector3f(200,0,0), hit, owner) );
+    BOOST_CHECK_EQUAL( owner, 1 );
+    BOOST_CHECK_CLOSE( hit.X, 10.0f, 0.01f );
+
+    // from the other side
+    BOOST_REQUIRE( bvh.Intersect(Vector3f(95,0,0), Vector3f(0,0,0), hit, owner) );
+    BOOST_CHECK_EQUAL( owner, 9 );
+    BOOST_CHECK_CLOSE( hit.X, 90.0f, 0.01f );
+
+    // segments that stop short of a wall do not hit it
+    BOOST_CHECK( !bvh.Intersect(Vector3f(41,0,0), Vector3f(49,0,0), hit, owner) );
+
+    // rays that pass beside the walls do not hit them
+    BOOST_CHECK( !bvh.Intersect(Vector3f(0,20,0), Vector3f(200,20,0), hit, owner) );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,57 @@
+#include "core/Common.h"
+#include "game/SimEntity.h"
+#include "game/SpatialIndex.h"
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+BOOST_AUTO_TEST_SUITE( test_opennero )
+
+BOOST_AUTO_TEST_CASE( test_spatial_index )
+{
+    using namespace OpenNero;
+    Vector3f zero(0,0,0), one(1,1,1);
+    SimEntityPtr a(new SimEntity(SimEntityData(Vector3f(0,0,0), zero, one, "a", 1, 0, 1), ""));
+    SimEntityPtr b(new SimEntity(SimEntityData(Vector3f(30,0,0), zero, one, "b", 2, 0, 2), ""));
+    SimEntityPtr c(new SimEntity(SimEntityData(Vector3f(-200,120,0), zero, one, "c", 1, 0, 3), ""));
+
+    SpatialIndex index(50);
+    SimEntityVector all;
+    all.push_back(a);
+    all.push_back(b);
+    all.push_back(c);
+    index.Rebuild(all);
+
+    SimEntityVector result;
+
+    // everything close by, any type
+    index.Query(zero, 40, 0xFFFFFFFF, result);
+    BOOST_CHECK_EQUAL( result.size(), 2 );
+
+    // filtered by type
+    result.clear();
+    index.Query(zero, 40, 2, result);
+    BOOST_REQUIRE_EQUAL( result.size(), 1 );
+    BOOST_CHECK( result[0] == b );
+
+    // a radius larger than the occupied grid
+    result.clear();
+    index.Query(zero, 1000, 1, result);
+    BOOST_CHECK_EQUAL( result.size(), 2 );
+
+    // moving an entity into another cell
+    c->SetPosition(Vector3f(10,10,0));
+    index.Update(c);
+    result.clear();
+    index.Query(zero, 20, 1, result);
+    BOOST_CHECK_EQUAL( result.size(), 2 );
+
+    // removal
+    index.Remove(a);
+    result.clear();
+    index.Query(zero, 20, 1, result);
+    BOOST_REQUIRE_EQUAL( result.size(), 1 );
+    BOOST_CHECK( result[0] == c );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,40 @@
+#ifndef _TEST_RTNEAT_SEEDEDPOPULATION_H_
+#define _TEST_RTNEAT_SEEDEDPOPULATION_H_
+
+#include "core/Common.h"
+#include "rtneat/population.h"
+#include "rtneat/innovation.h"
+
+namespace NEAT
+{
+    /// a population of size genomes with the given number of inputs and two
+    /// outputs, with different weights and one or two added nodes in two of
+    /// every three genomes; the same seed always gives the same population
+    inline PopulationPtr make_seeded_population(U32 seed, S32 size, S32 inputs)
+    {
+        NEAT::NEATRandGen.seed(seed);
+
+        GenomePtr start(new Genome(inputs, 2, 0, 0));
+        InnovationRegistry innovs;
+        S32 node_id = start->get_last_node_id() + 1;
+        F64 innov = start->get_last_gene_innovnum() + 1;
+
+        std::vector<Genome*> genomes;
+        for (S32 i = 0; i < size; ++i)
+        {
+            Genome* genome = new Genome(*start);
+            genome->genome_id = i;
+            for (S32 j = 0; j < i % 3; ++j)
+                genome->mutate_add_node(innovs, node_id, innov);
+            genome->mutate_link_weights(1.0, 1.0, COLDGAUSSIAN);
+            genomes.push_back(genome);
+        }
+        PopulationPtr pop(new Population(genomes, 0));
+        pop->innovations.set_innovations(innovs.get_innovations());
+        pop->cur_node_id = node_id;
+        pop->cur_innov_num = innov;
+        return pop;
+    }
+}
+
+#endif
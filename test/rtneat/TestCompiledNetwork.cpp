@@ -0,0 +1,134 @@
+#include "core/Common.h"
+#include "rtneat/network.h"
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace NEAT;
+
+namespace
+{
+    /// build a small net with a recurrent loop, a self-loop, a time delayed
+    /// link and a linear output
+    NetworkPtr make_network(bool adaptable, F64 scale = 1.0)
+    {
+        NNodePtr bias(new NNode(SENSOR, 1, BIAS));
+        NNodePtr in(new NNode(SENSOR, 2, INPUT));
+        NNodePtr hidden(new NNode(NEURON, 3, HIDDEN));
+        NNodePtr out1(new NNode(NEURON, 4, OUTPUT));
+        NNodePtr out2(new NNode(NEURON, 5, OUTPUT, LINEAR));
+
+        hidden->add_incoming(in, 0.7 * scale);
+        hidden->add_incoming(bias, -0.3);
+        hidden->add_incoming(hidden, 0.4, true);
+        hidden->add_incoming(out1, -1.1, true);
+        out1->add_incoming(hidden, 1.5 * scale);
+        out1->add_incoming(in, -0.2);
+        out2->add_incoming(out1, 0.9 * scale);
+        out2->add_incoming(hidden, 0.6, true);
+        out2->incoming.back()->time_delay = true;
+
+        std::vector<NNodePtr> inputs, outputs, all;
+        inputs.push_back(bias);
+        inputs.push_back(in);
+        outputs.push_back(out1);
+        outputs.push_back(out2);
+        all.push_back(bias);
+        all.push_back(in);
+        all.push_back(out1); // the output comes before the hidden node that feeds it
+        all.push_back(hidden);
+        all.push_back(out2);
+
+        NetworkPtr net(new Network(inputs, outputs, all, 0));
+        // links keep the default trait, so adaptation leaves them alone
+        net->adaptable = adaptable;
+        return net;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( test_opennero )
+
+BOOST_AUTO_TEST_CASE( test_compiled_network )
+{
+    NetworkPtr graph = make_network(true);
+    NetworkPtr flat = make_network(false);
+    BOOST_REQUIRE( flat->compile() );
+
+    for (int step = 0; step < 10; ++step)
+    {
+        std::vector<F64> sensors;
+        sensors.push_back(1.0);
+        sensors.push_back(0.1 * step - 0.4);
+        graph->load_sensors(sensors);
+        flat->load_sensors(sensors);
+
+        if (step == 5)
+        {
+            F64 overrides[] = { 0.25, -0.5 };
+            graph->override_outputs(overrides);
+            flat->override_outputs(overrides);
+        }
+
+        BOOST_CHECK_EQUAL( graph->activate(), flat->activate() );
+        for (size_t i = 0; i < graph->all_nodes.size(); ++i)
+        {
+            BOOST_CHECK_EQUAL( graph->all_nodes[i]->activation, flat->all_nodes[i]->activation );
+            BOOST_CHECK_EQUAL( graph->all_nodes[i]->last_activation, flat->all_nodes[i]->last_activation );
+            BOOST_CHECK_EQUAL( graph->all_nodes[i]->activation_count, flat->all_nodes[i]->activation_count );
+        }
+
+        if (step == 7)
+        {
+            graph->flush();
+            flat->flush();
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE( test_batched_networks )
+{
+    // several nets with the same topology but different weights, and one other
+    std::vector<NetworkPtr> single, batched;
+    for (int i = 0; i < 5; ++i)
+    {
+        single.push_back(make_network(true, 0.5 + 0.25 * i));
+        batched.push_back(make_network(false, 0.5 + 0.25 * i));
+    }
+    single.push_back(make_network(true));
+    batched.push_back(make_network(false));
+    batched.back()->outputs[1]->add_incoming(batched.back()->inputs[1], 0.3);
+    single.back()->outputs[1]->add_incoming(single.back()->inputs[1], 0.3);
+
+    for (int step = 0; step < 10; ++step)
+    {
+        std::vector<bool> results;
+        for (size_t n = 0; n < single.size(); ++n)
+        {
+            std::vector<F64> sensors;
+            sensors.push_back(1.0);
+            sensors.push_back(0.05 * step * n - 0.3);
+            single[n]->load_sensors(sensors);
+            batched[n]->load_sensors(sensors);
+            if (step == 6 && n == 2)
+            {
+                F64 overrides[] = { 0.25, -0.5 };
+                single[n]->override_outputs(overrides);
+                batched[n]->override_outputs(overrides);
+            }
+        }
+
+        Network::activate_all(batched, results);
+        BOOST_REQUIRE_EQUAL( results.size(), single.size() );
+        for (size_t n = 0; n < single.size(); ++n)
+        {
+            BOOST_CHECK_EQUAL( single[n]->activate(), results[n] );
+            for (size_t i = 0; i < single[n]->all_nodes.size(); ++i)
+            {
+                BOOST_CHECK_CLOSE( single[n]->all_nodes[i]->activation, batched[n]->all_nodes[i]->activation, 1e-9 );
+                BOOST_CHECK_EQUAL( single[n]->all_nodes[i]->activation_count, batched[n]->all_nodes[i]->activation_count );
+            }
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,116 @@
+#include "core/Common.h"
+#include "rtneat/population.h"
+#include "rtneat/snapshot.h"
+#include "SeededPopulation.h"
+#include <algorithm>
+#include <cmath>
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace NEAT;
+
+namespace
+{
+    /// the organism remove_worst picks, found by looking at all of them
+    OrganismPtr scan_worst(PopulationPtr pop)
+    {
+        F64 min_fitness = 999999;
+        OrganismPtr worst;
+        for (size_t i = 0; i < pop->organisms.size(); ++i)
+        {
+            OrganismPtr org = pop->organisms[i];
+            F64 adjusted = org->fitness / org->species.lock()->organisms.size();
+            if (adjusted < min_fitness && org->time_alive >= static_cast<S32>(NEAT::time_alive_minimum))
+            {
+                min_fitness = adjusted;
+                worst = org;
+            }
+        }
+        return worst;
+    }
+
+    /// the average fitness of the organisms of a species that are old enough
+    F64 scan_average(SpeciesPtr species)
+    {
+        F64 total = 0;
+        F64 count = 0;
+        for (size_t i = 0; i < species->organisms.size(); ++i)
+        {
+            if (species->organisms[i]->time_alive >= static_cast<S32>(NEAT::time_alive_minimum))
+            {
+                total += species->organisms[i]->fitness;
+                ++count;
+            }
+        }
+        return count > 0 ? total / count : 0;
+    }
+
+    /// give an organism a new fitness and age, the way rtNEAT does
+    void set_organism(OrganismPtr org, F64 fitness, S32 time_alive)
+    {
+        org->fitness = fitness;
+        org->time_alive = time_alive;
+        org->species.lock()->update_org(org);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( test_opennero )
+
+BOOST_AUTO_TEST_CASE( test_fitness_index )
+{
+    U32 old_minimum = NEAT::time_alive_minimum;
+    NEAT::time_alive_minimum = 10;
+    PopulationPtr pop = make_seeded_population(2011, 40, 3);
+    BOOST_REQUIRE( pop->species.size() > 1 );
+
+    // nobody is old enough yet
+    BOOST_CHECK( !pop->remove_worst() );
+
+    for (size_t i = 0; i < pop->organisms.size(); ++i)
+    {
+        set_organism(pop->organisms[i], randfloat() * 10, randint(0, 20));
+    }
+
+    for (int round = 0; round < 30; ++round)
+    {
+        // change some of the organisms
+        for (int j = 0; j < 10; ++j)
+        {
+            OrganismPtr org = pop->organisms[randint(0, pop->organisms.size() - 1)];
+            set_organism(org, randfloat() * 10, org->time_alive + randint(0, 5));
+        }
+        for (size_t s = 0; s < pop->species.size(); ++s)
+        {
+            BOOST_CHECK_CLOSE( pop->species[s]->estimate_average() + 1, scan_average(pop->species[s]) + 1, 1e-9 );
+        }
+
+        OrganismPtr expected = scan_worst(pop);
+        size_t size = pop->organisms.size();
+        OrganismPtr removed = pop->remove_worst();
+        BOOST_REQUIRE( expected && removed );
+        BOOST_CHECK_EQUAL( removed, expected );
+        BOOST_CHECK_EQUAL( pop->organisms.size(), size - 1 );
+        BOOST_CHECK( std::find(pop->organisms.begin(), pop->organisms.end(), removed) == pop->organisms.end() );
+    }
+
+    // a frozen copy indexes its own organisms, and a new minimum age re-files them
+    PopulationPtr frozen = PopulationSnapshot::freeze(pop);
+    NEAT::time_alive_minimum = 15;
+    OrganismPtr expected = scan_worst(frozen);
+    OrganismPtr removed = frozen->remove_worst();
+    BOOST_REQUIRE( expected );
+    BOOST_CHECK_EQUAL( removed, expected );
+    BOOST_CHECK_EQUAL( pop->remove_worst()->gnome, removed->gnome );
+
+    // smited organisms go first once they reach the next multiple of the minimum age
+    OrganismPtr smited = pop->organisms.back();
+    smited->smited = true;
+    set_organism(smited, 100, 1);
+    BOOST_CHECK_EQUAL( smited->time_alive, 15 );
+    BOOST_CHECK_EQUAL( pop->remove_worst(), smited );
+
+    NEAT::time_alive_minimum = old_minimum;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
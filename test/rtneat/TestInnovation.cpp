@@ -0,0 +1,94 @@
+#include "core/Common.h"
+#include "rtneat/innovation.h"
+#include "rtneat/genome.h"
+#include "rtneat/gene.h"
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace NEAT;
+
+BOOST_AUTO_TEST_SUITE( test_opennero )
+
+BOOST_AUTO_TEST_CASE( test_innovation_registry )
+{
+    InnovationRegistry registry;
+    InnovationPtr node(new Innovation(1, 4, 10.0, 11.0, 7, 3.0));
+    InnovationPtr link(new Innovation(2, 4, 12.0, 0.5, 1));
+    registry.add(node);
+    registry.add(link);
+    BOOST_CHECK_EQUAL( registry.size(), 2 );
+
+    // a match needs the same kind of innovation at the same place
+    BOOST_CHECK( registry.find_node(1, 4, 3.0) == node );
+    BOOST_CHECK( !registry.find_node(1, 4, 2.0) );
+    BOOST_CHECK( !registry.find_node(2, 4, 0.0) );
+    BOOST_CHECK( registry.find_link(2, 4, false) == link );
+    BOOST_CHECK( !registry.find_link(2, 4, true) );
+    BOOST_CHECK( !registry.find_link(1, 4, false) );
+
+    // a later innovation with the same key never matches
+    registry.add(InnovationPtr(new Innovation(2, 4, 13.0, 0.7, 1)));
+    BOOST_CHECK( registry.find_link(2, 4, false) == link );
+
+    // innovations that are not used are forgotten after a few epochs
+    U32 old_max_age = NEAT::innovation_max_age;
+    NEAT::innovation_max_age = 2;
+    registry.next_epoch();
+    BOOST_CHECK( registry.find_node(1, 4, 3.0) == node );
+    registry.next_epoch();
+    BOOST_CHECK_EQUAL( registry.size(), 1 );
+    BOOST_CHECK( !registry.find_link(2, 4, false) );
+    BOOST_CHECK( registry.find_node(1, 4, 3.0) == node );
+    registry.next_epoch();
+    registry.next_epoch();
+    BOOST_CHECK_EQUAL( registry.size(), 0 );
+    NEAT::innovation_max_age = old_max_age;
+
+    // the innovations are listed in the order they were added
+    std::vector<InnovationPtr> innovs;
+    innovs.push_back(link);
+    innovs.push_back(node);
+    registry.set_innovations(innovs);
+    std::vector<InnovationPtr> listed = registry.get_innovations();
+    BOOST_CHECK_EQUAL_COLLECTIONS( listed.begin(), listed.end(), innovs.begin(), innovs.end() );
+
+    // or only those created or matched since an epoch
+    U32 since = registry.get_epoch() + 1;
+    registry.next_epoch();
+    BOOST_CHECK( registry.get_innovations(since).empty() );
+    BOOST_CHECK( registry.find_node(1, 4, 3.0) == node );
+    listed = registry.get_innovations(since);
+    BOOST_REQUIRE_EQUAL( listed.size(), 1 );
+    BOOST_CHECK( listed[0] == node );
+    BOOST_CHECK_EQUAL( registry.get_innovations().size(), 2 );
+    registry.clear();
+    BOOST_CHECK_EQUAL( registry.size(), 0 );
+}
+
+BOOST_AUTO_TEST_CASE( test_repeated_innovation )
+{
+    // the same new node in two copies of a genome gets the same numbers
+    NEAT::NEATRandGen.seed(3);
+    GenomePtr genome(new Genome(2, 1, 0, 0));
+    InnovationRegistry registry;
+    S32 node_id = genome->get_last_node_id() + 1;
+    F64 innov = genome->get_last_gene_innovnum() + 1;
+
+    GenomePtr first(new Genome(*genome));
+    NEAT::NEATRandGen.seed(5);
+    BOOST_REQUIRE( first->mutate_add_node(registry, node_id, innov) );
+    BOOST_CHECK_EQUAL( registry.size(), 1 );
+
+    GenomePtr second(new Genome(*genome));
+    NEAT::NEATRandGen.seed(5);
+    BOOST_REQUIRE( second->mutate_add_node(registry, node_id, innov) );
+    BOOST_CHECK_EQUAL( registry.size(), 1 );
+
+    BOOST_REQUIRE_EQUAL( first->genes.size(), second->genes.size() );
+    for (size_t i = 0; i < first->genes.size(); ++i)
+        BOOST_CHECK_EQUAL( first->genes[i]->innovation_num, second->genes[i]->innovation_num );
+    BOOST_CHECK_EQUAL( first->get_last_node_id(), second->get_last_node_id() );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,189 @@
+#include "core/Common.h"
+#include "rtneat/island.h"
+#include "rtneat/population.h"
+#include "rtneat/gene.h"
+#include <boost/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+// the islands talk over Unix domain sockets, which Windows builds leave out
+#ifndef _WIN32
+#include <unistd.h>
+
+using namespace NEAT;
+
+namespace
+{
+    /// the innovation numbers of a genome, in order
+    std::vector<F64> innovation_numbers(const Genome& genome)
+    {
+        std::vector<F64> numbers;
+        for (size_t i = 0; i < genome.genes.size(); ++i)
+            numbers.push_back(genome.genes[i]->innovation_num);
+        return numbers;
+    }
+
+    /// the node ids of a genome, in order
+    std::vector<S32> node_ids(const Genome& genome)
+    {
+        std::vector<S32> ids;
+        for (size_t i = 0; i < genome.nodes.size(); ++i)
+            ids.push_back(genome.nodes[i]->node_id);
+        return ids;
+    }
+
+    /// polls the coordinator until told to stop
+    struct CoordinatorLoop
+    {
+        IslandCoordinator* coordinator;
+        boost::mutex mutex;
+        bool stop;
+
+        bool stopped()
+        {
+            boost::mutex::scoped_lock lock(mutex);
+            return stop;
+        }
+
+        void run()
+        {
+            while (!stopped())
+                coordinator->poll(10);
+        }
+    };
+}
+
+BOOST_AUTO_TEST_SUITE( test_opennero )
+
+BOOST_AUTO_TEST_CASE( test_innovation_merger )
+{
+    GenomePtr start(new Genome(3, 2, 0, 0));
+
+    // the same new node on two islands, with the numbers of each island
+    GenomePtr genomes[2];
+    InnovationRegistry registries[2];
+    for (U32 island = 0; island < 2; ++island)
+    {
+        genomes[island] = start->duplicate(island);
+        S32 cur_node_id = std::max(start->get_last_node_id(), static_cast<S32>(island * ISLAND_NODE_RANGE));
+        F64 cur_innov_num = std::max(start->get_last_gene_innovnum(), island * ISLAND_INNOVATION_RANGE);
+        NEAT::NEATRandGen.seed(5);
+        BOOST_REQUIRE( genomes[island]->mutate_add_node(registries[island], cur_node_id, cur_innov_num) );
+    }
+    BOOST_REQUIRE( innovation_numbers(*genomes[0]) != innovation_numbers(*genomes[1]) );
+
+    InnovationMerger merger;
+    merger.add_innovations(0, registries[0].get_innovations());
+    merger.add_innovations(1, registries[1].get_innovations());
+    BOOST_CHECK_EQUAL( merger.size(), 1u );
+
+    // a migrant from island 1 lines up with the genomes of island 0
+    std::vector<InnovationPtr> unseen;
+    GenomePtr migrant = genomes[1]->duplicate(2);
+    merger.translate(*migrant, 0, unseen);
+    BOOST_CHECK( unseen.empty() );
+    BOOST_CHECK( innovation_numbers(*migrant) == innovation_numbers(*genomes[0]) );
+    BOOST_CHECK( node_ids(*migrant) == node_ids(*genomes[0]) );
+
+    // an island that has not seen the new node gets the first numbers, once
+    migrant = genomes[1]->duplicate(3);
+    merger.translate(*migrant, 2, unseen);
+    BOOST_CHECK( innovation_numbers(*migrant) == innovation_numbers(*genomes[0]) );
+    BOOST_REQUIRE_EQUAL( unseen.size(), 1u );
+    BOOST_CHECK_EQUAL( unseen[0]->innovation_type, NEWNODE );
+    BOOST_CHECK_EQUAL( unseen[0]->newnode_id, genomes[0]->nodes.back()->node_id );
+    unseen.clear();
+    merger.translate(*genomes[1]->duplicate(4), 2, unseen);
+    BOOST_CHECK( unseen.empty() );
+
+    // island 1 still gets its own numbers back
+    migrant = genomes[0]->duplicate(5);
+    merger.translate(*migrant, 1, unseen);
+    BOOST_CHECK( innovation_numbers(*migrant) == innovation_numbers(*genomes[1]) );
+    BOOST_CHECK( node_ids(*migrant) == node_ids(*genomes[1]) );
+}
+
+BOOST_AUTO_TEST_CASE( test_island_migration )
+{
+    std::string path = "/tmp/opennero_island_test_" + boost::lexical_cast<std::string>(getpid());
+    IslandCoordinator coordinator(path);
+    BOOST_REQUIRE( coordinator.listen() );
+    CoordinatorLoop loop;
+    loop.coordinator = &coordinator;
+    loop.stop = false;
+    boost::thread polling(boost::bind(&CoordinatorLoop::run, &loop));
+
+    NEAT::NEATRandGen.seed(11);
+    GenomePtr start(new Genome(3, 2, 0, 0));
+    PopulationPtr pops[2];
+    IslandClient clients[2];
+    for (S32 island = 0; island < 2; ++island)
+    {
+        pops[island].reset(new Population(start, 10));
+        BOOST_REQUIRE( clients[island].connect(path, 5000) );
+        BOOST_CHECK_EQUAL( clients[island].get_island_id(), island );
+        clients[island].claim_numbers(pops[island]);
+    }
+    BOOST_CHECK( pops[1]->cur_node_id >= ISLAND_NODE_RANGE );
+    BOOST_CHECK( pops[1]->cur_innov_num >= ISLAND_INNOVATION_RANGE );
+
+    // only the organisms that are old enough are sent, the fittest first
+    for (size_t i = 0; i < pops[0]->organisms.size(); ++i)
+    {
+        pops[0]->organisms[i]->fitness = i;
+        pops[0]->organisms[i]->time_alive = i < 5 ? 0 : NEAT::time_alive_minimum;
+    }
+    BOOST_CHECK( clients[0].send_migrants(pops[0], 3) );
+
+    std::deque<GenomePtr> migrants;
+    for (int tries = 0; tries < 200 && migrants.size() < 3; ++tries)
+    {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+        clients[1].receive_migrants(pops[1], migrants);
+    }
+    BOOST_REQUIRE_EQUAL( migrants.size(), 3u );
+    GenomePtr best = pops[0]->organisms.back()->gnome;
+    BOOST_CHECK( innovation_numbers(*migrants[0]) == innovation_numbers(*best) );
+    BOOST_CHECK_EQUAL( migrants[0]->genes.size(), best->genes.size() );
+    BOOST_CHECK_EQUAL( migrants[0]->genes[0]->lnk->weight, best->genes[0]->lnk->weight );
+
+    // nothing comes back to the island that sent them
+    std::deque<GenomePtr> returned;
+    clients[0].receive_migrants(pops[0], returned);
+    BOOST_CHECK( returned.empty() );
+
+    // a later send only carries the new innovations, which still reach
+    // the other island with the migrant that uses them
+    pops[0]->innovations.next_epoch();
+    BOOST_REQUIRE( best->mutate_add_node(pops[0]->innovations, pops[0]->cur_node_id, pops[0]->cur_innov_num) );
+    std::vector<InnovationPtr> made = pops[0]->innovations.get_innovations(pops[0]->innovations.get_epoch());
+    BOOST_REQUIRE_EQUAL( made.size(), 1u );
+    BOOST_CHECK( clients[0].send_migrants(pops[0], 1) );
+    migrants.clear();
+    for (int tries = 0; tries < 200 && migrants.empty(); ++tries)
+    {
+        boost::this_thread::sleep(boost::posix_time::milliseconds(10));
+        clients[1].receive_migrants(pops[1], migrants);
+    }
+    BOOST_REQUIRE_EQUAL( migrants.size(), 1u );
+    BOOST_CHECK( innovation_numbers(*migrants[0]) == innovation_numbers(*best) );
+    BOOST_CHECK( pops[1]->innovations.find_node(made[0]->node_in_id, made[0]->node_out_id, made[0]->old_innov_num) );
+
+    {
+        boost::mutex::scoped_lock lock(loop.mutex);
+        loop.stop = true;
+    }
+    polling.join();
+    BOOST_CHECK_EQUAL( coordinator.num_migrants(), 4u );
+    clients[0].close();
+    clients[1].close();
+    coordinator.close();
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+#endif // _WIN32
@@ -0,0 +1,167 @@
+#include "core/Common.h"
+#include "core/ThreadPool.h"
+#include "rtneat/population.h"
+#include <cmath>
+#include <map>
+#include <utility>
+#include <vector>
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace NEAT;
+
+namespace
+{
+    /// reproduction settings that use every kind of offspring, put back
+    /// to what they were when they go out of scope (epoch also adjusts
+    /// compat_threshold, so every run starts from them afresh)
+    struct EpochParams
+    {
+        std::vector<std::pair<F64*, F64> > saved_reals;
+        std::vector<std::pair<S32*, S32> > saved_ints;
+
+        EpochParams()
+        {
+            set(NEAT::pop_size, 40);
+            set(NEAT::disjoint_coeff, 1.0);
+            set(NEAT::excess_coeff, 1.0);
+            set(NEAT::mutdiff_coeff, 0.4);
+            set(NEAT::compat_threshold, 1.0);
+            set(NEAT::age_significance, 1.0);
+            set(NEAT::survival_thresh, 0.4);
+            set(NEAT::dropoff_age, 15);
+            set(NEAT::babies_stolen, 0);
+            set(NEAT::weight_mut_power, 2.5);
+            set(NEAT::recur_prob, 0.2);
+            set(NEAT::recur_only_prob, 0);
+            set(NEAT::newlink_tries, 20);
+            set(NEAT::mutate_only_prob, 0.25);
+            set(NEAT::mutate_add_node_prob, 0.1);
+            set(NEAT::mutate_add_link_prob, 0.2);
+            set(NEAT::mutate_link_weights_prob, 0.9);
+            set(NEAT::mutate_toggle_enable_prob, 0.05);
+            set(NEAT::mutate_gene_reenable_prob, 0.05);
+            set(NEAT::mutate_random_trait_prob, 0);
+            set(NEAT::mutate_link_trait_prob, 0);
+            set(NEAT::mutate_node_trait_prob, 0);
+            set(NEAT::interspecies_mate_rate, 0.05);
+            set(NEAT::mate_multipoint_prob, 0.6);
+            set(NEAT::mate_multipoint_avg_prob, 0.4);
+            set(NEAT::mate_singlepoint_prob, 0);
+            set(NEAT::mate_only_prob, 0.2);
+        }
+
+        ~EpochParams()
+        {
+            for (size_t i = saved_reals.size(); i > 0; --i)
+                *saved_reals[i - 1].first = saved_reals[i - 1].second;
+            for (size_t i = saved_ints.size(); i > 0; --i)
+                *saved_ints[i - 1].first = saved_ints[i - 1].second;
+        }
+
+        void set(F64& param, F64 value)
+        {
+            saved_reals.push_back(std::make_pair(&param, param));
+            param = value;
+        }
+
+        void set(S32& param, S32 value)
+        {
+            saved_ints.push_back(std::make_pair(&param, param));
+            param = value;
+        }
+    };
+
+    /// a fitness that only depends on the genome
+    F64 fitness_of(const Genome& genome)
+    {
+        F64 fitness = 1.0;
+        for (size_t i = 0; i < genome.genes.size(); ++i)
+            if (genome.genes[i]->enable)
+                fitness += std::fabs(genome.genes[i]->lnk->weight);
+        return fitness;
+    }
+
+    /// a few generations from the same seed, with a given thread pool
+    PopulationPtr evolve(OpenNero::ThreadPoolPtr pool)
+    {
+        EpochParams params;
+        NEAT::NEATRandGen.seed(2024);
+        GenomePtr start(new Genome(3, 2, 0, 0));
+        PopulationPtr pop(new Population(start, NEAT::pop_size));
+        NEAT::thread_pool = pool;
+        for (S32 generation = 1; generation <= 6; ++generation)
+        {
+            for (size_t i = 0; i < pop->organisms.size(); ++i)
+                pop->organisms[i]->fitness = fitness_of(*pop->organisms[i]->gnome);
+            pop->epoch(generation);
+        }
+        NEAT::thread_pool.reset();
+        return pop;
+    }
+
+    /// the genomes and species of a population in order
+    std::vector<F64> describe(PopulationPtr pop)
+    {
+        std::vector<F64> description;
+        for (size_t i = 0; i < pop->organisms.size(); ++i)
+        {
+            const Genome& genome = *pop->organisms[i]->gnome;
+            description.push_back(pop->organisms[i]->species.lock()->id);
+            for (size_t j = 0; j < genome.nodes.size(); ++j)
+                description.push_back(genome.nodes[j]->node_id);
+            for (size_t j = 0; j < genome.genes.size(); ++j)
+            {
+                description.push_back(genome.genes[j]->innovation_num);
+                description.push_back(genome.genes[j]->lnk->weight);
+            }
+        }
+        return description;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( test_opennero )
+
+BOOST_AUTO_TEST_CASE( test_parallel_epoch )
+{
+    OpenNero::ThreadPoolPtr one(new OpenNero::ThreadPool(1));
+    OpenNero::ThreadPoolPtr four(new OpenNero::ThreadPool(4));
+    PopulationPtr first = evolve(one);
+    PopulationPtr second = evolve(four);
+    PopulationPtr third = evolve(four);
+    PopulationPtr serial = evolve(OpenNero::ThreadPoolPtr());
+    BOOST_CHECK_EQUAL( serial->organisms.size(), static_cast<size_t>(40) );
+
+    // the outcome only depends on the seed
+    std::vector<F64> expected = describe(first);
+    std::vector<F64> parallel = describe(second);
+    std::vector<F64> repeated = describe(third);
+    BOOST_CHECK_EQUAL_COLLECTIONS( parallel.begin(), parallel.end(), expected.begin(), expected.end() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( repeated.begin(), repeated.end(), expected.begin(), expected.end() );
+    BOOST_CHECK_EQUAL( second->cur_node_id, first->cur_node_id );
+    BOOST_CHECK_EQUAL( second->cur_innov_num, first->cur_innov_num );
+
+    // the species made new structure, and the same innovation number
+    // always means the same link
+    BOOST_CHECK( first->cur_node_id > 6 );
+    std::map<F64, std::pair<S32, S32> > links;
+    for (size_t i = 0; i < second->organisms.size(); ++i)
+    {
+        Genome& genome = *second->organisms[i]->gnome;
+        BOOST_CHECK( genome.verify() );
+        for (size_t j = 0; j < genome.genes.size(); ++j)
+        {
+            const Gene& gene = *genome.genes[j];
+            std::pair<S32, S32> link(gene.lnk->get_in_node()->node_id, gene.lnk->get_out_node()->node_id);
+            if (links.count(gene.innovation_num))
+                BOOST_CHECK( links[gene.innovation_num] == link );
+            else
+                links[gene.innovation_num] = link;
+            if (j > 0)
+                BOOST_CHECK( genome.genes[j - 1]->innovation_num <= gene.innovation_num );
+        }
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
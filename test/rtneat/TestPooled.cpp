@@ -0,0 +1,41 @@
+#include "core/Common.h"
+#include "rtneat/gene.h"
+#include "rtneat/genome.h"
+#include "rtneat/network.h"
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace NEAT;
+
+BOOST_AUTO_TEST_SUITE( test_opennero )
+
+BOOST_AUTO_TEST_CASE( test_pooled )
+{
+    // the memory of a deleted object is used for the next one
+    GenePtr gene = pooled(new Gene(1.0, NNodePtr(), NNodePtr(), false, 1.0, 0.0));
+    Gene* address = gene.get();
+    gene.reset();
+    gene = pooled(new Gene(2.0, NNodePtr(), NNodePtr(), false, 2.0, 0.0));
+    BOOST_CHECK_EQUAL( gene.get(), address );
+    BOOST_CHECK_EQUAL( gene->lnk->weight, 2.0 );
+
+    // copies of a genome and their networks go away with the copies
+    NEAT::NEATRandGen.seed(3);
+    GenomePtr genome(new Genome(3, 2, 0, 0));
+    GenomePtr copy = genome->duplicate(1);
+    NetworkPtr net = copy->genesis(1);
+    NNodeWeakPtr copied_node = copy->nodes.front();
+    NNodeWeakPtr net_node = net->all_nodes.back();
+    BOOST_CHECK( copied_node.lock() );
+    net.reset();
+    copy.reset();
+    BOOST_CHECK( copied_node.expired() );
+    BOOST_CHECK( net_node.expired() );
+
+    Genome other(*genome);
+    BOOST_CHECK_EQUAL( other.nodes.size(), genome->nodes.size() );
+    BOOST_CHECK( !genome->nodes.front()->dup );
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,164 @@
+#include "core/Common.h"
+#include "rtneat/population.h"
+#include "rtneat/snapshot.h"
+#include "SeededPopulation.h"
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace NEAT;
+
+namespace
+{
+    /// a seeded population with some added links, fitness and ages
+    PopulationPtr make_population()
+    {
+        PopulationPtr pop = make_seeded_population(1999, 30, 4);
+        for (size_t i = 0; i < pop->organisms.size(); ++i)
+        {
+            // add_link looks for loops in the phenotype the organism holds
+            pop->organisms[i]->gnome->mutate_add_link(pop->innovations, pop->cur_innov_num, 20);
+            pop->organisms[i]->fitness = 0.5 * i;
+            pop->organisms[i]->time_alive = static_cast<S32>(i);
+        }
+        return pop;
+    }
+
+    /// the text form of a population
+    std::string to_text(PopulationPtr pop, const std::string& filename)
+    {
+        {
+            std::ofstream out(filename.c_str());
+            pop->print_to_file(out);
+        }
+        std::ifstream in(filename.c_str());
+        std::stringstream text;
+        text << in.rdbuf();
+        std::remove(filename.c_str());
+        return text.str();
+    }
+
+    /// the shortest of a few loads of a population file, in seconds
+    template <typename Load>
+    F64 time_load(Load load, const std::string& filename)
+    {
+        F64 best = 0;
+        for (S32 i = 0; i < 3; ++i)
+        {
+            boost::posix_time::ptime start = boost::posix_time::microsec_clock::universal_time();
+            PopulationPtr pop = load(filename);
+            boost::posix_time::time_duration took = boost::posix_time::microsec_clock::universal_time() - start;
+            BOOST_REQUIRE( pop );
+            F64 seconds = took.total_microseconds() / 1e6;
+            if (i == 0 || seconds < best)
+                best = seconds;
+        }
+        return best;
+    }
+
+    PopulationPtr load_text(const std::string& filename)
+    {
+        return PopulationPtr(new Population(filename));
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( test_opennero )
+
+BOOST_AUTO_TEST_CASE( test_population_snapshot )
+{
+    NEAT::compat_threshold = 1.5;
+    PopulationPtr pop = make_population();
+    const std::string snap_file = "test_population.snap";
+    BOOST_REQUIRE( PopulationSnapshot::save(pop, snap_file) );
+    BOOST_CHECK( PopulationSnapshot::is_snapshot(snap_file) );
+
+    PopulationPtr loaded = PopulationSnapshot::load(snap_file);
+    BOOST_CHECK_EQUAL( to_text(pop, "test_population_a.txt"), to_text(loaded, "test_population_b.txt") );
+    BOOST_CHECK_EQUAL( loaded->cur_node_id, pop->cur_node_id );
+    BOOST_CHECK_EQUAL( loaded->cur_innov_num, pop->cur_innov_num );
+    BOOST_CHECK_EQUAL( loaded->last_species, pop->last_species );
+    BOOST_CHECK_EQUAL( loaded->innovations.size(), pop->innovations.size() );
+
+    // the species come back as they were, not speciated again
+    BOOST_REQUIRE_EQUAL( loaded->species.size(), pop->species.size() );
+    for (size_t i = 0; i < pop->species.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL( loaded->species[i]->id, pop->species[i]->id );
+        BOOST_CHECK_EQUAL( loaded->species[i]->organisms.size(), pop->species[i]->organisms.size() );
+    }
+    BOOST_REQUIRE_EQUAL( loaded->organisms.size(), pop->organisms.size() );
+    for (size_t i = 0; i < pop->organisms.size(); ++i)
+    {
+        BOOST_CHECK_EQUAL( loaded->organisms[i]->fitness, pop->organisms[i]->fitness );
+        BOOST_CHECK_EQUAL( loaded->organisms[i]->time_alive, pop->organisms[i]->time_alive );
+        BOOST_CHECK_EQUAL( loaded->organisms[i]->species.lock()->id, pop->organisms[i]->species.lock()->id );
+        BOOST_CHECK_EQUAL( loaded->organisms[i]->gnome->compatibility(pop->organisms[i]->gnome), 0.0 );
+    }
+
+    // text -> snapshot -> text keeps the genomes
+    const std::string text_file = "test_population.txt";
+    {
+        std::ofstream out(text_file.c_str());
+        pop->print_to_file(out);
+    }
+    BOOST_CHECK( !PopulationSnapshot::is_snapshot(text_file) );
+    BOOST_REQUIRE( PopulationSnapshot::text_to_snapshot(text_file, snap_file) );
+    BOOST_REQUIRE( PopulationSnapshot::snapshot_to_text(snap_file, "test_population_round.txt") );
+    PopulationPtr from_text(new Population(text_file));
+    PopulationPtr round_trip(new Population("test_population_round.txt"));
+    BOOST_CHECK_EQUAL( to_text(from_text, "test_population_a.txt"), to_text(round_trip, "test_population_b.txt") );
+
+    // a durable save replaces the file and leaves no temporary file behind
+    BOOST_REQUIRE( PopulationSnapshot::save(pop, snap_file, true) );
+    BOOST_CHECK( !std::ifstream((snap_file + ".tmp").c_str()) );
+    BOOST_CHECK_EQUAL( to_text(PopulationSnapshot::load(snap_file), "test_population_a.txt"),
+                       to_text(pop, "test_population_b.txt") );
+
+    // a truncated file is refused
+    {
+        std::ofstream out(snap_file.c_str(), std::ios::binary | std::ios::trunc);
+        out << "NEATSNAP";
+    }
+    BOOST_CHECK_THROW( PopulationSnapshot::load(snap_file), std::runtime_error );
+
+    std::remove(snap_file.c_str());
+    std::remove(text_file.c_str());
+    std::remove("test_population_round.txt");
+}
+
+BOOST_AUTO_TEST_CASE( test_population_snapshot_load_time )
+{
+    // a population the size of a long run: many organisms with grown genomes,
+    // speciated with the threshold the mods ship with
+    F64 old_threshold = NEAT::compat_threshold;
+    NEAT::compat_threshold = 4.0;
+    PopulationPtr pop = make_seeded_population(2012, 1000, 24);
+    for (size_t i = 0; i < pop->organisms.size(); ++i)
+        for (S32 j = 0; j < 4; ++j)
+            pop->organisms[i]->gnome->mutate_add_link(pop->innovations, pop->cur_innov_num, 20);
+
+    const std::string text_file = "test_population_large.txt";
+    const std::string snap_file = "test_population_large.snap";
+    {
+        std::ofstream out(text_file.c_str());
+        pop->print_to_file(out);
+    }
+    BOOST_REQUIRE( PopulationSnapshot::save(pop, snap_file) );
+
+    F64 text_time = time_load(&load_text, text_file);
+    F64 snap_time = time_load(&PopulationSnapshot::load, snap_file);
+    BOOST_TEST_MESSAGE( "loading " << pop->organisms.size() << " organisms: text " << text_time
+                        << " s, snapshot " << snap_time << " s, "
+                        << text_time / snap_time << " times faster" );
+    BOOST_CHECK( snap_time < text_time );
+
+    std::remove(text_file.c_str());
+    std::remove(snap_file.c_str());
+    NEAT::compat_threshold = old_threshold;
+}
+
+BOOST_AUTO_TEST_SUITE_END()
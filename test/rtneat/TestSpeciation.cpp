@@ -0,0 +1,104 @@
+#include "core/Common.h"
+#include "core/ThreadPool.h"
+#include "rtneat/population.h"
+#include "rtneat/innovation.h"
+#include "SeededPopulation.h"
+
+#define BOOST_TEST_DYN_LINK
+#include <boost/test/unit_test.hpp>
+
+using namespace NEAT;
+
+namespace
+{
+    /// the same seeded population, speciated with a given thread pool
+    PopulationPtr make_population(OpenNero::ThreadPoolPtr pool)
+    {
+        NEAT::thread_pool = pool;
+        PopulationPtr pop = make_seeded_population(2011, 60, 4);
+        NEAT::thread_pool.reset();
+        return pop;
+    }
+
+    /// the ids of the species of all the organisms
+    std::vector<S32> species_ids(PopulationPtr pop)
+    {
+        std::vector<S32> ids;
+        for (size_t i = 0; i < pop->organisms.size(); ++i)
+            ids.push_back(pop->organisms[i]->species.lock()->id);
+        return ids;
+    }
+}
+
+BOOST_AUTO_TEST_SUITE( test_opennero )
+
+BOOST_AUTO_TEST_CASE( test_speciation )
+{
+    NEAT::disjoint_coeff = 1.0;
+    NEAT::excess_coeff = 1.0;
+    NEAT::mutdiff_coeff = 0.4;
+    NEAT::compat_threshold = 1.5;
+
+    PopulationPtr serial = make_population(OpenNero::ThreadPoolPtr());
+    OpenNero::ThreadPoolPtr pool(new OpenNero::ThreadPool(4));
+    PopulationPtr parallel = make_population(pool);
+
+    // place the organisms one by one as speciate used to
+    std::vector<OrganismPtr> reps;
+    std::vector<S32> expected;
+    for (size_t i = 0; i < serial->organisms.size(); ++i)
+    {
+        size_t j = 0;
+        while (j < reps.size() &&
+               !(serial->organisms[i]->gnome->compatibility(reps[j]->gnome) < NEAT::compat_threshold))
+            ++j;
+        if (j == reps.size())
+            reps.push_back(serial->organisms[i]);
+        expected.push_back(static_cast<S32>(j + 1));
+    }
+    BOOST_REQUIRE( reps.size() > 3 );
+    BOOST_REQUIRE( reps.size() < serial->organisms.size() );
+
+    std::vector<S32> serial_ids = species_ids(serial);
+    std::vector<S32> parallel_ids = species_ids(parallel);
+    BOOST_CHECK_EQUAL_COLLECTIONS( serial_ids.begin(), serial_ids.end(), expected.begin(), expected.end() );
+    BOOST_CHECK_EQUAL_COLLECTIONS( parallel_ids.begin(), parallel_ids.end(), expected.begin(), expected.end() );
+
+    // reassign everyone with a different threshold, with and without threads
+    NEAT::compat_threshold = 1.0;
+    for (size_t i = 0; i < serial->organisms.size(); ++i)
+        serial->reassign_species(serial->organisms[i]);
+    NEAT::thread_pool = pool;
+    for (size_t i = 0; i < parallel->organisms.size(); ++i)
+        parallel->reassign_species(parallel->organisms[i]);
+    NEAT::thread_pool.reset();
+
+    serial_ids = species_ids(serial);
+    parallel_ids = species_ids(parallel);
+    BOOST_CHECK_EQUAL_COLLECTIONS( serial_ids.begin(), serial_ids.end(), parallel_ids.begin(), parallel_ids.end() );
+    BOOST_CHECK_EQUAL( serial->species.size(), parallel->species.size() );
+}
+
+BOOST_AUTO_TEST_CASE( test_gene_keys )
+{
+    NEAT::NEATRandGen.seed(7);
+    GenomePtr genome(new Genome(3, 1, 0, 0));
+    GenomePtr other(new Genome(*genome));
+    BOOST_CHECK_EQUAL( genome->compatibility(other), 0.0 );
+
+    // the cached keys follow the mutations
+    InnovationRegistry innovs;
+    S32 node_id = genome->get_last_node_id() + 1;
+    F64 innov = genome->get_last_gene_innovnum() + 1;
+    BOOST_REQUIRE( other->mutate_add_node(innovs, node_id, innov) );
+    BOOST_CHECK_EQUAL( other->gene_keys().size(), other->genes.size() );
+    NEAT::mutdiff_coeff = 0.0;
+    BOOST_CHECK_EQUAL( genome->compatibility(other), 2.0 * NEAT::excess_coeff );
+
+    NEAT::mutdiff_coeff = 1.0;
+    other->mutate_link_weights(1.0, 1.0, COLDGAUSSIAN);
+    for (size_t i = 0; i < other->genes.size(); ++i)
+        BOOST_CHECK_EQUAL( other->gene_keys()[i].mutation_num, other->genes[i]->mutation_num );
+}
+
+BOOST_AUTO_TEST_SUITE_END()